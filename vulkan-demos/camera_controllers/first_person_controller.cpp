@@ -15,9 +15,41 @@ void first_person_controller::update()
 {
     if(_lock)
         return;
-    double xpos, ypos;
+    
+    update(read_input());
+}
 
-    glfwGetCursorPos(_window, &xpos, &ypos);
+controller_input first_person_controller::read_input()
+{
+    controller_input input {};
+    double current_time = glfwGetTime();
+    input.delta_time = current_time - _time;
+    _time = current_time;
+    
+    //note: no window, nothing is pressed and the cursor does not move
+    if(_window == nullptr)
+        return input;
+    
+    glfwGetCursorPos(_window, &input.cursor_x, &input.cursor_y);
+    
+    if (glfwGetKey(_window, GLFW_KEY_UP) == GLFW_PRESS || glfwGetKey(_window, GLFW_KEY_W) == GLFW_PRESS)
+        input.keys |= controller_input::MOVE_FORWARD;
+    if (glfwGetKey(_window, GLFW_KEY_DOWN) == GLFW_PRESS || glfwGetKey(_window, GLFW_KEY_S) == GLFW_PRESS)
+        input.keys |= controller_input::MOVE_BACKWARD;
+    if (glfwGetKey(_window, GLFW_KEY_RIGHT) == GLFW_PRESS || glfwGetKey(_window, GLFW_KEY_D) == GLFW_PRESS)
+        input.keys |= controller_input::MOVE_RIGHT;
+    if (glfwGetKey(_window, GLFW_KEY_LEFT) == GLFW_PRESS || glfwGetKey(_window, GLFW_KEY_A) == GLFW_PRESS)
+        input.keys |= controller_input::MOVE_LEFT;
+    
+    return input;
+}
+
+void first_person_controller::update(const controller_input& input)
+{
+    if(_lock)
+        return;
+    double xpos = input.cursor_x;
+    double ypos = input.cursor_y;
 
     if (_first_update) {
         _target_camera->forward = _rendering_camera->forward;
@@ -47,30 +79,27 @@ void first_person_controller::update()
     _target_camera->forward = new_direction;
 
 
-    double current_time = glfwGetTime();
-    _delta_time = current_time - _time;
-    
-    _time = current_time;
+    _delta_time = input.delta_time;
     // ----------
     // Position.
     // ----------
     // Move forward.
-    if (glfwGetKey(_window, GLFW_KEY_UP) == GLFW_PRESS || glfwGetKey(_window, GLFW_KEY_W) == GLFW_PRESS)
+    if (input.keys & controller_input::MOVE_FORWARD)
     {
         _target_camera->position += _target_camera->front() * (float)_delta_time * CAMERA_SPEED;
     }
     // Move backward.
-    if (glfwGetKey(_window, GLFW_KEY_DOWN) == GLFW_PRESS || glfwGetKey(_window, GLFW_KEY_S) == GLFW_PRESS)
+    if (input.keys & controller_input::MOVE_BACKWARD)
     {
         _target_camera->position -= _target_camera->front() * (float)_delta_time * CAMERA_SPEED;
     }
     // Strafe right.
-    if (glfwGetKey(_window, GLFW_KEY_RIGHT) == GLFW_PRESS || glfwGetKey(_window, GLFW_KEY_D) == GLFW_PRESS)
+    if (input.keys & controller_input::MOVE_RIGHT)
     {
         _target_camera->position += _target_camera->right() * (float)_delta_time * CAMERA_SPEED;
     }
     // Strafe left.
-    if (glfwGetKey(_window, GLFW_KEY_LEFT) == GLFW_PRESS || glfwGetKey(_window, GLFW_KEY_A) == GLFW_PRESS)
+    if (input.keys & controller_input::MOVE_LEFT)
     {
         _target_camera->position -= _target_camera->right() * (float)_delta_time * CAMERA_SPEED;
     }
@@ -22,6 +22,24 @@
 #include "../vulkan_wrapper/cameras/camera.h"
 #include "vulkan_wrapper/cameras/perspective_camera.h"
 
+//note: what first_person_controller reads from the window in one update, see input_recorder.h
+struct controller_input
+{
+    enum keys : uint32_t
+    {
+        MOVE_FORWARD = 1u << 0u,
+        MOVE_BACKWARD = 1u << 1u,
+        MOVE_RIGHT = 1u << 2u,
+        MOVE_LEFT = 1u << 3u
+    };
+    
+    double cursor_x = 0.0;
+    double cursor_y = 0.0;
+    uint32_t keys = 0;
+    //note: seconds since the last update
+    double delta_time = 0.0;
+};
+
 class first_person_controller {
 public:
     
@@ -40,6 +58,12 @@ public:
     first_person_controller() { delete _target_camera; }
     
     void update();
+    
+    //note: reads the cursor, the keys and the time from the window, update(read_input()) is what update does
+    controller_input read_input();
+    //note: moves the camera the same way every time it is given the same input, recorded input replays the path it was
+    //recorded with
+    void update(const controller_input& input);
     void reset(){ _first_update = true; }
 private:
     bool _first_update = true;
@@ -0,0 +1,82 @@
+//
+//  input_recorder.cpp
+//  vulkan-demos
+//
+//  Created by Rafael Sabino on 10/19/26.
+//  Copyright © 2026 Rafael Sabino. All rights reserved.
+//
+
+#include "input_recorder.h"
+#include <cstdio>
+
+void input_recorder::add_key(int32_t key)
+{
+    if(_pending_keys.size() < MAX_KEYS)
+        _pending_keys.push_back(key);
+}
+
+void input_recorder::add_frame(const controller_input& input)
+{
+    frame f {};
+    f.input = input;
+    f.keys = _pending_keys;
+    _frames.push_back(f);
+    _pending_keys.clear();
+}
+
+bool input_recorder::write(const char* path) const
+{
+    FILE* file = fopen(path, "wb");
+    if(file == nullptr)
+        return false;
+
+    uint32_t header[3] = { MAGIC, VERSION, get_num_frames() };
+    bool written = fwrite(header, sizeof(header), 1, file) == 1;
+    for( const frame& f : _frames)
+    {
+        file_frame ff {};
+        ff.cursor_x = f.input.cursor_x;
+        ff.cursor_y = f.input.cursor_y;
+        ff.delta_time = f.input.delta_time;
+        ff.keys = f.input.keys;
+        ff.num_pressed = static_cast<uint32_t>(f.keys.size());
+        for( uint32_t i = 0; i < ff.num_pressed; ++i)
+        {
+            ff.pressed[i] = f.keys[i];
+        }
+        written = written && fwrite(&ff, sizeof(ff), 1, file) == 1;
+    }
+    fclose(file);
+    return written;
+}
+
+bool input_recorder::read(const char* path)
+{
+    FILE* file = fopen(path, "rb");
+    if(file == nullptr)
+        return false;
+
+    _frames.clear();
+    uint32_t header[3] = {};
+    bool read = fread(header, sizeof(header), 1, file) == 1 && header[0] == MAGIC && header[1] == VERSION;
+    for( uint32_t i = 0; read && i < header[2]; ++i)
+    {
+        file_frame ff {};
+        read = fread(&ff, sizeof(ff), 1, file) == 1 && ff.num_pressed <= MAX_KEYS;
+        if(!read)
+            break;
+
+        frame f {};
+        f.input.cursor_x = ff.cursor_x;
+        f.input.cursor_y = ff.cursor_y;
+        f.input.delta_time = ff.delta_time;
+        f.input.keys = ff.keys;
+        f.keys.assign(ff.pressed, ff.pressed + ff.num_pressed);
+        _frames.push_back(f);
+    }
+    fclose(file);
+
+    if(!read)
+        _frames.clear();
+    return read;
+}
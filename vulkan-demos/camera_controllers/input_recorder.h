@@ -0,0 +1,65 @@
+//
+//  input_recorder.h
+//  vulkan-demos
+//
+//  Created by Rafael Sabino on 10/19/26.
+//  Copyright © 2026 Rafael Sabino. All rights reserved.
+//
+
+#pragma once
+
+#include <cstdint>
+#include "EASTL/fixed_vector.h"
+#include "EASTL/vector.h"
+#include "first_person_controller.h"
+
+//note: keeps what drove the camera in every frame, so a run can be played back along the same path.  A frame holds the input
+//first_person_controller read and the keys that were pressed (they switch views and controllers, see key_callback in main.mm).
+//The circle controller reads nothing, it moves the same step every update.
+//
+//recording goes like this: add_key for every key pressed during a frame, then add_frame with the input the controller was
+//updated with, then write once the run is over.  Replay reads the file and hands out the frames in order.  Frames keep the
+//seconds they took when they were recorded, replay can give them a fixed timestep instead so every run takes the same steps
+//whatever the frame rate was
+class input_recorder
+{
+public:
+
+    static constexpr uint32_t MAX_KEYS = 8u;
+
+    struct frame
+    {
+        controller_input input {};
+        eastl::fixed_vector<int32_t, MAX_KEYS, false> keys {};
+    };
+
+    //note: keys pressed past MAX_KEYS in one frame are dropped
+    void add_key(int32_t key);
+    void add_frame(const controller_input& input);
+
+    inline uint32_t get_num_frames() const { return static_cast<uint32_t>(_frames.size()); }
+    inline const frame& get_frame(uint32_t i) const { return _frames[i]; }
+
+    //note: false if the file could not be written, or read and was not written by write
+    bool write(const char* path) const;
+    bool read(const char* path);
+
+private:
+
+    static constexpr uint32_t MAGIC = 0x4e504e49u; // "INPN"
+    static constexpr uint32_t VERSION = 1u;
+
+    //note: how a frame is kept in the file
+    struct file_frame
+    {
+        double   cursor_x = 0.0;
+        double   cursor_y = 0.0;
+        double   delta_time = 0.0;
+        uint32_t keys = 0;
+        uint32_t num_pressed = 0;
+        int32_t  pressed[MAX_KEYS] = {};
+    };
+
+    eastl::vector<frame> _frames {};
+    eastl::fixed_vector<int32_t, MAX_KEYS, false> _pending_keys {};
+};
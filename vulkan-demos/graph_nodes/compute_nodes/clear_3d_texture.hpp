@@ -42,6 +42,8 @@ public:
     {
     }
     
+    virtual bool is_async_compatible() override { return true; }
+    
     virtual void init_node() override
     {
         tex_registry_type* _tex_registry = parent_type::_texture_registry;
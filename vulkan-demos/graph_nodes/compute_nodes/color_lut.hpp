@@ -69,6 +69,25 @@ public:
         }
         return true;
     }
+    
+    virtual void refresh_node_parameters(uint32_t image_id) override
+    {
+        if(_count < vk::NUM_SWAPCHAIN_IMAGES)
+            parent_type::refresh_node_parameters(image_id);
+    }
+    
+    //note: the lut is recorded for the first frame of every swapchain image, the graph records those frames every time.  After
+    //that the node records nothing
+    virtual bool hash_node_commands(uint64_t& state, uint32_t image_id) override
+    {
+        return _count >= vk::NUM_SWAPCHAIN_IMAGES;
+    }
+    
+    //note: the frames that build the lut run on the compute queue, the ones after record barriers only and stay on graphics
+    virtual bool is_async_compatible() override
+    {
+        return _count < vk::NUM_SWAPCHAIN_IMAGES;
+    }
 };
 
 template class color_lut<1>;
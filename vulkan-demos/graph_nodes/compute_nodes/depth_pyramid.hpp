@@ -0,0 +1,292 @@
+//
+//  depth_pyramid.hpp
+//  vulkan-demos
+//
+//  Created by Rafael Sabino on 10/19/26.
+//  Copyright © 2026 Rafael Sabino. All rights reserved.
+//
+
+#pragma once
+
+#include "compute_node.h"
+#include "texture_registry.h"
+#include "storage_texture_2d.h"
+#include "depth_texture.h"
+
+//builds a hierarchical depth pyramid (hi-z) out of a depth texture written by a graphics node below this one.  Level 0 is the
+//depth reduced to the previous power of two, every level after that halves the one before it.  The default reduction keeps
+//the farthest depth of every footprint, which is what occlusion culling needs with a regular 0 (near) to 1 (far) depth buffer,
+//use MIN for reversed depth.  Screen space effects can read the pyramid through get_pyramid.
+template< uint32_t NUM_CHILDREN>
+class depth_pyramid: public vk::compute_node<NUM_CHILDREN>
+{
+public:
+    using parent_type = vk::compute_node<NUM_CHILDREN>;
+    using tex_registry_type = typename parent_type::tex_registry_type;
+    using material_store_type = typename vk::node<NUM_CHILDREN>::material_store_type;
+    using compute_pipeline_type = typename parent_type::compute_pipeline_type;
+
+    //must match local_size_x and local_size_y in depth_pyramid.comp
+    static constexpr uint32_t LOCAL_GROUP_SIZE = 8u;
+    static constexpr uint32_t MAX_LEVELS = vk::storage_texture_2d::MAX_MIP_LEVELS;
+
+    //note: must match the reduction values in depth_pyramid.comp
+    enum class reduction
+    {
+        MIN = 0,
+        MAX = 1
+    };
+
+    depth_pyramid(vk::device* dev, const char* depth_texture, reduction r = reduction::MAX):
+    parent_type(dev, 1, 1, 1), _depth_texture(depth_texture), _reduction(r)
+    {
+    }
+
+    inline vk::storage_texture_2d& get_pyramid(uint32_t image_id){ return _pyramids[image_id]; }
+    inline uint32_t get_num_levels(){ return _num_levels; }
+    inline glm::vec2 get_dimensions(){ return glm::vec2(_pyramids[0].get_width(), _pyramids[0].get_height()); }
+    inline reduction get_reduction(){ return _reduction; }
+
+    //note: the depth is drawn in a corner of the texture when the node that writes it has dynamic resolution, level 0 then
+    //reduces that corner alone.  The pyramid covers the screen either way
+    inline void set_dynamic_resolution(bool b){ _dynamic_resolution = b; }
+
+    virtual void init_node() override
+    {
+        tex_registry_type* _tex_registry = parent_type::_texture_registry;
+
+        _depth = &_tex_registry->get_read_depth_texture_set(_depth_texture.c_str(), this, vk::usage_type::COMBINED_IMAGE_SAMPLER);
+
+        create_pyramids();
+        for( uint32_t level = 0; level < _num_levels; ++level)
+        {
+            init_level(level);
+        }
+        _num_pipelines = _num_levels;
+    }
+
+    //note: the depth texture was made again at the new size by the texture registry.  The pyramids follow it, levels that are
+    //new get their pipelines, the ones that are left only get their sizes.  The views of the levels stay where they were, so
+    //the descriptors pointing at them are written again without being set
+    virtual void resize_node(glm::vec2 old_size, glm::vec2 new_size) override
+    {
+        parent_type::resize_node(old_size, new_size);
+
+        vk::resource_set<vk::depth_texture>& depth = *_depth;
+        if(depth[0].get_width() == _depth_width && depth[0].get_height() == _depth_height)
+            return;
+
+        for( int i = 0; i < _pyramids.size(); ++i)
+        {
+            _pyramids[i].destroy();
+        }
+        create_pyramids();
+
+        for( uint32_t level = 0; level < _num_levels; ++level)
+        {
+            if(level < _num_pipelines)
+            {
+                for( uint32_t i = 0; i < vk::NUM_SWAPCHAIN_IMAGES; ++i)
+                {
+                    _level_pipelines[level].get_uniform_parameters(i, 2)["sizes"] = get_level_sizes(level);
+                }
+                continue;
+            }
+
+            init_level(level);
+            for( uint32_t i = 0; i < vk::NUM_SWAPCHAIN_IMAGES; ++i)
+            {
+                _level_pipelines[level].commit_parameter_to_gpu(i);
+            }
+        }
+        _num_pipelines = eastl::max(_num_pipelines, _num_levels);
+    }
+
+    virtual void render_scale_node(float scale) override
+    {
+        if(!_dynamic_resolution)
+            return;
+
+        _render_scale = scale;
+        for( uint32_t i = 0; i < vk::NUM_SWAPCHAIN_IMAGES; ++i)
+        {
+            _level_pipelines[0].get_uniform_parameters(i, 2)["sizes"] = get_level_sizes(0);
+        }
+    }
+
+    virtual void update_node(vk::camera& camera, uint32_t image_id) override
+    {
+    }
+
+    virtual bool record_node_commands(vk::command_recorder& buffer, uint32_t image_id) override
+    {
+        VkCommandBuffer& command = buffer.get_raw_compute_command(image_id);
+        vk::storage_texture_2d& pyramid = _pyramids[image_id];
+
+        //whoever read the pyramid last time this image was recorded must be done before we overwrite it
+        record_barrier(command, pyramid, 0, _num_levels, VK_ACCESS_SHADER_READ_BIT, VK_ACCESS_SHADER_WRITE_BIT);
+
+        for( uint32_t level = 0; level < _num_levels; ++level)
+        {
+            if(level != 0)
+                record_barrier(command, pyramid, level - 1, 1, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT);
+
+            uint32_t groups_x = (pyramid.get_mip_width(level) + LOCAL_GROUP_SIZE - 1) / LOCAL_GROUP_SIZE;
+            uint32_t groups_y = (pyramid.get_mip_height(level) + LOCAL_GROUP_SIZE - 1) / LOCAL_GROUP_SIZE;
+            _level_pipelines[level].record_dispatch_commands(command, image_id, groups_x, groups_y, 1);
+        }
+
+        //the whole pyramid is ready for the nodes that depend on it
+        record_barrier(command, pyramid, 0, _num_levels, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT);
+
+        return true;
+    }
+
+    //note: the compute pipeline in compute_node has no material, the levels are committed instead
+    virtual void refresh_node_parameters(uint32_t image_id) override
+    {
+        for( uint32_t level = 0; level < _num_levels; ++level)
+        {
+            _level_pipelines[level].commit_parameter_to_gpu(image_id);
+        }
+    }
+
+    virtual bool hash_node_commands(uint64_t& state, uint32_t image_id) override
+    {
+        vk::command_recorder::hash_state(state, reinterpret_cast<uintptr_t>(_pyramids[image_id].get_image()));
+        for( uint32_t level = 0; level < _num_levels; ++level)
+        {
+            vk::command_recorder::hash_state(state, reinterpret_cast<uintptr_t>(_level_pipelines[level].get_vk_pipeline(image_id)));
+            vk::command_recorder::hash_state(state, _level_pipelines[level].get_descriptor_writes(image_id));
+        }
+        return true;
+    }
+
+    virtual void destroy() override
+    {
+        //note: the compute pipeline in compute_node is never given a material, the levels have their own pipelines.  A resize
+        //to a smaller size can leave pipelines past the last level
+        for( uint32_t level = 0; level < _num_pipelines; ++level)
+        {
+            _level_pipelines[level].destroy();
+        }
+        for( int i = 0; i < _pyramids.size(); ++i)
+        {
+            _pyramids[i].destroy();
+        }
+    }
+
+protected:
+
+    virtual void create_gpu_resources() override
+    {
+        for( uint32_t level = 0; level < _num_levels; ++level)
+        {
+            for(int i = 0; i < vk::NUM_SWAPCHAIN_IMAGES; ++i)
+            {
+                _level_pipelines[level].commit_parameter_to_gpu(i);
+            }
+        }
+    }
+
+private:
+
+    void create_pyramids()
+    {
+        vk::resource_set<vk::depth_texture>& depth = *_depth;
+        _depth_width = depth[0].get_width();
+        _depth_height = depth[0].get_height();
+
+        uint32_t width = previous_pow2(_depth_width);
+        uint32_t height = previous_pow2(_depth_height);
+
+        for( int i = 0; i < _pyramids.size(); ++i)
+        {
+            _pyramids[i].set_device(parent_type::_device);
+            _pyramids[i].set_dimensions(width, height);
+            _pyramids[i].set_format(vk::image::formats::R32_SIGNED_FLOAT);
+            _pyramids[i].set_filter(vk::image::filter::NEAREST);
+            _pyramids[i].set_enable_mipmapping(true);
+            _pyramids[i].init();
+        }
+
+        _num_levels = _pyramids[0].get_num_mips();
+    }
+
+    //note: size of the level read from in xy, size of level in zw
+    glm::vec4 get_level_sizes(uint32_t level)
+    {
+        glm::vec2 src_size = level == 0 ? vk::scale_dimensions(glm::vec2(_depth_width, _depth_height), _render_scale) :
+                             glm::vec2(_pyramids[0].get_mip_width(level - 1), _pyramids[0].get_mip_height(level - 1));
+        glm::vec2 dst_size = glm::vec2(_pyramids[0].get_mip_width(level), _pyramids[0].get_mip_height(level));
+        return glm::vec4(src_size, dst_size);
+    }
+
+    void init_level(uint32_t level)
+    {
+        material_store_type* _mat_store = parent_type::_material_store;
+        vk::resource_set<vk::depth_texture>& depth = *_depth;
+
+        compute_pipeline_type& pipeline = _level_pipelines[level];
+        pipeline.set_device(parent_type::_device);
+        pipeline.set_material("depth_pyramid", *_mat_store);
+
+        for( uint32_t i = 0; i < vk::NUM_SWAPCHAIN_IMAGES; ++i)
+        {
+            vk::image& src = level == 0 ? static_cast<vk::image&>(depth[i]) : static_cast<vk::image&>(_pyramids[i].get_mip(level - 1));
+
+            pipeline.set_image_sampler(i, src, "src", 0, vk::usage_type::COMBINED_IMAGE_SAMPLER);
+            pipeline.set_image_sampler(i, _pyramids[i].get_mip(level), "dst", 1, vk::usage_type::STORAGE_IMAGE);
+        }
+
+        pipeline.init_parameter("sizes", get_level_sizes(level), 2);
+        pipeline.init_parameter("reduction", static_cast<int32_t>(_reduction), 2);
+    }
+
+    static uint32_t previous_pow2(uint32_t v)
+    {
+        uint32_t result = 1;
+        while( result * 2 <= v)
+            result *= 2;
+        return result;
+    }
+
+    void record_barrier(VkCommandBuffer& command, vk::storage_texture_2d& pyramid, uint32_t base_level, uint32_t level_count,
+                        VkAccessFlags src_access, VkAccessFlags dst_access)
+    {
+        VkImageMemoryBarrier barrier {};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.pNext = nullptr;
+        barrier.srcAccessMask = src_access;
+        barrier.dstAccessMask = dst_access;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = pyramid.get_image();
+        barrier.subresourceRange = { pyramid.get_aspect_flag(), base_level, level_count, 0, 1 };
+
+        vkCmdPipelineBarrier(command,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             0,
+                             0, nullptr,
+                             0, nullptr,
+                             1, &barrier);
+    }
+
+    eastl::fixed_string<char, 100> _depth_texture {};
+    reduction _reduction = reduction::MAX;
+    uint32_t _num_levels = 0;
+    uint32_t _num_pipelines = 0;
+    uint32_t _depth_width = 0;
+    uint32_t _depth_height = 0;
+    bool _dynamic_resolution = false;
+    float _render_scale = 1.0f;
+    vk::resource_set<vk::depth_texture>* _depth = nullptr;
+
+    eastl::array<vk::storage_texture_2d, vk::NUM_SWAPCHAIN_IMAGES> _pyramids {};
+    eastl::array<compute_pipeline_type, MAX_LEVELS> _level_pipelines {};
+};
+
+template class depth_pyramid<1>;
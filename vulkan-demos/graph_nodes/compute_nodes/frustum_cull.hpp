@@ -0,0 +1,254 @@
+//
+//  frustum_cull.hpp
+//  vulkan-demos
+//
+//  Created by Rafael Sabino on 10/19/26.
+//  Copyright © 2026 Rafael Sabino. All rights reserved.
+//
+
+#pragma once
+
+#include "compute_node.h"
+#include "assimp_node.h"
+#include "indirect_draws.h"
+#include "storage_buffer.h"
+#include "frustum.h"
+#include "bounds.h"
+
+//tests the bounds of every mesh of its assimp_node children against a camera frustum on the gpu and writes out the
+//indirect draws of the visible ones, packed per object when the device can draw with a count (see indirect_draws.h).
+//Graphics nodes that consume the draws should have this node as a child and call set_indirect_draws
+template< uint32_t NUM_CHILDREN>
+class frustum_cull: public vk::compute_node<NUM_CHILDREN>
+{
+public:
+    using parent_type = vk::compute_node<NUM_CHILDREN>;
+    using node_type = vk::node<NUM_CHILDREN>;
+    using material_store_type = typename vk::node<NUM_CHILDREN>::material_store_type;
+    using compute_pipeline_type = typename parent_type::compute_pipeline_type;
+    using mesh_node = vk::assimp_node<NUM_CHILDREN>;
+
+    //must match local_size_x in frustum_cull.comp
+    static constexpr uint32_t LOCAL_GROUP_SIZE = 64u;
+
+    //note: std430 layout, must match the struct in frustum_cull.comp
+    struct draw_info
+    {
+        glm::mat4   model;
+        glm::vec4   center;
+        glm::vec4   extents;
+        uint32_t    index_count;
+        uint32_t    first_index;
+        int32_t     vertex_offset;
+        uint32_t    instance_count;
+        uint32_t    first_instance;
+        uint32_t    range;
+        uint32_t    range_first;
+        uint32_t    pad;
+    };
+    static_assert(sizeof(draw_info) == 128, "draw_info does not match the shader layout");
+
+    frustum_cull(vk::device* dev):
+    parent_type(dev, 1, 1, 1)
+    {
+    }
+
+    //note: if a cull camera is not given, the camera the graph is updated with is used
+    frustum_cull(vk::device* dev, vk::camera& cull_cam):
+    parent_type(dev, 1, 1, 1), _cull_cam(&cull_cam)
+    {
+    }
+
+    virtual void add_child( node_type& child ) override
+    {
+        node_type::add_child(child);
+
+        if( child.get_instance_type() == mesh_node::get_class_type())
+        {
+            _obj_vector.push_back(static_cast<mesh_node*>(&child));
+        }
+    }
+
+    inline vk::indirect_draws& get_indirect_draws(){ return _draws; }
+
+    //note: the draws of every mesh node are filled out with the level this view picks, the passes drawing through them pick
+    //with it too.  Without one everything is drawn at full detail
+    inline void set_lod_view(const vk::lod_view& view)
+    {
+        _lod_view = &view;
+        _draws.set_lod_view(&view);
+    }
+
+    //note: visible count of the last frame this image was used in
+    inline uint32_t get_visible_count(uint32_t image_id){ return _visible_count[image_id]; }
+
+    virtual void init_node() override
+    {
+        add_draws();
+        create_draw_infos();
+        init_pipeline("frustum_cull");
+    }
+
+    virtual void update_node(vk::camera& camera, uint32_t image_id) override
+    {
+        vk::camera* cam = &camera;
+        if(_cull_cam != nullptr)
+        {
+            _cull_cam->update_view_matrix();
+            cam = _cull_cam;
+        }
+
+        _frustums[image_id].set(cam->get_projection_matrix() * cam->view_matrix);
+        _graph_cam = &camera;
+
+        vk::frustum::planes_array& planes = _frustums[image_id].get_planes();
+        parent_type::_compute_pipelines.get_uniform_parameters(image_id, 3)["planes"].set_vectors_array(planes.data(), planes.size());
+    }
+
+    //note: runs every frame, also when the command buffer that dispatches the culling is submitted again
+    virtual void refresh_node_parameters(uint32_t image_id) override
+    {
+        //note: the fence for this image has been waited on by the time we refresh, the gpu is done with these buffers
+        _visible_count[image_id] = _draws.get_visible_count(image_id);
+#if EA_DEBUG
+        if(_cpu_visible_count[image_id] != _visible_count[image_id])
+        {
+            eastl::fixed_string<char, 100> msg {};
+            msg.sprintf("gpu culling mismatch, cpu found %u visible meshes, gpu found %u", _cpu_visible_count[image_id], _visible_count[image_id]);
+            parent_type::debug_print(msg.c_str());
+        }
+#endif
+        _draws.reset_visible_count(image_id);
+        _cpu_visible_count[image_id] = write_draw_infos(image_id);
+
+        parent_type::refresh_node_parameters(image_id);
+    }
+
+    virtual void destroy() override
+    {
+        parent_type::destroy();
+        _draws.destroy();
+        for( int i = 0; i < _draw_infos.size(); ++i)
+        {
+            _draw_infos[i].destroy();
+        }
+    }
+
+protected:
+
+    void add_draws()
+    {
+        EA_ASSERT_MSG(!_obj_vector.empty(), "cull node needs assimp node children to cull");
+
+        for( int i = 0; i < _obj_vector.size(); ++i)
+        {
+            //note: slots belong to the full detail shape, whatever level is picked is written into them
+            vk::obj_shape* shape = _obj_vector[i]->get_lod(0);
+            for( uint32_t mesh_id = 0; mesh_id < shape->get_num_meshes(); ++mesh_id)
+            {
+                _draws.add_draw(shape, mesh_id);
+            }
+        }
+
+        _draws.set_device(parent_type::_device);
+        _draws.create();
+    }
+
+    void create_draw_infos()
+    {
+        for( int i = 0; i < _draw_infos.size(); ++i)
+        {
+            _draw_infos[i].set_device(parent_type::_device);
+            _draw_infos[i].create(sizeof(draw_info) * _draws.get_num_draws(), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                  VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        }
+    }
+
+    //note: binds what every culling shader shares, the draw infos, commands and visible count buffers and the cull parameters.
+    //cull shaders that need more add their bindings after calling this function
+    void init_pipeline(const char* material_name)
+    {
+        material_store_type* _mat_store = parent_type::_material_store;
+        compute_pipeline_type& _compute_pipelines = parent_type::_compute_pipelines;
+
+        _compute_pipelines.set_material(material_name, *_mat_store);
+
+        _compute_pipelines.set_storage_buffer(_draw_infos, "draw_infos", 0);
+        _compute_pipelines.set_storage_buffer(_draws.get_commands(), "commands", 1);
+        _compute_pipelines.set_storage_buffer(_draws.get_visible_count_buffers(), "visible_count", 2);
+
+        vk::frustum::planes_array planes {};
+        _compute_pipelines.init_parameter("planes", planes.data(), planes.size(), 3);
+        _compute_pipelines.init_parameter("num_draws", _draws.get_num_draws(), 3);
+
+        parent_type::set_group_size((_draws.get_num_draws() + LOCAL_GROUP_SIZE - 1) / LOCAL_GROUP_SIZE, 1, 1);
+    }
+
+    //writes the bounds and transform of every mesh for the culling shader, returns how many meshes the cpu finds inside the frustum
+    uint32_t write_draw_infos(uint32_t image_id)
+    {
+        draw_info* infos = static_cast<draw_info*>(_draw_infos[image_id].get_mapped_memory());
+        uint32_t cpu_visible_count = 0;
+
+        uint32_t slot = 0;
+        for( int i = 0; i < _obj_vector.size(); ++i)
+        {
+            vk::obj_shape* shape = _obj_vector[i]->get_lod(0);
+            if(_lod_view != nullptr)
+            {
+                EA_ASSERT_MSG(_graph_cam != nullptr, "levels of detail are picked in update_node");
+                shape = _obj_vector[i]->select_lod(*_lod_view, *_graph_cam, image_id);
+                EA_ASSERT_MSG(shape->get_num_meshes() == _obj_vector[i]->get_lod(0)->get_num_meshes(),
+                              "every level of detail needs the same number of meshes, they share draw slots");
+            }
+            //note: instances are culled together, their draw is tested with a world space box around all of them
+            bool instanced = _obj_vector[i]->get_num_instances() > 1;
+            glm::mat4 model = instanced ? glm::mat4(1.0f) : _obj_vector[i]->get_world_matrix(0);
+            const vk::instance_pool::range& instances = shape->get_instances();
+            //note: the render pass asks the same question of the same level, see render_pass::record_objects
+            bool packed = _draws.is_packed(shape);
+
+            for( uint32_t mesh_id = 0; mesh_id < shape->get_num_meshes(); ++mesh_id)
+            {
+                vk::aabb bounds = instanced ? _obj_vector[i]->get_instance_bounds(shape->get_bounds(mesh_id), image_id) :
+                                              shape->get_bounds(mesh_id);
+
+                uint32_t range_id = _draws.get_draw(slot).range;
+                draw_info& info = infos[slot++];
+                info.model = model;
+                info.center = glm::vec4(bounds.get_center(), 1.0f);
+                info.extents = glm::vec4(bounds.get_extents(), 0.0f);
+                info.index_count = shape->get_index_count(mesh_id);
+                info.first_index = shape->get_first_index(mesh_id);
+                info.vertex_offset = shape->get_vertex_offset(mesh_id);
+                info.instance_count = instances.instance_count;
+                //note: without drawIndirectFirstInstance the vertex shaders add the first instance, see set_mesh_param
+                info.first_instance = parent_type::_device->has_draw_indirect_first_instance() ? instances.first_instance : 0;
+                info.range = packed ? range_id : vk::indirect_draws::NO_RANGE;
+                info.range_first = _draws.get_range(range_id).first_slot;
+
+                //cpu reference, has to agree with frustum_cull.comp
+                if(_frustums[image_id].intersects(bounds.transform(model)))
+                    ++cpu_visible_count;
+            }
+        }
+        EA_ASSERT(slot == _draws.get_num_draws());
+
+        return cpu_visible_count;
+    }
+
+    vk::camera* _cull_cam = nullptr;
+    vk::camera* _graph_cam = nullptr;
+    const vk::lod_view* _lod_view = nullptr;
+
+    eastl::fixed_vector<mesh_node*, 20, true> _obj_vector {};
+
+    vk::indirect_draws _draws {};
+    eastl::array<vk::storage_buffer, vk::NUM_SWAPCHAIN_IMAGES> _draw_infos {};
+    eastl::array<vk::frustum, vk::NUM_SWAPCHAIN_IMAGES> _frustums {};
+
+    eastl::array<uint32_t, vk::NUM_SWAPCHAIN_IMAGES> _visible_count {};
+    eastl::array<uint32_t, vk::NUM_SWAPCHAIN_IMAGES> _cpu_visible_count {};
+};
+
+template class frustum_cull<1>;
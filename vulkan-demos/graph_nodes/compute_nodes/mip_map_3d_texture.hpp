@@ -75,6 +75,9 @@ public:
     {
         
     }
+    
+    virtual bool is_async_compatible() override { return true; }
+    
     virtual void destroy() override
     {
         vk::compute_node<NUM_CHILDREN>::destroy();
@@ -0,0 +1,192 @@
+//
+//  occlusion_cull.hpp
+//  vulkan-demos
+//
+//  Created by Rafael Sabino on 10/19/26.
+//  Copyright © 2026 Rafael Sabino. All rights reserved.
+//
+
+#pragma once
+
+#include "frustum_cull.hpp"
+#include "depth_pyramid.hpp"
+#include "hi_z_reference.h"
+#include <cstring>
+
+//two phase occlusion culling, one graphics pass is split in two and each half gets its own cull node:
+//
+//  EARLY: draws the meshes that were visible at the end of last frame and are still inside the frustum.
+//  a depth_pyramid node then builds hi-z out of the depth the early pass wrote.
+//  LATE:  tests every mesh against the frustum and the pyramid, draws the ones that became visible this frame and saves the
+//  visibility of every mesh for the next early phase.  The late graphics pass must load, not clear, its attachments.
+//
+//both phases share a visibility buffer that lives in the early node.  The graph for one pass looks like this:
+//
+//  late pass <- late cull <- depth pyramid <- early pass <- early cull
+template< uint32_t NUM_CHILDREN>
+class occlusion_cull: public frustum_cull<NUM_CHILDREN>
+{
+public:
+    using parent_type = frustum_cull<NUM_CHILDREN>;
+    using compute_node_type = vk::compute_node<NUM_CHILDREN>;
+    using compute_pipeline_type = typename parent_type::compute_pipeline_type;
+    using pyramid_type = depth_pyramid<NUM_CHILDREN>;
+
+    enum class phase
+    {
+        EARLY,
+        LATE
+    };
+
+    occlusion_cull(vk::device* dev):
+    parent_type(dev)
+    {
+    }
+
+    occlusion_cull(vk::device* dev, vk::camera& cull_cam):
+    parent_type(dev, cull_cam)
+    {
+    }
+
+    //note: the late phase culls the same meshes as the early phase, from the same camera and with the same levels of detail,
+    //give it the same assimp node children.  Set the lod view of the early phase before constructing this one
+    occlusion_cull(vk::device* dev, occlusion_cull& early, pyramid_type& pyramid):
+    parent_type(dev), _phase(phase::LATE), _early(&early), _pyramid(&pyramid)
+    {
+        EA_ASSERT_MSG(early._phase == phase::EARLY, "the late phase must be paired with an early phase");
+        parent_type::_cull_cam = early._cull_cam;
+        if(early._lod_view != nullptr)
+            parent_type::set_lod_view(*early._lod_view);
+    }
+
+    inline phase get_phase(){ return _phase; }
+    inline vk::storage_buffer& get_visibility(){ return _visibility; }
+
+    virtual void init_node() override
+    {
+        compute_pipeline_type& _compute_pipelines = compute_node_type::_compute_pipelines;
+
+        parent_type::add_draws();
+        parent_type::create_draw_infos();
+
+        if(_phase == phase::EARLY)
+        {
+            //note: every mesh starts out invisible, the first late phase draws everything that passes its tests
+            _visibility.set_device(compute_node_type::_device);
+            _visibility.create(sizeof(uint32_t) * parent_type::_draws.get_num_draws(), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                               VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+            memset(_visibility.get_mapped_memory(), 0, sizeof(uint32_t) * parent_type::_draws.get_num_draws());
+
+            parent_type::init_pipeline("occlusion_cull_early");
+            _compute_pipelines.set_storage_buffer(_visibility, "visibility", 4);
+        }
+        else
+        {
+            EA_ASSERT_MSG(_early->_visibility.is_initialized(), "the early phase has to be initialized first, it must be below the depth pyramid in the graph");
+            EA_ASSERT_MSG(_pyramid->get_reduction() == pyramid_type::reduction::MAX, "occlusion culling expects the farthest depth in the pyramid");
+            EA_ASSERT_MSG(_early->_draws.get_num_draws() == parent_type::_draws.get_num_draws(), "both phases must cull the same meshes");
+
+            for( uint32_t i = 0; i < parent_type::_draws.get_num_draws(); ++i)
+            {
+                EA_ASSERT_MSG(_early->_draws.get_draw(i).shape == parent_type::_draws.get_draw(i).shape &&
+                              _early->_draws.get_draw(i).mesh_id == parent_type::_draws.get_draw(i).mesh_id,
+                              "both phases must have the same draw slots, the visibility buffer is indexed by slot");
+            }
+
+            parent_type::init_pipeline("occlusion_cull_late");
+            _compute_pipelines.set_storage_buffer(_early->_visibility, "visibility", 4);
+
+            glm::vec2 pyramid_size = _pyramid->get_dimensions();
+            _compute_pipelines.init_parameter("view_proj", glm::mat4(1.0f), 3);
+            _compute_pipelines.init_parameter("pyramid_size", glm::vec4(pyramid_size, _pyramid->get_num_levels(), 0.0f), 3);
+
+            for( uint32_t i = 0; i < vk::NUM_SWAPCHAIN_IMAGES; ++i)
+            {
+                _compute_pipelines.set_image_sampler(i, _pyramid->get_pyramid(i), "depth_pyramid", 5, vk::usage_type::COMBINED_IMAGE_SAMPLER);
+            }
+#if EA_DEBUG
+            vk::hi_z_reference::validation_result result = vk::hi_z_reference::validate_synthetic_scene();
+            eastl::fixed_string<char, 100> msg {};
+            msg.sprintf("hi-z reference: %u of %u boxes occluded, %u occluded at full resolution", result.occluded_hi_z,
+                        result.tested, result.occluded_full_resolution);
+            compute_node_type::debug_print(msg.c_str());
+            EA_ASSERT_MSG(result.false_occlusions == 0, "hi-z culled boxes that are visible, see hi_z_reference.h");
+#endif
+        }
+    }
+
+    virtual void update_node(vk::camera& camera, uint32_t image_id) override
+    {
+        parent_type::update_node(camera, image_id);
+
+        if(_phase == phase::LATE)
+        {
+            vk::camera* cam = parent_type::_cull_cam != nullptr ? parent_type::_cull_cam : &camera;
+            vk::shader_parameter::shader_params_group& params = compute_node_type::_compute_pipelines.get_uniform_parameters(image_id, 3);
+            params["view_proj"] = cam->get_projection_matrix() * cam->view_matrix;
+            //note: the pyramid changes size with the window
+            params["pyramid_size"] = glm::vec4(_pyramid->get_dimensions(), _pyramid->get_num_levels(), 0.0f);
+        }
+    }
+
+    virtual void refresh_node_parameters(uint32_t image_id) override
+    {
+        //note: for the early phase this counts meshes visible last frame, for the late phase meshes that became visible.  Neither
+        //matches a plain frustum test, so there is no cpu comparison like in frustum_cull
+        parent_type::_visible_count[image_id] = parent_type::_draws.get_visible_count(image_id);
+        parent_type::_draws.reset_visible_count(image_id);
+        parent_type::write_draw_infos(image_id);
+
+        compute_node_type::refresh_node_parameters(image_id);
+    }
+
+    virtual bool record_node_commands(vk::command_recorder& buffer, uint32_t image_id) override
+    {
+        record_visibility_barrier(buffer.get_raw_compute_command(image_id));
+
+        return compute_node_type::record_node_commands(buffer, image_id);
+    }
+
+    virtual void destroy() override
+    {
+        parent_type::destroy();
+        _visibility.destroy();
+    }
+
+private:
+
+    //note: the visibility buffer is shared across frames, the previous cull dispatch (in this or an earlier submission) must be
+    //done with it before this one reads and writes it
+    void record_visibility_barrier(VkCommandBuffer& command)
+    {
+        vk::storage_buffer& visibility = _phase == phase::EARLY ? _visibility : _early->_visibility;
+
+        VkBufferMemoryBarrier barrier {};
+        barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        barrier.pNext = nullptr;
+        barrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.buffer = visibility.get_vk_buffer();
+        barrier.offset = 0;
+        barrier.size = VK_WHOLE_SIZE;
+
+        vkCmdPipelineBarrier(command,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             0,
+                             0, nullptr,
+                             1, &barrier,
+                             0, nullptr);
+    }
+
+    phase _phase = phase::EARLY;
+    occlusion_cull* _early = nullptr;
+    pyramid_type*   _pyramid = nullptr;
+
+    //note: one uint per draw slot, only the early phase owns it
+    vk::storage_buffer _visibility {};
+};
+
+template class occlusion_cull<1>;
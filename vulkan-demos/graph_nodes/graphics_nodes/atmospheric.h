@@ -114,6 +114,12 @@ public:
 
     }
     
+    //note: writes its own pipelines, the cameras of the faces are made here
+    virtual bool is_thread_safe() override
+    {
+        return true;
+    }
+    
     virtual void update_node(vk::camera& camera, uint32_t image_id) override
     {
         render_pass_type &pass = parent_type::_node_render_pass;
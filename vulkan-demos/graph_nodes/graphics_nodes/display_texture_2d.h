@@ -103,6 +103,21 @@ public:
     {
     }
     
+    virtual void resize_node(glm::vec2 old_size, glm::vec2 new_size) override
+    {
+        if(parent_type::_node_render_pass.get_dimensions() != old_size)
+            return;
+        
+        parent_type::resize_node(old_size, new_size);
+        subpass_type& sub_p = parent_type::_node_render_pass.get_subpass(0);
+        for( uint32_t i = 0; i < vk::NUM_SWAPCHAIN_IMAGES; ++i)
+        {
+            vk::shader_parameter::shader_params_group& vertex_params = sub_p.get_pipeline(i).get_uniform_parameters(vk::parameter_stage::VERTEX, 0);
+            vertex_params["width"] = static_cast<uint32_t>(new_size.x);
+            vertex_params["height"] = static_cast<uint32_t>(new_size.y);
+        }
+    }
+    
     virtual bool record_node_commands(vk::command_recorder& buffer, uint32_t image_id) override
     {
         parent_type::record_node_commands(buffer, image_id);
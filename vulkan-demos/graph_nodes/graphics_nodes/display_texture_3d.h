@@ -114,6 +114,21 @@ public:
         return false;
     }
     
+    virtual void resize_node(glm::vec2 old_size, glm::vec2 new_size) override
+    {
+        if(parent_type::_node_render_pass.get_dimensions() != old_size)
+            return;
+        
+        parent_type::resize_node(old_size, new_size);
+        subpass_type& sub_p = parent_type::_node_render_pass.get_subpass(0);
+        for( uint32_t i = 0; i < vk::NUM_SWAPCHAIN_IMAGES; ++i)
+        {
+            vk::shader_parameter::shader_params_group& fragment_params = sub_p.get_pipeline(i).get_uniform_parameters(vk::parameter_stage::FRAGMENT, 1);
+            fragment_params["screen_height"] = new_size.y;
+            fragment_params["screen_width"] = new_size.x;
+        }
+    }
+    
     
     virtual void destroy() override
     {
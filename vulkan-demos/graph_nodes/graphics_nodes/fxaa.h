@@ -80,6 +80,20 @@ public:
     
     }
     
+    virtual void resize_node(glm::vec2 old_size, glm::vec2 new_size) override
+    {
+        if(parent_type::_node_render_pass.get_dimensions() != old_size)
+            return;
+        
+        parent_type::resize_node(old_size, new_size);
+        subpass_type& fxaa_subpass = parent_type::_node_render_pass.get_subpass(0);
+        for( uint32_t i = 0; i < vk::NUM_SWAPCHAIN_IMAGES; ++i)
+        {
+            fxaa_subpass.get_pipeline(i).get_uniform_parameters(vk::parameter_stage::FRAGMENT, 1)["maintex_texel_size"] =
+                glm::vec4(1.0f / new_size.x, 1.0f / new_size.y, 0.0f, 0.0f);
+        }
+    }
+    
     virtual void destroy() override
     {
         _screen_plane.destroy();
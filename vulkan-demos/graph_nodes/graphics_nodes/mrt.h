@@ -235,6 +235,28 @@ public:
         
     }
     
+    virtual void resize_node(glm::vec2 old_size, glm::vec2 new_size) override
+    {
+        if(parent_type::_node_render_pass.get_dimensions() != old_size)
+            return;
+        
+        parent_type::resize_node(old_size, new_size);
+        subpass_type& composite = parent_type::_node_render_pass.get_subpass(0);
+        for( uint32_t i = 0; i < vk::NUM_SWAPCHAIN_IMAGES; ++i)
+        {
+            vk::shader_parameter::shader_params_group& vertex_params = composite.get_pipeline(i).get_uniform_parameters(vk::parameter_stage::VERTEX, 0);
+            vertex_params["width"] = new_size.x;
+            vertex_params["height"] = new_size.y;
+        }
+        set_screen_size();
+    }
+    
+    virtual void render_scale_node(float scale) override
+    {
+        parent_type::render_scale_node(scale);
+        set_screen_size();
+    }
+    
     inline void set_rendering_state( rendering_mode state ){ _rendering_mode = state; }
     
     virtual void destroy() override
@@ -245,6 +267,17 @@ public:
     
 private:
     
+    //note: the camera rays are made from the pixel in the part of the pass that is drawn
+    void set_screen_size()
+    {
+        subpass_type& composite = parent_type::_node_render_pass.get_subpass(0);
+        for( uint32_t i = 0; i < vk::NUM_SWAPCHAIN_IMAGES; ++i)
+        {
+            composite.get_pipeline(i).get_uniform_parameters(vk::parameter_stage::FRAGMENT, 5)["screen_size"] =
+                parent_type::_node_render_pass.get_render_dimensions();
+        }
+    }
+    
     rendering_mode _rendering_mode = rendering_mode::FULL_RENDERING;
     
     void setup_sampling_rays()
@@ -9,6 +9,7 @@
 #pragma once
 
 #include "graphics_node.h"
+#include "texture_streamer.h"
 
 static const uint32_t ATTACHMENTS = 4;
 template< uint32_t NUM_CHILDREN>
@@ -33,6 +34,13 @@ public:
     parent_type(dev, width, height)
     { }
     
+    //note: when set, this node draws on top of what an earlier pbr node left in the g-buffer instead of clearing it,
+    //this is how the late pass of occlusion culling is set up
+    inline void set_load_attachments(bool b)
+    {
+        _load_attachments = b;
+    }
+    
     //this node is heavy on multisampling, for an excellent explanation of how this works in vulkan, go here:
     //https://vulkan-tutorial.com/Multisampling
     virtual void init_node() override
@@ -54,27 +62,41 @@ public:
         vk::attachment_group<ATTACHMENTS>& pbr_attachment_group = pass.get_attachment_group();
         
         //all color attachments must have a resolve attachment for the multisampling to work
-        pbr_attachment_group.add_attachment(albedos, glm::vec4(0));
-        pbr_attachment_group.add_attachment(normals, glm::vec4(0));
-        pbr_attachment_group.add_attachment(positions, glm::vec4(0));
-        pbr_attachment_group.add_attachment(depth, glm::vec2(1.0f, 0.0f), true, true);
+        pbr_attachment_group.add_attachment(albedos, glm::vec4(0), !_load_attachments);
+        pbr_attachment_group.add_attachment(normals, glm::vec4(0), !_load_attachments);
+        pbr_attachment_group.add_attachment(positions, glm::vec4(0), !_load_attachments);
+        pbr_attachment_group.add_attachment(depth, glm::vec2(1.0f, 0.0f), !_load_attachments, true);
+        for( uint32_t i = 0; i < pbr_attachment_group.size(); ++i)
+        {
+            pbr_attachment_group.set_keep_contents(i, _load_attachments);
+        }
         
-        albedos.set_filter(vk::image::filter::NEAREST);
+        //note: the node that clears the g-buffer creates it
+        if(!_load_attachments)
+        {
+            albedos.set_filter(vk::image::filter::NEAREST);
 
-        depth.set_format(vk::image::formats::DEPTH_32_FLOAT);
-        depth.set_filter(vk::image::filter::NEAREST);
-        
-        normals.set_format(vk::image::formats::R32G32B32A32_SIGNED_FLOAT);
-        normals.set_filter(vk::image::filter::NEAREST);
+            //depth pyramids sample the depth, see depth_pyramid.hpp
+            for( int i = 0; i < depth.size(); ++i)
+            {
+                depth[i].set_write_to_texture(true);
+            }
+            depth.set_format(vk::image::formats::DEPTH_32_FLOAT);
+            depth.set_filter(vk::image::filter::NEAREST);
+            
+            normals.set_format(vk::image::formats::R32G32B32A32_SIGNED_FLOAT);
+            normals.set_filter(vk::image::filter::NEAREST);
 
-        positions.set_filter(vk::image::filter::NEAREST);
-        positions.set_format(vk::image::formats::R32G32B32A32_SIGNED_FLOAT);
-        
-        albedos.init();
-        normals.init();
-        positions.init();
-        depth.init();
+            positions.set_filter(vk::image::filter::NEAREST);
+            positions.set_format(vk::image::formats::R32G32B32A32_SIGNED_FLOAT);
+            
+            albedos.init();
+            normals.init();
+            positions.init();
+            depth.init();
+        }
         
+        //note: objects with the same textures share a subpass, scenes have many more objects than a render pass has subpasses
         for(int i = 0; i < _obj_vector.size(); ++i)
         {
             
@@ -84,14 +106,6 @@ public:
             vk::texture_path roughness_texture = _obj_vector[i]->get_lod(0)->get_texture((uint32_t)(aiTextureType_DIFFUSE_ROUGHNESS));
             vk::texture_path ao_texture = _obj_vector[i]->get_lod(0)->get_texture((uint32_t)(aiTextureType_AMBIENT_OCCLUSION));
             
-
-            subpass_type& pbr =  pass.add_subpass(_mat_store,"pbr");
-            pbr.add_output_attachment("albedos", render_pass_type::write_channels::RGBA, false);
-            pbr.add_output_attachment("normals", render_pass_type::write_channels::RGBA, false);
-            pbr.add_output_attachment("positions", render_pass_type::write_channels::RGBA, false);
-            pbr.add_output_attachment("depth");
-                
-            
             vk::texture_2d& diffuse = _tex_registry->get_loaded_texture_2d(diffuse_texture.c_str(), this, parent_type::_device, diffuse_texture.c_str());
             vk::texture_2d& norms = _tex_registry->get_loaded_texture_2d(normals_texture.c_str(), this, parent_type::_device, normals_texture.c_str());
             vk::texture_2d& metals = _tex_registry->get_loaded_texture_2d(specular_texture.c_str(), this, parent_type::_device, specular_texture.c_str());
@@ -99,9 +113,35 @@ public:
             vk::texture_2d& occlusion = _tex_registry->get_loaded_texture_2d(ao_texture.c_str(), this, parent_type::_device, ao_texture.c_str());
             pass.add_object(_obj_vector[i]->get_lod(0));
             
+            texture_set textures = { &diffuse, &norms, &metals, &roughness, &occlusion };
+            uint32_t subpass_id = 0;
+            while(subpass_id < _subpass_textures.size() && _subpass_textures[subpass_id] != textures)
+                ++subpass_id;
+            
+            _obj_subpass.push_back(subpass_id);
+            if(subpass_id != _subpass_textures.size())
+            {
+                pass.get_subpass(subpass_id).ignore_object(i, false);
+                continue;
+            }
+            _subpass_textures.push_back(textures);
+
+            subpass_type& pbr =  pass.add_subpass(_mat_store,"pbr");
+            pbr.add_output_attachment("albedos", render_pass_type::write_channels::RGBA, false);
+            pbr.add_output_attachment("normals", render_pass_type::write_channels::RGBA, false);
+            pbr.add_output_attachment("positions", render_pass_type::write_channels::RGBA, false);
+            pbr.add_output_attachment("depth");
+            
             roughness.set_filter(vk::image::filter::LINEAR);
             roughness.init();
             
+            //note: albedos are authored in srgb and stored as unorm, their mips are averaged in linear space
+            diffuse.set_mip_filter(vk::mip_filter::SRGB);
+            diffuse.init();
+            
+            //note: a flat tangent space normal until the asset loader copies the real map in
+            norms.set_placeholder_color(glm::vec4(.5f, .5f, 1.f, 1.f));
+            norms.set_mip_filter(vk::mip_filter::NORMAL_MAP);
             norms.init();
             metals.init();
             roughness.init();
@@ -115,12 +155,32 @@ public:
             pbr.set_image_sampler( metals, "metalness", vk::parameter_stage::FRAGMENT, 4);
             pbr.set_image_sampler( roughness, "roughness", vk::parameter_stage::FRAGMENT, 5);
             pbr.set_image_sampler( occlusion, "occlusion", vk::parameter_stage::FRAGMENT, 6);
+            pbr.set_storage_buffer(parent_type::_device->get_instance_pool().get_buffers(), "instances", vk::parameter_stage::VERTEX, 7);
+            
+            //note: the textures of this subpass are streamed at the resolution its fragments ask for, see texture_streamer.h
+            vk::texture_streamer& streamer = parent_type::_device->get_texture_streamer();
+            uint32_t slot = streamer.allocate_slot();
+            for( vk::texture_2d* texture : textures)
+            {
+                streamer.add_to_slot(slot, texture);
+            }
+            pbr.init_parameter("slot", vk::parameter_stage::FRAGMENT, int32_t(slot), 8);
+            pbr.set_storage_buffer(streamer.get_feedback_buffers(), "feedback", vk::parameter_stage::FRAGMENT, 9);
             
             pbr.ignore_all_objs(true);
             pbr.ignore_object(i, false);
-            
-            parent_type::add_dynamic_param("model", i, vk::parameter_stage::VERTEX, glm::mat4(1.0), 1);
         }
+        
+        for( uint32_t subpass_id = 0; subpass_id < pass.get_number_of_subpasses(); ++subpass_id)
+        {
+            parent_type::add_mesh_param("mesh", subpass_id, 1);
+        }
+    }
+    
+    //note: writes the parameters of its own pipelines, levels of detail are the exception, see graphics_node::picks_lods
+    virtual bool is_thread_safe() override
+    {
+        return !parent_type::picks_lods();
     }
     
     virtual void update_node(vk::camera& camera, uint32_t image_id) override
@@ -128,17 +188,21 @@ public:
         render_pass_type &pass = parent_type::_node_render_pass;
         object_vector_type &obj_vec = parent_type::_obj_vector;
         
-        for(int i = 0; i < _obj_vector.size(); ++i)
+        parent_type::select_lods(camera, image_id);
+        
+        for( uint32_t subpass_id = 0; subpass_id < pass.get_number_of_subpasses(); ++subpass_id)
         {
-            subpass_type& pbr_subpass = pass.get_subpass(i);
+            subpass_type& pbr_subpass = pass.get_subpass(subpass_id);
             vk::shader_parameter::shader_params_group& pbr_vertex_params =
                     pbr_subpass.get_pipeline(image_id).get_uniform_parameters(vk::parameter_stage::VERTEX, 0);
             
             pbr_vertex_params["view"] = camera.view_matrix;
             pbr_vertex_params["projection"] = camera.get_projection_matrix();
-            
-            parent_type::set_dynamic_param("model", image_id, i, obj_vec[i]->get_lod(0),
-                                           obj_vec[i]->transforms[image_id].get_transform_matrix(), 1 );
+        }
+        
+        for(int i = 0; i < _obj_vector.size(); ++i)
+        {
+            parent_type::set_mesh_param("mesh", image_id, _obj_subpass[i], obj_vec[i]->get_lod(0), 1);
         }
     }
     
@@ -149,6 +213,12 @@ public:
     
 private:
     
+    using texture_set = eastl::array<vk::texture_2d*, 5>;
+    
+    bool _load_attachments = false;
+    
+    eastl::fixed_vector<texture_set, render_pass_type::MAX_SUBPASSES, false> _subpass_textures {};
+    typename parent_type::object_subpass_vector _obj_subpass {};
 };
 
 pbr<1>;
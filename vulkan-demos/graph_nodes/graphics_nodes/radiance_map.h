@@ -220,6 +220,13 @@ public:
     virtual void update_node(vk::camera& camera, uint32_t image_id) override
     {
     }
+    //note: the map is only drawn for the first frame of every swapchain image, there is nothing to prepare after that
+    virtual void prepare_node_commands(vk::secondary_recorder& recorder, uint32_t image_id) override
+    {
+        if(_count < vk::NUM_SWAPCHAIN_IMAGES)
+            parent_type::prepare_node_commands(recorder, image_id);
+    }
+    
     virtual bool record_node_commands(vk::command_recorder& buffer, uint32_t image_id) override
     {
         if(_count < vk::NUM_SWAPCHAIN_IMAGES)
@@ -230,6 +237,18 @@ public:
         return true;
     }
     
+    virtual void refresh_node_parameters(uint32_t image_id) override
+    {
+        if(_count < vk::NUM_SWAPCHAIN_IMAGES)
+            parent_type::refresh_node_parameters(image_id);
+    }
+    
+    //note: same as color_lut, nothing is recorded once every swapchain image has drawn the map
+    virtual bool hash_node_commands(uint64_t& state, uint32_t image_id) override
+    {
+        return _count >= vk::NUM_SWAPCHAIN_IMAGES;
+    }
+    
     
     virtual void destroy() override
     {
@@ -0,0 +1,122 @@
+//
+//  upscale.h
+//  vulkan-demos
+//
+//  Created by Rafael Sabino on 10/19/26.
+//  Copyright © 2026 Rafael Sabino. All rights reserved.
+//
+
+#pragma once
+
+#include "EAAssert/eaassert.h"
+#include "graphics_node.h"
+#include "screen_plane.h"
+
+//note: stretches a texture that was drawn at the render scale, see graph::set_render_scale, over the full size of the node.
+//The source is the size of the node as well, only the corner it was drawn in is read, with a catmull-rom filter that is
+//sharper than a bilinear one.  At a scale of 1 it is a copy
+static const uint32_t UPSCALE_ATTACHMENTS = 1;
+template< uint32_t NUM_CHILDREN>
+class upscale : public vk::graphics_node<UPSCALE_ATTACHMENTS, NUM_CHILDREN>
+{
+private:
+
+    eastl::fixed_string<char, 20> _input_texture;
+    eastl::fixed_string<char, 20> _output_texture;
+    vk::screen_plane _screen_plane;
+    float _render_scale = 1.0f;
+
+public:
+
+    using parent_type = vk::graphics_node<UPSCALE_ATTACHMENTS, NUM_CHILDREN>;
+    using render_pass_type = typename parent_type::render_pass_type;
+    using subpass_type = typename parent_type::render_pass_type::subpass_s;
+    using image_ptr = eastl::shared_ptr<vk::image>;
+    using tex_registry_type = typename parent_type::tex_registry_type;
+    using material_store_type = typename parent_type::material_store_type;
+
+    upscale(vk::device* dev, float width, float height, const char* input_tex, const char* output_tex):
+    parent_type(dev, width, height),
+    _screen_plane(dev)
+    {
+        _input_texture = input_tex;
+        _output_texture = output_tex;
+        parent_type::_name = "upscale";
+    }
+
+    virtual void init_node() override
+    {
+        render_pass_type &pass = parent_type::_node_render_pass;
+        tex_registry_type* _tex_registry = parent_type::_texture_registry;
+
+        EA_ASSERT_MSG(!_input_texture.empty(), "texture to be upscaled has not been set");
+
+        _screen_plane.create();
+
+        vk::attachment_group<UPSCALE_ATTACHMENTS>& attach_group = pass.get_attachment_group();
+
+        vk::resource_set<vk::render_texture>& upscaled_tex = _tex_registry->get_write_render_texture_set(_output_texture.c_str(), this);
+        attach_group.add_attachment(upscaled_tex, glm::vec4(0.0f));
+
+        upscaled_tex.set_format(vk::image::formats::R16G16B16A16_SIGNED_FLOAT);
+        upscaled_tex.set_filter(vk::image::filter::LINEAR);
+        upscaled_tex.init();
+
+        subpass_type& sub_p = pass.add_subpass(parent_type::_material_store, "upscale");
+
+        sub_p.init_parameter("source_size", vk::parameter_stage::FRAGMENT, get_source_size(pass.get_dimensions()), 1);
+
+        vk::resource_set<vk::render_texture>& source = _tex_registry->get_read_render_texture_set(_input_texture.c_str(), this, vk::usage_type::COMBINED_IMAGE_SAMPLER);
+
+        sub_p.set_image_sampler(source, "source", vk::parameter_stage::FRAGMENT, 0);
+        sub_p.add_output_attachment(_output_texture.c_str(), render_pass_type::write_channels::RGBA, true);
+
+        pass.add_object(static_cast<vk::obj_shape*>(&_screen_plane));
+    }
+
+    virtual void update_node(vk::camera& camera, uint32_t image_id) override
+    {
+
+    }
+
+    virtual void render_scale_node(float scale) override
+    {
+        parent_type::render_scale_node(scale);
+        _render_scale = scale;
+        set_source_size(parent_type::_node_render_pass.get_dimensions());
+    }
+
+    virtual void resize_node(glm::vec2 old_size, glm::vec2 new_size) override
+    {
+        if(parent_type::_node_render_pass.get_dimensions() != old_size)
+            return;
+
+        parent_type::resize_node(old_size, new_size);
+        set_source_size(new_size);
+    }
+
+    virtual void destroy() override
+    {
+        parent_type::destroy();
+        _screen_plane.destroy();
+    }
+
+private:
+
+    //note: xy is the size the source was drawn at, zw the size of the source texture
+    glm::vec4 get_source_size(glm::vec2 dims)
+    {
+        return glm::vec4(vk::scale_dimensions(dims, _render_scale), dims);
+    }
+
+    void set_source_size(glm::vec2 dims)
+    {
+        subpass_type& sub_p = parent_type::_node_render_pass.get_subpass(0);
+        for( uint32_t i = 0; i < vk::NUM_SWAPCHAIN_IMAGES; ++i)
+        {
+            sub_p.get_pipeline(i).get_uniform_parameters(vk::parameter_stage::FRAGMENT, 1)["source_size"] = get_source_size(dims);
+        }
+    }
+};
+
+template class upscale<1>;
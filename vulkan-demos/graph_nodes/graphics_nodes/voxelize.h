@@ -58,6 +58,10 @@ private:
     glm::vec3 _light_pos = glm::vec3(0.0f, .8f, 0.0f);
     light_type _light_type = light_type::DIRECTIONAL_LIGHT;
     
+    //note: albedo texture of every subpass, nullptr for objects without one
+    eastl::fixed_vector<vk::texture_2d*, vk::render_pass<1>::MAX_SUBPASSES, false> _subpass_textures {};
+    typename vk::graphics_node<1, NUM_CHILDREN>::object_subpass_vector _obj_subpass {};
+    
 public:
     
     using parent_type = vk::graphics_node<1, NUM_CHILDREN>;
@@ -143,18 +147,36 @@ public:
         attachment_group.add_attachment(target, glm::vec4(1.0f, 1.0f, 1.0f, .0f));
         enum{ VOXEL_ATTACHMENT_ID = 0 };
         
+        //note: objects with the same albedo share a subpass
         for( int obj = 0; obj < _obj_vector.size(); ++obj )
         {
             int use_texture = 1;
             
-            subpass_type& voxelize_subpass = pass.add_subpass(_mat_store, "voxelizer");
             vk::texture_path diffuse = _obj_vector[obj]->get_lod(0)->get_texture((uint32_t)(aiTextureType_BASE_COLOR));
-            
+            vk::texture_2d* albedo = nullptr;
             if(!diffuse.empty())
             {
-                vk::texture_2d& rsrc = _tex_registry->get_loaded_texture_2d(diffuse.c_str(), this, parent_type::_device, diffuse.c_str());
-                rsrc.init();
-                voxelize_subpass.set_image_sampler( rsrc, "albedos",
+                albedo = &_tex_registry->get_loaded_texture_2d(diffuse.c_str(), this, parent_type::_device, diffuse.c_str());
+            }
+            
+            uint32_t subpass_id = 0;
+            while(subpass_id < _subpass_textures.size() && _subpass_textures[subpass_id] != albedo)
+                ++subpass_id;
+            
+            _obj_subpass.push_back(subpass_id);
+            if(subpass_id != _subpass_textures.size())
+            {
+                pass.get_subpass(subpass_id).ignore_object(obj, false);
+                continue;
+            }
+            _subpass_textures.push_back(albedo);
+            
+            subpass_type& voxelize_subpass = pass.add_subpass(_mat_store, "voxelizer");
+            
+            if(albedo != nullptr)
+            {
+                albedo->init();
+                voxelize_subpass.set_image_sampler( *albedo, "albedos",
                                       vk::parameter_stage::VERTEX, 5);
             }
             else
@@ -180,14 +202,25 @@ public:
             voxelize_subpass.init_parameter("voxel_coords", vk::parameter_stage::FRAGMENT,
                                                 glm::vec3(VOXEL_CUBE_WIDTH,VOXEL_CUBE_HEIGHT, VOXEL_CUBE_DEPTH ), 2);
             
-            parent_type::add_dynamic_param("model", obj, vk::parameter_stage::VERTEX, glm::mat4(1.0), 3);
+            voxelize_subpass.set_storage_buffer(parent_type::_device->get_instance_pool().get_buffers(), "instances", vk::parameter_stage::VERTEX, 6);
             voxelize_subpass.set_cull_mode( render_pass_type::graphics_pipeline_type::cull_mode::NONE);
             
             voxelize_subpass.add_output_attachment(test_name.c_str(), render_pass_type::write_channels::RGBA, false);
         }
+        
+        for( uint32_t subpass_id = 0; subpass_id < pass.get_number_of_subpasses(); ++subpass_id)
+        {
+            parent_type::add_mesh_param("mesh", subpass_id, 3);
+        }
 
     }
     
+    //note: writes its own pipelines and its own camera, levels of detail are the exception, see graphics_node::picks_lods
+    virtual bool is_thread_safe() override
+    {
+        return !parent_type::picks_lods();
+    }
+    
     virtual void update_node(vk::camera& camera, uint32_t image_id) override
     {
 
@@ -197,9 +230,11 @@ public:
         material_store_type* _mat_store = parent_type::_material_store;
         object_vector_type& _obj_vector = parent_type::_obj_vector;
         
-        for( int i = 0; i < _obj_vector.size(); ++i)
+        parent_type::select_lods(camera, image_id);
+        
+        for( uint32_t subpass_id = 0; subpass_id < pass.get_number_of_subpasses(); ++subpass_id)
         {
-            subpass_type& vox_subpass = pass.get_subpass(i);
+            subpass_type& vox_subpass = pass.get_subpass(subpass_id);
             vk::shader_parameter::shader_params_group& voxelize_vertex_params =
                     vox_subpass.get_pipeline(image_id).get_uniform_parameters(vk::parameter_stage::VERTEX, 0);
             
@@ -221,10 +256,11 @@ public:
             voxelize_vertex_params["projection"] =_ortho_camera.get_projection_matrix();
             voxelize_vertex_params["light_position"] = _key_light_cam.position;
             voxelize_vertex_params["eye_position"] = camera.position;
-    
-
-            parent_type::set_dynamic_param("model", image_id, i, _obj_vector[i]->get_lod(0),
-                                           _obj_vector[i]->transforms[image_id].get_transform_matrix(), 3 );
+        }
+        
+        for( int i = 0; i < _obj_vector.size(); ++i)
+        {
+            parent_type::set_mesh_param("mesh", image_id, _obj_subpass[i], _obj_vector[i]->get_lod(0), 3);
         }
     }
     
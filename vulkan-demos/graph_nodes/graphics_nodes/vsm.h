@@ -35,6 +35,8 @@ private:
     
     vk::resource_set<vk::render_texture>* _vsm = nullptr;
     
+    bool _load_attachments = false;
+    
 public:
     
     using parent_type = vk::graphics_node<NUM_ATTACHMENTS, NUM_CHILDREN>;
@@ -53,6 +55,13 @@ public:
         _light_cam = &cam;
     }
     
+    //note: when set, this node draws on top of what an earlier vsm node left in the shadow map instead of clearing it,
+    //this is how the late pass of occlusion culling is set up
+    inline void set_load_attachments(bool b)
+    {
+        _load_attachments = b;
+    }
+    
     virtual void init_node() override
     {
         render_pass_type &pass = parent_type::_node_render_pass;
@@ -76,17 +85,25 @@ public:
         _vsm = &vsm;
         vk::attachment_group<NUM_ATTACHMENTS>& vsm_attachment_grp = pass.get_attachment_group();
         
-        vsm_attachment_grp.add_attachment(vsm, glm::vec4(1.0f));
-        vsm_attachment_grp.add_attachment(vsm_depth, glm::vec2(1.0f, 0.0f));
-        
-        vsm.set_format(vk::image::formats::R8G8_SIGNED_NORMALIZED);
+        vsm_attachment_grp.add_attachment(vsm, glm::vec4(1.0f), !_load_attachments);
+        vsm_attachment_grp.add_attachment(vsm_depth, glm::vec2(1.0f, 0.0f), !_load_attachments);
+        for( uint32_t i = 0; i < vsm_attachment_grp.size(); ++i)
+        {
+            vsm_attachment_grp.set_keep_contents(i, _load_attachments);
+        }
         
-        glm::vec2 dims = parent_type::_node_render_pass.get_dimensions();
-        vsm.set_dimensions(dims.x, dims.y);
-        vsm.set_filter(vk::image::filter::NEAREST);
-        vsm.set_format(vk::image::formats::R32G32_SIGNED_FLOAT);
-        vsm.init();
-        vsm_depth.init();
+        //note: the node that clears the shadow map creates it
+        if(!_load_attachments)
+        {
+            vsm.set_format(vk::image::formats::R8G8_SIGNED_NORMALIZED);
+            
+            glm::vec2 dims = parent_type::_node_render_pass.get_dimensions();
+            vsm.set_dimensions(dims.x, dims.y);
+            vsm.set_filter(vk::image::filter::NEAREST);
+            vsm.set_format(vk::image::formats::R32G32_SIGNED_FLOAT);
+            vsm.init();
+            vsm_depth.init();
+        }
         
         cam_depth_subpass.add_output_attachment("vsm", render_pass_type::write_channels::RGBA, true);
         cam_depth_subpass.add_output_attachment("vsm_depth", render_pass_type::write_channels::R, true);
@@ -95,13 +112,14 @@ public:
         
         cam_depth_subpass.init_parameter("view", vk::parameter_stage::VERTEX, glm::mat4(1.0f), 0);
         cam_depth_subpass.init_parameter("projection", vk::parameter_stage::VERTEX, glm::mat4(1.0f), 0);
+        cam_depth_subpass.set_storage_buffer(parent_type::_device->get_instance_pool().get_buffers(), "instances", vk::parameter_stage::VERTEX, 2);
         
         for(int i = 0; i < _obj_vector.size(); ++i)
         {
-            pass.add_object(_obj_vector[i]->get_lod(1));
+            pass.add_object(_obj_vector[i]->get_lod(0));
         }
         
-        parent_type::add_dynamic_param("model", 0, vk::parameter_stage::VERTEX, glm::mat4(1.0), 1);
+        parent_type::add_mesh_param("mesh", 0, 1);
         
 
     }
@@ -125,11 +143,12 @@ public:
         vsm_vertex_params["view"] = _light_cam->view_matrix;
         vsm_vertex_params["projection"] = _light_cam->get_projection_matrix();
         
+        //note: levels of detail come from the lod view of the shadow cull nodes, see main.mm
+        parent_type::select_lods(camera, image_id);
         
         for( int i = 0; i < obj_vec.size(); ++i)
         {
-            parent_type::set_dynamic_param("model", image_id, 0, obj_vec[i]->get_lod(1),
-                                           obj_vec[i]->transforms[image_id].get_transform_matrix(), 1 );
+            parent_type::set_mesh_param("mesh", image_id, 0, obj_vec[i]->get_lod(0), 1);
         }
         
     }
@@ -19,23 +19,46 @@
 #include <array>
 #include <algorithm>
 #include <iostream>
+#include <string>
+#include <thread>
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/mat4x4.hpp>
 #include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <random>
+#include "EASTL/string_view.h"
+#include "EASTL/algorithm.h"
+#include "EASTL/sort.h"
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+#include <assimp/postprocess.h>
 
 #include "vulkan_wrapper/core/device.h"
 #include "vulkan_wrapper/core/glfw_swapchain.h"
 
 #include "vulkan_wrapper/materials/material_store.h"
 #include "vulkan_wrapper/shapes/obj_shape.h"
+#include "vulkan_wrapper/shapes/transform_hierarchy.h"
+#include "vulkan_wrapper/textures/texture_container.h"
+#include "vulkan_wrapper/textures/asset_loader.h"
+#include "vulkan_wrapper/textures/texture_streamer.h"
+#include "vulkan_wrapper/textures/texture_cache.h"
+#include "vulkan_wrapper/core/secondary_recorder.h"
+#include "vulkan_wrapper/core/job_system.h"
+#include "vulkan_wrapper/core/profiler.h"
+#include "vulkan_wrapper/core/frame_capture.h"
+#include "vulkan_wrapper/core/frame_pacer.h"
+#include "vulkan_wrapper/core/dynamic_resolution.h"
 
 #include "vulkan_wrapper/render_graph/assimp_node.h"
 
 #include "vulkan_wrapper/cameras/perspective_camera.h"
 #include "camera_controllers/first_person_controller.h"
 #include "camera_controllers/circle_controller.h"
+#include "camera_controllers/input_recorder.h"
 
 #include "graph_nodes/graphics_nodes/display_texture_2d.h"
 #include "graph_nodes/graphics_nodes/display_texture_3d.h"
@@ -43,6 +66,7 @@
 #include "graph_nodes/graphics_nodes/gaussian_blur.h"
 #include "graph_nodes/graphics_nodes/pbr.h"
 #include "graph_nodes/graphics_nodes/fxaa.h"
+#include "graph_nodes/graphics_nodes/upscale.h"
 #include "graph_nodes/graphics_nodes/luminance.h"
 #include "graph_nodes/graphics_nodes/radiance_map.h"
 
@@ -50,6 +74,8 @@
 #include "graph_nodes/graphics_nodes/voxelize.h"
 #include "graph_nodes/compute_nodes/clear_3d_texture.hpp"
 #include "graph_nodes/compute_nodes/color_lut.hpp"
+#include "graph_nodes/compute_nodes/frustum_cull.hpp"
+#include "graph_nodes/compute_nodes/occlusion_cull.hpp"
 #include "graph_nodes/graphics_nodes/mrt.h"
 #include "graph_nodes/graphics_nodes/atmospheric.h"
 
@@ -74,16 +100,191 @@ VkSurfaceKHR surface2;
 int width = 1024;
 int height = 768;
 
+//note: command line options, see parse_options
+struct options
+{
+    //cubes added to the scene on a grid, to test how the renderer holds up with thousands of objects
+    uint32_t stress_objects = 0;
+    //the window is hidden, a swapchain is still needed to present to.  With --golden no window is made at all if the driver has
+    //VK_EXT_headless_surface
+    bool headless = false;
+    //the demo quits after this many frames and prints how long they took, 0 runs until the window is closed
+    uint32_t frames = 0;
+    //nodes in a transform hierarchy that is timed and checked against glm, the demo does not start
+    uint32_t transform_bench = 0;
+    //bunny, dragon and cornell box go through the mesh optimizer and are checked, the demo does not start.  See test_mesh_optimizer
+    bool mesh_optimizer_test = false;
+    //meshes are imported with assimp every run instead of loaded from their cache, to compare load times, see mesh_cache.h
+    bool no_mesh_cache = false;
+    //the optimizer prints the cache statistics of every mesh it imports, and every mesh how long it took to load, instead of one
+    //line for the scene.  See mesh_optimizer.h and mesh_cache.h
+    bool mesh_report = false;
+    //textures are decoded in their constructors instead of by the asset loader, to compare how long the first frame takes
+    bool sync_assets = false;
+    //textures keep their whole mip chain on the gpu instead of what the feedback asks for, see texture_streamer.h
+    bool no_mip_streaming = false;
+    //megabytes streamed textures may use on the gpu, 0 picks a quarter of the device local heap
+    uint32_t texture_budget = 0;
+    //every path is loaded on its own even when another path holds the same image, see texture_cache.h
+    bool no_texture_dedup = false;
+    //threads that record draws into secondary command buffers, 0 records them into the primary one.  See secondary_recorder.h
+    uint32_t record_threads = vk::secondary_recorder::AUTO_THREADS;
+    //frames recorded with every thread count from 0 up to one per core, the time recording took is printed for each.  Run it
+    //with --headless and a software driver such as lavapipe for numbers that only depend on the cpu
+    uint32_t record_bench = 0;
+    //records the graph every frame, even when the command buffers it recorded before are still good to submit.  See graph::record
+    bool no_command_reuse = false;
+    //compute nodes run on the graphics queue even when the device has a queue for compute alone.  See command_recorder.h
+    bool no_async_compute = false;
+    //threads nodes and transforms are updated on, 0 updates them on the main thread in the order the graph visits them.  See
+    //job_system.h
+    uint32_t job_threads = vk::job_system::AUTO_THREADS;
+    //a file the jobs of every frame are written to once the demo quits, open it with chrome://tracing or perfetto.  Same trace
+    //as --profile, jobs are profiler zones on the thread that ran them
+    const char* job_timeline = nullptr;
+    //a file the cpu zones of every thread and the gpu time of every submission are written to once the demo quits, open it
+    //with chrome://tracing or perfetto.  See profiler.h
+    const char* profile = nullptr;
+    //a file the input that moves the camera and the keys pressed are written to once the demo quits, see input_recorder.h
+    const char* record_input = nullptr;
+    //a file written by --record-input, the camera follows it instead of the keyboard and mouse and the demo quits at its end.
+    //The cpu and gpu time of every frame is printed at the end, gpu times need timestamps so the profiler is on
+    const char* replay_input = nullptr;
+    //milliseconds every replayed frame moves the camera by, 0 moves it by the time the frame took when it was recorded
+    float replay_timestep = 1000.0f / 60.0f;
+    //a file the cpu and gpu time of every replayed frame is written to, as comma separated values
+    const char* replay_timings = nullptr;
+    //a folder of golden images, every debug view is rendered from fixed cameras and compared to them instead of running the
+    //demo.  The process fails if one differs, see run_golden_tests
+    const char* golden = nullptr;
+    //the rendered images are written as the new goldens instead of being compared
+    bool update_golden = false;
+    //an image that is converted to a compressed texture container next to it, the demo does not start.  See texture_container.h
+    const char* compress_texture = nullptr;
+    const char* compress_format = nullptr;
+    //the block compression encoders and decoders are checked, the demo does not start.  See test_block_compression
+    bool block_compression_test = false;
+    //fifo, fifo_relaxed, mailbox or immediate.  Without it the swapchain picks mailbox, then immediate, then fifo
+    const char* present_mode = nullptr;
+    //frames do not start faster than this, 0 does not limit them.  See frame_pacer.h
+    float target_fps = 0.0f;
+    //frames presented and not yet shown when the next one reads its input, needs VK_KHR_present_wait.  0 does not wait
+    uint32_t max_queued_frames = 0;
+    //VK_KHR_present_id and VK_KHR_present_wait are not turned on even when the device has them
+    bool no_present_wait = false;
+    //a file the frame time and input to present latency of every frame are written to once the demo quits, as comma separated
+    //values.  Input to present needs VK_KHR_present_wait
+    const char* latency_log = nullptr;
+    //milliseconds of gpu time a frame should take, the scene is drawn at a lower resolution and upscaled to hold it, 0 always
+    //draws it at the size of the window.  Gpu times need timestamps so the profiler is on, see dynamic_resolution.h
+    float target_gpu_ms = 0.0f;
+    //the lowest render scale --target-gpu-ms goes down to
+    float min_render_scale = vk::dynamic_resolution::DEFAULT_MIN_SCALE;
+};
+
+options opts;
+std::chrono::time_point<std::chrono::high_resolution_clock> launch_time;
+//note: golden images that did not match, the process returns 1 if there were any
+uint32_t golden_failures = 0;
+//note: what --record-input keeps and --replay-input plays back
+input_recorder recorded_input;
+
+void parse_options(int argc, const char* argv[])
+{
+    for( int i = 1; i < argc; ++i)
+    {
+        eastl::string_view arg(argv[i]);
+        if(arg == "--stress" && (i + 1) < argc)
+            opts.stress_objects = static_cast<uint32_t>(std::atoi(argv[++i]));
+        else if(arg == "--headless")
+            opts.headless = true;
+        else if(arg == "--frames" && (i + 1) < argc)
+            opts.frames = static_cast<uint32_t>(std::atoi(argv[++i]));
+        else if(arg == "--transform-bench" && (i + 1) < argc)
+            opts.transform_bench = static_cast<uint32_t>(std::atoi(argv[++i]));
+        else if(arg == "--mesh-optimizer-test")
+            opts.mesh_optimizer_test = true;
+        else if(arg == "--no-mesh-cache")
+            opts.no_mesh_cache = true;
+        else if(arg == "--mesh-report")
+            opts.mesh_report = true;
+        else if(arg == "--sync-assets")
+            opts.sync_assets = true;
+        else if(arg == "--no-mip-streaming")
+            opts.no_mip_streaming = true;
+        else if(arg == "--texture-budget" && (i + 1) < argc)
+            opts.texture_budget = static_cast<uint32_t>(std::atoi(argv[++i]));
+        else if(arg == "--no-texture-dedup")
+            opts.no_texture_dedup = true;
+        else if(arg == "--record-threads" && (i + 1) < argc)
+            opts.record_threads = static_cast<uint32_t>(std::atoi(argv[++i]));
+        else if(arg == "--record-bench" && (i + 1) < argc)
+            opts.record_bench = static_cast<uint32_t>(std::atoi(argv[++i]));
+        else if(arg == "--no-command-reuse")
+            opts.no_command_reuse = true;
+        else if(arg == "--no-async-compute")
+            opts.no_async_compute = true;
+        else if(arg == "--job-threads" && (i + 1) < argc)
+            opts.job_threads = static_cast<uint32_t>(std::atoi(argv[++i]));
+        else if(arg == "--job-timeline" && (i + 1) < argc)
+            opts.job_timeline = argv[++i];
+        else if(arg == "--profile" && (i + 1) < argc)
+            opts.profile = argv[++i];
+        else if(arg == "--record-input" && (i + 1) < argc)
+            opts.record_input = argv[++i];
+        else if(arg == "--replay-input" && (i + 1) < argc)
+            opts.replay_input = argv[++i];
+        else if(arg == "--replay-timestep" && (i + 1) < argc)
+            opts.replay_timestep = static_cast<float>(std::atof(argv[++i]));
+        else if(arg == "--replay-timings" && (i + 1) < argc)
+            opts.replay_timings = argv[++i];
+        else if(arg == "--golden" && (i + 1) < argc)
+            opts.golden = argv[++i];
+        else if(arg == "--update-golden")
+            opts.update_golden = true;
+        else if(arg == "--present-mode" && (i + 1) < argc)
+            opts.present_mode = argv[++i];
+        else if(arg == "--target-fps" && (i + 1) < argc)
+            opts.target_fps = static_cast<float>(std::atof(argv[++i]));
+        else if(arg == "--max-queued-frames" && (i + 1) < argc)
+            opts.max_queued_frames = static_cast<uint32_t>(std::atoi(argv[++i]));
+        else if(arg == "--no-present-wait")
+            opts.no_present_wait = true;
+        else if(arg == "--latency-log" && (i + 1) < argc)
+            opts.latency_log = argv[++i];
+        else if(arg == "--target-gpu-ms" && (i + 1) < argc)
+            opts.target_gpu_ms = static_cast<float>(std::atof(argv[++i]));
+        else if(arg == "--min-render-scale" && (i + 1) < argc)
+            opts.min_render_scale = static_cast<float>(std::atof(argv[++i]));
+        else if(arg == "--compress-texture" && (i + 2) < argc)
+        {
+            opts.compress_texture = argv[++i];
+            opts.compress_format = argv[++i];
+        }
+        else if(arg == "--block-compression-test")
+            opts.block_compression_test = true;
+        else
+            std::cout << "unknown option " << argv[i] << ", options are --stress <objects> --headless --frames <frames> " <<
+                         "--transform-bench <nodes> --mesh-optimizer-test --no-mesh-cache --mesh-report --sync-assets --no-mip-streaming --texture-budget <mb> " <<
+                         "--no-texture-dedup --record-threads <threads> --record-bench <frames> --no-command-reuse " <<
+                         "--no-async-compute --job-threads <threads> --job-timeline <file> --profile <file> " <<
+                         "--record-input <file> --replay-input <file> --replay-timestep <ms> --replay-timings <file> " <<
+                         "--golden <folder> --update-golden --compress-texture <image> <bc1|bc4|bc5|bc7> --block-compression-test " <<
+                         "--present-mode <fifo|fifo_relaxed|mailbox|immediate> --target-fps <fps> --max-queued-frames <frames> " <<
+                         "--no-present-wait --latency-log <file> --target-gpu-ms <ms> --min-render-scale <scale>" << std::endl;
+    }
+}
+
 void start_glfw() {
     glfwInit();
     glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+    glfwWindowHint(GLFW_VISIBLE, opts.headless ? GLFW_FALSE : GLFW_TRUE);
     //my computer cannot handle retina right now, commented for this reason
     //glfwWindowHint(GLFW_COCOA_RETINA_FRAMEBUFFER, GLFW_TRUE);
     constexpr int DEFAULT_VSYNC = 1;
     glfwSwapInterval(DEFAULT_VSYNC);
-    glfwWindowHint(GLFW_RESIZABLE, GL_FALSE);
-
-    window = glfwCreateWindow(width, height, "Rafael's Demo", nullptr, nullptr);
+    //note: golden images are compared at the size they were rendered at
+    glfwWindowHint(GLFW_RESIZABLE, opts.golden == nullptr ? GLFW_TRUE : GLFW_FALSE);
 }
 
 //render target
@@ -114,8 +315,11 @@ struct App
     first_person_controller* texture_3d_view_controller = nullptr;
     circle_controller* circle_controller = nullptr;
 
-    vk::camera*     perspective_camera = nullptr;
-    vk::camera*     three_d_texture_camera = nullptr;
+    vk::perspective_camera*     perspective_camera = nullptr;
+    vk::perspective_camera*     three_d_texture_camera = nullptr;
+    //note: they pick levels of detail from the height of the window, see resize_swapchain
+    vk::lod_view*   view_lod = nullptr;
+    vk::lod_view*   shadow_lod = nullptr;
     vk::glfw_swapchain*  swapchain = nullptr;
     vk::material_store* material_store = nullptr;
 
@@ -128,59 +332,910 @@ struct App
     camera_type cam_type = camera_type::USER;
     bool quit = false;
     glm::mat4 model = glm::mat4(1.0f);
+    
+    //note: where the window was before it went fullscreen, see key_callback
+    int windowed_x = 0;
+    int windowed_y = 0;
+    int windowed_width = 0;
+    int windowed_height = 0;
 
 };
 
 
 App app;
+//note: set when the framebuffer of the window changes size, the swapchain is made again before the next frame
+bool swapchain_resized = false;
+
+void resize_swapchain();
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
+
+//note: keys go through here so they can be recorded.  While input is replayed only escape is taken from the keyboard, the rest
+//comes from the recording
+void input_key_callback(GLFWwindow* window, int key, int scancode, int action, int mods)
+{
+    if(opts.replay_input != nullptr && key != GLFW_KEY_ESCAPE)
+        return;
+    
+    if(opts.record_input != nullptr && action == GLFW_PRESS)
+        recorded_input.add_key(key);
+    key_callback(window, key, scancode, action, mods);
+}
 
+//note: frame counts from 0, it is the frame of the recording that is replayed
+void update_controllers(uint32_t frame)
+{
+    const input_recorder::frame* replayed = nullptr;
+    if(opts.replay_input != nullptr)
+    {
+        replayed = &recorded_input.get_frame(frame);
+        for( int32_t key : replayed->keys)
+        {
+            key_callback(window, key, 0, GLFW_PRESS, 0);
+        }
+    }
+    
+    if( app.cam_type == camera_type::DEMO)
+    {
+        app.circle_controller->update();
+        if(opts.record_input != nullptr)
+            recorded_input.add_frame(controller_input {});
+        return;
+    }
+    
+    first_person_controller* controller = app.cam_type == camera_type::USER ? app.user_controller : app.texture_3d_view_controller;
+    if(replayed != nullptr)
+    {
+        controller_input input = replayed->input;
+        if(opts.replay_timestep > 0.0f)
+            input.delta_time = opts.replay_timestep / 1000.0;
+        controller->update(input);
+    }
+    else if(opts.record_input != nullptr)
+    {
+        controller_input input = controller->read_input();
+        recorded_input.add_frame(input);
+        controller->update(input);
+    }
+    else
+        controller->update();
+}
+
+//note: the gpu time of a frame is known once the fence of its swapchain image is waited on, the last frames have none
+void report_replay(const eastl::vector<double>& cpu_times, const eastl::vector<double>& gpu_times,
+                   const eastl::vector<float>& render_scales)
+{
+    auto summary = [](const char* name, eastl::vector<double> times)
+    {
+        times.erase(eastl::remove(times.begin(), times.end(), 0.0), times.end());
+        if(times.empty())
+        {
+            std::cout << name << ": no times" << std::endl;
+            return;
+        }
+        
+        double total = 0.0;
+        for( double t : times)
+        {
+            total += t;
+        }
+        eastl::sort(times.begin(), times.end());
+        std::cout << name << ": mean " << total / times.size() << " ms, median " << times[times.size() / 2] << " ms, 95th percentile " <<
+                     times[(times.size() * 95) / 100] << " ms, worst " << times.back() << " ms" << std::endl;
+    };
+    
+    std::cout << cpu_times.size() << " frames replayed from " << opts.replay_input << std::endl;
+    summary("cpu", cpu_times);
+    summary("gpu", gpu_times);
+    if(opts.target_gpu_ms > 0.0f && !render_scales.empty())
+    {
+        double total = 0.0;
+        for( float scale : render_scales)
+        {
+            total += scale;
+        }
+        std::cout << "render scale: mean " << total / render_scales.size() << ", lowest " <<
+                     *eastl::min_element(render_scales.begin(), render_scales.end()) << std::endl;
+    }
+    
+    if(opts.replay_timings == nullptr)
+        return;
+    
+    FILE* file = fopen(opts.replay_timings, "w");
+    if(file == nullptr)
+    {
+        std::cout << "could not write replay timings to " << opts.replay_timings << std::endl;
+        return;
+    }
+    fprintf(file, "frame,cpu_ms,gpu_ms,render_scale\n");
+    for( eastl_size_t i = 0; i < cpu_times.size(); ++i)
+    {
+        if(gpu_times[i] != 0.0)
+            fprintf(file, "%u,%f,%f,%f\n", static_cast<uint32_t>(i), cpu_times[i], gpu_times[i], render_scales[i]);
+        else
+            fprintf(file, "%u,%f,,%f\n", static_cast<uint32_t>(i), cpu_times[i], render_scales[i]);
+    }
+    fclose(file);
+    std::cout << "replay timings written to " << opts.replay_timings << std::endl;
+}
 
 void game_loop()
 {
     int next_swap = 0;
+    uint32_t frame = 0;
+    std::chrono::time_point start = std::chrono::high_resolution_clock::now();
+    
+    //note: the controllers were updated once with live input when they were made, they start over so recordings and replays
+    //begin from the same camera
+    if(opts.record_input != nullptr || opts.replay_input != nullptr)
+    {
+        app.user_controller->reset();
+        app.texture_3d_view_controller->reset();
+    }
+    eastl::vector<double> cpu_times {};
+    eastl::vector<double> gpu_times {};
+    eastl::vector<float> render_scales {};
+    
+    vk::dynamic_resolution resolution(opts.target_gpu_ms, opts.min_render_scale);
+    //note: gpu time of the last frame whose fence was waited on, 0 until there is one
+    double last_gpu_time = 0.0;
+    
+    vk::frame_pacer pacer(app.swapchain);
+    pacer.set_target_frame_time(opts.target_fps > 0.0f ? 1000.0 / opts.target_fps : 0.0);
+    pacer.set_max_queued_frames(opts.max_queued_frames);
+    
     while (!glfwWindowShouldClose(window) && !app.quit)
     {
+        if(opts.frames != 0 && frame == opts.frames)
+            break;
+        if(opts.replay_input != nullptr && frame == recorded_input.get_num_frames())
+            break;
+        ++frame;
+        
+        //note: input is read right after the pacer lets the frame start, the latency it measures starts here
+        pacer.begin_frame();
         glfwPollEvents();
-
-        if(app.cam_type == camera_type::USER)
-        {
-            app.user_controller->update();
-        }
-        else if( app.cam_type == camera_type::THREE_D_TEXTURE)
+        //note: the new swapchain hands its images out from the start
+        if(swapchain_resized || app.swapchain->is_out_of_date())
         {
-            app.texture_3d_view_controller->update();
+            pacer.drop_presents();
+            resize_swapchain();
+            next_swap = 0;
         }
-        else if( app.cam_type == camera_type::DEMO)
-            app.circle_controller->update();
 
+        std::chrono::time_point frame_start = std::chrono::high_resolution_clock::now();
+        update_controllers(frame - 1);
+        if(opts.target_gpu_ms > 0.0f)
+            app.voxel_graph->set_render_scale(resolution.update(last_gpu_time));
 
         app.voxel_graph->update(*app.perspective_camera, next_swap);
         app.voxel_graph->record(next_swap);
         app.voxel_graph->execute(next_swap);
+        pacer.end_frame();
+        
+        //note: record waited on the fence of the frame that used this swapchain image before
+        if(opts.target_gpu_ms > 0.0f && frame > vk::NUM_SWAPCHAIN_IMAGES)
+            last_gpu_time = double(app.voxel_graph->get_gpu_time(next_swap)) / 1000000.0;
+        
+        if(opts.replay_input != nullptr)
+        {
+            std::chrono::duration<double, std::milli> cpu_time = std::chrono::high_resolution_clock::now() - frame_start;
+            cpu_times.push_back(cpu_time.count());
+            gpu_times.push_back(0.0);
+            render_scales.push_back(app.voxel_graph->get_render_scale());
+            if(frame > vk::NUM_SWAPCHAIN_IMAGES)
+                gpu_times[frame - 1 - vk::NUM_SWAPCHAIN_IMAGES] = double(app.voxel_graph->get_gpu_time(next_swap)) / 1000000.0;
+        }
         next_swap = ++next_swap % vk::NUM_SWAPCHAIN_IMAGES;
+        
+        if(frame == 1)
+        {
+            std::chrono::duration<double, std::milli> first_frame = std::chrono::high_resolution_clock::now() - launch_time;
+            std::cout << "first frame submitted " << first_frame.count() << " ms after launch, " <<
+                         app.device->get_asset_loader().get_num_pending() << " textures still loading" << std::endl;
+        }
     }
 
+    pacer.finish();
+    if(opts.frames != 0 || opts.latency_log != nullptr)
+        pacer.print_summary();
+    if(opts.latency_log != nullptr)
+    {
+        if(pacer.write_log(opts.latency_log))
+            std::cout << "frame latencies written to " << opts.latency_log << std::endl;
+        else
+            std::cout << "could not write frame latencies to " << opts.latency_log << std::endl;
+    }
+    
+    if(opts.target_gpu_ms > 0.0f)
+    {
+        std::cout << resolution.get_num_over_target() << " of " << resolution.get_num_measured() << " timed frames went over the " <<
+                     opts.target_gpu_ms << " ms gpu target, the render scale changed " << resolution.get_num_changes() <<
+                     " times and ended at " << resolution.get_scale() << std::endl;
+    }
+
+    if(opts.frames != 0)
+    {
+        app.device->wait_for_all_operations_to_finish();
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+        std::cout << frame << " frames in " << elapsed.count() << " ms, " << elapsed.count() / std::max(frame, 1u) << " ms per frame" << std::endl;
+        
+        vk::texture_streamer& streamer = app.device->get_texture_streamer();
+        std::cout << "streamed textures use " << streamer.get_resident_bytes() / (1024 * 1024) << " of " <<
+                     streamer.get_budget() / (1024 * 1024) << " mb on the gpu" << std::endl;
+        
+        vk::texture_cache& cache = app.device->get_texture_cache();
+        std::cout << cache.get_num_textures() << " textures loaded, " << cache.get_num_shared() << " more asked for and shared, " <<
+                     cache.get_saved_bytes() / (1024 * 1024) << " mb of image memory saved.  " << cache.get_num_samplers() <<
+                     " samplers for " << cache.get_num_sampler_references() << " images" << std::endl;
+        
+        std::cout << app.voxel_graph->get_num_reused() << " frames submitted as they were recorded before, " <<
+                     app.voxel_graph->get_num_recorded() << " recorded" << std::endl;
+        
+        std::cout << app.voxel_graph->get_num_submissions(0) << " submissions per frame, " <<
+                     app.voxel_graph->get_num_async_submissions(0) << " of them on the async compute queue" << std::endl;
+        
+        vk::job_system& jobs = app.device->get_job_system();
+        std::cout << jobs.get_num_jobs() << " jobs in the last run on " << vk::job_system::get_num_threads() << " threads, " <<
+                     jobs.get_main_time() / 1000000 << " ms of them on the main thread and " << jobs.get_worker_time() / 1000000 <<
+                     " ms on workers, " << jobs.get_num_steals() << " stolen" << std::endl;
+    }
+    
+    if(opts.replay_input != nullptr)
+        report_replay(cpu_times, gpu_times, render_scales);
+    
+    if(opts.record_input != nullptr)
+    {
+        if(recorded_input.write(opts.record_input))
+            std::cout << recorded_input.get_num_frames() << " frames of input written to " << opts.record_input << std::endl;
+        else
+            std::cout << "could not write the input to " << opts.record_input << std::endl;
+    }
+    
+    if(opts.job_timeline != nullptr)
+    {
+        if(vk::profiler::write_trace(opts.job_timeline))
+            std::cout << "job timeline written to " << opts.job_timeline << std::endl;
+        else
+            std::cout << "could not write the job timeline to " << opts.job_timeline << std::endl;
+    }
+    
+    if(opts.profile != nullptr)
+    {
+        //note: gpu times are read when the fence of their image is waited on again, the last frame of every image has none
+        if(vk::profiler::write_trace(opts.profile))
+            std::cout << "profile written to " << opts.profile << std::endl;
+        else
+            std::cout << "could not write the profile to " << opts.profile << std::endl;
+    }
 }
 
-void on_window_resize(GLFWwindow * window, int w, int h)
+//note: the camera stays where it is so every thread count records the same frames, only the time spent in record is measured.
+//Command buffers are recorded every frame, reusing them would leave nothing to measure
+void benchmark_recording(uint32_t frames)
+{
+    app.voxel_graph->set_reuse_commands(false);
+    uint32_t max_threads = std::min(vk::secondary_recorder::MAX_THREADS, std::max(1u, std::thread::hardware_concurrency()));
+    int next_swap = 0;
+    
+    std::cout << "recording " << frames << " frames per thread count" << std::endl;
+    for( uint32_t threads = 0; threads <= max_threads && !app.quit; threads = threads == 0 ? 1 : threads * 2)
+    {
+        vk::secondary_recorder::set_num_threads(threads);
+        std::chrono::duration<double, std::milli> recording {};
+        for( uint32_t frame = 0; frame < frames && !glfwWindowShouldClose(window); ++frame)
+        {
+            glfwPollEvents();
+            app.voxel_graph->update(*app.perspective_camera, next_swap);
+            
+            std::chrono::time_point start = std::chrono::high_resolution_clock::now();
+            app.voxel_graph->record(next_swap);
+            recording += std::chrono::high_resolution_clock::now() - start;
+            
+            app.voxel_graph->execute(next_swap);
+            next_swap = ++next_swap % vk::NUM_SWAPCHAIN_IMAGES;
+        }
+        
+        std::cout << (threads == 0 ? "inline" : std::to_string(threads) + " threads") << ": " <<
+                     recording.count() / std::max(frames, 1u) << " ms recording per frame" << std::endl;
+    }
+    vk::secondary_recorder::set_num_threads(opts.record_threads);
+    app.voxel_graph->set_reuse_commands(!opts.no_command_reuse);
+}
+
+//note: renders every debug view of the mrt node and the voxel view from fixed cameras, through the whole graph, and compares
+//what was presented with <folder>/<case>.ppm.  Failures write <case>_actual.ppm and <case>_diff.ppm next to the golden.  The
+//controllers are not updated so nothing but the case moves the camera.
+//
+//goldens depend on the driver and are not in the repository, they are made with --update-golden from a commit known to be good,
+//on the machine that compares against them.  Run it with --headless on lavapipe for images that do not depend on the gpu, no
+//window is made then if the driver has VK_EXT_headless_surface.  See the README
+void run_golden_tests(const char* folder)
+{
+    std::cout << "golden images in " << folder << ", rendered " << (window == nullptr ? "without a window through VK_EXT_headless_surface" :
+                 "through a window, the driver has no VK_EXT_headless_surface or --headless was not given") << std::endl;
+    //note: display_texture_2d is only made by the commented out pbr_debug in create_graph, it is not part of the graph
+    std::cout << "not covered: display_texture_2d, the demo graph does not have one" << std::endl;
+    
+
+    //note: frames rendered before the capture, enough for every swapchain image and for the voxels and shadows to settle
+    constexpr uint32_t WARM_UP_FRAMES = 3u * vk::NUM_SWAPCHAIN_IMAGES;
+
+    struct golden_case
+    {
+        const char*             name;
+        mrt<4>::rendering_mode  mode;
+        bool                    voxels;
+        glm::vec3               position;
+    };
+
+    const glm::vec3 front(0.0f, 1.0f, -5.0f);
+    const glm::vec3 side(4.0f, 1.5f, -2.5f);
+    const golden_case cases[] =
+    {
+        { "full_rendering", mrt<4>::rendering_mode::FULL_RENDERING, false, front },
+        { "full_rendering_side", mrt<4>::rendering_mode::FULL_RENDERING, false, side },
+        { "albedo", mrt<4>::rendering_mode::ALBEDO, false, front },
+        { "normals", mrt<4>::rendering_mode::NORMALS, false, front },
+        { "positions", mrt<4>::rendering_mode::POSITIONS, false, front },
+        { "depth", mrt<4>::rendering_mode::DEPTH, false, front },
+        { "variance_shadow_map", mrt<4>::rendering_mode::VARIANCE_SHADOW_MAP, false, front },
+        { "ambient_light", mrt<4>::rendering_mode::AMBIENT_LIGHT, false, front },
+        { "ambient_occlusion", mrt<4>::rendering_mode::AMBIENT_OCCLUSION, false, front },
+        { "direct_light", mrt<4>::rendering_mode::DIRECT_LIGHT, false, front },
+        { "voxel_albedos", mrt<4>::rendering_mode::FULL_RENDERING, true, front },
+    };
+
+    vk::frame_capture capture(app.device, app.swapchain);
+    app.voxel_graph->set_capture(&capture);
+    app.device->get_asset_loader().flush();
+
+    const vk::frame_capture::tolerance limits {};
+    eastl::vector<uint8_t> actual {};
+    eastl::vector<uint8_t> golden {};
+    eastl::vector<uint8_t> diff {};
+    int next_swap = 0;
+    for( const golden_case& c : cases)
+    {
+        if((window != nullptr && glfwWindowShouldClose(window)) || app.quit)
+            break;
+
+        app.mrt_node->set_rendering_state(c.mode);
+        app.debug_node_3d->set_active(c.voxels);
+        app.perspective_camera->position = c.position;
+        app.perspective_camera->forward = -c.position;
+        app.perspective_camera->update_view_matrix();
+
+        for( uint32_t frame = 0; frame <= WARM_UP_FRAMES; ++frame)
+        {
+            glfwPollEvents();
+            if(frame == WARM_UP_FRAMES)
+                capture.request();
+
+            app.voxel_graph->update(*app.perspective_camera, next_swap);
+            app.voxel_graph->record(next_swap);
+            app.voxel_graph->execute(next_swap);
+            next_swap = ++next_swap % vk::NUM_SWAPCHAIN_IMAGES;
+        }
+        app.device->wait_for_all_operations_to_finish();
+
+        fs::path golden_path = fs::path(folder) / (std::string(c.name) + ".ppm");
+        if(!capture.read(actual))
+        {
+            std::cout << c.name << ": the swapchain image could not be captured" << std::endl;
+            ++golden_failures;
+            continue;
+        }
+
+        if(opts.update_golden)
+        {
+            bool written = vk::frame_capture::write_ppm(golden_path.c_str(), actual, capture.get_width(), capture.get_height());
+            std::cout << c.name << (written ? ": golden written to " : ": could not write the golden to ") << golden_path << std::endl;
+            golden_failures += written ? 0 : 1;
+            continue;
+        }
+
+        uint32_t golden_width = 0;
+        uint32_t golden_height = 0;
+        if(!vk::frame_capture::read_ppm(golden_path.c_str(), golden, golden_width, golden_height) ||
+           golden_width != capture.get_width() || golden_height != capture.get_height())
+        {
+            std::cout << c.name << ": no golden of " << capture.get_width() << "x" << capture.get_height() << " at " << golden_path <<
+                         ", run with --update-golden to make one" << std::endl;
+            ++golden_failures;
+            continue;
+        }
+
+        vk::frame_capture::comparison result = vk::frame_capture::compare(actual, golden, capture.get_width(), capture.get_height(),
+                                                                          limits, diff);
+        std::cout << c.name << (result.passed ? ": passed" : ": FAILED") << ", ssim " << result.ssim << ", " << result.num_off <<
+                     " pixels off, largest error rgb " << uint32_t(result.max_error[0]) << " " << uint32_t(result.max_error[1]) << " " <<
+                     uint32_t(result.max_error[2]) << ", mean " << result.mean_error[0] << " " << result.mean_error[1] << " " <<
+                     result.mean_error[2] << std::endl;
+
+        if(!result.passed)
+        {
+            ++golden_failures;
+            fs::path actual_path = fs::path(folder) / (std::string(c.name) + "_actual.ppm");
+            fs::path diff_path = fs::path(folder) / (std::string(c.name) + "_diff.ppm");
+            vk::frame_capture::write_ppm(actual_path.c_str(), actual, capture.get_width(), capture.get_height());
+            vk::frame_capture::write_ppm(diff_path.c_str(), diff, capture.get_width(), capture.get_height());
+        }
+    }
+
+    app.voxel_graph->set_capture(nullptr);
+    capture.destroy();
+    std::cout << golden_failures << " golden images failed" << std::endl;
+}
+
+//note: cubes on a grid over the floor, they share textures so the passes draw them all in one subpass
+void create_stress_objects(eastl::vector<eastl::shared_ptr<vk::assimp_node<4>>>& nodes, uint32_t count)
+{
+    constexpr float FLOOR_EXTENT = 1.8f;
+    uint32_t side = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<float>(count))));
+    float spacing = (2.0f * FLOOR_EXTENT) / static_cast<float>(side);
+    
+    vk::transform trans = {};
+    for( uint32_t i = 0; i < count; ++i)
+    {
+        eastl::shared_ptr<vk::assimp_node<4>> cube = eastl::make_shared<vk::assimp_node<4>>(app.device, "cube.obj");
+        cube->set_texture_relative_path("../textures/white.png", aiTextureType_BASE_COLOR);
+        cube->set_texture_relative_path("../textures/black.png", aiTextureType_METALNESS);
+        cube->set_texture_relative_path("../textures/white.png", aiTextureType_NORMAL_CAMERA);
+        cube->set_texture_relative_path("../textures/white.png", aiTextureType_DIFFUSE_ROUGHNESS);
+        cube->set_texture_relative_path("../textures/white.png", aiTextureType_AMBIENT_OCCLUSION);
+        cube->set_vertex_format(vk::vertex_format::PACKED);
+        
+        trans.reset();
+        trans.scale = glm::vec3(spacing * .25f);
+        trans.position = glm::vec3(-FLOOR_EXTENT + spacing * (.5f + static_cast<float>(i % side)), spacing * .25f,
+                                   -FLOOR_EXTENT + spacing * (.5f + static_cast<float>(i / side)));
+        trans.update_transform_matrix();
+        cube->init_transforms(trans);
+        
+        nodes.push_back(cube);
+    }
+}
+
+//note: largest difference between the world matrices of the hierarchy and the glm reference.  Errors are relative, matrices deep
+//in the tree have large translations
+float get_transform_error(const vk::transform_hierarchy& hierarchy, const eastl::vector<glm::mat4>& reference)
+{
+    float max_error = 0.0f;
+    for( uint32_t i = 0; i < hierarchy.get_num_nodes(); ++i)
+    {
+        const glm::mat4& world = hierarchy.get_world(i);
+        for( int c = 0; c < 4; ++c)
+        {
+            for( int r = 0; r < 4; ++r)
+            {
+                float error = std::abs(world[c][r] - reference[i][c][r]) / std::max(1.0f, std::abs(reference[i][c][r]));
+                max_error = std::max(max_error, error);
+            }
+        }
+    }
+    return max_error;
+}
+
+//note: every node of a four way tree is moved each iteration, as if the whole scene was animated.  The reference is what mesh nodes
+//did before the hierarchy, one vk::transform at a time and a glm product per parent.
+//
+//the timed runs recompute everything, so a second hierarchy with random parents is checked as well.  Each round moves a few nodes,
+//reparents a few others and updates, alternating between update and the job system.  Every world matrix is compared to the
+//reference after each round, a child left out of the dirty propagation keeps the world of its old parent and fails.  Returns 1 if
+//any matrix is off by more than TOLERANCE
+int benchmark_transforms(uint32_t count)
+{
+    constexpr uint32_t ITERATIONS = 100;
+    constexpr uint32_t CHILDREN_PER_NODE = 4;
+    constexpr uint32_t ROUNDS = 32;
+    constexpr float TOLERANCE = 1e-4f;
+    
+    vk::transform_hierarchy hierarchy;
+    eastl::vector<vk::transform> locals(count);
+    for( uint32_t i = 0; i < count; ++i)
+    {
+        float f = static_cast<float>(i);
+        locals[i].position = glm::vec3(std::sin(f), std::cos(f * .5f), std::sin(f * .25f));
+        locals[i].rotation = glm::vec3(f * .01f, f * .02f, f * .03f);
+        locals[i].scale = glm::vec3(.9f + .2f * std::sin(f * .1f));
+        
+        int32_t parent = i == 0 ? vk::transform_hierarchy::NO_PARENT : static_cast<int32_t>((i - 1) / CHILDREN_PER_NODE);
+        hierarchy.add(locals[i], parent);
+    }
+    
+    std::chrono::duration<double, std::milli> hierarchy_time {};
+    for( uint32_t iteration = 0; iteration < ITERATIONS; ++iteration)
+    {
+        for( uint32_t i = 0; i < count; ++i)
+        {
+            hierarchy.set_local(i, locals[i]);
+        }
+        
+        std::chrono::time_point start = std::chrono::high_resolution_clock::now();
+        hierarchy.update();
+        hierarchy_time += std::chrono::high_resolution_clock::now() - start;
+    }
+    
+    //note: the world matrices checked below come from this run, local matrices are computed on every thread of the job system
+    vk::job_system jobs;
+    std::chrono::duration<double, std::milli> jobs_time {};
+    for( uint32_t iteration = 0; iteration < ITERATIONS; ++iteration)
+    {
+        for( uint32_t i = 0; i < count; ++i)
+        {
+            hierarchy.set_local(i, locals[i]);
+        }
+        
+        std::chrono::time_point start = std::chrono::high_resolution_clock::now();
+        jobs.begin();
+        hierarchy.add_update_jobs(jobs);
+        jobs.run();
+        jobs_time += std::chrono::high_resolution_clock::now() - start;
+    }
+    
+    eastl::vector<glm::mat4> reference {};
+    std::chrono::time_point start = std::chrono::high_resolution_clock::now();
+    for( uint32_t iteration = 0; iteration < ITERATIONS; ++iteration)
+    {
+        hierarchy.update_reference(reference);
+    }
+    std::chrono::duration<double, std::milli> reference_time = std::chrono::high_resolution_clock::now() - start;
+    float max_error = get_transform_error(hierarchy, reference);
+    
+    std::cout << count << " transforms, hierarchy " << hierarchy_time.count() / ITERATIONS << " ms, with jobs on " <<
+                 vk::job_system::get_num_threads() << " threads " << jobs_time.count() / ITERATIONS << " ms, glm reference " <<
+                 reference_time.count() / ITERATIONS << " ms per update" << std::endl;
+    std::cout << "largest relative error " << max_error << (max_error <= TOLERANCE ? ", passed" : ", FAILED") << std::endl;
+    
+    //note: fixed seed, a failure shows up the same way every run
+    std::mt19937 random(1234u);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    auto random_transform = [&]()
+    {
+        vk::transform t {};
+        t.position = glm::vec3(unit(random), unit(random), unit(random));
+        t.rotation = glm::vec3(unit(random), unit(random), unit(random)) * glm::pi<float>();
+        t.scale = glm::vec3(1.0f + .5f * unit(random));
+        return t;
+    };
+    auto random_parent = [&](uint32_t id)
+    {
+        //note: one in eight nodes is a root, the rest hang from any node before them
+        if(id == 0 || random() % 8u == 0)
+            return vk::transform_hierarchy::NO_PARENT;
+        return static_cast<int32_t>(random() % id);
+    };
+    
+    vk::transform_hierarchy randomized;
+    for( uint32_t i = 0; i < count; ++i)
+    {
+        randomized.add(random_transform(), random_parent(i));
+    }
+    randomized.update();
+    
+    float random_error = 0.0f;
+    uint32_t changes_per_round = std::max(1u, count / 64u);
+    for( uint32_t round = 0; round < ROUNDS; ++round)
+    {
+        //note: the last round changes nothing, update has to leave the matrices as they are
+        uint32_t changes = round + 1 == ROUNDS ? 0 : changes_per_round;
+        for( uint32_t c = 0; c < changes; ++c)
+        {
+            randomized.set_local(random() % count, random_transform());
+            uint32_t id = random() % count;
+            randomized.set_parent(id, random_parent(id));
+        }
+        
+        if(round % 2 == 0)
+        {
+            randomized.update();
+        }
+        else
+        {
+            jobs.begin();
+            randomized.add_update_jobs(jobs);
+            jobs.run();
+        }
+        
+        randomized.update_reference(reference);
+        random_error = std::max(random_error, get_transform_error(randomized, reference));
+    }
+    jobs.destroy();
+    
+    std::cout << ROUNDS << " rounds of moves and reparents on a random hierarchy, largest relative error " << random_error <<
+                 (random_error <= TOLERANCE ? ", passed" : ", FAILED") << std::endl;
+    
+    return max_error <= TOLERANCE && random_error <= TOLERANCE ? 0 : 1;
+}
+
+//note: a triangle as the positions of its corners, starting from the smallest one so the winding is kept
+using mesh_triangle = eastl::array<float, 9>;
+
+eastl::vector<mesh_triangle> get_sorted_triangles(const eastl::vector<glm::vec3>& positions, const eastl::vector<uint32_t>& indices)
 {
-    if( w != 0 && h != 0)
+    auto less = [](const glm::vec3& a, const glm::vec3& b)
     {
-        VkSurfaceCapabilitiesKHR surface_capabilities {};
-        vkGetPhysicalDeviceSurfaceCapabilitiesKHR(app.device->_physical_device, surface, &surface_capabilities);
+        if(a.x != b.x) return a.x < b.x;
+        if(a.y != b.y) return a.y < b.y;
+        return a.z < b.z;
+    };
+    
+    eastl::vector<mesh_triangle> triangles {};
+    triangles.reserve(indices.size() / 3);
+    for( size_t i = 0; i + 2 < indices.size(); i += 3)
+    {
+        uint32_t first = 0;
+        for( uint32_t corner = 1; corner < 3; ++corner)
+        {
+            if(less(positions[indices[i + corner]], positions[indices[i + first]]))
+                first = corner;
+        }
+        
+        mesh_triangle t {};
+        for( uint32_t corner = 0; corner < 3; ++corner)
+        {
+            const glm::vec3& p = positions[indices[i + (first + corner) % 3]];
+            t[corner * 3 + 0] = p.x;
+            t[corner * 3 + 1] = p.y;
+            t[corner * 3 + 2] = p.z;
+        }
+        triangles.push_back(t);
+    }
+    eastl::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+
+//note: every mesh has to come out of the optimizer with the triangles it went in with, wound the same way, and with fewer
+//vertices transformed.  The cornell box is small enough for the cache to hold all of it, it only has to not get worse.  Returns 1
+//if a mesh failed
+int test_mesh_optimizer()
+{
+    struct test_mesh
+    {
+        const char* path;
+        bool must_improve;
+    };
+    const test_mesh meshes[] = { { "bunny.obj", true }, { "dragon_lod1.obj", true }, { "cornell/cornell_box.obj", false } };
+    
+    uint32_t failures = 0;
+    for( const test_mesh& m : meshes)
+    {
+        eastl::string path = vk::resource::resource_root.c_str();
+        path += "/models/";
+        path += m.path;
+        
+        Assimp::Importer importer;
+        const aiScene* scene = importer.ReadFile(path.c_str(), aiProcess_Triangulate | aiProcess_JoinIdenticalVertices);
+        if(scene == nullptr)
+        {
+            std::cout << m.path << ": FAILED, could not import " << path.c_str() << ", " << importer.GetErrorString() << std::endl;
+            ++failures;
+            continue;
+        }
+        
+        //note: the meshes of the file are optimized as one, positions are all the optimizer looks at
+        eastl::vector<glm::vec3> positions {};
+        eastl::vector<uint32_t> indices {};
+        for( uint32_t mesh_id = 0; mesh_id < scene->mNumMeshes; ++mesh_id)
+        {
+            const aiMesh* mesh = scene->mMeshes[mesh_id];
+            uint32_t first_vertex = static_cast<uint32_t>(positions.size());
+            for( uint32_t v = 0; v < mesh->mNumVertices; ++v)
+            {
+                positions.push_back(glm::vec3(mesh->mVertices[v].x, mesh->mVertices[v].y, mesh->mVertices[v].z));
+            }
+            for( uint32_t f = 0; f < mesh->mNumFaces; ++f)
+            {
+                const aiFace& face = mesh->mFaces[f];
+                if(face.mNumIndices != 3)
+                    continue;
+                for( uint32_t corner = 0; corner < 3; ++corner)
+                    indices.push_back(first_vertex + face.mIndices[corner]);
+            }
+        }
+        
+        eastl::vector<mesh_triangle> before = get_sorted_triangles(positions, indices);
+        vk::mesh_optimizer::report report = vk::mesh_optimizer::optimize(positions.data(), positions.size(), sizeof(glm::vec3), 0,
+                                                                         indices.data(), indices.size());
+        positions.resize(report.vertex_count_after);
+        eastl::vector<mesh_triangle> after = get_sorted_triangles(positions, indices);
+        
+        bool same_triangles = before == after;
+        bool better = m.must_improve ? (report.after.acmr < report.before.acmr && report.after.atvr < report.before.atvr) :
+                                       (report.after.acmr <= report.before.acmr && report.after.atvr <= report.before.atvr);
+        report.print(m.path);
+        if(same_triangles && better)
+        {
+            std::cout << m.path << ": passed" << std::endl;
+            continue;
+        }
+        
+        ++failures;
+        std::cout << m.path << ": FAILED" << (same_triangles ? "" : ", the triangles changed") <<
+                     (better ? "" : ", the vertex cache did not get better") << std::endl;
+    }
+    
+    std::cout << failures << " meshes failed the optimizer test" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
 
-        w = std::min(w, static_cast<int>(surface_capabilities.maxImageExtent.width));
-        h = std::min(h, static_cast<int>(surface_capabilities.maxImageExtent.height));
+//note: blocks written by hand from the BC1, BC4, BC5 and BC7 layouts in the Khronos data format spec, the texels are what Pillow's BCn
+//decoder gives for them (single channel BC4 as red only, the way texture_2d samples it).  Every index of every block is used, the
+//interpolated ones can differ by 1 from decoder to decoder for BC1, BC4 and BC5.  BC7 interpolation is exact, no difference is allowed
+struct reference_block
+{
+    vk::block_compression::format format;
+    const char* name;
+    uint8_t bytes[16];
+    uint32_t texels[16];    //0xAABBGGRR
+};
 
-        w = std::max(w, static_cast<int>(surface_capabilities.minImageExtent.width));
-        h = std::max(h, static_cast<int>(surface_capabilities.minImageExtent.height));
+const reference_block reference_blocks[] =
+{
+    { vk::block_compression::format::BC1, "bc1 four colors",
+      { 0x00, 0xf8, 0x1f, 0x00, 0xe4, 0xe4, 0xe4, 0xe4 },
+      { 0xff0000ff, 0xffff0000, 0xff5500aa, 0xffaa0055, 0xff0000ff, 0xffff0000, 0xff5500aa, 0xffaa0055,
+        0xff0000ff, 0xffff0000, 0xff5500aa, 0xffaa0055, 0xff0000ff, 0xffff0000, 0xff5500aa, 0xffaa0055 } },
+    { vk::block_compression::format::BC1, "bc1 three colors and transparent",
+      { 0x1f, 0x00, 0x00, 0xf8, 0xe4, 0xe4, 0xe4, 0xe4 },
+      { 0xffff0000, 0xff0000ff, 0xff7f007f, 0x00000000, 0xffff0000, 0xff0000ff, 0xff7f007f, 0x00000000,
+        0xffff0000, 0xff0000ff, 0xff7f007f, 0x00000000, 0xffff0000, 0xff0000ff, 0xff7f007f, 0x00000000 } },
+    { vk::block_compression::format::BC4, "bc4 eight values",
+      { 0xff, 0x00, 0x88, 0xc6, 0xfa, 0x88, 0xc6, 0xfa },
+      { 0xff0000ff, 0xff000000, 0xff0000da, 0xff0000b6, 0xff000091, 0xff00006d, 0xff000048, 0xff000024,
+        0xff0000ff, 0xff000000, 0xff0000da, 0xff0000b6, 0xff000091, 0xff00006d, 0xff000048, 0xff000024 } },
+    { vk::block_compression::format::BC4, "bc4 six values",
+      { 0x00, 0xff, 0x88, 0xc6, 0xfa, 0x88, 0xc6, 0xfa },
+      { 0xff000000, 0xff0000ff, 0xff000033, 0xff000066, 0xff000099, 0xff0000cc, 0xff000000, 0xff0000ff,
+        0xff000000, 0xff0000ff, 0xff000033, 0xff000066, 0xff000099, 0xff0000cc, 0xff000000, 0xff0000ff } },
+    { vk::block_compression::format::BC5, "bc5",
+      { 0xff, 0x00, 0x88, 0xc6, 0xfa, 0x88, 0xc6, 0xfa, 0x00, 0xff, 0x88, 0xc6, 0xfa, 0x88, 0xc6, 0xfa },
+      { 0xff0000ff, 0xff00ff00, 0xff0033da, 0xff0066b6, 0xff009991, 0xff00cc6d, 0xff000048, 0xff00ff24,
+        0xff0000ff, 0xff00ff00, 0xff0033da, 0xff0066b6, 0xff009991, 0xff00cc6d, 0xff000048, 0xff00ff24 } },
+    { vk::block_compression::format::BC7, "bc7 mode 6",
+      { 0xc0, 0x3f, 0x00, 0x00, 0x00, 0xfc, 0xff, 0xff, 0x10, 0x32, 0x54, 0x76, 0x98, 0xba, 0xdc, 0xfe },
+      { 0xff0101ff, 0xff1101ef, 0xff2501db, 0xff3401cb, 0xff4401bb, 0xff5401ab, 0xff680197, 0xff780187,
+        0xfe870078, 0xfe970068, 0xfeab0054, 0xfebb0044, 0xfecb0034, 0xfeda0024, 0xfeee0010, 0xfefe0000 } },
+};
 
-        width = w;
-        height = h;
+//note: the reference blocks have to decode to their texels, then an image with gradients, hard edges and alpha goes through the
+//encoder and decoder of every format and has to come back above a psnr floor.  The floors are a few dB under what the encoders
+//reach today, an encoder change that loses quality fails here.  Returns 1 if anything failed
+int test_block_compression()
+{
+    using bc = vk::block_compression;
+    uint32_t failures = 0;
+    
+    for( const reference_block& reference : reference_blocks)
+    {
+        uint8_t texels[64] {};
+        bc::decompress_image(reference.format, reference.bytes, bc::BLOCK_DIMENSION, bc::BLOCK_DIMENSION, texels);
+        
+        int tolerance = reference.format == bc::format::BC7 ? 0 : 1;
+        int max_difference = 0;
+        for( uint32_t i = 0; i < 64; ++i)
+        {
+            int expected = static_cast<int>((reference.texels[i / 4] >> ((i % 4) * 8)) & 0xffu);
+            max_difference = std::max(max_difference, std::abs(expected - static_cast<int>(texels[i])));
+        }
+        
+        bool passed = max_difference <= tolerance;
+        failures += passed ? 0 : 1;
+        std::cout << reference.name << " reference block, largest difference " << max_difference << (passed ? ", passed" : ", FAILED") << std::endl;
+    }
+    
+    constexpr uint32_t SIZE = 64;
+    eastl::vector<uint8_t> source(SIZE * SIZE * 4);
+    for( uint32_t y = 0; y < SIZE; ++y)
+    {
+        for( uint32_t x = 0; x < SIZE; ++x)
+        {
+            uint8_t* texel = &source[(y * SIZE + x) * 4];
+            float dx = static_cast<float>(x) - SIZE * .5f;
+            float dy = static_cast<float>(y) - SIZE * .5f;
+            bool inside = dx * dx + dy * dy < SIZE * SIZE * .1f;
+            texel[0] = static_cast<uint8_t>(x * 4);
+            texel[1] = static_cast<uint8_t>(inside ? 255 - y * 2 : y * 4);
+            texel[2] = static_cast<uint8_t>((x + y) * 2);
+            texel[3] = static_cast<uint8_t>(inside ? 255 : 128 + x);
+        }
+    }
+    
+    struct round_trip
+    {
+        bc::format format;
+        uint32_t channels;
+        float min_psnr;
+    };
+    const round_trip round_trips[] = { { bc::format::BC1, 3, 35.0f }, { bc::format::BC4, 1, 47.0f },
+                                       { bc::format::BC5, 2, 45.0f }, { bc::format::BC7, 4, 38.0f } };
+    
+    eastl::vector<uint8_t> blocks {};
+    eastl::vector<uint8_t> decoded(source.size());
+    for( const round_trip& trip : round_trips)
+    {
+        blocks.resize(bc::get_compressed_size(trip.format, SIZE, SIZE));
+        bc::compress_image(trip.format, source.data(), SIZE, SIZE, blocks.data());
+        bc::decompress_image(trip.format, blocks.data(), SIZE, SIZE, decoded.data());
+        
+        float psnr = bc::psnr(source.data(), decoded.data(), SIZE * SIZE, trip.channels);
+        bool passed = psnr >= trip.min_psnr;
+        failures += passed ? 0 : 1;
+        std::cout << bc::get_name(trip.format) << " round trip, psnr " << psnr << " dB, at least " << trip.min_psnr << " dB" <<
+                     (passed ? ", passed" : ", FAILED") << std::endl;
     }
+    
+    return failures == 0 ? 0 : 1;
 }
 
+//note: level 0 is decoded back on the cpu and compared to the source, the same decoder texture_2d falls back to when a device
+//cannot sample the format
+int compress_texture(const char* source, const char* format_name)
+{
+    vk::block_compression::format format = vk::block_compression::get_format(format_name);
+    if(format == vk::block_compression::format::COUNT || !vk::block_compression::can_encode(format))
+    {
+        std::cout << "cannot compress to " << format_name << ", formats are bc1 bc4 bc5 bc7" << std::endl;
+        return 1;
+    }
+    
+    eastl::string destination(source);
+    destination += vk::texture_container::EXTENSION;
+    
+    vk::texture_container::conversion_report report {};
+    std::chrono::time_point start = std::chrono::high_resolution_clock::now();
+    bool ok = vk::texture_container::convert(source, destination.c_str(), format, &report);
+    std::chrono::duration<double, std::milli> time = std::chrono::high_resolution_clock::now() - start;
+    if(!ok)
+    {
+        std::cout << "could not write " << destination.c_str() << std::endl;
+        return 1;
+    }
+    
+    std::cout << destination.c_str() << ": " << report.width << "x" << report.height << " " << format_name << ", " << report.num_levels <<
+                 " levels, " << report.source_bytes / 1024 << " KB as RGBA8 -> " << report.compressed_bytes / 1024 << " KB with mips, psnr " <<
+                 report.psnr << " dB, " << time.count() << " ms" << std::endl;
+    return 0;
+}
 
+void on_window_resize(GLFWwindow * window, int w, int h)
+{
+    swapchain_resized = true;
+}
+
+//note: the swapchain is made again at the size of the window, then the graph makes again what was as big as the old one.  A
+//minimized window has no size, nothing is drawn until it comes back
+void resize_swapchain()
+{
+    int w = 0;
+    int h = 0;
+    glfwGetFramebufferSize(window, &w, &h);
+    while((w == 0 || h == 0) && !glfwWindowShouldClose(window))
+    {
+        glfwWaitEvents();
+        glfwGetFramebufferSize(window, &w, &h);
+    }
+    swapchain_resized = false;
+    if(w == 0 || h == 0)
+        return;
+    
+    app.device->wait_for_all_operations_to_finish();
+    VkExtent2D old_extent = app.swapchain->get_extent();
+    app.swapchain->resize();
+    VkExtent2D new_extent = app.swapchain->get_extent();
+    width = static_cast<int>(new_extent.width);
+    height = static_cast<int>(new_extent.height);
+    
+    glm::vec2 old_size(old_extent.width, old_extent.height);
+    glm::vec2 new_size(new_extent.width, new_extent.height);
+    app.voxel_graph->resize(old_size, new_size);
+    
+    float aspect = new_size.x / new_size.y;
+    app.perspective_camera->set_aspect_ratio(aspect);
+    app.three_d_texture_camera->set_aspect_ratio(aspect);
+    app.view_lod->set_viewport_height(new_size.y);
+    app.shadow_lod->set_viewport_height(new_size.y);
+}
 
 void game_loop_ortho()
 {
@@ -282,6 +1337,23 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
         app.debug_node_3d->set_active(false);
     }
     
+    if( key == GLFW_KEY_F && action == GLFW_PRESS && opts.golden == nullptr)
+    {
+        //note: the framebuffer size callback picks up the new size, the swapchain is made again next frame
+        if(glfwGetWindowMonitor(window) == nullptr)
+        {
+            glfwGetWindowPos(window, &app.windowed_x, &app.windowed_y);
+            glfwGetWindowSize(window, &app.windowed_width, &app.windowed_height);
+            GLFWmonitor* monitor = glfwGetPrimaryMonitor();
+            const GLFWvidmode* mode = glfwGetVideoMode(monitor);
+            glfwSetWindowMonitor(window, monitor, 0, 0, mode->width, mode->height, mode->refreshRate);
+        }
+        else
+        {
+            glfwSetWindowMonitor(window, nullptr, app.windowed_x, app.windowed_y, app.windowed_width, app.windowed_height, GLFW_DONT_CARE);
+        }
+    }
+    
     if( key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
     {
         app.quit = true;
@@ -313,6 +1385,10 @@ void create_graph()
     model_node->set_texture_relative_path("Material_65_Roughness.png", aiTextureType_DIFFUSE_ROUGHNESS);
     model_node->set_texture_relative_path("Material_65_Mixed_AO.png", aiTextureType_AMBIENT_OCCLUSION);
     
+    //note: scene meshes are fetched by the shadow, voxelization and g-buffer passes, 24 byte vertices instead of 72
+    floor->set_vertex_format(vk::vertex_format::PACKED);
+    model_node->set_vertex_format(vk::vertex_format::PACKED);
+    
     
     vk::transform trans ={};
     
@@ -331,6 +1407,23 @@ void create_graph()
     trans.update_transform_matrix();
 
     floor->init_transforms(trans);
+    
+    eastl::vector<eastl::shared_ptr<vk::assimp_node<4>>> stress_nodes;
+    create_stress_objects(stress_nodes, opts.stress_objects);
+    
+    //every pass that draws the scene gets all of its objects
+    eastl::vector<vk::assimp_node<4>*> scene = { model_node.get(), floor.get() };
+    for( eastl::shared_ptr<vk::assimp_node<4>>& node : stress_nodes)
+    {
+        scene.push_back(node.get());
+    }
+    auto add_scene = [&scene](vk::node<4>& parent)
+    {
+        for( vk::assimp_node<4>* obj : scene)
+        {
+            parent.add_child(*obj);
+        }
+    };
 
     float aspect = static_cast<float>(app.swapchain->get_vk_swap_extent().width)/ static_cast<float>(app.swapchain->get_vk_swap_extent().height);
     vk::perspective_camera perspective_camera(glm::radians(45.0f),
@@ -409,15 +1502,37 @@ void create_graph()
 
         voxelizers[i]->set_key_light_cam(point_light_cam, voxelize<4>::light_type::POINT_LIGHT);
 
-        voxelizers[i]->add_child(*model_node);
-        voxelizers[i]->add_child(*floor);
+        add_scene(*voxelizers[i]);
     }
 
-    mrt_node->add_child(*model_node);
-    mrt_node->add_child(*floor);
+    add_scene(*mrt_node);
 
-    vsm_node->add_child(*model_node);
-    vsm_node->add_child(*floor);
+    add_scene(*vsm_node);
+    
+    //levels of detail are picked per point of view from their error on screen, see lod_view.h.  The shadow map is blurred and the
+    //voxel grid is coarse, both get away with more error than the final image
+    vk::lod_view shadow_lod(point_light_cam, app.swapchain->get_vk_swap_extent().height, vk::lod_view::SHADOW_THRESHOLD);
+    app.shadow_lod = &shadow_lod;
+    vk::lod_view voxel_lod(vox_proj_cam, voxelize<4>::VOXEL_CUBE_HEIGHT, vk::lod_view::VOXEL_THRESHOLD);
+    
+    //gpu culling, each pass culls against the volume it renders.  The shadow map and the g-buffer are also occlusion culled,
+    //their nodes render in two phases, see occlusion_cull.hpp
+    occlusion_cull<4> vsm_early_cull(app.device, point_light_cam);
+    vsm_early_cull.set_name("vsm early cull");
+    vsm_early_cull.set_lod_view(shadow_lod);
+    add_scene(vsm_early_cull);
+    vsm_node->add_child(vsm_early_cull);
+    vsm_node->set_indirect_draws(vsm_early_cull.get_indirect_draws());
+    
+    frustum_cull<4> voxel_cull(app.device, vox_proj_cam);
+    voxel_cull.set_name("voxel cull");
+    voxel_cull.set_lod_view(voxel_lod);
+    add_scene(voxel_cull);
+    for( int i = 0; i < voxelizers.size(); ++i)
+    {
+        voxelizers[i]->add_child(voxel_cull);
+        voxelizers[i]->set_indirect_draws(voxel_cull.get_indirect_draws());
+    }
 
 
     eastl::array<clear_3d_textures<4>, mip_map_3d_texture<4>::TOTAL_LODS> clear_mip_maps;
@@ -523,12 +1638,29 @@ void create_graph()
 
     debug_node_3d->add_child( three_d_mip_maps[three_d_mip_maps.size()-1]);
     vsm_node->add_child(*debug_node_3d);
+    
+    depth_pyramid<4> vsm_pyramid(app.device, "vsm_depth");
+    vsm_pyramid.set_name("vsm depth pyramid");
+    vsm_pyramid.add_child(*vsm_node);
+    
+    occlusion_cull<4> vsm_late_cull(app.device, vsm_early_cull, vsm_pyramid);
+    vsm_late_cull.set_name("vsm late cull");
+    vsm_late_cull.add_child(vsm_pyramid);
+    add_scene(vsm_late_cull);
+    
+    eastl::shared_ptr<vsm<4>> vsm_late_node = eastl::make_shared<vsm<4>>(app.device, app.swapchain->get_vk_swap_extent().width,
+                    app.swapchain->get_vk_swap_extent().height, point_light_cam);
+    vsm_late_node->set_name("vsm late node");
+    vsm_late_node->set_load_attachments(true);
+    add_scene(*vsm_late_node);
+    vsm_late_node->add_child(vsm_late_cull);
+    vsm_late_node->set_indirect_draws(vsm_late_cull.get_indirect_draws());
 
 
     eastl::shared_ptr<gaussian_blur<4>> gsb_vertical = eastl::make_shared<gaussian_blur<4>> (app.device,  dims.x, dims.y, gaussian_blur<4>::DIRECTION::VERTICAL, "vsm", "gauss_vertical");
     eastl::shared_ptr<gaussian_blur<4>> gsb_horizontal = eastl::make_shared<gaussian_blur<4>>(app.device, dims.x, dims.y, gaussian_blur<4>::DIRECTION::HORIZONTAL, "gauss_vertical", "blur_final");
 
-    gsb_vertical->add_child(*vsm_node);
+    gsb_vertical->add_child(*vsm_late_node);
     gsb_horizontal->add_child(*gsb_vertical);
 
 
@@ -536,11 +1668,36 @@ void create_graph()
     
     pbr_node->add_child(*gsb_horizontal);
     
-    pbr_node->add_child(*model_node);
-    pbr_node->add_child(*floor);
+    add_scene(*pbr_node);
+    
+    //note: no camera given, the pbr pass culls against the view camera
+    vk::lod_view view_lod(dims.y);
+    app.view_lod = &view_lod;
+    occlusion_cull<4> pbr_early_cull(app.device);
+    pbr_early_cull.set_name("pbr early cull");
+    pbr_early_cull.set_lod_view(view_lod);
+    add_scene(pbr_early_cull);
+    pbr_node->add_child(pbr_early_cull);
+    pbr_node->set_indirect_draws(pbr_early_cull.get_indirect_draws());
 
     
     pbr_node->set_name("pbr node");
+    
+    depth_pyramid<4> pbr_pyramid(app.device, "depth");
+    pbr_pyramid.set_name("pbr depth pyramid");
+    pbr_pyramid.add_child(*pbr_node);
+    
+    occlusion_cull<4> pbr_late_cull(app.device, pbr_early_cull, pbr_pyramid);
+    pbr_late_cull.set_name("pbr late cull");
+    pbr_late_cull.add_child(pbr_pyramid);
+    add_scene(pbr_late_cull);
+    
+    eastl::shared_ptr<pbr<4>> pbr_late_node = eastl::make_shared<pbr<4>>(app.device, dims.x, dims.y);
+    pbr_late_node->set_name("pbr late node");
+    pbr_late_node->set_load_attachments(true);
+    add_scene(*pbr_late_node);
+    pbr_late_node->add_child(pbr_late_cull);
+    pbr_late_node->set_indirect_draws(pbr_late_cull.get_indirect_draws());
     //pbr_node->set_active(false);
     eastl::shared_ptr<atmospheric<4>> atmos_node = eastl::make_shared<atmospheric<4>>(app.device);
     atmos_node->set_name("atmospheric");
@@ -553,11 +1710,15 @@ void create_graph()
                                                                                      512, 512 );
     
     //atmos_node->set_sun_position(point_light_cam.position);
-    eastl::shared_ptr<fxaa<4>> fast_approximate_aa = eastl::make_shared<fxaa<4>>(app.device, app.swapchain,"final_render");
+    //note: golden images are compared at the size of the window
+    const bool dynamic_resolution = opts.target_gpu_ms > 0.0f && opts.golden == nullptr;
+    eastl::shared_ptr<fxaa<4>> fast_approximate_aa = eastl::make_shared<fxaa<4>>(app.device, app.swapchain,
+                                                                                 dynamic_resolution ? "upscaled_render" : "final_render");
+    eastl::shared_ptr<upscale<4>> upscale_node = eastl::make_shared<upscale<4>>(app.device, dims.x, dims.y, "final_render", "upscaled_render");
     
     //atmos_node->add_child(*pbr_node);
     //rad_map->add_child(*atmos_node);
-    rad_map->add_child(*pbr_node);
+    rad_map->add_child(*pbr_late_node);
     rad_map->set_name("radiance");
     
     lut_node->set_name("lut node");
@@ -570,7 +1731,21 @@ void create_graph()
 //        eastl::make_shared<display_texture_2d<4>>(app.device, app.swapchain, (uint32_t)dims.x, (uint32_t)dims.y, "spec_map_lut");
 //    eastl::shared_ptr<display_texture_2d<4>> pbr_debug = eastl::make_shared<display_texture_2d<4>>(app.device, app.swapchain, (uint32_t)dims.x, (uint32_t)dims.y, "model_albedo", vk::texture_2d::get_class_type());
     
-    fast_approximate_aa->add_child(*mrt_node);
+    //note: the shadow maps are drawn from the light and sampled with its coordinates, they keep their size.  The scene from the
+    //camera is drawn at the render scale up to the composite and stretched back before anti aliasing
+    if(dynamic_resolution)
+    {
+        pbr_node->set_dynamic_resolution(true);
+        pbr_late_node->set_dynamic_resolution(true);
+        pbr_pyramid.set_dynamic_resolution(true);
+        mrt_node->set_dynamic_resolution(true);
+        
+        upscale_node->set_name("upscale");
+        upscale_node->add_child(*mrt_node);
+        fast_approximate_aa->add_child(*upscale_node);
+    }
+    else
+        fast_approximate_aa->add_child(*mrt_node);
     fast_approximate_aa->set_active(true);
     
 //    pbr_debug->add_child(*fast_approximate_aa);
@@ -583,35 +1758,120 @@ void create_graph()
     app.debug_node_3d = debug_node_3d;
 
     app.voxel_graph->init();
+    app.voxel_graph->set_reuse_commands(!opts.no_command_reuse);
+    vk::mesh_optimizer::print_totals();
+    vk::mesh_cache::print_totals();
     
     app.aa = fast_approximate_aa.get();
     //app.debug = pbr_debug.get();
 
-    game_loop();
+    if(opts.golden != nullptr)
+        run_golden_tests(opts.golden);
+    else if(opts.record_bench != 0)
+        benchmark_recording(opts.record_bench);
+    else
+        game_loop();
 
     app.device->wait_for_all_operations_to_finish();
     app.voxel_graph->destroy_all();
 
     voxelizers.clear();
 }
-int main()
+void create_window()
 {
+    window = glfwCreateWindow(width, height, "Rafael's Demo", nullptr, nullptr);
+    glfwSetFramebufferSizeCallback(window, on_window_resize);
+    glfwSetKeyCallback(window, input_key_callback);
+}
+
+int main(int argc, const char* argv[])
+{
+    launch_time = std::chrono::high_resolution_clock::now();
+    parse_options(argc, argv);
+    vk::job_system::set_num_threads(opts.job_threads);
+    //note: replays and dynamic resolution need the gpu time of every frame, submissions are timed while the profiler is on
+    vk::profiler::set_enabled(opts.profile != nullptr || opts.job_timeline != nullptr || opts.replay_input != nullptr ||
+                              opts.target_gpu_ms > 0.0f);
+    vk::profiler::set_thread_name("main");
+    
+    if(opts.transform_bench != 0)
+    {
+        return benchmark_transforms(opts.transform_bench);
+    }
+    
+    if(opts.mesh_optimizer_test)
+    {
+        return test_mesh_optimizer();
+    }
+    
+    if(opts.block_compression_test)
+    {
+        return test_block_compression();
+    }
+    
+    if(opts.compress_texture != nullptr)
+    {
+        return compress_texture(opts.compress_texture, opts.compress_format);
+    }
+    
+    if(opts.replay_input != nullptr && !recorded_input.read(opts.replay_input))
+    {
+        std::cout << "could not read the input to replay from " << opts.replay_input << std::endl;
+        return 1;
+    }
+    
+    vk::mesh_cache::set_enabled(!opts.no_mesh_cache);
+    vk::mesh_optimizer::set_verbose(opts.mesh_report);
+    vk::mesh_cache::set_verbose(opts.mesh_report);
+    vk::asset_loader::set_enabled(!opts.sync_assets);
+    //note: streamed levels follow the feedback of earlier frames, golden images keep every level so they do not depend on them
+    vk::texture_streamer::set_enabled(!opts.no_mip_streaming && opts.golden == nullptr);
+    vk::texture_cache::set_enabled(!opts.no_texture_dedup);
+    vk::secondary_recorder::set_num_threads(opts.record_threads);
+    vk::device::set_async_compute_enabled(!opts.no_async_compute);
+    vk::device::set_present_wait_enabled(!opts.no_present_wait);
+    if(opts.present_mode != nullptr)
+    {
+        const VkPresentModeKHR modes[] = { VK_PRESENT_MODE_FIFO_KHR, VK_PRESENT_MODE_FIFO_RELAXED_KHR, VK_PRESENT_MODE_MAILBOX_KHR,
+                                           VK_PRESENT_MODE_IMMEDIATE_KHR };
+        bool known = false;
+        for( VkPresentModeKHR mode : modes)
+        {
+            if(eastl::string_view(opts.present_mode) == vk::glfw_swapchain::get_present_mode_name(mode))
+            {
+                vk::glfw_swapchain::set_present_mode(mode);
+                known = true;
+            }
+        }
+        if(!known)
+            std::cout << "unknown present mode " << opts.present_mode << ", the swapchain picks one" << std::endl;
+    }
+    
     std::cout << std::endl;
     std::cout << "working directory " << fs::current_path() << std::endl;
     
     start_glfw();
 
-    glfwSetWindowSizeCallback(window, on_window_resize);
-    glfwSetKeyCallback(window, key_callback);
-
+    //note: golden images rendered with --headless need no window at all when the instance has VK_EXT_headless_surface,
+    //otherwise they go through a hidden one
+    vk::device::set_headless_surface_enabled(opts.golden != nullptr && opts.headless);
     vk::device device;
 
-    glfwCreateWindowSurface(device._instance, window, nullptr, &surface);
+    if(device.has_headless_surface())
+    {
+        surface = device.create_headless_surface();
+    }
+    else
+    {
+        create_window();
+        glfwCreateWindowSurface(device._instance, window, nullptr, &surface);
+    }
     device.create_logical_device(surface);
+    device.get_texture_streamer().set_budget(VkDeviceSize(opts.texture_budget) * 1024 * 1024);
     vk::material_store material_store;
     material_store.create(&device);
     
-    vk::glfw_swapchain swapchain(&device, window, surface);
+    vk::glfw_swapchain swapchain(&device, window, surface, VkExtent2D { static_cast<uint32_t>(width), static_cast<uint32_t>(height) });
     app.device = &device;
     //glfwSetCursorPos(window, width * .5f, height * .5f);
 
@@ -624,7 +1884,10 @@ int main()
 
     vkDestroySurfaceKHR(device._instance, surface, nullptr);
     device.destroy();
+    
+    std::cout << "scene containers used " << vk::arena::get_persistent().get_bytes_reserved() / 1024 << " kb of arena memory" << std::endl;
+    vk::arena::get_persistent().reset();
 
     shutdown_glfw();
-    return 0;
+    return golden_failures == 0 ? 0 : 1;
 }
@@ -18,6 +18,17 @@ layout (binding = 4) uniform sampler2D metalness;
 layout (binding = 5) uniform sampler2D roughness;
 layout (binding = 6) uniform sampler2D occlusion;
 
+layout (binding = 8, std140) uniform FEEDBACK_SLOT
+{
+    int slot;
+} feedback_slot;
+
+//note: texels across the uv range this subpass needs, read back by the texture streamer, see texture_streamer.h
+layout (std430, binding = 9) buffer FEEDBACK
+{
+    uint texels[];
+} feedback;
+
 //based off of: https://aras-p.info/texts/CompactNormalStorage.html and
 //https://en.wikipedia.org/wiki/Lambert_azimuthal_equal-area_projection
 
@@ -51,5 +62,13 @@ void main()
     }
     
     out_positions = vec4(in_position,1.0f);
+    
+    //note: one pixel out of every 8x8 block is enough, the atomics of every pixel would go to the same address
+    if(((int(gl_FragCoord.x) | int(gl_FragCoord.y)) & 7) == 0)
+    {
+        vec2 footprint = max(abs(dFdx(in_uv_coord)), abs(dFdy(in_uv_coord)));
+        float texels = -log2(max(max(footprint.x, footprint.y), 1e-6f));
+        atomicMax(feedback.texels[feedback_slot.slot], uint(clamp(texels, 0.0f, 15.0f) * 16.0f) + 1u);
+    }
 }
 
@@ -1,24 +1,55 @@
 
 #version 450
 
-layout(location = 0) in vec3 pos;
+layout(location = 0) in vec4 pos;
 layout(location = 1) in vec4 color;
 layout(location = 2) in vec2 uv_coord;
 layout(location = 3) in vec3 normal;
 layout(location = 4) in vec3 tangent;
 layout(location = 5) in vec3 bitangent;
 
+//note: 0 is vk::vertex, 1 is vk::packed_vertex, the pipeline sets it.  See packed_vertex.h
+layout(constant_id = 0) const int VERTEX_FORMAT = 0;
+
+//must match vk::packed_vertex::octahedral_decode
+vec3 octahedral_decode(vec2 e)
+{
+    vec3 n = vec3(e.x, e.y, 1.0f - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0f);
+    n.x += n.x >= 0.0f ? -t : t;
+    n.y += n.y >= 0.0f ? -t : t;
+    return normalize(n);
+}
+
 layout(binding = 0, std140) uniform UBO
 {
     mat4 view;
     mat4 projection;
 } ubo;
 
+//takes the mesh to object space, i.e. the dequantization of packed vertices
 layout(binding = 1,std140) uniform DYNAMIC
 {
-    mat4 model;
+    mat4 mesh;
+    //added to gl_InstanceIndex, see graphics_node::set_mesh_param
+    uint instance_base;
 }dynamic_b;
 
+//note: must match vk::instance_pool::instance
+struct instance
+{
+    mat4 model;
+    uint material_id;
+    uint pad0;
+    uint pad1;
+    uint pad2;
+};
+
+layout(std430, binding = 7) readonly buffer INSTANCES
+{
+    instance instances[];
+};
+
 
 layout(location = 0) out vec2 out_uv_coord;
 layout(location = 1) out vec4 out_color;
@@ -30,22 +61,35 @@ layout(location = 4) out mat3 out_tbn;
 
 void main()
 {
-    gl_Position = ubo.projection * ubo.view * dynamic_b.model * vec4(pos, 1.0f);
+    vec3 in_normal = normal;
+    vec3 in_tangent = tangent;
+    if(VERTEX_FORMAT == 1)
+    {
+        in_normal = octahedral_decode(normal.xy);
+        in_tangent = octahedral_decode(tangent.xy);
+    }
+    
+    mat4 model = instances[dynamic_b.instance_base + gl_InstanceIndex].model * dynamic_b.mesh;
+    gl_Position = ubo.projection * ubo.view * model * vec4(pos.xyz, 1.0f);
     
     out_uv_coord = uv_coord;
     out_color = color;
-    out_position = (dynamic_b.model * vec4(pos, 1.0f)).xyz;
+    out_position = (model * vec4(pos.xyz, 1.0f)).xyz;
     
     //this code is based off of:
     //https://learnopengl.com/Advanced-Lighting/Normal-Mapping
     
-    vec3 N = normalize(ubo.view * dynamic_b.model * vec4(normal, 0.0f)).xyz;
-    vec3 T = normalize(ubo.view * dynamic_b.model * vec4(tangent, 0.0f)).xyz;
+    vec3 N = normalize(ubo.view * model * vec4(in_normal, 0.0f)).xyz;
+    vec3 T = normalize(ubo.view * model * vec4(in_tangent, 0.0f)).xyz;
     
     T = normalize(T - dot(T, N) * N);
-    vec3 B = cross(N.xyz,T.xyz);
+    //note: float vertices have the bitangent that was authored, packed ones leave it out and keep the handedness of the
+    //tangent frame in pos.w, it is rebuilt from the normal and tangent
+    vec3 B = normalize(ubo.view * model * vec4(bitangent, 0.0f)).xyz;
+    if(VERTEX_FORMAT == 1)
+        B = pos.w * cross(N.xyz,T.xyz);
     out_tbn = mat3(T, B, N);
     out_tbn = transpose(inverse(out_tbn));
-    out_normal = normalize(dynamic_b.model * vec4(normal,0)).xyz;
+    out_normal = normalize(model * vec4(in_normal,0)).xyz;
 
 }
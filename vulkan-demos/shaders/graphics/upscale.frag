@@ -0,0 +1,64 @@
+#version 450
+#extension GL_ARB_separate_shader_objects: enable
+
+
+layout(location = 0) in vec2 in_frag_coord;
+layout(location = 0) out vec4 out_color;
+
+layout(binding = 0) uniform sampler2D source;
+
+layout(binding = 1) uniform UPSCALE_INPUT
+{
+    vec4    source_size;            //vec4(drawn_width, drawn_height, texture_width, texture_height)
+} upscale_input;
+
+//catmull-rom with 9 bilinear taps instead of 16 point ones, based off of
+//https://vec3.ca/bicubic-filtering-in-fewer-taps/
+
+vec4 sample_clamped(vec2 uv, vec2 min_uv, vec2 max_uv)
+{
+    //the source was only drawn in a corner, the texels past it are stale
+    return textureLod(source, clamp(uv, min_uv, max_uv), 0.0f);
+}
+
+void main()
+{
+    vec2 drawn_size = upscale_input.source_size.xy;
+    vec2 texture_size = upscale_input.source_size.zw;
+    vec2 texel_size = 1.0f / texture_size;
+
+    vec2 min_uv = 0.5f * texel_size;
+    vec2 max_uv = (drawn_size - 0.5f) * texel_size;
+
+    vec2 sample_pos = in_frag_coord * drawn_size;
+    vec2 tex_pos1 = floor(sample_pos - 0.5f) + 0.5f;
+    vec2 f = sample_pos - tex_pos1;
+
+    vec2 w0 = f * (-0.5f + f * (1.0f - 0.5f * f));
+    vec2 w1 = 1.0f + f * f * (-2.5f + 1.5f * f);
+    vec2 w2 = f * (0.5f + f * (2.0f - 1.5f * f));
+    vec2 w3 = f * f * (-0.5f + 0.5f * f);
+
+    vec2 w12 = w1 + w2;
+    vec2 offset12 = w2 / w12;
+
+    vec2 tex_pos0 = (tex_pos1 - 1.0f) * texel_size;
+    vec2 tex_pos3 = (tex_pos1 + 2.0f) * texel_size;
+    vec2 tex_pos12 = (tex_pos1 + offset12) * texel_size;
+
+    vec4 result = vec4(0.0f);
+    result += sample_clamped(vec2(tex_pos0.x,  tex_pos0.y), min_uv, max_uv) * w0.x * w0.y;
+    result += sample_clamped(vec2(tex_pos12.x, tex_pos0.y), min_uv, max_uv) * w12.x * w0.y;
+    result += sample_clamped(vec2(tex_pos3.x,  tex_pos0.y), min_uv, max_uv) * w3.x * w0.y;
+
+    result += sample_clamped(vec2(tex_pos0.x,  tex_pos12.y), min_uv, max_uv) * w0.x * w12.y;
+    result += sample_clamped(vec2(tex_pos12.x, tex_pos12.y), min_uv, max_uv) * w12.x * w12.y;
+    result += sample_clamped(vec2(tex_pos3.x,  tex_pos12.y), min_uv, max_uv) * w3.x * w12.y;
+
+    result += sample_clamped(vec2(tex_pos0.x,  tex_pos3.y), min_uv, max_uv) * w0.x * w3.y;
+    result += sample_clamped(vec2(tex_pos12.x, tex_pos3.y), min_uv, max_uv) * w12.x * w3.y;
+    result += sample_clamped(vec2(tex_pos3.x,  tex_pos3.y), min_uv, max_uv) * w3.x * w3.y;
+
+    //the negative lobes ring around bright edges
+    out_color = max(result, vec4(0.0f));
+}
@@ -15,6 +15,19 @@ layout(location = 1) in vec4 color;
 layout(location = 2) in vec2 uv_coord;
 layout(location = 3) in vec3 normal;
 
+//note: 0 is vk::vertex, 1 is vk::packed_vertex, the pipeline sets it.  See packed_vertex.h
+layout(constant_id = 0) const int VERTEX_FORMAT = 0;
+
+//must match vk::packed_vertex::octahedral_decode
+vec3 octahedral_decode(vec2 e)
+{
+    vec3 n = vec3(e.x, e.y, 1.0f - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0f);
+    n.x += n.x >= 0.0f ? -t : t;
+    n.y += n.y >= 0.0f ? -t : t;
+    return normalize(n);
+}
+
 
 layout(location = 0) out vec4 vertex_color;
 layout(location = 1) out vec3 out_normal;
@@ -38,16 +51,35 @@ layout(binding = 0, std140) uniform UBO
 } ubo;
 layout (binding = 5) uniform sampler2D albedo;
 
+//takes the mesh to object space, i.e. the dequantization of packed vertices
 layout(binding = 3, std140) uniform DYNAMIC_UBO
 {
-    mat4 model;
+    mat4 mesh;
+    //added to gl_InstanceIndex, see graphics_node::set_mesh_param
+    uint instance_base;
 }d_ubo;
 
+//note: must match vk::instance_pool::instance
+struct instance
+{
+    mat4 model;
+    uint material_id;
+    uint pad0;
+    uint pad1;
+    uint pad2;
+};
+
+layout(std430, binding = 6) readonly buffer INSTANCES
+{
+    instance instances[];
+};
+
 void main()
 {
-    gl_Position = ubo.projection * ubo.view * d_ubo.model * vec4(pos, 1.0f);
+    mat4 model = instances[d_ubo.instance_base + gl_InstanceIndex].model * d_ubo.mesh;
+    gl_Position = ubo.projection * ubo.view * model * vec4(pos, 1.0f);
     
-    vec4 world_pos = d_ubo.model * vec4(pos,1.f);
+    vec4 world_pos = model * vec4(pos,1.f);
     
     //position is the direction in directional lights
     vec3 wrold_space_light_vec = normalize(ubo.light_position);
@@ -61,7 +93,8 @@ void main()
     if(ubo.use_texture != 0)
         vertex_color = texture(albedo,uv_coord);
     
-    out_normal = (d_ubo.model * vec4(normal,0)).xyz;
+    vec3 n = VERTEX_FORMAT == 1 ? octahedral_decode(normal.xy) : normal;
+    out_normal = (model * vec4(n,0)).xyz;
     out_light_vec = wrold_space_light_vec;
     out_view_vec = world_space_view_vec;
 }
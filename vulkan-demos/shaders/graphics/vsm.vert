@@ -21,13 +21,32 @@ layout(binding = 0) uniform UBO
     //vec3 lightPosition;
 } ubo;
 
+//takes the mesh to object space, i.e. the dequantization of packed vertices
 layout(binding = 1, std140) uniform DYNAMIC_UBO
 {
-    mat4 model;
+    mat4 mesh;
+    //added to gl_InstanceIndex, see graphics_node::set_mesh_param
+    uint instance_base;
 }d_ubo;
 
+//note: must match vk::instance_pool::instance
+struct instance
+{
+    mat4 model;
+    uint material_id;
+    uint pad0;
+    uint pad1;
+    uint pad2;
+};
+
+layout(std430, binding = 2) readonly buffer INSTANCES
+{
+    instance instances[];
+};
+
 void main()
 {
     
-    gl_Position = ubo.projection * ubo.view * d_ubo.model * vec4(pos, 1.0f);
+    mat4 model = instances[d_ubo.instance_base + gl_InstanceIndex].model * d_ubo.mesh;
+    gl_Position = ubo.projection * ubo.view * model * vec4(pos, 1.0f);
 }
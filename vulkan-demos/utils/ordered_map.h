@@ -11,6 +11,7 @@
 #include "EASTL/string_view.h"
 #include "EASTL/fixed_vector.h"
 #include "EAAssert/eaassert.h"
+#include "EASTL/type_traits.h"
 #include <algorithm>
 
 //this container gives us the ability to keep the insertion order of the keys as they are entered
@@ -122,6 +123,15 @@ public:
     }
     inline iterator<_value> find(_key i)
     {
+        //note: maps keyed by object id are filled out in order, the key is the index.  This keeps lookups in scenes with many
+        //objects from walking the whole map
+        if constexpr (eastl::is_integral<_key>::value)
+        {
+            size_t slot = static_cast<size_t>(i);
+            if( slot < _vec.size() && _vec[slot].first == i)
+                return iterator<_value>(_vec, slot);
+        }
+        
         size_t index =0;
         for( auto& element : _vec)
         {
@@ -0,0 +1,117 @@
+//
+//  geometry_pool.cpp
+//  vulkan-demos
+//
+//  Created by Rafael Sabino on 10/19/26.
+//  Copyright © 2026 Rafael Sabino. All rights reserved.
+//
+
+#include "geometry_pool.h"
+#include <cstring>
+
+using namespace vk;
+
+geometry_pool::range geometry_pool::allocate(uint32_t vertex_stride, const void* vertices, uint32_t vertex_count,
+                                             const uint32_t* indices, uint32_t index_count)
+{
+    EA_ASSERT_MSG(_device != nullptr, "call set_device on the geometry pool before allocating from it");
+    EA_ASSERT(vertex_stride != 0);
+    EA_ASSERT(vertex_count != 0 && index_count != 0);
+
+    uint32_t block_id = find_block(vertex_stride, vertex_count, index_count);
+    if(block_id == INVALID_BLOCK)
+        block_id = create_block(vertex_stride, vertex_count, index_count);
+
+    block& b = _blocks[block_id];
+
+    range r {};
+    r.block_id = block_id;
+    r.first_index = b.index_count;
+    r.vertex_offset = static_cast<int32_t>(b.vertex_count);
+    r.index_count = index_count;
+    r.vertex_count = vertex_count;
+
+    upload(b.vertex_buffer, VkDeviceSize(b.vertex_count) * vertex_stride, vertices, VkDeviceSize(vertex_count) * vertex_stride);
+    upload(b.index_buffer, VkDeviceSize(b.index_count) * sizeof(uint32_t), indices, VkDeviceSize(index_count) * sizeof(uint32_t));
+
+    b.vertex_count += vertex_count;
+    b.index_count += index_count;
+
+    return r;
+}
+
+void geometry_pool::bind(VkCommandBuffer& command_buffer, uint32_t block_id)
+{
+    EA_ASSERT_MSG(block_id < _blocks.size(), "this mesh was never given room in the geometry pool");
+    block& b = _blocks[block_id];
+
+    VkDeviceSize offsets[] = { 0 };
+    vkCmdBindVertexBuffers(command_buffer, 0, 1, &b.vertex_buffer, offsets);
+    vkCmdBindIndexBuffer(command_buffer, b.index_buffer, 0, VK_INDEX_TYPE_UINT32);
+}
+
+uint32_t geometry_pool::find_block(uint32_t vertex_stride, uint32_t vertex_count, uint32_t index_count)
+{
+    for( uint32_t i = 0; i < _blocks.size(); ++i)
+    {
+        block& b = _blocks[i];
+        if(b.vertex_stride == vertex_stride &&
+           (b.vertex_capacity - b.vertex_count) >= vertex_count &&
+           (b.index_capacity - b.index_count) >= index_count)
+        {
+            return i;
+        }
+    }
+    return INVALID_BLOCK;
+}
+
+uint32_t geometry_pool::create_block(uint32_t vertex_stride, uint32_t vertex_count, uint32_t index_count)
+{
+    block b {};
+    b.vertex_stride = vertex_stride;
+    b.vertex_capacity = eastl::max(static_cast<uint32_t>(VERTEX_BLOCK_SIZE / vertex_stride), vertex_count);
+    b.index_capacity = eastl::max(static_cast<uint32_t>(INDEX_BLOCK_SIZE / sizeof(uint32_t)), index_count);
+
+    create_buffer(_device->_logical_device, _device->_physical_device, VkDeviceSize(b.vertex_capacity) * vertex_stride,
+                  VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, b.vertex_buffer,
+                  VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, b.vertex_memory);
+
+    create_buffer(_device->_logical_device, _device->_physical_device, VkDeviceSize(b.index_capacity) * sizeof(uint32_t),
+                  VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, b.index_buffer,
+                  VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, b.index_memory);
+
+    _blocks.push_back(b);
+    return static_cast<uint32_t>(_blocks.size() - 1);
+}
+
+void geometry_pool::upload(VkBuffer dest, VkDeviceSize dest_offset, const void* data, VkDeviceSize size)
+{
+    VkBuffer staging_buffer {};
+    VkDeviceMemory staging_buffer_memory {};
+
+    create_buffer(_device->_logical_device, _device->_physical_device, size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, staging_buffer,
+                  VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, staging_buffer_memory);
+
+    void* raw_data = nullptr;
+    VkResult r = vkMapMemory(_device->_logical_device, staging_buffer_memory, 0, size, 0, &raw_data);
+    ASSERT_VULKAN(r);
+    memcpy(raw_data, data, size);
+    vkUnmapMemory(_device->_logical_device, staging_buffer_memory);
+
+    _device->copy_buffer(_device->_graphics_command_pool, _device->_graphics_queue, staging_buffer, dest, size, dest_offset);
+
+    vkDestroyBuffer(_device->_logical_device, staging_buffer, nullptr);
+    vkFreeMemory(_device->_logical_device, staging_buffer_memory, nullptr);
+}
+
+void geometry_pool::destroy()
+{
+    for( block& b : _blocks)
+    {
+        vkDestroyBuffer(_device->_logical_device, b.vertex_buffer, nullptr);
+        vkFreeMemory(_device->_logical_device, b.vertex_memory, nullptr);
+        vkDestroyBuffer(_device->_logical_device, b.index_buffer, nullptr);
+        vkFreeMemory(_device->_logical_device, b.index_memory, nullptr);
+    }
+    _blocks.clear();
+}
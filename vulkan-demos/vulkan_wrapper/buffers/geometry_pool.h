@@ -0,0 +1,93 @@
+//
+//  geometry_pool.h
+//  vulkan-demos
+//
+//  Created by Rafael Sabino on 10/19/26.
+//  Copyright © 2026 Rafael Sabino. All rights reserved.
+//
+
+#pragma once
+
+#include "resource.h"
+#include "device.h"
+#include "EASTL/fixed_vector.h"
+#include "arena.h"
+#include <limits>
+
+namespace vk
+{
+    //note: every mesh in the application lives in one of a handful of large device local vertex/index buffers.  A block only holds
+    //vertices of a single stride, that way the vertex offset handed to the draw call is a whole number of vertices.  Meshes keep a
+    //range (first index, vertex offset) into a block instead of owning buffers, so a pass binds a block once and draws many meshes.
+    //
+    //ranges are never returned one at a time, the memory goes away when the pool is destroyed along with the device.
+    class geometry_pool : public resource
+    {
+    public:
+
+        static constexpr uint32_t INVALID_BLOCK = std::numeric_limits<uint32_t>::max();
+        //note: blocks kept inline, more grow into the persistent arena
+        static constexpr uint32_t MAX_BLOCKS = 32u;
+
+        //note: meshes bigger than this get a block of their own
+        static constexpr VkDeviceSize VERTEX_BLOCK_SIZE = 64u * 1024u * 1024u;
+        static constexpr VkDeviceSize INDEX_BLOCK_SIZE = 16u * 1024u * 1024u;
+
+        struct range
+        {
+            uint32_t    block_id = INVALID_BLOCK;
+            uint32_t    first_index = 0;
+            int32_t     vertex_offset = 0;
+            uint32_t    index_count = 0;
+            uint32_t    vertex_count = 0;
+
+            inline bool is_valid() const { return block_id != INVALID_BLOCK; }
+        };
+
+        geometry_pool(){}
+        geometry_pool(device* dev){ _device = dev; }
+
+        inline void set_device(device* dev)
+        {
+            _device = dev;
+        }
+
+        //copies the vertices and indices into a block with room for them, indices are relative to the first vertex of the mesh
+        range allocate(uint32_t vertex_stride, const void* vertices, uint32_t vertex_count, const uint32_t* indices, uint32_t index_count);
+
+        void bind(VkCommandBuffer& command_buffer, uint32_t block_id);
+
+        inline uint32_t get_num_blocks(){ return static_cast<uint32_t>(_blocks.size()); }
+
+        virtual void destroy() override;
+
+        virtual char const * const * get_instance_type() override { return (&_type); };
+        static char const * const *  get_class_type(){ return (&_type); }
+
+    private:
+
+        struct block
+        {
+            uint32_t        vertex_stride = 0;
+
+            VkBuffer        vertex_buffer = VK_NULL_HANDLE;
+            VkDeviceMemory  vertex_memory = VK_NULL_HANDLE;
+            uint32_t        vertex_capacity = 0;
+            uint32_t        vertex_count = 0;
+
+            VkBuffer        index_buffer = VK_NULL_HANDLE;
+            VkDeviceMemory  index_memory = VK_NULL_HANDLE;
+            uint32_t        index_capacity = 0;
+            uint32_t        index_count = 0;
+        };
+
+        uint32_t find_block(uint32_t vertex_stride, uint32_t vertex_count, uint32_t index_count);
+        uint32_t create_block(uint32_t vertex_stride, uint32_t vertex_count, uint32_t index_count);
+        void upload(VkBuffer dest, VkDeviceSize dest_offset, const void* data, VkDeviceSize size);
+
+        static constexpr char const * _type = nullptr;
+
+        device* _device = nullptr;
+        eastl::fixed_vector<block, MAX_BLOCKS, true, arena_allocator> _blocks {};
+    };
+}
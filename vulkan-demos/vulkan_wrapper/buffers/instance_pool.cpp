@@ -0,0 +1,92 @@
+//
+//  instance_pool.cpp
+//  vulkan-demos
+//
+//  Created by Rafael Sabino on 10/19/26.
+//  Copyright © 2026 Rafael Sabino. All rights reserved.
+//
+
+#include "instance_pool.h"
+#include <cstring>
+#include "EASTL/algorithm.h"
+
+using namespace vk;
+
+instance_pool::range instance_pool::allocate(uint32_t instance_count)
+{
+    EA_ASSERT(instance_count != 0);
+
+    range r {};
+    r.first_instance = _num_instances;
+    r.instance_count = instance_count;
+    _num_instances += instance_count;
+
+    if(_buffers[0].is_initialized() && _num_instances > _capacity)
+        grow_buffers();
+
+    return r;
+}
+
+instance_pool::instance* instance_pool::get_instances(uint32_t image_id)
+{
+    EA_ASSERT(image_id < _buffers.size());
+    if(!_buffers[image_id].is_initialized())
+        create_buffers();
+
+    return static_cast<instance*>(_buffers[image_id].get_mapped_memory());
+}
+
+instance_pool::buffer_array& instance_pool::get_buffers()
+{
+    if(!_buffers[0].is_initialized())
+        create_buffers();
+
+    return _buffers;
+}
+
+void instance_pool::create_buffers()
+{
+    EA_ASSERT_MSG(_device != nullptr, "call set_device on the instance pool before using it");
+
+    _capacity = eastl::max(_num_instances, INITIAL_CAPACITY);
+    for( int i = 0; i < _buffers.size(); ++i)
+    {
+        _buffers[i].set_device(_device);
+        _buffers[i].create(sizeof(instance) * _capacity, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                           VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        memset(_buffers[i].get_mapped_memory(), 0, sizeof(instance) * _capacity);
+    }
+}
+
+//note: the instances written so far are copied over, the old buffers are kept until the pool is destroyed
+void instance_pool::grow_buffers()
+{
+    uint32_t old_capacity = _capacity;
+    _capacity = eastl::max(_num_instances, _capacity * 2);
+    for( int i = 0; i < _buffers.size(); ++i)
+    {
+        storage_buffer old_buffer = _buffers[i];
+        _retired.push_back(old_buffer);
+
+        _buffers[i] = storage_buffer(_device);
+        _buffers[i].create(sizeof(instance) * _capacity, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                           VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        memcpy(_buffers[i].get_mapped_memory(), old_buffer.get_mapped_memory(), sizeof(instance) * old_capacity);
+        memset(static_cast<instance*>(_buffers[i].get_mapped_memory()) + old_capacity, 0, sizeof(instance) * (_capacity - old_capacity));
+    }
+}
+
+void instance_pool::destroy()
+{
+    for( int i = 0; i < _buffers.size(); ++i)
+    {
+        _buffers[i].destroy();
+    }
+    for( storage_buffer& b : _retired)
+    {
+        b.destroy();
+    }
+    _retired.clear();
+    _num_instances = 0;
+    _capacity = 0;
+}
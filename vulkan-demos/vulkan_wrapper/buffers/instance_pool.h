@@ -0,0 +1,95 @@
+//
+//  instance_pool.h
+//  vulkan-demos
+//
+//  Created by Rafael Sabino on 10/19/26.
+//  Copyright © 2026 Rafael Sabino. All rights reserved.
+//
+
+#pragma once
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#define GLM_FORCE_SILENT_WARNINGS
+
+#include <glm/glm.hpp>
+#include "EASTL/array.h"
+#include "EASTL/vector.h"
+#include "resource.h"
+#include "device.h"
+#include "glfw_swapchain.h"
+#include "storage_buffer.h"
+
+namespace vk
+{
+    //note: per instance data of every mesh in the application, one host visible storage buffer per swapchain image.  A mesh that is
+    //drawn many times (foliage, props) gets a range of instances and is drawn with a single instanced draw, shaders index the buffer
+    //with gl_InstanceIndex.  Passes bind the same buffers, so a range means the same thing to every pass and culling node.
+    //
+    //like the geometry pool, ranges are never returned one at a time.  Ranges allocated once the buffers exist make them grow,
+    //they are made again twice as big and the materials that bind them write their descriptors again, see
+    //material_base::refresh_storage_descriptors
+    class instance_pool : public resource
+    {
+    public:
+
+        //note: instances the buffers have room for when they are first made, they double from there
+        static constexpr uint32_t INITIAL_CAPACITY = 1024u;
+
+        //note: std430, must match the instance struct in pbr.vert, vsm.vert and voxelize.vert.  material_id is carried for shaders
+        //that index a material table, the passes in this demo bind their materials per subpass and do not read it
+        struct instance
+        {
+            glm::mat4   model;
+            uint32_t    material_id;
+            uint32_t    pad[3];
+        };
+        static_assert(sizeof(instance) == 80, "instance does not match the shader layout");
+
+        struct range
+        {
+            uint32_t    first_instance = 0;
+            uint32_t    instance_count = 1;
+        };
+
+        using buffer_array = eastl::array<storage_buffer, glfw_swapchain::NUM_SWAPCHAIN_IMAGES>;
+
+        instance_pool(){}
+        instance_pool(device* dev){ _device = dev; }
+
+        inline void set_device(device* dev)
+        {
+            _device = dev;
+        }
+
+        range allocate(uint32_t instance_count);
+
+        //note: only write to the instances of an image once its fence has been waited on, i.e. when recording
+        instance* get_instances(uint32_t image_id);
+
+        //note: buffers are created the first time they are asked for, subpasses bind them in init_node
+        buffer_array& get_buffers();
+
+        inline uint32_t get_num_instances(){ return _num_instances; }
+        inline uint32_t get_capacity(){ return _capacity; }
+
+        virtual void destroy() override;
+
+        virtual char const * const * get_instance_type() override { return (&_type); };
+        static char const * const *  get_class_type(){ return (&_type); }
+
+    private:
+
+        void create_buffers();
+        void grow_buffers();
+
+        static constexpr char const * _type = nullptr;
+
+        device*         _device = nullptr;
+        buffer_array    _buffers {};
+        //note: buffers that were replaced by bigger ones, frames in flight may still read them.  They go with the pool
+        eastl::vector<storage_buffer> _retired {};
+        uint32_t        _num_instances = 0;
+        uint32_t        _capacity = 0;
+    };
+}
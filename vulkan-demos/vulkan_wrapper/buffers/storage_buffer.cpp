@@ -0,0 +1,46 @@
+//
+//  storage_buffer.cpp
+//  vulkan-demos
+//
+//  Created by Rafael Sabino on 10/19/26.
+//  Copyright © 2026 Rafael Sabino. All rights reserved.
+//
+
+#include "storage_buffer.h"
+
+using namespace vk;
+
+void storage_buffer::create(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags memory_properties)
+{
+    EA_ASSERT_MSG(_device != nullptr, "call set_device on the storage buffer before creating it");
+    EA_ASSERT_MSG(_buffer == VK_NULL_HANDLE, "this storage buffer has already been created");
+    EA_ASSERT(size != 0);
+    
+    _size = size;
+    create_buffer(_device->_logical_device, _device->_physical_device, _size, usage, _buffer, memory_properties, _device_memory);
+    
+    if(memory_properties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+    {
+        VkResult result = vkMapMemory(_device->_logical_device, _device_memory, 0, _size, 0, &_mapped_memory);
+        ASSERT_VULKAN(result);
+    }
+}
+
+void storage_buffer::destroy()
+{
+    if(_buffer == VK_NULL_HANDLE)
+        return;
+    
+    if(_mapped_memory != nullptr)
+    {
+        vkUnmapMemory(_device->_logical_device, _device_memory);
+        _mapped_memory = nullptr;
+    }
+    
+    vkDestroyBuffer(_device->_logical_device, _buffer, nullptr);
+    vkFreeMemory(_device->_logical_device, _device_memory, nullptr);
+    
+    _buffer = VK_NULL_HANDLE;
+    _device_memory = VK_NULL_HANDLE;
+    _size = 0;
+}
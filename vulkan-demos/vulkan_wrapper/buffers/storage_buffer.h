@@ -0,0 +1,57 @@
+//
+//  storage_buffer.h
+//  vulkan-demos
+//
+//  Created by Rafael Sabino on 10/19/26.
+//  Copyright © 2026 Rafael Sabino. All rights reserved.
+//
+
+#pragma once
+
+#include "resource.h"
+#include "device.h"
+
+namespace vk
+{
+    //note: a plain vulkan buffer that shaders can read and write to (std430 storage buffers, indirect commands, etc.).
+    //host visible buffers stay mapped for as long as the buffer is alive.
+    class storage_buffer : public resource
+    {
+    public:
+        
+        storage_buffer(){}
+        storage_buffer(device* dev){ _device = dev; }
+        
+        inline void set_device(device* dev)
+        {
+            _device = dev;
+        }
+        
+        void create(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags memory_properties);
+        
+        inline void* get_mapped_memory()
+        {
+            EA_ASSERT_MSG(_mapped_memory != nullptr, "this storage buffer is not host visible");
+            return _mapped_memory;
+        }
+        
+        inline VkBuffer get_vk_buffer(){ return _buffer; }
+        inline VkDeviceSize get_size(){ return _size; }
+        inline bool is_initialized(){ return _buffer != VK_NULL_HANDLE; }
+        
+        virtual void destroy() override;
+        
+        virtual char const * const * get_instance_type() override { return (&_type); };
+        static char const * const *  get_class_type(){ return (&_type); }
+        
+    private:
+        
+        static constexpr char const * _type = nullptr;
+        
+        device*         _device = nullptr;
+        VkBuffer        _buffer = VK_NULL_HANDLE;
+        VkDeviceMemory  _device_memory = VK_NULL_HANDLE;
+        void*           _mapped_memory = nullptr;
+        VkDeviceSize    _size = 0;
+    };
+}
@@ -0,0 +1,98 @@
+//
+//  frustum.h
+//  vulkan-demos
+//
+//  Created by Rafael Sabino on 10/19/26.
+//  Copyright © 2026 Rafael Sabino. All rights reserved.
+//
+
+#pragma once
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#define GLM_FORCE_SILENT_WARNINGS
+
+#include <glm/glm.hpp>
+#include "EASTL/array.h"
+#include "bounds.h"
+
+namespace vk
+{
+    //planes are stored as (normal, distance) with normals pointing towards the inside of the frustum.  This class is the cpu
+    //reference for the culling done in shaders/compute/frustum_cull.comp, keep both in sync
+    class frustum
+    {
+    public:
+
+        enum plane
+        {
+            PLANE_LEFT = 0,
+            PLANE_RIGHT,
+            PLANE_BOTTOM,
+            PLANE_TOP,
+            PLANE_NEAR,
+            PLANE_FAR,
+            PLANE_COUNT
+        };
+
+        using planes_array = eastl::array<glm::vec4, PLANE_COUNT>;
+
+        frustum(){}
+        frustum(const glm::mat4& view_projection){ set(view_projection); }
+
+        //Gribb & Hartmann plane extraction, near plane assumes depth range [0,1]
+        void set(const glm::mat4& view_projection)
+        {
+            const glm::mat4& m = view_projection;
+            glm::vec4 row0 = glm::vec4(m[0][0], m[1][0], m[2][0], m[3][0]);
+            glm::vec4 row1 = glm::vec4(m[0][1], m[1][1], m[2][1], m[3][1]);
+            glm::vec4 row2 = glm::vec4(m[0][2], m[1][2], m[2][2], m[3][2]);
+            glm::vec4 row3 = glm::vec4(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+            _planes[PLANE_LEFT]   = row3 + row0;
+            _planes[PLANE_RIGHT]  = row3 - row0;
+            _planes[PLANE_BOTTOM] = row3 + row1;
+            _planes[PLANE_TOP]    = row3 - row1;
+            _planes[PLANE_NEAR]   = row2;
+            _planes[PLANE_FAR]    = row3 - row2;
+
+            for( glm::vec4& p : _planes)
+            {
+                float len = glm::length(glm::vec3(p));
+                p /= len;
+            }
+        }
+
+        inline bool intersects(const aabb& box) const
+        {
+            glm::vec3 center = box.get_center();
+            glm::vec3 extents = box.get_extents();
+
+            for( const glm::vec4& p : _planes)
+            {
+                glm::vec3 n = glm::vec3(p);
+                //projected radius of the box onto the plane normal
+                float r = glm::dot(extents, glm::abs(n));
+                if( glm::dot(n, center) + p.w + r < 0.0f)
+                    return false;
+            }
+
+            return true;
+        }
+
+        inline bool intersects(const glm::vec3& center, float radius) const
+        {
+            for( const glm::vec4& p : _planes)
+            {
+                if( glm::dot(glm::vec3(p), center) + p.w + radius < 0.0f)
+                    return false;
+            }
+            return true;
+        }
+
+        inline planes_array& get_planes(){ return _planes; }
+
+    private:
+        planes_array _planes {};
+    };
+}
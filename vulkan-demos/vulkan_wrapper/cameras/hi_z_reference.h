@@ -0,0 +1,331 @@
+//
+//  hi_z_reference.h
+//  vulkan-demos
+//
+//  Created by Rafael Sabino on 10/19/26.
+//  Copyright © 2026 Rafael Sabino. All rights reserved.
+//
+
+#pragma once
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#define GLM_FORCE_SILENT_WARNINGS
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <cmath>
+#include "EASTL/vector.h"
+#include "EASTL/array.h"
+#include "bounds.h"
+
+namespace vk
+{
+    //cpu reference for hierarchical-z occlusion culling.  It rasterizes boxes into a depth buffer, builds the same pyramid as
+    //shaders/compute/depth_pyramid.comp and runs the same test as shaders/compute/occlusion_cull_late.comp, keep all three in sync.
+    //Depth is expected to go from 0 (near) to 1 (far), the pyramid keeps the farthest depth of every footprint.
+    class hi_z_reference
+    {
+    public:
+
+        struct level
+        {
+            uint32_t width = 0;
+            uint32_t height = 0;
+            eastl::vector<float> texels {};
+        };
+
+        //screen space bounds of a box, uvs go from 0 to 1 across the depth buffer
+        struct screen_rect
+        {
+            glm::vec2 uv_min = glm::vec2(0.0f);
+            glm::vec2 uv_max = glm::vec2(0.0f);
+            float     nearest = 0.0f;
+        };
+
+        struct validation_result
+        {
+            uint32_t tested = 0;
+            uint32_t occluded_full_resolution = 0;
+            uint32_t occluded_hi_z = 0;
+            //note: boxes the pyramid culled that are visible at full resolution, anything but zero is a bug
+            uint32_t false_occlusions = 0;
+        };
+
+        hi_z_reference(){}
+
+        void clear(uint32_t width, uint32_t height, float depth = 1.0f)
+        {
+            _width = width;
+            _height = height;
+            _depth.assign(width * height, depth);
+            _levels.clear();
+        }
+
+        inline uint32_t get_width(){ return _width; }
+        inline uint32_t get_height(){ return _height; }
+        inline eastl::vector<level>& get_levels(){ return _levels; }
+
+        //rasterizes the twelve triangles of a world space box with a depth test, boxes crossing the near plane are skipped
+        void rasterize(const aabb& box, const glm::mat4& view_proj)
+        {
+            static const eastl::array<uint32_t, 36> indices =
+            {
+                0, 1, 3,  0, 3, 2,
+                4, 6, 7,  4, 7, 5,
+                0, 4, 5,  0, 5, 1,
+                2, 3, 7,  2, 7, 6,
+                0, 2, 6,  0, 6, 4,
+                1, 5, 7,  1, 7, 3
+            };
+
+            eastl::array<glm::vec3, 8> screen {};
+            for( uint32_t i = 0; i < 8; ++i)
+            {
+                glm::vec4 clip = view_proj * glm::vec4(get_corner(box, i), 1.0f);
+                if(clip.w <= 0.0f)
+                    return;
+
+                glm::vec3 ndc = glm::vec3(clip) / clip.w;
+                screen[i] = glm::vec3((ndc.x * 0.5f + 0.5f) * _width, (ndc.y * 0.5f + 0.5f) * _height, ndc.z);
+            }
+
+            for( uint32_t t = 0; t < indices.size(); t += 3)
+            {
+                rasterize_triangle(screen[indices[t]], screen[indices[t + 1]], screen[indices[t + 2]]);
+            }
+        }
+
+        //see depth_pyramid.comp
+        void build()
+        {
+            EA_ASSERT_MSG(!_depth.empty(), "call clear and rasterize before building the pyramid");
+
+            _levels.clear();
+
+            level level0 {};
+            level0.width = previous_pow2(_width);
+            level0.height = previous_pow2(_height);
+            reduce(_depth, _width, _height, level0);
+            _levels.push_back(level0);
+
+            uint32_t num_levels = static_cast<uint32_t>(std::floor(std::log2(std::max(level0.width, level0.height)))) + 1;
+            for( uint32_t i = 1; i < num_levels; ++i)
+            {
+                level& src = _levels[i - 1];
+                level dst {};
+                dst.width = std::max(src.width >> 1, 1u);
+                dst.height = std::max(src.height >> 1, 1u);
+                reduce(src.texels, src.width, src.height, dst);
+                _levels.push_back(dst);
+            }
+        }
+
+        //note: returns false if the box crosses the near plane, those boxes are never culled
+        static bool project(const aabb& box, const glm::mat4& view_proj, screen_rect& rect)
+        {
+            glm::vec3 ndc_min = glm::vec3(FLT_MAX);
+            glm::vec3 ndc_max = glm::vec3(-FLT_MAX);
+
+            for( uint32_t i = 0; i < 8; ++i)
+            {
+                glm::vec4 clip = view_proj * glm::vec4(get_corner(box, i), 1.0f);
+                if(clip.w <= 0.0f)
+                    return false;
+
+                glm::vec3 ndc = glm::vec3(clip) / clip.w;
+                ndc_min = glm::min(ndc_min, ndc);
+                ndc_max = glm::max(ndc_max, ndc);
+            }
+
+            rect.uv_min = glm::clamp(glm::vec2(ndc_min) * 0.5f + 0.5f, glm::vec2(0.0f), glm::vec2(1.0f));
+            rect.uv_max = glm::clamp(glm::vec2(ndc_max) * 0.5f + 0.5f, glm::vec2(0.0f), glm::vec2(1.0f));
+            rect.nearest = ndc_min.z;
+
+            return true;
+        }
+
+        //see occlusion_cull_late.comp
+        bool is_occluded(const aabb& box, const glm::mat4& view_proj)
+        {
+            EA_ASSERT_MSG(!_levels.empty(), "pyramid has not been built");
+
+            screen_rect rect {};
+            if(!project(box, view_proj, rect))
+                return false;
+
+            glm::vec2 size = (rect.uv_max - rect.uv_min) * glm::vec2(_levels[0].width, _levels[0].height);
+            float lod = std::ceil(std::log2(std::max(std::max(size.x, size.y), 1.0f)));
+            uint32_t level_id = std::min(static_cast<uint32_t>(lod), static_cast<uint32_t>(_levels.size() - 1));
+
+            float farthest = std::max(std::max(sample(level_id, rect.uv_min), sample(level_id, glm::vec2(rect.uv_max.x, rect.uv_min.y))),
+                                      std::max(sample(level_id, glm::vec2(rect.uv_min.x, rect.uv_max.y)), sample(level_id, rect.uv_max)));
+
+            return rect.nearest > farthest;
+        }
+
+        //same test against every pixel the box covers in the full resolution depth buffer
+        bool is_occluded_full_resolution(const aabb& box, const glm::mat4& view_proj)
+        {
+            screen_rect rect {};
+            if(!project(box, view_proj, rect))
+                return false;
+
+            uint32_t x_min = std::min(static_cast<uint32_t>(rect.uv_min.x * _width), _width - 1);
+            uint32_t y_min = std::min(static_cast<uint32_t>(rect.uv_min.y * _height), _height - 1);
+            uint32_t x_max = std::min(static_cast<uint32_t>(rect.uv_max.x * _width), _width - 1);
+            uint32_t y_max = std::min(static_cast<uint32_t>(rect.uv_max.y * _height), _height - 1);
+
+            for( uint32_t y = y_min; y <= y_max; ++y)
+            {
+                for( uint32_t x = x_min; x <= x_max; ++x)
+                {
+                    if(rect.nearest <= _depth[y * _width + x])
+                        return false;
+                }
+            }
+            return true;
+        }
+
+        //synthetic scene: a wall close to the camera with a grid of boxes behind it and around it.  Every box is tested against
+        //the pyramid and against the full resolution depth buffer.
+        static validation_result validate_synthetic_scene(uint32_t width = 1280, uint32_t height = 720)
+        {
+            glm::mat4 projection = glm::perspective(0.7f, static_cast<float>(width) / static_cast<float>(height), 0.1f, 500.0f);
+            projection[1][1] *= -1.0f;
+            glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 0.0f, 10.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+            glm::mat4 view_proj = projection * view;
+
+            hi_z_reference reference {};
+            reference.clear(width, height);
+
+            aabb wall {};
+            wall.expand(glm::vec3(-2.0f, -1.5f, 4.0f));
+            wall.expand(glm::vec3(2.0f, 1.5f, 4.5f));
+            reference.rasterize(wall, view_proj);
+            reference.build();
+
+            validation_result result {};
+            for( int z = 0; z < 4; ++z)
+            {
+                for( int y = -3; y <= 3; ++y)
+                {
+                    for( int x = -5; x <= 5; ++x)
+                    {
+                        aabb box {};
+                        glm::vec3 center = glm::vec3(x * 0.75f, y * 0.75f, -z * 2.0f);
+                        box.expand(center - glm::vec3(0.2f));
+                        box.expand(center + glm::vec3(0.2f));
+
+                        bool full_resolution = reference.is_occluded_full_resolution(box, view_proj);
+                        bool hi_z = reference.is_occluded(box, view_proj);
+
+                        ++result.tested;
+                        result.occluded_full_resolution += full_resolution ? 1 : 0;
+                        result.occluded_hi_z += hi_z ? 1 : 0;
+                        result.false_occlusions += (hi_z && !full_resolution) ? 1 : 0;
+                    }
+                }
+            }
+
+            return result;
+        }
+
+    private:
+
+        static glm::vec3 get_corner(const aabb& box, uint32_t i)
+        {
+            return glm::vec3((i & 1) ? box.max.x : box.min.x,
+                             (i & 2) ? box.max.y : box.min.y,
+                             (i & 4) ? box.max.z : box.min.z);
+        }
+
+        static uint32_t previous_pow2(uint32_t v)
+        {
+            uint32_t result = 1;
+            while( result * 2 <= v)
+                result *= 2;
+            return result;
+        }
+
+        static float edge(const glm::vec3& a, const glm::vec3& b, const glm::vec2& p)
+        {
+            return (b.x - a.x) * (p.y - a.y) - (b.y - a.y) * (p.x - a.x);
+        }
+
+        //note: ndc depth is affine in screen space, so interpolating it linearly with the screen space barycentrics is exact
+        void rasterize_triangle(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c)
+        {
+            float area = edge(a, b, c);
+            if(std::abs(area) < 1e-8f)
+                return;
+
+            int32_t x_min = std::max(static_cast<int32_t>(std::floor(std::min(a.x, std::min(b.x, c.x)))), 0);
+            int32_t y_min = std::max(static_cast<int32_t>(std::floor(std::min(a.y, std::min(b.y, c.y)))), 0);
+            int32_t x_max = std::min(static_cast<int32_t>(std::ceil(std::max(a.x, std::max(b.x, c.x)))), static_cast<int32_t>(_width) - 1);
+            int32_t y_max = std::min(static_cast<int32_t>(std::ceil(std::max(a.y, std::max(b.y, c.y)))), static_cast<int32_t>(_height) - 1);
+
+            for( int32_t y = y_min; y <= y_max; ++y)
+            {
+                for( int32_t x = x_min; x <= x_max; ++x)
+                {
+                    glm::vec2 p = glm::vec2(x + 0.5f, y + 0.5f);
+                    float w0 = edge(b, c, p) / area;
+                    float w1 = edge(c, a, p) / area;
+                    float w2 = edge(a, b, p) / area;
+
+                    if(w0 < 0.0f || w1 < 0.0f || w2 < 0.0f)
+                        continue;
+
+                    float z = w0 * a.z + w1 * b.z + w2 * c.z;
+                    float& d = _depth[y * _width + x];
+                    if(z >= 0.0f && z < d)
+                        d = z;
+                }
+            }
+        }
+
+        static void reduce(const eastl::vector<float>& src, uint32_t src_width, uint32_t src_height, level& dst)
+        {
+            dst.texels.assign(dst.width * dst.height, 0.0f);
+
+            float ratio_x = static_cast<float>(src_width) / static_cast<float>(dst.width);
+            float ratio_y = static_cast<float>(src_height) / static_cast<float>(dst.height);
+
+            for( uint32_t y = 0; y < dst.height; ++y)
+            {
+                for( uint32_t x = 0; x < dst.width; ++x)
+                {
+                    uint32_t x_min = static_cast<uint32_t>(std::floor(x * ratio_x));
+                    uint32_t y_min = static_cast<uint32_t>(std::floor(y * ratio_y));
+                    uint32_t x_max = std::min(static_cast<uint32_t>(std::ceil((x + 1) * ratio_x)) - 1, src_width - 1);
+                    uint32_t y_max = std::min(static_cast<uint32_t>(std::ceil((y + 1) * ratio_y)) - 1, src_height - 1);
+
+                    float farthest = src[y_min * src_width + x_min];
+                    for( uint32_t sy = y_min; sy <= y_max; ++sy)
+                    {
+                        for( uint32_t sx = x_min; sx <= x_max; ++sx)
+                        {
+                            farthest = std::max(farthest, src[sy * src_width + sx]);
+                        }
+                    }
+                    dst.texels[y * dst.width + x] = farthest;
+                }
+            }
+        }
+
+        //nearest filtering with clamp to edge, like the sampler of vk::storage_texture_2d
+        float sample(uint32_t level_id, const glm::vec2& uv)
+        {
+            level& l = _levels[level_id];
+            uint32_t x = std::min(static_cast<uint32_t>(std::max(uv.x, 0.0f) * l.width), l.width - 1);
+            uint32_t y = std::min(static_cast<uint32_t>(std::max(uv.y, 0.0f) * l.height), l.height - 1);
+            return l.texels[y * l.width + x];
+        }
+
+        uint32_t _width = 0;
+        uint32_t _height = 0;
+        eastl::vector<float> _depth {};
+        eastl::vector<level> _levels {};
+    };
+}
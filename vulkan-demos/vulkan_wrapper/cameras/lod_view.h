@@ -0,0 +1,129 @@
+//
+//  lod_view.h
+//  vulkan-demos
+//
+//  Created by Rafael Sabino on 10/19/26.
+//  Copyright © 2026 Rafael Sabino. All rights reserved.
+//
+
+#pragma once
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#define GLM_FORCE_SILENT_WARNINGS
+
+#include <glm/glm.hpp>
+#include "EAAssert/eaassert.h"
+#include "camera.h"
+#include "bounds.h"
+
+namespace vk
+{
+    //note: picks levels of detail for one point of view.  A level is good enough when its error, projected to the screen at the
+    //closest point of the object's bounds, covers fewer pixels than the threshold.  Passes that see the scene from the same place
+    //(a pass and the node that culls for it) must share a lod_view so that they agree on the level they draw.
+    //
+    //to keep levels from flickering back and forth, a finer level is taken as soon as the current one goes over the threshold but
+    //a coarser one only once it fits under HYSTERESIS * threshold.
+    class lod_view
+    {
+    public:
+
+        static constexpr uint32_t MAX_VIEWS = 8u;
+        static constexpr float HYSTERESIS = 0.75f;
+
+        //in pixels.  Shadow maps and voxel grids are blurred or coarse anyway and get away with more
+        static constexpr float DEFAULT_THRESHOLD = 1.0f;
+        static constexpr float SHADOW_THRESHOLD = 4.0f;
+        static constexpr float VOXEL_THRESHOLD = 2.0f;
+
+        //note: without a camera, levels are picked for the camera the graph is updated with
+        lod_view(float viewport_height, float threshold = DEFAULT_THRESHOLD):
+        _viewport_height(viewport_height), _threshold(threshold)
+        {
+            _id = next_id();
+        }
+
+        lod_view(camera& cam, float viewport_height, float threshold = DEFAULT_THRESHOLD):
+        _camera(&cam), _viewport_height(viewport_height), _threshold(threshold)
+        {
+            _id = next_id();
+        }
+
+        inline void set_threshold(float pixels){ _threshold = pixels; }
+        inline float get_threshold() const { return _threshold; }
+        inline void set_viewport_height(float pixels){ _viewport_height = pixels; }
+        inline uint32_t get_id() const { return _id; }
+
+        inline camera& get_camera(camera& graph_camera) const
+        {
+            return _camera != nullptr ? *_camera : graph_camera;
+        }
+
+        //pixels covered by one unit of object space error.  Works for perspective and orthographic projections, w in clip space
+        //is the view distance for the first and 1 for the second
+        float get_pixels_per_unit(const aabb& bounds, const glm::mat4& model, camera& cam) const
+        {
+            EA_ASSERT(bounds.is_valid());
+            const glm::mat4& projection = cam.get_projection_matrix();
+
+            aabb world = bounds.transform(model);
+            glm::vec4 view_center = cam.view_matrix * glm::vec4(world.get_center(), 1.0f);
+
+            glm::vec4 w_row = glm::vec4(projection[0][3], projection[1][3], projection[2][3], projection[3][3]);
+            float w = glm::dot(w_row, view_center);
+            if(projection[3][3] == 0.0f)
+                w = glm::max(w - world.get_radius(), MIN_DISTANCE);
+
+            float scale = glm::max(glm::max(glm::length(glm::vec3(model[0])), glm::length(glm::vec3(model[1]))), glm::length(glm::vec3(model[2])));
+            return scale * glm::abs(projection[1][1]) * .5f * _viewport_height / w;
+        }
+
+        //errors must grow with the level, current is what was picked last frame
+        uint32_t select(const float* errors, uint32_t num_levels, const aabb& bounds, const glm::mat4& model, camera& cam,
+                        uint32_t current) const
+        {
+            return select(errors, num_levels, get_pixels_per_unit(bounds, model, cam), current);
+        }
+        
+        //note: for objects drawn in many places at once (instances), pass the largest pixels per unit of all of them
+        uint32_t select(const float* errors, uint32_t num_levels, float pixels_per_unit, uint32_t current) const
+        {
+            EA_ASSERT(num_levels != 0);
+            current = glm::min(current, num_levels - 1);
+
+            uint32_t finest_needed = 0;
+            uint32_t relaxed = 0;
+            for( uint32_t l = 1; l < num_levels; ++l)
+            {
+                float pixels = errors[l] * pixels_per_unit;
+                if(pixels <= _threshold)
+                    finest_needed = l;
+                if(pixels <= _threshold * HYSTERESIS)
+                    relaxed = l;
+            }
+
+            //note: finest_needed is the coarsest level under the threshold, anything coarser than it is visibly off
+            if(finest_needed < current)
+                return finest_needed;
+
+            return glm::max(current, relaxed);
+        }
+
+    private:
+
+        static constexpr float MIN_DISTANCE = 1e-4f;
+
+        static uint32_t next_id()
+        {
+            static uint32_t count = 0;
+            EA_ASSERT_MSG(count < MAX_VIEWS, "too many lod views, increase MAX_VIEWS");
+            return count++;
+        }
+
+        camera*     _camera = nullptr;
+        float       _viewport_height = 0.0f;
+        float       _threshold = DEFAULT_THRESHOLD;
+        uint32_t    _id = 0;
+    };
+}
@@ -26,3 +26,11 @@ perspective_camera::perspective_camera(float fov, float aspect, float near, floa
     _focal_length = 1.0f/tanf(fov*.5f);
 }
 
+
+void perspective_camera::set_aspect_ratio(float aspect)
+{
+    _aspect = aspect;
+    _projection_matrix = glm::perspective(_fov, _aspect, _near, _far);
+    _projection_matrix[1][1] *= -1.0f;
+    _projection_matrix_has_changed = true;
+}
@@ -18,6 +18,9 @@ namespace vk
     public:
         perspective_camera(float fov = 0.7, float aspect = 1.0, float near = 0.1, float far = 500);
         
+        //note: when the window changes size
+        void set_aspect_ratio(float aspect);
+        
     private:
         
     };
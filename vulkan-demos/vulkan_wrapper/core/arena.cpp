@@ -0,0 +1,94 @@
+//
+//  arena.cpp
+//  vulkan-demos
+//
+//  Created by Rafael Sabino on 10/19/26.
+//  Copyright © 2026 Rafael Sabino. All rights reserved.
+//
+
+#include "arena.h"
+#include <new>
+
+using namespace vk;
+
+arena& arena::get_persistent()
+{
+    static arena persistent;
+    return persistent;
+}
+
+arena::chunk* arena::add_chunk(size_t bytes)
+{
+    size_t size = bytes > CHUNK_SIZE ? bytes : CHUNK_SIZE;
+    void* memory = ::operator new(sizeof(chunk) + size);
+
+    chunk* c = new (memory) chunk();
+    c->size = size;
+    c->next = _chunks;
+    _chunks = c;
+    _bytes_reserved += size;
+
+    return c;
+}
+
+void* arena::allocate(size_t bytes, size_t alignment)
+{
+    EA_ASSERT_MSG((alignment != 0) && ((alignment & (alignment - 1)) == 0), "alignment must be a power of 2");
+
+    chunk* c = _chunks;
+    uintptr_t address = 0;
+    for( int attempt = 0; attempt < 2; ++attempt)
+    {
+        if(c != nullptr)
+        {
+            uintptr_t start = reinterpret_cast<uintptr_t>(c + 1);
+            address = (start + c->used + alignment - 1) & ~(alignment - 1);
+            if(address + bytes <= start + c->size)
+            {
+                c->used = (address + bytes) - start;
+                break;
+            }
+        }
+        //note: the old chunk is not visited again, what is left in it is lost until reset
+        c = add_chunk(bytes + alignment);
+        address = 0;
+    }
+    EA_ASSERT(address != 0);
+
+    _last_allocation = reinterpret_cast<char*>(address);
+    _bytes_allocated += bytes;
+
+    return _last_allocation;
+}
+
+void arena::deallocate(void* p, size_t bytes)
+{
+    //note: containers that outlive a reset have nothing to give back
+    if(p == nullptr || _chunks == nullptr)
+        return;
+
+    _bytes_allocated -= bytes;
+
+    //note: only the last allocation can be given back, a temporary that is freed right away costs nothing
+    if(p == _last_allocation)
+    {
+        uintptr_t start = reinterpret_cast<uintptr_t>(_chunks + 1);
+        _chunks->used = reinterpret_cast<uintptr_t>(p) - start;
+        _last_allocation = nullptr;
+    }
+}
+
+void arena::reset()
+{
+    while(_chunks != nullptr)
+    {
+        chunk* next = _chunks->next;
+        _chunks->~chunk();
+        ::operator delete(static_cast<void*>(_chunks));
+        _chunks = next;
+    }
+
+    _last_allocation = nullptr;
+    _bytes_allocated = 0;
+    _bytes_reserved = 0;
+}
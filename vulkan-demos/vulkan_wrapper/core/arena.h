@@ -0,0 +1,101 @@
+//
+//  arena.h
+//  vulkan-demos
+//
+//  Created by Rafael Sabino on 10/19/26.
+//  Copyright © 2026 Rafael Sabino. All rights reserved.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "EAAssert/eaassert.h"
+
+namespace vk
+{
+    //note: bump allocator for memory that lives as long as the scene, i.e. the objects, meshes and parameters passes are built
+    //with.  Memory is handed out of big chunks and is only given back all at once with reset, the last allocation is the exception.
+    //Containers that grow leave their old storage behind, it is bounded by what they end up using.  Scenes are built on the main
+    //thread, this is not thread safe
+    class arena
+    {
+    public:
+
+        static constexpr size_t CHUNK_SIZE = 1024u * 1024u;
+        static constexpr size_t DEFAULT_ALIGNMENT = 16u;
+
+        arena(){}
+        ~arena(){ reset(); }
+
+        arena & operator=(const arena&) = delete;
+        arena(const arena&) = delete;
+
+        void* allocate(size_t bytes, size_t alignment = DEFAULT_ALIGNMENT);
+        void deallocate(void* p, size_t bytes);
+
+        //frees every chunk, nothing allocated from this arena can be used after this call
+        void reset();
+
+        inline size_t get_bytes_allocated(){ return _bytes_allocated; }
+        inline size_t get_bytes_reserved(){ return _bytes_reserved; }
+
+        //note: the arena the containers of the render graph grow into, see arena_allocator
+        static arena& get_persistent();
+
+    private:
+
+        struct chunk
+        {
+            chunk*  next = nullptr;
+            size_t  size = 0;
+            size_t  used = 0;
+        };
+
+        chunk* add_chunk(size_t bytes);
+
+        chunk*  _chunks = nullptr;
+        char*   _last_allocation = nullptr;
+        size_t  _bytes_allocated = 0;
+        size_t  _bytes_reserved = 0;
+    };
+
+    //note: eastl allocator on top of the persistent arena.  It is meant as the overflow allocator of fixed containers, they keep
+    //their usual capacity inline and grow into the arena instead of asserting when a scene is bigger than that
+    class arena_allocator
+    {
+    public:
+
+        arena_allocator(const char* name = "vk arena"){ _name = name; }
+        arena_allocator(const arena_allocator& x){ _name = x._name; }
+        arena_allocator(const arena_allocator& x, const char* name){ _name = name; }
+
+        arena_allocator& operator=(const arena_allocator& x){ _name = x._name; return *this; }
+
+        inline void* allocate(size_t n, int /*flags*/ = 0)
+        {
+            return arena::get_persistent().allocate(n);
+        }
+
+        inline void* allocate(size_t n, size_t alignment, size_t offset, int /*flags*/ = 0)
+        {
+            EA_ASSERT_MSG(offset == 0, "the arena does not support aligned allocations with an offset");
+            return arena::get_persistent().allocate(n, alignment < arena::DEFAULT_ALIGNMENT ? arena::DEFAULT_ALIGNMENT : alignment);
+        }
+
+        inline void deallocate(void* p, size_t n)
+        {
+            arena::get_persistent().deallocate(p, n);
+        }
+
+        inline const char* get_name() const { return _name; }
+        inline void set_name(const char* name){ _name = name; }
+
+    private:
+
+        const char* _name = nullptr;
+    };
+
+    inline bool operator==(const arena_allocator&, const arena_allocator&){ return true; }
+    inline bool operator!=(const arena_allocator&, const arena_allocator&){ return false; }
+}
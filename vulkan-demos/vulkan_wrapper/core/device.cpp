@@ -12,6 +12,7 @@
 #include "EASTL/array.h"
 #include <set>
 #include <string>
+#include <cstring>
 #include <iostream>
 #include <fstream>
 #include <vulkan/vulkan.h>
@@ -19,6 +20,14 @@
 
 #include "device.h"
 #include "EAAssert/eaassert.h"
+#include "geometry_pool.h"
+#include "instance_pool.h"
+#include "transform_hierarchy.h"
+#include "asset_loader.h"
+#include "texture_streamer.h"
+#include "mip_generator.h"
+#include "texture_cache.h"
+#include "job_system.h"
 
 #if __APPLE__ && DEBUG
 #include <MoltenVK/vk_mvk_moltenvk.h>
@@ -32,6 +41,9 @@
 
 using namespace vk;
 
+bool device::_async_compute_enabled = true;
+bool device::_present_wait_enabled = true;
+bool device::_headless_surface_enabled = false;
 
 //this function is meant to be private and not accessible to anybody outside of this file
 VKAPI_ATTR VkBool32 VKAPI_CALL debug_report_callback(
@@ -87,6 +99,8 @@ void device::create_logical_device( VkSurfaceKHR surface)
 
     eastl::fixed_vector<VkDeviceQueueCreateInfo,20, true> queue_create_infos {};
     std::set<uint32_t> unique_queue_families = {_queue_family_indices.graphics_family.value(), _queue_family_indices.present_family.value()};
+    if(_queue_family_indices.async_compute_family.has_value())
+        unique_queue_families.insert(_queue_family_indices.async_compute_family.value());
 
     float queue_priority = 1.0f;
     for (uint32_t queueFamily : unique_queue_families) {
@@ -108,6 +122,13 @@ void device::create_logical_device( VkSurfaceKHR surface)
     device_features.independentBlend = VK_TRUE;
     device_features.sampleRateShading = VK_TRUE;
     
+    VkPhysicalDeviceFeatures supported_features {};
+    vkGetPhysicalDeviceFeatures(_physical_device, &supported_features);
+    _draw_indirect_first_instance = supported_features.drawIndirectFirstInstance == VK_TRUE;
+    device_features.drawIndirectFirstInstance = supported_features.drawIndirectFirstInstance;
+    _multi_draw_indirect = supported_features.multiDrawIndirect == VK_TRUE;
+    device_features.multiDrawIndirect = supported_features.multiDrawIndirect;
+    
     VkPhysicalDeviceFeatures2 device_features_2 = {};
     
     features_ext.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FRAGMENT_SHADER_INTERLOCK_FEATURES_EXT;
@@ -119,6 +140,42 @@ void device::create_logical_device( VkSurfaceKHR surface)
     device_features_2.pNext = &features_ext;
     device_features_2.features = device_features;
     
+    eastl::fixed_vector<const char*, 20, true> extensions(device::device_extensions.begin(), device::device_extensions.end());
+    
+#if defined(VK_KHR_present_wait) && defined(VK_KHR_present_id)
+    //note: both features have to be there, the instance is 1.0 so the query goes through the function pointer when the
+    //loader has it
+    VkPhysicalDevicePresentIdFeaturesKHR present_id_features {};
+    present_id_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+    VkPhysicalDevicePresentWaitFeaturesKHR present_wait_features {};
+    present_wait_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+    
+    PFN_vkGetPhysicalDeviceFeatures2 get_features_2 = reinterpret_cast<PFN_vkGetPhysicalDeviceFeatures2>(
+        vkGetInstanceProcAddr(_instance, "vkGetPhysicalDeviceFeatures2"));
+    
+    if(_present_wait_enabled && get_features_2 != nullptr &&
+       is_device_extension_available(VK_KHR_PRESENT_ID_EXTENSION_NAME) && is_device_extension_available(VK_KHR_PRESENT_WAIT_EXTENSION_NAME))
+    {
+        present_id_features.pNext = &present_wait_features;
+        VkPhysicalDeviceFeatures2 supported {};
+        supported.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        supported.pNext = &present_id_features;
+        get_features_2(_physical_device, &supported);
+        
+        _present_wait = present_id_features.presentId == VK_TRUE && present_wait_features.presentWait == VK_TRUE;
+        if(_present_wait)
+        {
+            present_wait_features.pNext = features_ext.pNext;
+            features_ext.pNext = &present_id_features;
+            extensions.push_back(VK_KHR_PRESENT_ID_EXTENSION_NAME);
+            extensions.push_back(VK_KHR_PRESENT_WAIT_EXTENSION_NAME);
+        }
+    }
+#endif
+    
+    bool draw_indirect_count = is_device_extension_available(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+    if(draw_indirect_count)
+        extensions.push_back(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
 
     
 
@@ -137,8 +194,8 @@ void device::create_logical_device( VkSurfaceKHR surface)
 
     create_info.pEnabledFeatures = nullptr;
 
-    create_info.enabledExtensionCount = static_cast<uint32_t>(device::device_extensions.size());
-    create_info.ppEnabledExtensionNames = device::device_extensions.data();
+    create_info.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
+    create_info.ppEnabledExtensionNames = extensions.data();
 
     if (device::enable_validation_layers)
     {
@@ -156,6 +213,12 @@ void device::create_logical_device( VkSurfaceKHR surface)
         throw std::runtime_error("failed to create logical device!");
     }
     
+    if(draw_indirect_count)
+    {
+        _draw_indexed_indirect_count = reinterpret_cast<PFN_vkCmdDrawIndexedIndirectCountKHR>(
+            vkGetDeviceProcAddr(_logical_device, "vkCmdDrawIndexedIndirectCountKHR"));
+    }
+    
     vkGetDeviceQueue(_logical_device, _queue_family_indices.graphics_family.value(), 0, &_graphics_queue);
     vkGetDeviceQueue(_logical_device, _queue_family_indices.present_family.value(), 0, &_present_queue);
     vkGetDeviceQueue(_logical_device, _queue_family_indices.compute_family.value(), 0, &_compute_queue);
@@ -177,6 +240,21 @@ void device::create_logical_device( VkSurfaceKHR surface)
     {
         create_command_pool(_queue_family_indices.compute_family.value(), &_compute_command_pool);
     }
+    
+    if(_queue_family_indices.async_compute_family.has_value())
+    {
+        vkGetDeviceQueue(_logical_device, _queue_family_indices.async_compute_family.value(), 0, &_async_compute_queue);
+        create_command_pool(_queue_family_indices.async_compute_family.value(), &_async_compute_command_pool);
+    }
+    
+    _geometry_pool = new geometry_pool(this);
+    _instance_pool = new instance_pool(this);
+    _transform_hierarchy = new transform_hierarchy();
+    _asset_loader = new asset_loader(this);
+    _texture_streamer = new texture_streamer(this);
+    _mip_generator = new mip_generator(this);
+    _texture_cache = new texture_cache(this);
+    _job_system = new job_system();
 }
 
 device::queue_family_indices device::find_queue_families( VkPhysicalDevice device, VkSurfaceKHR surface) {
@@ -216,6 +294,18 @@ device::queue_family_indices device::find_queue_families( VkPhysicalDevice devic
         i++;
     }
     
+    //note: the loop above stops as soon as it has what it needs, the families after it are looked at here
+    for( uint32_t family = 0; family < queue_family_count; ++family)
+    {
+        const VkQueueFamilyProperties& queue_family = queue_families[family];
+        if(queue_family.queueCount > 0 && (queue_family.queueFlags & VK_QUEUE_COMPUTE_BIT) &&
+           !(queue_family.queueFlags & VK_QUEUE_GRAPHICS_BIT))
+        {
+            indices.async_compute_family = family;
+            break;
+        }
+    }
+    
     return indices;
 }
 
@@ -238,6 +328,22 @@ bool device::check_device_extension_support(VkPhysicalDevice device)
     return requiredExtensions.empty();
 }
 
+bool device::is_device_extension_available(const char* name)
+{
+    uint32_t count = 0;
+    vkEnumerateDeviceExtensionProperties(_physical_device, nullptr, &count, nullptr);
+    
+    eastl::fixed_vector<VkExtensionProperties, 20, true> available(count);
+    vkEnumerateDeviceExtensionProperties(_physical_device, nullptr, &count, available.data());
+    
+    for (const VkExtensionProperties& extension : available)
+    {
+        if(strcmp(extension.extensionName, name) == 0)
+            return true;
+    }
+    return false;
+}
+
 void device::query_swapchain_support( VkPhysicalDevice device, VkSurfaceKHR surface, device::swapchain_support_details& details)
 {
     
@@ -327,15 +433,33 @@ void device::create_instance()
 
     auto glfw_extensions = glfwGetRequiredInstanceExtensions(&glfw_extensions_count);
     
+    uint32_t instance_extension_count = 0;
+    eastl::array<VkExtensionProperties, 100> vk_props = {};
+    vkEnumerateInstanceExtensionProperties(NULL, &instance_extension_count, NULL);
+    if(instance_extension_count > vk_props.size())
+        instance_extension_count = static_cast<uint32_t>(vk_props.size());
+    vkEnumerateInstanceExtensionProperties(NULL, &instance_extension_count, vk_props.data());
+    
+    _headless_surface = false;
+    for( uint32_t e = 0; e < instance_extension_count && _headless_surface_enabled; ++e)
+    {
+        _headless_surface = _headless_surface || strcmp(vk_props[e].extensionName, VK_EXT_HEADLESS_SURFACE_EXTENSION_NAME) == 0;
+    }
+    
     eastl::array<const char*, 10> all_required_extensions {};
     //all_required_extensions[0] = "VK_EXT_debug_report";
     
-    EA_ASSERT(all_required_extensions.size() > (glfw_extensions_count + 1));
+    EA_ASSERT(all_required_extensions.size() > (glfw_extensions_count + 3));
     int i = 0;
     for( ; i < glfw_extensions_count; ++i)
     {
         all_required_extensions[i] = glfw_extensions[i];
     }
+    //note: glfw lists no extensions when it could not start, i.e. on a machine without a display
+    if(_headless_surface && glfw_extensions_count == 0)
+        all_required_extensions[i++] = VK_KHR_SURFACE_EXTENSION_NAME;
+    if(_headless_surface)
+        all_required_extensions[i++] = VK_EXT_HEADLESS_SURFACE_EXTENSION_NAME;
     //NOTE: Keep in mind that the order in which you load extensions matters, careful in loading something too early
     all_required_extensions[i] = "VK_EXT_debug_report";
     all_required_extensions[++i] = "VK_KHR_get_physical_device_properties2";
@@ -368,10 +492,6 @@ void device::create_instance()
         }
     }
     
-    uint32_t instance_extension_count = 0;
-    eastl::array<VkExtensionProperties, 100> vk_props = {};
-    vkEnumerateInstanceExtensionProperties(NULL, &instance_extension_count, NULL);
-    vkEnumerateInstanceExtensionProperties(NULL, &instance_extension_count, vk_props.data());
     std::cout << std::endl;
     std::cout << instance_extension_count << " instance extensions have been found " << std::endl;
     for (uint32_t i = 0; i < instance_extension_count; i++) {
@@ -402,6 +522,23 @@ void device::create_instance()
     ASSERT_VULKAN(result);
 }
 
+VkSurfaceKHR device::create_headless_surface()
+{
+    VkSurfaceKHR surface = VK_NULL_HANDLE;
+    if(!_headless_surface)
+        return surface;
+    
+    PFN_vkCreateHeadlessSurfaceEXT vkCreateHeadlessSurfaceEXT =
+        reinterpret_cast<PFN_vkCreateHeadlessSurfaceEXT>(vkGetInstanceProcAddr(_instance, "vkCreateHeadlessSurfaceEXT"));
+    EA_ASSERT(vkCreateHeadlessSurfaceEXT != nullptr);
+    
+    VkHeadlessSurfaceCreateInfoEXT create_info {};
+    create_info.sType = VK_STRUCTURE_TYPE_HEADLESS_SURFACE_CREATE_INFO_EXT;
+    VkResult result = vkCreateHeadlessSurfaceEXT(_instance, &create_info, nullptr, &surface);
+    ASSERT_VULKAN(result);
+    return surface;
+}
+
 //vulkan renderer
 void device::print_instance_layers()
 {
@@ -639,7 +776,64 @@ void device::destroy()
             (vkGetInstanceProcAddr(_instance, "vkDestroyDebugReportCallbackEXT"));
     
     vkDestroyDebugReportCallbackEXT(_instance, _callback, nullptr);
+    
+    if(_asset_loader != nullptr)
+    {
+        _asset_loader->destroy();
+        delete _asset_loader;
+        _asset_loader = nullptr;
+    }
+    
+    if(_texture_streamer != nullptr)
+    {
+        _texture_streamer->destroy();
+        delete _texture_streamer;
+        _texture_streamer = nullptr;
+    }
+    
+    if(_mip_generator != nullptr)
+    {
+        _mip_generator->destroy();
+        delete _mip_generator;
+        _mip_generator = nullptr;
+    }
+    
+    if(_texture_cache != nullptr)
+    {
+        _texture_cache->destroy();
+        delete _texture_cache;
+        _texture_cache = nullptr;
+    }
+    
+    if(_job_system != nullptr)
+    {
+        _job_system->destroy();
+        delete _job_system;
+        _job_system = nullptr;
+    }
+    
+    if(_geometry_pool != nullptr)
+    {
+        _geometry_pool->destroy();
+        delete _geometry_pool;
+        _geometry_pool = nullptr;
+    }
+    
+    if(_instance_pool != nullptr)
+    {
+        _instance_pool->destroy();
+        delete _instance_pool;
+        _instance_pool = nullptr;
+    }
+    
+    delete _transform_hierarchy;
+    _transform_hierarchy = nullptr;
+    
     vkDestroyCommandPool(_logical_device, _graphics_command_pool, nullptr);
+    if(_async_compute_command_pool != VK_NULL_HANDLE)
+        vkDestroyCommandPool(_logical_device, _async_compute_command_pool, nullptr);
+    _async_compute_command_pool = VK_NULL_HANDLE;
+    _async_compute_queue = VK_NULL_HANDLE;
     
     vkDestroyDevice(_logical_device, nullptr);
     vkDestroyInstance(_instance, nullptr);
@@ -649,14 +843,13 @@ void device::destroy()
 }
 
 
-void device::copy_buffer( VkCommandPool commandPool, VkQueue queue, VkBuffer src, VkBuffer dest, VkDeviceSize size)
+void device::copy_buffer( VkCommandPool commandPool, VkQueue queue, VkBuffer src, VkBuffer dest, VkDeviceSize size, VkDeviceSize dest_offset)
 {
     
     VkCommandBuffer commandBuffer = start_single_time_command_buffer( commandPool);
     
     VkBufferCopy bufferCopy = {};
-    bufferCopy.dstOffset = 0;
-    bufferCopy.srcOffset = 0;
+    bufferCopy.dstOffset = dest_offset;
     bufferCopy.srcOffset = 0;
     bufferCopy.size = size;
     vkCmdCopyBuffer(commandBuffer, src, dest, 1, &bufferCopy);
@@ -665,6 +858,54 @@ void device::copy_buffer( VkCommandPool commandPool, VkQueue queue, VkBuffer src
     
 }
 
+geometry_pool& device::get_geometry_pool()
+{
+    EA_ASSERT_MSG(_geometry_pool != nullptr, "the geometry pool is created along with the logical device");
+    return *_geometry_pool;
+}
+
+instance_pool& device::get_instance_pool()
+{
+    EA_ASSERT_MSG(_instance_pool != nullptr, "the instance pool is created along with the logical device");
+    return *_instance_pool;
+}
+
+transform_hierarchy& device::get_transform_hierarchy()
+{
+    EA_ASSERT_MSG(_transform_hierarchy != nullptr, "the transform hierarchy is created along with the logical device");
+    return *_transform_hierarchy;
+}
+
+asset_loader& device::get_asset_loader()
+{
+    EA_ASSERT_MSG(_asset_loader != nullptr, "the asset loader is created along with the logical device");
+    return *_asset_loader;
+}
+
+texture_streamer& device::get_texture_streamer()
+{
+    EA_ASSERT_MSG(_texture_streamer != nullptr, "the texture streamer is created along with the logical device");
+    return *_texture_streamer;
+}
+
+mip_generator& device::get_mip_generator()
+{
+    EA_ASSERT_MSG(_mip_generator != nullptr, "the mip generator is created along with the logical device");
+    return *_mip_generator;
+}
+
+texture_cache& device::get_texture_cache()
+{
+    EA_ASSERT_MSG(_texture_cache != nullptr, "the texture cache is created along with the logical device");
+    return *_texture_cache;
+}
+
+job_system& device::get_job_system()
+{
+    EA_ASSERT_MSG(_job_system != nullptr, "the job system is created along with the logical device");
+    return *_job_system;
+}
+
 device::~device()
 {
     
@@ -24,6 +24,15 @@ else{\
 
 namespace vk {
     
+    class geometry_pool;
+    class instance_pool;
+    class transform_hierarchy;
+    class asset_loader;
+    class texture_streamer;
+    class mip_generator;
+    class texture_cache;
+    class job_system;
+    
     class device : public object
     {
     public:
@@ -32,6 +41,9 @@ namespace vk {
             eastl::optional<uint32_t> graphics_family;
             eastl::optional<uint32_t> present_family;
             eastl::optional<uint32_t> compute_family;
+            //note: a family with compute and without graphics, its queue runs compute work next to the graphics queue.  Not
+            //every device has one, see has_async_compute
+            eastl::optional<uint32_t> async_compute_family;
             
             bool is_complete() {
                 return graphics_family.has_value() && present_family.has_value() && compute_family.has_value();
@@ -80,11 +92,64 @@ namespace vk {
         VkCommandBuffer start_single_time_command_buffer( VkCommandPool commandPool);
         void end_single_time_command_buffer(VkQueue queue, VkCommandPool commandPool, VkCommandBuffer commandBuffer);
         
-        void copy_buffer( VkCommandPool commandPool, VkQueue queue, VkBuffer src, VkBuffer dest, VkDeviceSize size);
+        void copy_buffer( VkCommandPool commandPool, VkQueue queue, VkBuffer src, VkBuffer dest, VkDeviceSize size, VkDeviceSize dest_offset = 0);
         void create_command_pool(uint32_t queueIndex, VkCommandPool* pool);
         void wait_for_all_operations_to_finish();
+        
+        //note: false runs every compute node on the graphics queue, like it used to, even when the device has a queue for
+        //compute alone.  See command_recorder::begin_node
+        static void set_async_compute_enabled(bool enabled){ _async_compute_enabled = enabled; }
+        inline bool has_async_compute() const { return _async_compute_enabled && _async_compute_queue != VK_NULL_HANDLE; }
+        
+        //note: VK_KHR_present_id and VK_KHR_present_wait are turned on when the device has both and the vulkan headers know them.
+        //They tell when a frame was shown, see frame_pacer.h.  Call before create_logical_device
+        static void set_present_wait_enabled(bool enabled){ _present_wait_enabled = enabled; }
+        inline bool has_present_wait() const { return _present_wait; }
+        
+        //note: VK_EXT_headless_surface is turned on when the instance has it, surfaces made with create_headless_surface need no
+        //window and are never shown.  The golden images are rendered through one, see run_golden_tests in main.mm.  Call before
+        //the device is made
+        static void set_headless_surface_enabled(bool enabled){ _headless_surface_enabled = enabled; }
+        inline bool has_headless_surface() const { return _headless_surface; }
+        //note: VK_NULL_HANDLE if the instance does not have the extension
+        VkSurfaceKHR create_headless_surface();
+        
+        //note: indirect draws may only start past instance 0 with drawIndirectFirstInstance.  Without it every draw starts at
+        //instance 0 and the shaders add the first instance of the range, see graphics_node::set_mesh_param
+        inline bool has_draw_indirect_first_instance() const { return _draw_indirect_first_instance; }
+        
+        //note: VK_KHR_draw_indirect_count is turned on when the device has it, culled draws are then compacted on the gpu and
+        //drawn with the count the culling shader wrote, see indirect_draws.h.  Without it a range of draws goes out in one
+        //vkCmdDrawIndexedIndirect when the device has multiDrawIndirect, one draw at a time when it does not
+        inline bool has_draw_indirect_count() const { return _draw_indexed_indirect_count != nullptr; }
+        inline bool has_multi_draw_indirect() const { return _multi_draw_indirect; }
+        inline PFN_vkCmdDrawIndexedIndirectCountKHR get_draw_indexed_indirect_count() const { return _draw_indexed_indirect_count; }
         VkPhysicalDeviceProperties get_properties() { return _properties; }
         
+        //note: vertex and index memory shared by every mesh, see geometry_pool.h
+        geometry_pool& get_geometry_pool();
+        
+        //note: per instance transforms shared by every pass, see instance_pool.h
+        instance_pool& get_instance_pool();
+        
+        //note: world matrices of every mesh node, see transform_hierarchy.h
+        transform_hierarchy& get_transform_hierarchy();
+        
+        //note: decodes images on worker threads and uploads them between frames, see asset_loader.h
+        asset_loader& get_asset_loader();
+        
+        //note: keeps the mip levels textures need on the gpu and nothing more, see texture_streamer.h
+        texture_streamer& get_texture_streamer();
+        
+        //note: builds mip chains with compute instead of blits, see mip_generator.h
+        mip_generator& get_mip_generator();
+        
+        //note: samplers and loaded textures shared by everything that asks for the same one, see texture_cache.h
+        texture_cache& get_texture_cache();
+        
+        //note: runs the cpu work of a frame on several threads, see job_system.h
+        job_system& get_job_system();
+        
         virtual void destroy() override;
         device();
         ~device();
@@ -95,12 +160,34 @@ namespace vk {
         VkQueue             _graphics_queue = VK_NULL_HANDLE;
         VkQueue             _present_queue = VK_NULL_HANDLE;
         VkQueue             _compute_queue = VK_NULL_HANDLE;
+        VkQueue             _async_compute_queue = VK_NULL_HANDLE;
         VkCommandPool       _graphics_command_pool = VK_NULL_HANDLE;
         VkCommandPool       _present_command_pool = VK_NULL_HANDLE;
         VkCommandPool       _compute_command_pool = VK_NULL_HANDLE;
+        VkCommandPool       _async_compute_command_pool = VK_NULL_HANDLE;
         VkPhysicalDeviceProperties _properties {};
         device::queue_family_indices _queue_family_indices;
         VkDebugReportCallbackEXT _callback {};
     private:
+        static bool _async_compute_enabled;
+        static bool _present_wait_enabled;
+        static bool _headless_surface_enabled;
+        
+        bool is_device_extension_available(const char* name);
+        
+        bool                _present_wait = false;
+        bool                _headless_surface = false;
+        bool                _draw_indirect_first_instance = false;
+        bool                _multi_draw_indirect = false;
+        PFN_vkCmdDrawIndexedIndirectCountKHR _draw_indexed_indirect_count = nullptr;
+        
+        geometry_pool*      _geometry_pool = nullptr;
+        instance_pool*      _instance_pool = nullptr;
+        transform_hierarchy* _transform_hierarchy = nullptr;
+        asset_loader*       _asset_loader = nullptr;
+        texture_streamer*   _texture_streamer = nullptr;
+        mip_generator*      _mip_generator = nullptr;
+        texture_cache*      _texture_cache = nullptr;
+        job_system*         _job_system = nullptr;
     };
 }
@@ -0,0 +1,59 @@
+//
+//  dynamic_resolution.cpp
+//  vulkan-demos
+//
+//  Created by Rafael Sabino on 10/19/26.
+//  Copyright © 2026 Rafael Sabino. All rights reserved.
+//
+
+#include "dynamic_resolution.h"
+#include <cmath>
+#include "EASTL/algorithm.h"
+#include "EAAssert/eaassert.h"
+#include "glfw_swapchain.h"
+
+using namespace vk;
+
+namespace
+{
+    //note: the time of the first frame drawn at a new scale is read this many frames after the change
+    constexpr uint32_t SETTLE_FRAMES = glfw_swapchain::NUM_SWAPCHAIN_IMAGES + 1;
+}
+
+float dynamic_resolution::update(double gpu_milliseconds)
+{
+    EA_ASSERT_MSG(_min_scale > 0.0f && _min_scale <= 1.0f, "the smallest render scale has to be in (0, 1]");
+    if(_target <= 0.0 || gpu_milliseconds <= 0.0)
+        return _scale;
+
+    ++_num_measured;
+    if(gpu_milliseconds > _target)
+        ++_num_over_target;
+
+    _average = _average == 0.0 ? gpu_milliseconds : _average + (gpu_milliseconds - _average) * SMOOTHING;
+
+    if(_settle != 0)
+    {
+        --_settle;
+        return _scale;
+    }
+
+    if(std::abs(_average - _target) <= _target * HYSTERESIS)
+        return _scale;
+
+    //note: rounds down either way, a scale that is a little small costs less than one that misses the target
+    double wanted = _scale * std::sqrt(_target * HEADROOM / _average);
+    float scale = std::floor(static_cast<float>(wanted) / STEP + 0.001f) * STEP;
+    scale = eastl::min(eastl::max(scale, _min_scale), 1.0f);
+
+    if(std::abs(scale - _scale) < STEP * 0.5f)
+        return _scale;
+
+    //note: guess what the frames at the new scale cost so the average does not drag the old ones along
+    _average *= static_cast<double>(scale * scale) / static_cast<double>(_scale * _scale);
+    _scale = scale;
+    _settle = SETTLE_FRAMES;
+    ++_num_changes;
+
+    return _scale;
+}
@@ -0,0 +1,67 @@
+//
+//  dynamic_resolution.h
+//  vulkan-demos
+//
+//  Created by Rafael Sabino on 10/19/26.
+//  Copyright © 2026 Rafael Sabino. All rights reserved.
+//
+
+#pragma once
+
+#include <cstdint>
+
+namespace vk
+{
+    //note: picks the render scale (see graph::set_render_scale) that keeps the gpu time of a frame under a target.  The time
+    //is read from the timestamps of the submissions, see command_recorder::get_gpu_time, it is 0 while the profiler is off and
+    //the scale stays where it is then.
+    //
+    //the cost of the passes that scale goes with the pixels they draw, the square of the scale, so a change aims for the scale
+    //that should land a little under the target.  Times are averaged, a frame has to be off the target by more than HYSTERESIS
+    //before the scale moves, and scales are multiples of STEP so command buffers are not recorded again for small changes.  A
+    //frame the gpu finished is NUM_SWAPCHAIN_IMAGES frames old by the time its time is read, after a change the scale waits
+    //for frames drawn at it
+    class dynamic_resolution
+    {
+    public:
+
+        static constexpr float STEP = 0.05f;
+        static constexpr float DEFAULT_MIN_SCALE = 0.5f;
+        //note: fraction of the target the average has to be off by
+        static constexpr double HYSTERESIS = 0.1;
+        //note: weight of a new time in the average
+        static constexpr double SMOOTHING = 0.2;
+        //note: a change aims this far under the target
+        static constexpr double HEADROOM = 0.95;
+
+        dynamic_resolution(){}
+        dynamic_resolution(double target_milliseconds, float min_scale = DEFAULT_MIN_SCALE):
+        _target(target_milliseconds), _min_scale(min_scale)
+        {}
+
+        //main thread only: gpu_milliseconds is the time of the last frame that finished, 0 if it is not known.  Returns the scale
+        //the next frame renders at
+        float update(double gpu_milliseconds);
+
+        inline float get_scale() const { return _scale; }
+        inline double get_target() const { return _target; }
+        inline double get_average() const { return _average; }
+
+        //note: frames with a known time and how many of them went over the target
+        inline uint64_t get_num_measured() const { return _num_measured; }
+        inline uint64_t get_num_over_target() const { return _num_over_target; }
+        inline uint32_t get_num_changes() const { return _num_changes; }
+
+    private:
+
+        double   _target = 0.0;
+        float    _min_scale = DEFAULT_MIN_SCALE;
+        float    _scale = 1.0f;
+        double   _average = 0.0;
+        uint32_t _settle = 0;
+
+        uint64_t _num_measured = 0;
+        uint64_t _num_over_target = 0;
+        uint32_t _num_changes = 0;
+    };
+}
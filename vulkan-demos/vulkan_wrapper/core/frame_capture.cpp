@@ -0,0 +1,246 @@
+//
+//  frame_capture.cpp
+//  vulkan-demos
+//
+//  Created by Rafael Sabino on 10/19/26.
+//  Copyright © 2026 Rafael Sabino. All rights reserved.
+//
+
+#include "frame_capture.h"
+#include "stb_image.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace vk;
+
+void frame_capture::record(VkCommandBuffer command_buffer, uint32_t image_id)
+{
+    EA_ASSERT_MSG(_requested, "nothing was requested to be captured");
+    EA_ASSERT(_swapchain != nullptr);
+
+    VkExtent2D extent = _swapchain->get_vk_swap_extent();
+    VkImage image = _swapchain->present_textures[image_id].get_image();
+    _format = _swapchain->get_vk_surface_format().format;
+    _width = extent.width;
+    _height = extent.height;
+
+    VkDeviceSize size = VkDeviceSize(_width) * _height * 4u;
+    if(size > _size)
+    {
+        destroy();
+        create_buffer(_device->_logical_device, _device->_physical_device, size, VK_BUFFER_USAGE_TRANSFER_DST_BIT, _buffer,
+                      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, _memory);
+        _size = size;
+    }
+
+    VkImageMemoryBarrier barrier {};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = image;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.layerCount = 1;
+    vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+                         0, nullptr, 0, nullptr, 1, &barrier);
+
+    VkBufferImageCopy region {};
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.layerCount = 1;
+    region.imageExtent = { _width, _height, 1u };
+    vkCmdCopyImageToBuffer(command_buffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, _buffer, 1, &region);
+
+    //note: presenting waits on the semaphore of the submission, it needs no access mask
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    barrier.dstAccessMask = 0;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0,
+                         0, nullptr, 0, nullptr, 1, &barrier);
+
+    VkBufferMemoryBarrier host_barrier {};
+    host_barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    host_barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    host_barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    host_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    host_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    host_barrier.buffer = _buffer;
+    host_barrier.size = VK_WHOLE_SIZE;
+    vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0,
+                         0, nullptr, 1, &host_barrier, 0, nullptr);
+
+    _requested = false;
+    _captured = true;
+}
+
+bool frame_capture::read(eastl::vector<uint8_t>& rgb)
+{
+    if(!_captured)
+        return false;
+
+    uint32_t r = 0;
+    uint32_t b = 2;
+    switch(_format)
+    {
+        case VK_FORMAT_B8G8R8A8_UNORM:
+        case VK_FORMAT_B8G8R8A8_SRGB:
+            r = 2;
+            b = 0;
+            break;
+        case VK_FORMAT_R8G8B8A8_UNORM:
+        case VK_FORMAT_R8G8B8A8_SRGB:
+            break;
+        default:
+            EA_FAIL_MSG("the swapchain format can't be captured, add it here");
+            return false;
+    }
+
+    void* data = nullptr;
+    VkResult result = vkMapMemory(_device->_logical_device, _memory, 0, VK_WHOLE_SIZE, 0, &data);
+    ASSERT_VULKAN(result);
+
+    const uint8_t* pixels = static_cast<const uint8_t*>(data);
+    uint32_t count = _width * _height;
+    rgb.resize(count * 3u);
+    for( uint32_t i = 0; i < count; ++i)
+    {
+        rgb[i * 3u + 0u] = pixels[i * 4u + r];
+        rgb[i * 3u + 1u] = pixels[i * 4u + 1u];
+        rgb[i * 3u + 2u] = pixels[i * 4u + b];
+    }
+    vkUnmapMemory(_device->_logical_device, _memory);
+    return true;
+}
+
+bool frame_capture::write_ppm(const char* path, const eastl::vector<uint8_t>& rgb, uint32_t width, uint32_t height)
+{
+    EA_ASSERT(rgb.size() == size_t(width) * height * 3u);
+    FILE* file = fopen(path, "wb");
+    if(file == nullptr)
+        return false;
+
+    fprintf(file, "P6\n%u %u\n255\n", width, height);
+    bool written = fwrite(rgb.data(), 1, rgb.size(), file) == rgb.size();
+    fclose(file);
+    return written;
+}
+
+bool frame_capture::read_ppm(const char* path, eastl::vector<uint8_t>& rgb, uint32_t& width, uint32_t& height)
+{
+    int w = 0;
+    int h = 0;
+    int c = 0;
+    stbi_uc* pixels = stbi_load(path, &w, &h, &c, STBI_rgb);
+    if(pixels == nullptr)
+        return false;
+
+    width = static_cast<uint32_t>(w);
+    height = static_cast<uint32_t>(h);
+    rgb.assign(pixels, pixels + size_t(width) * height * 3u);
+    stbi_image_free(pixels);
+    return true;
+}
+
+float frame_capture::compute_ssim(const eastl::vector<uint8_t>& a, const eastl::vector<uint8_t>& b, uint32_t width, uint32_t height)
+{
+    //note: the constants of the paper, for 8 bit values
+    static constexpr float C1 = (0.01f * 255.0f) * (0.01f * 255.0f);
+    static constexpr float C2 = (0.03f * 255.0f) * (0.03f * 255.0f);
+
+    auto luminance = [](const eastl::vector<uint8_t>& rgb, uint32_t i)
+    {
+        return 0.2126f * rgb[i * 3u] + 0.7152f * rgb[i * 3u + 1u] + 0.0722f * rgb[i * 3u + 2u];
+    };
+
+    double total = 0.0;
+    uint32_t windows = 0;
+    for( uint32_t y0 = 0; y0 + SSIM_WINDOW <= height; y0 += SSIM_WINDOW)
+    {
+        for( uint32_t x0 = 0; x0 + SSIM_WINDOW <= width; x0 += SSIM_WINDOW)
+        {
+            float sum_a = 0.0f, sum_b = 0.0f, sum_aa = 0.0f, sum_bb = 0.0f, sum_ab = 0.0f;
+            for( uint32_t y = y0; y < y0 + SSIM_WINDOW; ++y)
+            {
+                for( uint32_t x = x0; x < x0 + SSIM_WINDOW; ++x)
+                {
+                    float la = luminance(a, y * width + x);
+                    float lb = luminance(b, y * width + x);
+                    sum_a += la;
+                    sum_b += lb;
+                    sum_aa += la * la;
+                    sum_bb += lb * lb;
+                    sum_ab += la * lb;
+                }
+            }
+
+            const float n = float(SSIM_WINDOW * SSIM_WINDOW);
+            float mean_a = sum_a / n;
+            float mean_b = sum_b / n;
+            float var_a = sum_aa / n - mean_a * mean_a;
+            float var_b = sum_bb / n - mean_b * mean_b;
+            float covariance = sum_ab / n - mean_a * mean_b;
+
+            total += ((2.0f * mean_a * mean_b + C1) * (2.0f * covariance + C2)) /
+                     ((mean_a * mean_a + mean_b * mean_b + C1) * (var_a + var_b + C2));
+            ++windows;
+        }
+    }
+
+    //note: images smaller than a window are compared per pixel only
+    return windows == 0 ? 1.0f : float(total / windows);
+}
+
+frame_capture::comparison frame_capture::compare(const eastl::vector<uint8_t>& a, const eastl::vector<uint8_t>& b, uint32_t width,
+                                                 uint32_t height, const tolerance& limits, eastl::vector<uint8_t>& diff)
+{
+    EA_ASSERT(a.size() == size_t(width) * height * 3u);
+    EA_ASSERT(a.size() == b.size());
+
+    comparison result {};
+    uint64_t sums[3] = {};
+    uint32_t count = width * height;
+    diff.resize(a.size());
+    for( uint32_t i = 0; i < count; ++i)
+    {
+        bool off = false;
+        for( uint32_t c = 0; c < 3u; ++c)
+        {
+            uint8_t error = static_cast<uint8_t>(std::abs(int(a[i * 3u + c]) - int(b[i * 3u + c])));
+            result.max_error[c] = std::max(result.max_error[c], error);
+            sums[c] += error;
+            off = off || error > limits.channel;
+            diff[i * 3u + c] = static_cast<uint8_t>(std::min(255, error * DIFF_SCALE));
+        }
+
+        if(off)
+        {
+            ++result.num_off;
+            diff[i * 3u + 0u] = 255u;
+        }
+    }
+
+    for( uint32_t c = 0; c < 3u; ++c)
+    {
+        result.mean_error[c] = count == 0 ? 0.0f : float(sums[c]) / float(count);
+    }
+    result.ssim = compute_ssim(a, b, width, height);
+    result.passed = float(result.num_off) <= limits.max_off * float(count) && result.ssim >= limits.min_ssim;
+    return result;
+}
+
+void frame_capture::destroy()
+{
+    if(_buffer != VK_NULL_HANDLE)
+    {
+        vkDestroyBuffer(_device->_logical_device, _buffer, nullptr);
+        vkFreeMemory(_device->_logical_device, _memory, nullptr);
+        _buffer = VK_NULL_HANDLE;
+        _memory = VK_NULL_HANDLE;
+        _size = 0;
+    }
+}
@@ -0,0 +1,100 @@
+//
+//  frame_capture.h
+//  vulkan-demos
+//
+//  Created by Rafael Sabino on 10/19/26.
+//  Copyright © 2026 Rafael Sabino. All rights reserved.
+//
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include "EASTL/vector.h"
+#include "resource.h"
+#include "device.h"
+#include "glfw_swapchain.h"
+
+namespace vk
+{
+    //note: copies the swapchain image a frame presents to memory the cpu can read, and compares images with golden ones.
+    //
+    //a capture goes like this: request, then the graph records the next frame with a copy of its swapchain image at the end of
+    //the last graphics submission (see graph::set_capture), the frame is submitted, then once the device is idle read hands back
+    //the pixels as 8 bit rgb.  The image is moved out of the present layout for the copy and back to it, presenting is untouched.
+    //
+    //images are kept as binary ppm, stb_image reads them and they need nothing to write.  compare gives the largest and mean
+    //error of every channel, the pixels that are off by more than a tolerance and the structural similarity (SSIM) of their
+    //luminance.  SSIM tells noise and small shifts, which differ a lot per pixel but look alike, from real changes
+    class frame_capture : public resource
+    {
+    public:
+
+        struct tolerance
+        {
+            //note: a pixel is off when one of its channels differs by more than this
+            uint8_t channel = 8;
+            //note: fraction of pixels that can be off
+            float   max_off = 0.001f;
+            float   min_ssim = 0.98f;
+        };
+
+        struct comparison
+        {
+            uint8_t  max_error[3] = {};
+            float    mean_error[3] = {};
+            uint32_t num_off = 0;
+            float    ssim = 0.0f;
+            bool     passed = false;
+        };
+
+        frame_capture(){}
+        frame_capture(device* dev, glfw_swapchain* swapchain){ _device = dev; _swapchain = swapchain; }
+
+        //main thread only: the next frame the graph records copies its swapchain image
+        inline void request(){ _requested = true; _captured = false; }
+        inline bool is_requested() const { return _requested; }
+        inline bool is_captured() const { return _captured; }
+
+        //main thread only: records the copy of image_id's swapchain image, called by the graph after everything else is recorded
+        void record(VkCommandBuffer command_buffer, uint32_t image_id);
+
+        //note: the frame that was captured has to be done on the gpu.  False if nothing was captured or the swapchain format is
+        //not one of the 8 bit ones this knows
+        bool read(eastl::vector<uint8_t>& rgb);
+
+        inline uint32_t get_width() const { return _width; }
+        inline uint32_t get_height() const { return _height; }
+
+        static bool write_ppm(const char* path, const eastl::vector<uint8_t>& rgb, uint32_t width, uint32_t height);
+        //note: any image stb_image reads, converted to rgb
+        static bool read_ppm(const char* path, eastl::vector<uint8_t>& rgb, uint32_t& width, uint32_t& height);
+
+        //note: a and b are rgb of the same size.  diff gets the error of every pixel, scaled up so small errors show, with the
+        //pixels that are off in red
+        static comparison compare(const eastl::vector<uint8_t>& a, const eastl::vector<uint8_t>& b, uint32_t width, uint32_t height,
+                                  const tolerance& limits, eastl::vector<uint8_t>& diff);
+
+        virtual void destroy() override;
+
+    private:
+
+        //note: SSIM is computed in windows of this many pixels across, without overlap
+        static constexpr uint32_t SSIM_WINDOW = 8u;
+        static constexpr uint8_t DIFF_SCALE = 4u;
+
+        static float compute_ssim(const eastl::vector<uint8_t>& a, const eastl::vector<uint8_t>& b, uint32_t width, uint32_t height);
+
+        device*         _device = nullptr;
+        glfw_swapchain* _swapchain = nullptr;
+
+        VkBuffer        _buffer = VK_NULL_HANDLE;
+        VkDeviceMemory  _memory = VK_NULL_HANDLE;
+        VkDeviceSize    _size = 0;
+
+        VkFormat    _format = VK_FORMAT_UNDEFINED;
+        uint32_t    _width = 0;
+        uint32_t    _height = 0;
+        bool        _requested = false;
+        bool        _captured = false;
+    };
+}
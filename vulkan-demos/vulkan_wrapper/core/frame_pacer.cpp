@@ -0,0 +1,233 @@
+//
+//  frame_pacer.cpp
+//  vulkan-demos
+//
+//  Created by Rafael Sabino on 10/19/26.
+//  Copyright © 2026 Rafael Sabino. All rights reserved.
+//
+
+#include "frame_pacer.h"
+#include <cstdio>
+#include <iostream>
+#include "EASTL/algorithm.h"
+#include "EAAssert/eaassert.h"
+#include "glfw_swapchain.h"
+
+using namespace vk;
+
+namespace
+{
+    //note: frames that were never shown, a minimized window for one, are forgotten past this many
+    constexpr eastl_size_t MAX_PENDING = 64;
+}
+
+frame_pacer::frame_pacer(glfw_swapchain* swapchain)
+{
+    _swapchain = swapchain;
+    if(_swapchain->has_present_wait())
+        _watcher = std::thread(&frame_pacer::watch_presents, this);
+}
+
+void frame_pacer::begin_frame()
+{
+    clock::time_point begin = clock::now();
+
+    //note: the watcher takes a present off once it was shown
+    if(_watcher.joinable() && _max_queued_frames != 0)
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _changed.wait_for(lock, std::chrono::nanoseconds(PRESENT_TIMEOUT), [this]{ return _pending.size() < _max_queued_frames; });
+    }
+    collect_presents();
+
+    //note: a frame that ran late moves the deadlines after it, the frames that follow do not hurry to catch up
+    if(_started && _target_frame_time > 0.0)
+    {
+        clock::time_point next = _deadline + std::chrono::duration_cast<clock::duration>(std::chrono::duration<double, std::milli>(_target_frame_time));
+        clock::time_point now = clock::now();
+        _deadline = next < now ? now : next;
+        sleep_until(_deadline);
+    }
+
+    clock::time_point start = clock::now();
+    if(!_started)
+        _deadline = start;
+
+    frame_stats stats {};
+    stats.frame = static_cast<uint64_t>(_frames.size());
+    stats.frame_time = _started ? to_milliseconds(start - _last_start) : -1.0;
+    stats.wait_time = to_milliseconds(start - begin);
+    _frames.push_back(stats);
+
+    _last_start = start;
+    _input_time = start;
+    _started = true;
+}
+
+void frame_pacer::end_frame()
+{
+    EA_ASSERT_MSG(_started, "end_frame was called without begin_frame");
+    frame_stats& stats = _frames.back();
+    stats.input_to_submit = to_milliseconds(clock::now() - _input_time);
+
+    //note: a present the swapchain turned down is never shown
+    if(!_watcher.joinable() || _swapchain->is_out_of_date())
+        return;
+
+    pending_present p {};
+    p.present_id = _swapchain->get_present_id();
+    p.frame = stats.frame;
+    p.input_time = _input_time;
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _pending.push_back(p);
+    if(_pending.size() > MAX_PENDING)
+        _pending.erase(_pending.begin());
+    _changed.notify_all();
+}
+
+void frame_pacer::drop_presents()
+{
+    std::lock_guard<std::mutex> wait_lock(_wait_mutex);
+    std::lock_guard<std::mutex> lock(_mutex);
+    _pending.clear();
+    _changed.notify_all();
+}
+
+void frame_pacer::finish()
+{
+    if(!_watcher.joinable())
+        return;
+
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _changed.wait_for(lock, std::chrono::nanoseconds(PRESENT_TIMEOUT), [this]{ return _pending.empty(); });
+        _stop = true;
+    }
+    _changed.notify_all();
+    _watcher.join();
+    collect_presents();
+}
+
+void frame_pacer::sleep_until(clock::time_point deadline)
+{
+    const clock::duration spin = std::chrono::microseconds(SPIN_MICROSECONDS);
+    for(clock::time_point now = clock::now(); now < deadline; now = clock::now())
+    {
+        if(deadline - now > spin)
+            std::this_thread::sleep_for(deadline - now - spin);
+        else
+            std::this_thread::yield();
+    }
+}
+
+void frame_pacer::collect_presents()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    for( const shown_present& shown : _shown)
+    {
+        _frames[shown.frame].input_to_present = shown.input_to_present;
+    }
+    _shown.clear();
+}
+
+//note: VK_KHR_present_wait is meant to be waited on from a thread other than the one that presents.  The wait returns when the
+//frame is shown, the time is taken right then
+void frame_pacer::watch_presents()
+{
+    for(;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _changed.wait(lock, [this]{ return _stop || !_pending.empty(); });
+            if(_stop)
+                return;
+        }
+
+        //note: drop_presents may have emptied _pending in between, it is looked at again with the swapchain held
+        std::lock_guard<std::mutex> wait_lock(_wait_mutex);
+        pending_present p {};
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if(_pending.empty())
+                continue;
+            p = _pending.front();
+        }
+
+        VkResult result = _swapchain->wait_for_present(p.present_id, WATCH_TIMEOUT);
+        clock::time_point now = clock::now();
+        if(result == VK_TIMEOUT)
+            continue;
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        //note: end_frame forgets the oldest present once there are too many, this one may be gone
+        if(_pending.empty() || _pending.front().present_id != p.present_id)
+            continue;
+
+        //note: a swapchain that is out of date or lost does not show it
+        if(result == VK_SUCCESS || result == VK_SUBOPTIMAL_KHR)
+        {
+            shown_present shown {};
+            shown.frame = p.frame;
+            shown.input_to_present = to_milliseconds(now - p.input_time);
+            _shown.push_back(shown);
+        }
+        _pending.erase(_pending.begin());
+        _changed.notify_all();
+    }
+}
+
+bool frame_pacer::write_log(const char* path) const
+{
+    FILE* file = fopen(path, "w");
+    if(file == nullptr)
+        return false;
+
+    auto write_time = [file](double t, const char* separator)
+    {
+        if(t >= 0.0)
+            fprintf(file, "%f%s", t, separator);
+        else
+            fprintf(file, "%s", separator);
+    };
+
+    fprintf(file, "frame,frame_ms,wait_ms,input_to_submit_ms,input_to_present_ms\n");
+    for( const frame_stats& f : _frames)
+    {
+        fprintf(file, "%llu,", static_cast<unsigned long long>(f.frame));
+        write_time(f.frame_time, ",");
+        write_time(f.wait_time, ",");
+        write_time(f.input_to_submit, ",");
+        write_time(f.input_to_present, "\n");
+    }
+    fclose(file);
+    return true;
+}
+
+void frame_pacer::print_summary() const
+{
+    auto summary = [this](const char* name, double frame_stats::* time)
+    {
+        double total = 0.0;
+        double worst = 0.0;
+        uint64_t count = 0;
+        for( const frame_stats& f : _frames)
+        {
+            if(f.*time < 0.0)
+                continue;
+            total += f.*time;
+            worst = eastl::max(worst, f.*time);
+            ++count;
+        }
+        if(count == 0)
+            std::cout << name << ": not known" << std::endl;
+        else
+            std::cout << name << ": mean " << total / count << " ms, worst " << worst << " ms" << std::endl;
+    };
+
+    std::cout << _frames.size() << " frames paced, target frame time " << _target_frame_time << " ms" << std::endl;
+    summary("frame time", &frame_stats::frame_time);
+    summary("pacing wait", &frame_stats::wait_time);
+    summary("input to submit", &frame_stats::input_to_submit);
+    summary("input to present", &frame_stats::input_to_present);
+}
@@ -0,0 +1,133 @@
+//
+//  frame_pacer.h
+//  vulkan-demos
+//
+//  Created by Rafael Sabino on 10/19/26.
+//  Copyright © 2026 Rafael Sabino. All rights reserved.
+//
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include "EASTL/vector.h"
+
+namespace vk
+{
+    class glfw_swapchain;
+
+    //note: keeps frames from starting sooner than a target frame time and, with VK_KHR_present_wait, from getting too far
+    //ahead of what is on screen.  It also measures how long the input of every frame took to reach the screen.
+    //
+    //a frame goes like this: begin_frame, which waits and then takes the time the input is read at, then read the input, update,
+    //record and execute, then end_frame.  Input to present is only known with present wait, a thread of the pacer waits on the
+    //present id of every frame and takes the time it was shown when that wait returns.  Without it the log keeps input to submit
+    //alone.
+    //
+    //sleeping is coarse, the last SPIN_MICROSECONDS before a deadline are spent yielding instead
+    class frame_pacer
+    {
+    public:
+
+        static constexpr int64_t SPIN_MICROSECONDS = 1000;
+        //note: waiting for a present gives up after this, a window that is hidden may never show its frames
+        static constexpr uint64_t PRESENT_TIMEOUT = 100000000ull;
+        //note: how long the thread that watches presents waits at a time before it checks whether it should stop
+        static constexpr uint64_t WATCH_TIMEOUT = 5000000ull;
+
+        //note: times are in milliseconds, negative ones are not known
+        struct frame_stats
+        {
+            uint64_t frame = 0;
+            //note: from the start of the frame before to the start of this one
+            double frame_time = -1.0;
+            //note: what begin_frame spent waiting for the target frame time and for presents
+            double wait_time = 0.0;
+            double input_to_submit = -1.0;
+            double input_to_present = -1.0;
+        };
+
+        frame_pacer(){}
+        frame_pacer(glfw_swapchain* swapchain);
+        ~frame_pacer(){ finish(); }
+
+        frame_pacer(const frame_pacer&) = delete;
+        frame_pacer& operator=(const frame_pacer&) = delete;
+
+        //note: 0 starts frames as soon as they can
+        inline void set_target_frame_time(double milliseconds){ _target_frame_time = milliseconds; }
+        inline double get_target_frame_time() const { return _target_frame_time; }
+
+        //note: frames that can be presented and not yet shown when the next one reads its input.  1 reads input once the last frame
+        //is on screen, which is the lowest latency.  0 does not wait, nor does a swapchain without present wait, the swapchain
+        //images bound how far ahead frames get then, see command_recorder::wait
+        inline void set_max_queued_frames(uint32_t frames){ _max_queued_frames = frames; }
+
+        //main thread only
+        void begin_frame();
+        void end_frame();
+        //note: frames presented before the swapchain is made again are never shown, call this before glfw_swapchain::resize.
+        //Once it returns nothing waits on the old swapchain
+        void drop_presents();
+        //note: gives the frames that were presented a last chance to be shown and stops watching presents, call it before the
+        //swapchain is destroyed and before reading the frames
+        void finish();
+
+        inline uint64_t get_num_frames() const { return static_cast<uint64_t>(_frames.size()); }
+        inline const frame_stats& get_frame(uint64_t i) const { return _frames[i]; }
+
+        //note: every frame as comma separated values, unknown times are left empty
+        bool write_log(const char* path) const;
+        //note: mean and worst of the times that are known
+        void print_summary() const;
+
+    private:
+
+        using clock = std::chrono::steady_clock;
+
+        double to_milliseconds(clock::duration d) const { return std::chrono::duration<double, std::milli>(d).count(); }
+        void sleep_until(clock::time_point deadline);
+        //note: copies input to present of the frames that were shown since the last call into _frames
+        void collect_presents();
+        //note: runs on _watcher, waits for the presents in _pending one at a time
+        void watch_presents();
+
+        glfw_swapchain* _swapchain = nullptr;
+        double   _target_frame_time = 0.0;
+        uint32_t _max_queued_frames = 0;
+
+        clock::time_point _last_start {};
+        clock::time_point _deadline {};
+        clock::time_point _input_time {};
+        bool _started = false;
+
+        struct pending_present
+        {
+            uint64_t present_id = 0;
+            uint64_t frame = 0;
+            clock::time_point input_time {};
+        };
+
+        struct shown_present
+        {
+            uint64_t frame = 0;
+            double input_to_present = -1.0;
+        };
+
+        eastl::vector<frame_stats> _frames {};
+
+        //note: _mutex guards what follows, _wait_mutex is held by the watcher for as long as it waits on the swapchain.  It is
+        //taken before _mutex by whoever takes both
+        std::mutex _mutex;
+        std::mutex _wait_mutex;
+        std::condition_variable _changed;
+        std::thread _watcher;
+        bool _stop = false;
+        //note: presents in the order they were made, the oldest is shown first
+        eastl::vector<pending_present> _pending {};
+        eastl::vector<shown_present> _shown {};
+    };
+}
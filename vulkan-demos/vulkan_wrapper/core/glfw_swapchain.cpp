@@ -19,15 +19,25 @@
 #include "attachment_group.h"
 using namespace vk;
 
+VkPresentModeKHR glfw_swapchain::_requested_present_mode = VK_PRESENT_MODE_MAX_ENUM_KHR;
 
-glfw_swapchain::glfw_swapchain(device* device, GLFWwindow* window, VkSurfaceKHR surface)
+
+glfw_swapchain::glfw_swapchain(device* device, GLFWwindow* window, VkSurfaceKHR surface, VkExtent2D headless_extent)
 {
     _device = device;
     _window =  window;
+    _headless_extent = headless_extent;
     
     _surface = surface;
     
     recreate_swapchain();
+#if defined(VK_KHR_present_wait) && defined(VK_KHR_present_id)
+    if(device->has_present_wait())
+    {
+        _wait_for_present = reinterpret_cast<PFN_vkWaitForPresentKHR>(vkGetDeviceProcAddr(device->_logical_device, "vkWaitForPresentKHR"));
+    }
+#endif
+    std::cout << "present mode " << get_present_mode_name(_present_mode) << (has_present_wait() ? ", present wait" : "") << std::endl;
     present_textures.set_name("present");
     for( int i =0; i < NUM_SWAPCHAIN_IMAGES; ++i)
     {
@@ -58,6 +68,16 @@ VkSurfaceFormatKHR glfw_swapchain::get_vk_swap_surface_format(const eastl::fixed
 
 VkPresentModeKHR glfw_swapchain::get_vk_swap_present_mode(const eastl::fixed_vector<VkPresentModeKHR, 20, true>& available_present_modes)
 {
+    if(_requested_present_mode != VK_PRESENT_MODE_MAX_ENUM_KHR)
+    {
+        for (VkPresentModeKHR available_present_mode : available_present_modes)
+        {
+            if(available_present_mode == _requested_present_mode)
+                return available_present_mode;
+        }
+        std::cout << "present mode " << get_present_mode_name(_requested_present_mode) << " is not supported by the surface" << std::endl;
+    }
+    
     VkPresentModeKHR best_mode = VK_PRESENT_MODE_FIFO_KHR;
 
     for (const auto& available_present_mode : available_present_modes) {
@@ -71,7 +91,37 @@ VkPresentModeKHR glfw_swapchain::get_vk_swap_present_mode(const eastl::fixed_vec
     return best_mode;
 }
 
-VkExtent2D glfw_swapchain::get_vk_swap_extent(const VkSurfaceCapabilitiesKHR& capabilities, GLFWwindow& window)
+const char* glfw_swapchain::get_present_mode_name(VkPresentModeKHR mode)
+{
+    switch(mode)
+    {
+        case VK_PRESENT_MODE_IMMEDIATE_KHR:     return "immediate";
+        case VK_PRESENT_MODE_MAILBOX_KHR:       return "mailbox";
+        case VK_PRESENT_MODE_FIFO_KHR:          return "fifo";
+        case VK_PRESENT_MODE_FIFO_RELAXED_KHR:  return "fifo_relaxed";
+        default:                                return "unknown";
+    }
+}
+
+bool glfw_swapchain::has_present_wait() const
+{
+#if defined(VK_KHR_present_wait) && defined(VK_KHR_present_id)
+    return _wait_for_present != nullptr;
+#else
+    return false;
+#endif
+}
+
+VkResult glfw_swapchain::wait_for_present(uint64_t present_id, uint64_t timeout)
+{
+#if defined(VK_KHR_present_wait) && defined(VK_KHR_present_id)
+    if(_wait_for_present != nullptr)
+        return _wait_for_present(_device->_logical_device, _swapchain, present_id, timeout);
+#endif
+    return VK_ERROR_EXTENSION_NOT_PRESENT;
+}
+
+VkExtent2D glfw_swapchain::get_vk_swap_extent(const VkSurfaceCapabilitiesKHR& capabilities, GLFWwindow* window)
 {
     if (capabilities.currentExtent.width != std::numeric_limits<uint32_t>::max())
     {
@@ -80,8 +130,10 @@ VkExtent2D glfw_swapchain::get_vk_swap_extent(const VkSurfaceCapabilitiesKHR& ca
     else
     {
         //TODO: maybe is possible to eliminate the glfw library dependency from the vulkan wrapper
-        int width, height;
-        glfwGetFramebufferSize(&window, &width, &height);
+        int width = static_cast<int>(_headless_extent.width);
+        int height = static_cast<int>(_headless_extent.height);
+        if(window != nullptr)
+            glfwGetFramebufferSize(window, &width, &height);
 
         VkExtent2D actual_extent = {
             static_cast<uint32_t>(width),
@@ -101,11 +153,23 @@ void glfw_swapchain::destroy_swapchain()
     vkDestroySwapchainKHR(_device->_logical_device, old_swapchain, nullptr);
 }
 
+void glfw_swapchain::resize()
+{
+    recreate_swapchain();
+    for( int i = 0; i < NUM_SWAPCHAIN_IMAGES; ++i)
+    {
+        present_textures[i].destroy();
+        present_textures[i].set_dimensions(_extent.width, _extent.height, 1);
+        present_textures[i].init();
+    }
+    _out_of_date = false;
+}
+
 VkExtent2D glfw_swapchain::get_vk_swap_extent()
 {
     device::swapchain_support_details swapchain_support;
     _device->query_swapchain_support( _device->_physical_device, _surface, swapchain_support);
-    VkExtent2D extent = get_vk_swap_extent(swapchain_support.capabilities, *_window);
+    VkExtent2D extent = get_vk_swap_extent(swapchain_support.capabilities, _window);
     
     return extent;
     
@@ -118,7 +182,7 @@ void glfw_swapchain::create_swapchain()
     //all present textures have the same format and present modes
     VkSurfaceFormatKHR surface_format = get_vk_swap_surface_format(swapchain_support.formats);
     VkPresentModeKHR present_mode = get_vk_swap_present_mode(swapchain_support.presentModes);
-    VkExtent2D extent = get_vk_swap_extent(swapchain_support.capabilities, *_window);
+    VkExtent2D extent = get_vk_swap_extent(swapchain_support.capabilities, _window);
     
     uint32_t image_count = swapchain_support.capabilities.minImageCount + 1;
     if (swapchain_support.capabilities.maxImageCount > 0 && image_count > swapchain_support.capabilities.maxImageCount)
@@ -130,13 +194,21 @@ void glfw_swapchain::create_swapchain()
     create_info.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
     create_info.surface = _surface;
     
+    //note: the graph records one frame per swapchain image and expects them handed out in order (see
+    //command_recorder::submit_graphics_commands), the count cannot follow the present mode
     create_info.minImageCount = NUM_SWAPCHAIN_IMAGES;
+    EA_ASSERT_MSG(NUM_SWAPCHAIN_IMAGES >= swapchain_support.capabilities.minImageCount &&
+                  (swapchain_support.capabilities.maxImageCount == 0 || NUM_SWAPCHAIN_IMAGES <= swapchain_support.capabilities.maxImageCount),
+                  "the surface cannot have NUM_SWAPCHAIN_IMAGES images");
     create_info.imageFormat = surface_format.format;
     create_info.imageColorSpace = surface_format.colorSpace;
     create_info.imageExtent = extent;
     create_info.imageArrayLayers = 1;
     create_info.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
-    
+    //note: frame_capture copies presented images out of the swapchain
+    if(swapchain_support.capabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_SRC_BIT)
+        create_info.imageUsage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+
     device::queue_family_indices indices = _device->find_queue_families(_device->_physical_device, _surface);
     uint32_t queue_family_indices[] = {indices.graphics_family.value(), indices.present_family.value()};
     
@@ -156,11 +228,20 @@ void glfw_swapchain::create_swapchain()
     create_info.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
     create_info.presentMode = present_mode;
     create_info.clipped = VK_TRUE;
+    //note: lets the presentation engine hand images over from the swapchain this one replaces, see recreate_swapchain
+    create_info.oldSwapchain = _swapchain;
     
     
     if (vkCreateSwapchainKHR(_device->_logical_device, &create_info, nullptr, &(_swapchain)) != VK_SUCCESS) {
         throw std::runtime_error("failed to create swap chain!");
     }
+    _extent = extent;
+    _present_mode = present_mode;
+    
+    //note: the driver may make more images than asked for, present textures only know NUM_SWAPCHAIN_IMAGES of them
+    uint32_t num_images = 0;
+    vkGetSwapchainImagesKHR(_device->_logical_device, _swapchain, &num_images, nullptr);
+    EA_ASSERT_MSG(num_images == NUM_SWAPCHAIN_IMAGES, "the swapchain has a different number of images than the graph records frames for");
 }
 
 void glfw_swapchain::print_stats()
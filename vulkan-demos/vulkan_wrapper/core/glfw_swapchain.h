@@ -38,7 +38,9 @@ namespace vk
 
         device* _device = nullptr;
         
-        glfw_swapchain(device* device, GLFWwindow* window, VkSurfaceKHR surface);
+        //note: window is nullptr for a surface that has none, see device::create_headless_surface.  The images are then
+        //headless_extent big, unless the surface says otherwise
+        glfw_swapchain(device* device, GLFWwindow* window, VkSurfaceKHR surface, VkExtent2D headless_extent = {});
         
         VkSurfaceKHR       get_vk_surface(){ return _surface; }
         void print_stats();
@@ -56,7 +58,7 @@ namespace vk
 
         VkSurfaceFormatKHR  get_vk_swap_surface_format(const eastl::fixed_vector<VkSurfaceFormatKHR, 20, true>& availableFormats);
         VkPresentModeKHR    get_vk_swap_present_mode(const eastl::fixed_vector<VkPresentModeKHR, 20, true>& availablePresentModes);
-        VkExtent2D          get_vk_swap_extent(const VkSurfaceCapabilitiesKHR& capabilities, GLFWwindow& window);
+        VkExtent2D          get_vk_swap_extent(const VkSurfaceCapabilitiesKHR& capabilities, GLFWwindow* window);
         
         VkExtent2D          get_vk_swap_extent();
         VkSwapchainKHR&      get_vk_swapchain() { return _swapchain; }
@@ -65,6 +67,30 @@ namespace vk
         void                destroy_swapchain();
         void                recreate_swapchain();
         
+        //note: waits for the device, makes a swapchain the size the window has now and points the present textures at its images.
+        //Framebuffers and descriptors that use the present textures have to be made again, see graph::resize
+        void                resize();
+        
+        //note: the size the swapchain was made with, get_vk_swap_extent asks the surface for the size it should have now
+        inline VkExtent2D   get_extent() const { return _extent; }
+        
+        //note: set when acquiring or presenting said the swapchain no longer matches the surface, resize clears it
+        inline void         set_out_of_date(){ _out_of_date = true; }
+        inline bool         is_out_of_date() const { return _out_of_date; }
+        
+        //note: the present mode swapchains are made with from now on.  VK_PRESENT_MODE_MAX_ENUM_KHR picks mailbox, then immediate,
+        //then fifo, like it always did.  A mode the surface does not have falls back to that too
+        static void set_present_mode(VkPresentModeKHR mode){ _requested_present_mode = mode; }
+        inline VkPresentModeKHR get_present_mode() const { return _present_mode; }
+        static const char* get_present_mode_name(VkPresentModeKHR mode);
+        
+        //note: with VK_KHR_present_id every present gets an id one past the last one, 0 means nothing was presented with an id.
+        //wait_for_present blocks until the frame with that id was shown or timeout nanoseconds passed, see frame_pacer.h
+        bool                has_present_wait() const;
+        inline uint64_t     get_present_id() const { return _present_id; }
+        inline uint64_t     next_present_id(){ return ++_present_id; }
+        VkResult            wait_for_present(uint64_t present_id, uint64_t timeout);
+        
         //eastl::array< resource_set< glfw_present_texture >, 1> present_textures;
         resource_set< glfw_present_texture > present_textures;
         
@@ -74,6 +100,16 @@ namespace vk
     private:
         VkSurfaceKHR  _surface = VK_NULL_HANDLE;
         VkSwapchainKHR _swapchain = VK_NULL_HANDLE;
+        VkExtent2D     _extent {};
+        VkExtent2D     _headless_extent {};
+        bool           _out_of_date = false;
+        
+        static VkPresentModeKHR _requested_present_mode;
+        VkPresentModeKHR _present_mode = VK_PRESENT_MODE_FIFO_KHR;
+        uint64_t       _present_id = 0;
+#if defined(VK_KHR_present_wait) && defined(VK_KHR_present_id)
+        PFN_vkWaitForPresentKHR _wait_for_present = nullptr;
+#endif
     };
 }
 
@@ -0,0 +1,248 @@
+//
+//  job_system.cpp
+//  vulkan-demos
+//
+//  Created by Rafael Sabino on 10/19/26.
+//  Copyright © 2026 Rafael Sabino. All rights reserved.
+//
+
+#include "job_system.h"
+#include "profiler.h"
+#include <algorithm>
+
+using namespace vk;
+
+uint32_t job_system::_num_threads = job_system::AUTO_THREADS;
+
+uint32_t job_system::get_num_threads()
+{
+    if(_num_threads != AUTO_THREADS)
+        return std::min(_num_threads, MAX_THREADS);
+
+    return std::min(MAX_THREADS, std::max(1u, std::thread::hardware_concurrency()));
+}
+
+void job_system::start_workers(uint32_t count)
+{
+    //note: thread 0 is the main thread, workers start at 1 and sleep until a job is queued
+    while(_workers.size() + 1 < count)
+    {
+        uint32_t thread_id = static_cast<uint32_t>(_workers.size() + 1);
+        _workers.push_back(std::thread(&job_system::work, this, thread_id));
+        _num_workers = thread_id;
+    }
+}
+
+void job_system::begin()
+{
+    EA_ASSERT_MSG(_pending == 0, "jobs of the last run are still running");
+    _jobs.clear();
+}
+
+uint32_t job_system::add(const char* name, job_function function)
+{
+    job j {};
+    j.name = name;
+    j.function = eastl::move(function);
+    _jobs.push_back(eastl::move(j));
+    return static_cast<uint32_t>(_jobs.size() - 1);
+}
+
+void job_system::depend(uint32_t job_id, uint32_t on)
+{
+    if(on == NO_JOB)
+        return;
+
+    EA_ASSERT_MSG(on < job_id, "a job can only depend on jobs added before it");
+    EA_ASSERT(job_id < _jobs.size());
+    _jobs[on].dependants.push_back(job_id);
+    ++_jobs[job_id].num_dependencies;
+}
+
+uint32_t job_system::add_range(const char* name, uint32_t count, uint32_t grain, range_function function, uint32_t after)
+{
+    EA_ASSERT(grain != 0);
+    eastl::fixed_vector<uint32_t, 64, true> ranges {};
+    for( uint32_t first = 0; first < count; first += grain)
+    {
+        uint32_t last = std::min(count, first + grain);
+        uint32_t range = add(name, [function, first, last](){ function(first, last); });
+        depend(range, after);
+        ranges.push_back(range);
+    }
+
+    //note: empty, it is only there so others can wait on every range at once
+    uint32_t join = add(name, [](){});
+    depend(join, after);
+    for( uint32_t range : ranges)
+    {
+        depend(join, range);
+    }
+    return join;
+}
+
+void job_system::push(uint32_t thread_id, uint32_t job_id)
+{
+    {
+        std::lock_guard<std::mutex> lock(_threads[thread_id].mutex);
+        _threads[thread_id].ready.push_back(job_id);
+    }
+    ++_queued;
+
+    //note: taking _mutex makes sure a worker that just saw nothing queued is asleep before it is told
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+    }
+    _work_available.notify_one();
+}
+
+bool job_system::execute_one(uint32_t thread_id)
+{
+    uint32_t job_id = NO_JOB;
+    {
+        thread_data& own = _threads[thread_id];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if(!own.ready.empty())
+        {
+            job_id = own.ready.back();
+            own.ready.pop_back();
+        }
+    }
+
+    uint32_t num_threads = _num_workers + 1;
+    for( uint32_t i = 1; job_id == NO_JOB && i < num_threads; ++i)
+    {
+        thread_data& other = _threads[(thread_id + i) % num_threads];
+        std::lock_guard<std::mutex> lock(other.mutex);
+        if(!other.ready.empty())
+        {
+            job_id = other.ready.front();
+            other.ready.pop_front();
+            ++_steals;
+        }
+    }
+
+    if(job_id == NO_JOB)
+        return false;
+
+    --_queued;
+    const job& j = _jobs[job_id];
+    uint64_t start = profiler::now();
+    {
+        PROFILE_ZONE(j.name);
+        j.function();
+    }
+    _threads[thread_id].busy += profiler::now() - start;
+
+    for( uint32_t dependant : j.dependants)
+    {
+        if(--_remaining[dependant] == 0)
+            push(thread_id, dependant);
+    }
+    --_pending;
+    return true;
+}
+
+void job_system::work(uint32_t thread_id)
+{
+    eastl::fixed_string<char, 32, false> name {};
+    name.sprintf("job worker %u", thread_id);
+    profiler::set_thread_name(name.c_str());
+
+    while(true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _work_available.wait(lock, [&]{ return _quit || _queued != 0; });
+            if(_quit)
+                return;
+        }
+
+        //note: _queued can be ahead of the queues while another thread is taking a job, let it finish
+        if(!execute_one(thread_id))
+            std::this_thread::yield();
+    }
+}
+
+void job_system::run()
+{
+    uint32_t num_jobs = get_num_jobs();
+    if(num_jobs == 0)
+        return;
+
+    uint32_t num_threads = get_num_threads();
+    if(num_threads == 0)
+    {
+        //note: jobs only depend on jobs added before them, so add order is an order they can run in
+        for( const job& j : _jobs)
+        {
+            uint64_t start = profiler::now();
+            {
+                PROFILE_ZONE(j.name);
+                j.function();
+            }
+            _threads[0].busy += profiler::now() - start;
+        }
+        return;
+    }
+
+    if(_remaining_size < num_jobs)
+    {
+        _remaining_size = std::max(num_jobs, _remaining_size * 2);
+        _remaining.reset(new std::atomic<uint32_t>[_remaining_size]);
+    }
+    for( uint32_t i = 0; i < num_jobs; ++i)
+    {
+        _remaining[i] = _jobs[i].num_dependencies;
+    }
+    _pending = num_jobs;
+    start_workers(num_threads);
+
+    //note: jobs that wait on nothing are dealt out to every thread, the rest are queued by whoever finishes their last dependency
+    uint32_t next_thread = 0;
+    for( uint32_t i = 0; i < num_jobs; ++i)
+    {
+        if(_jobs[i].num_dependencies != 0)
+            continue;
+
+        push(next_thread, i);
+        next_thread = (next_thread + 1) % num_threads;
+    }
+
+    while(_pending != 0)
+    {
+        if(!execute_one(0))
+            std::this_thread::yield();
+    }
+}
+
+uint64_t job_system::get_worker_time() const
+{
+    uint64_t time = 0;
+    for( uint32_t i = 1; i < MAX_THREADS; ++i)
+    {
+        time += _threads[i].busy;
+    }
+    return time;
+}
+
+void job_system::destroy()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _quit = true;
+    }
+    _work_available.notify_all();
+    for( std::thread& worker : _workers)
+    {
+        worker.join();
+    }
+    _workers.clear();
+    _num_workers = 0;
+
+    for( thread_data& t : _threads)
+    {
+        t.ready.clear();
+    }
+    _jobs.clear();
+}
@@ -0,0 +1,125 @@
+//
+//  job_system.h
+//  vulkan-demos
+//
+//  Created by Rafael Sabino on 10/19/26.
+//  Copyright © 2026 Rafael Sabino. All rights reserved.
+//
+
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <memory>
+#include <condition_variable>
+#include <functional>
+#include "EASTL/array.h"
+#include "EASTL/deque.h"
+#include "EASTL/fixed_vector.h"
+#include "EASTL/vector.h"
+#include "object.h"
+
+namespace vk
+{
+    //note: runs cpu work of a frame on several threads.  Work is added as jobs that wait on jobs added before them, a job is
+    //handed to a thread once everything it waits on is done.  Every thread keeps the jobs it made ready in a queue of its own
+    //and takes the newest one first, threads that run out take the oldest job of another thread.
+    //
+    //a frame goes like this: begin, then add for every job and depend for every job it has to run after, then run, which runs
+    //them all on the main thread and the workers and returns once they are done.  The graph adds a job for every node, see
+    //node::add_update_jobs.
+    //
+    //every job is a profiler zone named after it, the workers are named "job worker <n>".  With the profiler on, its trace shows
+    //which thread ran what and when, gaps between the jobs of a thread are time it spent waiting.  See profiler.h
+    class job_system : public object
+    {
+    public:
+
+        static constexpr uint32_t MAX_THREADS = 16u;
+        //note: picks one thread per core, see set_num_threads
+        static constexpr uint32_t AUTO_THREADS = ~0u;
+        static constexpr uint32_t NO_JOB = ~0u;
+
+        using job_function = std::function<void()>;
+        //note: called with the first item of a range and one past its last
+        using range_function = std::function<void(uint32_t, uint32_t)>;
+
+        job_system(){}
+
+        //note: 0 runs every job on the main thread in the order it was added, like the graph used to.  Otherwise jobs run on this
+        //many threads, the main thread is one of them
+        static void set_num_threads(uint32_t threads){ _num_threads = threads; }
+        static uint32_t get_num_threads();
+
+        //main thread only: forgets the jobs of the last run
+        void begin();
+
+        //main thread only: name has to outlive the profiler, it is kept for the trace
+        uint32_t add(const char* name, job_function function);
+
+        //main thread only: job runs after on is done.  on has to be added before job, NO_JOB is ignored
+        void depend(uint32_t job, uint32_t on);
+
+        //main thread only: calls function for ranges of at most grain items out of count, each range is a job that runs after
+        //the job after.  Returns a job that is done once every range is
+        uint32_t add_range(const char* name, uint32_t count, uint32_t grain, range_function function, uint32_t after = NO_JOB);
+
+        //main thread only: runs everything added since begin, returns once every job is done
+        void run();
+
+        inline uint32_t get_num_jobs() const { return static_cast<uint32_t>(_jobs.size()); }
+        //note: jobs a thread took from the queue of another one, since the job system was made
+        inline uint64_t get_num_steals() const { return _steals.load(); }
+        //note: nanoseconds jobs ran on workers and on the main thread, since the job system was made
+        uint64_t get_worker_time() const;
+        inline uint64_t get_main_time() const { return _threads[0].busy; }
+
+        virtual void destroy() override;
+
+    private:
+
+        struct job
+        {
+            const char*     name = nullptr;
+            job_function    function {};
+            eastl::fixed_vector<uint32_t, 4, true> dependants {};
+            uint32_t        num_dependencies = 0;
+        };
+
+        struct thread_data
+        {
+            //note: guards ready, the thread pushes and pops at the back, others steal at the front
+            std::mutex              mutex;
+            eastl::deque<uint32_t>  ready {};
+            //note: only touched by this thread while jobs run
+            uint64_t                busy = 0;
+        };
+
+        void start_workers(uint32_t count);
+        void work(uint32_t thread_id);
+        bool execute_one(uint32_t thread_id);
+        void push(uint32_t thread_id, uint32_t job_id);
+
+        static uint32_t _num_threads;
+
+        eastl::vector<job> _jobs {};
+        std::unique_ptr<std::atomic<uint32_t>[]> _remaining {};
+        uint32_t _remaining_size = 0;
+
+        //note: jobs of this run that are not done yet, and jobs sitting in the queues of the threads
+        std::atomic<uint32_t> _pending { 0 };
+        std::atomic<uint32_t> _queued { 0 };
+        std::atomic<uint64_t> _steals { 0 };
+
+        eastl::array<thread_data, MAX_THREADS> _threads {};
+        eastl::fixed_vector<std::thread, MAX_THREADS, false> _workers {};
+        //note: size of _workers, read by workers looking for a thread to steal from while the main thread starts more
+        std::atomic<uint32_t> _num_workers { 0 };
+
+        //note: workers with nothing to do sleep on _work_available, guarded by _mutex
+        std::mutex                  _mutex;
+        std::condition_variable     _work_available;
+        bool                        _quit = false;
+    };
+}
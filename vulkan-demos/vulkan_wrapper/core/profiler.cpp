@@ -0,0 +1,123 @@
+//
+//  profiler.cpp
+//  vulkan-demos
+//
+//  Created by Rafael Sabino on 10/19/26.
+//  Copyright © 2026 Rafael Sabino. All rights reserved.
+//
+
+#include "profiler.h"
+#include <chrono>
+#include <cstdio>
+#include "EAAssert/eaassert.h"
+
+using namespace vk;
+
+bool profiler::_enabled = false;
+std::atomic<uint32_t> profiler::_num_threads { 0 };
+profiler::thread_data* profiler::_threads[profiler::MAX_THREADS] = {};
+uint64_t profiler::_num_gpu_zones = 0;
+profiler::zone_data profiler::_gpu_zones[profiler::MAX_GPU_ZONES] = {};
+int64_t profiler::_gpu_offset = 0;
+bool profiler::_gpu_offset_known = false;
+
+uint64_t profiler::now()
+{
+    static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+}
+
+profiler::thread_data* profiler::get_thread_data()
+{
+    //note: rings are made once per thread and live as long as the program, the trace is written after threads are gone
+    static thread_local thread_data* data = nullptr;
+    static thread_local bool registered = false;
+    if(!registered)
+    {
+        registered = true;
+        uint32_t id = _num_threads++;
+        if(id < MAX_THREADS)
+        {
+            data = new thread_data();
+            data->name.sprintf("thread %u", id);
+            _threads[id] = data;
+        }
+    }
+    return data;
+}
+
+void profiler::set_thread_name(const char* name)
+{
+    thread_data* data = get_thread_data();
+    if(data != nullptr)
+        data->name = name;
+}
+
+void profiler::record(const char* name, uint64_t start, uint64_t end)
+{
+    thread_data* data = get_thread_data();
+    if(data == nullptr)
+        return;
+
+    zone_data& z = data->zones[data->count % ZONES_PER_THREAD];
+    z.name = name;
+    z.start = start;
+    z.end = end;
+    ++data->count;
+}
+
+void profiler::record_gpu(const char* name, uint64_t gpu_start, uint64_t gpu_end, uint64_t cpu_submit)
+{
+    int64_t offset = static_cast<int64_t>(cpu_submit) - static_cast<int64_t>(gpu_start);
+    if(!_gpu_offset_known || offset > _gpu_offset)
+        _gpu_offset = offset;
+    _gpu_offset_known = true;
+
+    zone_data& z = _gpu_zones[_num_gpu_zones % MAX_GPU_ZONES];
+    z.name = name;
+    z.start = gpu_start;
+    z.end = gpu_end;
+    ++_num_gpu_zones;
+}
+
+bool profiler::write_trace(const char* path)
+{
+    FILE* file = fopen(path, "w");
+    if(file == nullptr)
+        return false;
+
+    //note: chrome traces are in microseconds, fractions keep the nanoseconds
+    fprintf(file, "{\"traceEvents\":[\n");
+    fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":\"gpu\"}}", MAX_THREADS);
+
+    uint32_t num_threads = _num_threads < MAX_THREADS ? _num_threads.load() : MAX_THREADS;
+    for( uint32_t i = 0; i < num_threads; ++i)
+    {
+        const thread_data* data = _threads[i];
+        if(data == nullptr)
+            continue;
+
+        fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":\"%s\"}}", i, data->name.c_str());
+
+        uint64_t first = data->count > ZONES_PER_THREAD ? data->count - ZONES_PER_THREAD : 0;
+        for( uint64_t z = first; z < data->count; ++z)
+        {
+            const zone_data& zone = data->zones[z % ZONES_PER_THREAD];
+            fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}", zone.name, i,
+                    zone.start / 1000.0, (zone.end - zone.start) / 1000.0);
+        }
+    }
+
+    uint64_t first = _num_gpu_zones > MAX_GPU_ZONES ? _num_gpu_zones - MAX_GPU_ZONES : 0;
+    for( uint64_t z = first; z < _num_gpu_zones; ++z)
+    {
+        const zone_data& zone = _gpu_zones[z % MAX_GPU_ZONES];
+        int64_t start = static_cast<int64_t>(zone.start) + _gpu_offset;
+        fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}", zone.name, MAX_THREADS,
+                start / 1000.0, (zone.end - zone.start) / 1000.0);
+    }
+
+    fprintf(file, "\n]}\n");
+    fclose(file);
+    return true;
+}
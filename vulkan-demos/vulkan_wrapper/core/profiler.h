@@ -0,0 +1,124 @@
+//
+//  profiler.h
+//  vulkan-demos
+//
+//  Created by Rafael Sabino on 10/19/26.
+//  Copyright © 2026 Rafael Sabino. All rights reserved.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <atomic>
+#include "EASTL/fixed_string.h"
+
+//note: 0 compiles every zone out, PROFILE_ZONE then expands to nothing and command buffers get no timestamps
+#ifndef PROFILER_ENABLED
+#define PROFILER_ENABLED 1
+#endif
+
+#if PROFILER_ENABLED
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+//note: times the rest of the enclosing block.  name has to outlive the profiler, string literals do
+#define PROFILE_ZONE(name) vk::profiler::zone PROFILE_CONCAT(_profile_zone_, __LINE__)(name)
+#else
+#define PROFILE_ZONE(name)
+#endif
+
+namespace vk
+{
+    //note: times zones of cpu work on every thread that opens one.  A zone is a block of code wrapped in PROFILE_ZONE, it is kept
+    //with the thread it ran on, when it started and when it ended.  Every thread writes the zones it closes into a ring of its
+    //own, no locks are taken once a thread has its ring, the oldest zones are overwritten when a ring is full.
+    //
+    //submissions of the graph are timed on the gpu as well, see command_recorder.  Their timestamps are moved onto the clock of
+    //the cpu with the one thing both clocks agree on: a submission never starts on the gpu before it was submitted on the cpu.
+    //
+    //write_trace saves everything in the trace format chrome://tracing and perfetto read, Tracy reads it through its
+    //import-chrome tool.  Zones cost a check of a flag while the profiler is disabled and nothing when it is compiled out
+    class profiler
+    {
+    public:
+
+        static constexpr uint32_t MAX_THREADS = 64u;
+        static constexpr uint32_t ZONES_PER_THREAD = 1u << 16u;
+        static constexpr uint32_t MAX_GPU_ZONES = 1u << 16u;
+
+        class zone
+        {
+        public:
+            zone(const char* name)
+            {
+                if(_enabled)
+                {
+                    _name = name;
+                    _start = now();
+                }
+            }
+
+            ~zone()
+            {
+                if(_name != nullptr)
+                    record(_name, _start, now());
+            }
+
+            zone(const zone&) = delete;
+            zone& operator=(const zone&) = delete;
+
+        private:
+            const char* _name = nullptr;
+            uint64_t    _start = 0;
+        };
+
+        static void set_enabled(bool enabled){ _enabled = enabled; }
+        static bool is_enabled(){ return _enabled; }
+
+        //note: nanoseconds of steady_clock since the profiler was first used.  Its tick is fine enough and, unlike rdtsc, means
+        //the same on every core and on arm
+        static uint64_t now();
+
+        //note: the name the thread calling this gets in the trace, threads that never call it are numbered
+        static void set_thread_name(const char* name);
+
+        static void record(const char* name, uint64_t start, uint64_t end);
+
+        //note: a submission the gpu ran from gpu_start to gpu_end, in nanoseconds of the gpu clock, submitted at cpu_submit
+        static void record_gpu(const char* name, uint64_t gpu_start, uint64_t gpu_end, uint64_t cpu_submit);
+
+        //note: call it while no other thread opens zones, the rings are read without locks.  False if the file could not be
+        //written
+        static bool write_trace(const char* path);
+
+    private:
+
+        struct zone_data
+        {
+            const char* name = nullptr;
+            uint64_t    start = 0;
+            uint64_t    end = 0;
+        };
+
+        struct thread_data
+        {
+            eastl::fixed_string<char, 32, false> name {};
+            //note: zones ever recorded by the thread, the ring holds the last ZONES_PER_THREAD of them
+            uint64_t    count = 0;
+            zone_data   zones[ZONES_PER_THREAD];
+        };
+
+        //note: null once MAX_THREADS threads have a ring, the zones of later threads are dropped
+        static thread_data* get_thread_data();
+
+        static bool _enabled;
+        static std::atomic<uint32_t> _num_threads;
+        static thread_data* _threads[MAX_THREADS];
+
+        //note: written by the thread that waits on fences, the main one
+        static uint64_t _num_gpu_zones;
+        static zone_data _gpu_zones[MAX_GPU_ZONES];
+        //note: the largest cpu_submit - gpu_start seen so far, added to gpu times to put them on the cpu timeline
+        static int64_t _gpu_offset;
+        static bool _gpu_offset_known;
+    };
+}
@@ -23,6 +23,7 @@ namespace  vk
         STORAGE_IMAGE = VkDescriptorType::VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
         UNIFORM_BUFFER = VkDescriptorType::VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
         DYNAMIC_UNIFORM_BUFFER = VkDescriptorType::VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
+        STORAGE_BUFFER = VkDescriptorType::VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
         INPUT_ATTACHMENT = VkDescriptorType::VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT,
         INVALID = VkDescriptorType::VK_DESCRIPTOR_TYPE_MAX_ENUM
     };
@@ -0,0 +1,212 @@
+//
+//  secondary_recorder.cpp
+//  vulkan-demos
+//
+//  Created by Rafael Sabino on 10/19/26.
+//  Copyright © 2026 Rafael Sabino. All rights reserved.
+//
+
+#include "secondary_recorder.h"
+#include "profiler.h"
+#include <algorithm>
+
+using namespace vk;
+
+uint32_t secondary_recorder::_num_threads = secondary_recorder::AUTO_THREADS;
+
+uint32_t secondary_recorder::get_num_threads()
+{
+    if(_num_threads != AUTO_THREADS)
+        return std::min(_num_threads, MAX_THREADS);
+
+    return std::min(MAX_THREADS, std::max(1u, std::thread::hardware_concurrency()));
+}
+
+void secondary_recorder::start_workers(uint32_t count)
+{
+    //note: thread 0 is the main thread, workers start at 1.  They wait for the run after the current one
+    std::lock_guard<std::mutex> lock(_mutex);
+    while(_workers.size() + 1 < count)
+    {
+        uint32_t thread_id = static_cast<uint32_t>(_workers.size() + 1);
+        _workers.push_back(std::thread(&secondary_recorder::work, this, thread_id, _generation));
+    }
+}
+
+void secondary_recorder::begin_frame(uint32_t image_id)
+{
+    EA_ASSERT(image_id < glfw_swapchain::NUM_SWAPCHAIN_IMAGES);
+    _image_id = image_id;
+    _active_threads = get_num_threads();
+    _num_recorded = 0;
+    ++_frame;
+    start_workers(_active_threads);
+
+    for( uint32_t i = 0; i < _active_threads; ++i)
+    {
+        thread_data& t = _threads[i];
+        if(t.pools[image_id] == VK_NULL_HANDLE)
+        {
+            VkCommandPoolCreateInfo pool_info {};
+            pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+            pool_info.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+            pool_info.queueFamilyIndex = _device->_queue_family_indices.graphics_family.value();
+            VkResult result = vkCreateCommandPool(_device->_logical_device, &pool_info, nullptr, &t.pools[image_id]);
+            ASSERT_VULKAN(result);
+        }
+        else
+        {
+            VkResult result = vkResetCommandPool(_device->_logical_device, t.pools[image_id], 0);
+            ASSERT_VULKAN(result);
+        }
+        t.used = 0;
+        t.weight = 0;
+        t.jobs.clear();
+    }
+}
+
+VkCommandBuffer secondary_recorder::add(const VkCommandBufferInheritanceInfo& inheritance, uint32_t weight, record_function function)
+{
+    EA_ASSERT_MSG(_active_threads != 0, "nothing is recorded on other threads while the number of threads is 0");
+    uint32_t thread_id = 0;
+    for( uint32_t i = 1; i < _active_threads; ++i)
+    {
+        if(_threads[i].weight < _threads[thread_id].weight)
+            thread_id = i;
+    }
+
+    //note: allocated here on the main thread, the pool belongs to one thread but nobody records while work is being added
+    thread_data& t = _threads[thread_id];
+    eastl::vector<VkCommandBuffer>& buffers = t.buffers[_image_id];
+    if(t.used == buffers.size())
+    {
+        VkCommandBufferAllocateInfo allocate_info {};
+        allocate_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocate_info.commandPool = t.pools[_image_id];
+        allocate_info.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+        allocate_info.commandBufferCount = 1;
+
+        VkCommandBuffer buffer = VK_NULL_HANDLE;
+        VkResult result = vkAllocateCommandBuffers(_device->_logical_device, &allocate_info, &buffer);
+        ASSERT_VULKAN(result);
+        buffers.push_back(buffer);
+    }
+
+    job j {};
+    j.buffer = buffers[t.used++];
+    j.inheritance = inheritance;
+    j.inheritance.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+    j.inheritance.pNext = nullptr;
+    j.function = eastl::move(function);
+    t.jobs.push_back(eastl::move(j));
+    t.weight += std::max(1u, weight);
+
+    return t.jobs.back().buffer;
+}
+
+void secondary_recorder::record_jobs(uint32_t thread_id)
+{
+    PROFILE_ZONE("secondary_recorder::record_jobs");
+    for( job& j : _threads[thread_id].jobs)
+    {
+        VkCommandBufferBeginInfo begin_info {};
+        begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        //note: not one time submit, the graph submits the same primary command buffer again while nothing changes
+        begin_info.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+        begin_info.pInheritanceInfo = &j.inheritance;
+
+        VkResult result = vkBeginCommandBuffer(j.buffer, &begin_info);
+        ASSERT_VULKAN(result);
+        j.function(j.buffer);
+        result = vkEndCommandBuffer(j.buffer);
+        ASSERT_VULKAN(result);
+    }
+}
+
+void secondary_recorder::work(uint32_t thread_id, uint64_t generation)
+{
+    profiler::set_thread_name("secondary recorder");
+    while(true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _work_available.wait(lock, [&]{ return _quit || _generation != generation; });
+            if(_quit)
+                return;
+            generation = _generation;
+        }
+
+        //note: threads past the ones in use this frame have no jobs, they still check in so run knows everyone is done
+        if(thread_id < _active_threads)
+            record_jobs(thread_id);
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        if(--_remaining == 0)
+            _work_finished.notify_one();
+    }
+}
+
+void secondary_recorder::run()
+{
+    uint32_t recorded = 0;
+    for( uint32_t i = 0; i < _active_threads; ++i)
+    {
+        recorded += static_cast<uint32_t>(_threads[i].jobs.size());
+    }
+    if(recorded == 0)
+        return;
+
+    bool parallel = false;
+    for( uint32_t i = 1; i < _active_threads; ++i)
+    {
+        parallel = parallel || !_threads[i].jobs.empty();
+    }
+
+    if(parallel)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _remaining = static_cast<uint32_t>(_workers.size());
+        ++_generation;
+        _work_available.notify_all();
+    }
+
+    record_jobs(0);
+
+    if(parallel)
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _work_finished.wait(lock, [&]{ return _remaining == 0; });
+    }
+
+    for( uint32_t i = 0; i < _active_threads; ++i)
+    {
+        _threads[i].jobs.clear();
+    }
+    _num_recorded = recorded;
+}
+
+void secondary_recorder::destroy()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _quit = true;
+    }
+    _work_available.notify_all();
+    for( std::thread& worker : _workers)
+    {
+        worker.join();
+    }
+    _workers.clear();
+
+    //note: destroying a pool frees every command buffer allocated from it
+    for( thread_data& t : _threads)
+    {
+        for( uint32_t i = 0; i < glfw_swapchain::NUM_SWAPCHAIN_IMAGES; ++i)
+        {
+            if(t.pools[i] != VK_NULL_HANDLE)
+                vkDestroyCommandPool(_device->_logical_device, t.pools[i], nullptr);
+            t.pools[i] = VK_NULL_HANDLE;
+            t.buffers[i].clear();
+        }
+    }
+}
@@ -0,0 +1,111 @@
+//
+//  secondary_recorder.h
+//  vulkan-demos
+//
+//  Created by Rafael Sabino on 10/19/26.
+//  Copyright © 2026 Rafael Sabino. All rights reserved.
+//
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include "EASTL/array.h"
+#include "EASTL/fixed_vector.h"
+#include "EASTL/vector.h"
+#include "glfw_swapchain.h"
+#include "object.h"
+#include "device.h"
+
+namespace vk
+{
+    //note: records draws into secondary command buffers on several threads.  Every thread has a command pool of its own per
+    //swapchain image, a pool is only ever touched by one thread at a time and is reset as a whole once the fence of its image has
+    //been waited on.
+    //
+    //a frame goes like this: begin_frame, then add for every piece of work (the graph asks every node, see node::prepare), then run,
+    //which records all of them and returns when they are done.  add hands back the command buffer right away so the caller can
+    //execute it from its primary command buffer, in whatever order it likes, once run returned.  Work is handed to threads as it
+    //is added, each piece to the thread with the least work so far
+    class secondary_recorder : public object
+    {
+    public:
+
+        static constexpr uint32_t MAX_THREADS = 16u;
+        //note: picks one thread per core, see set_num_threads
+        static constexpr uint32_t AUTO_THREADS = ~0u;
+
+        using record_function = std::function<void(VkCommandBuffer)>;
+
+        secondary_recorder(device* dev){ _device = dev; }
+
+        //note: 0 records every draw straight into the primary command buffer, like it used to.  Otherwise draws are recorded by
+        //this many threads, the main thread is one of them
+        static void set_num_threads(uint32_t threads){ _num_threads = threads; }
+        static uint32_t get_num_threads();
+
+        //main thread only: image_id's fence has been waited on, its command buffers can be reused.  Called every time the graph
+        //records image_id again, even when nothing is recorded on other threads.  Frames that submit the primary command buffer
+        //as it was don't call it, the secondaries it executes are still in their pools
+        void begin_frame(uint32_t image_id);
+        
+        //note: counts calls to begin_frame, command buffers handed out in an earlier frame are not to be executed
+        inline uint64_t get_frame() const { return _frame; }
+
+        //main thread only: function records into the returned command buffer during the next call to run.  Weight is how much
+        //work function is, objects drawn for instance
+        VkCommandBuffer add(const VkCommandBufferInheritanceInfo& inheritance, uint32_t weight, record_function function);
+
+        //main thread only: records everything added since begin_frame, returns once every command buffer is recorded
+        void run();
+
+        inline uint32_t get_num_recorded() const { return _num_recorded; }
+
+        virtual void destroy() override;
+
+    private:
+
+        struct job
+        {
+            VkCommandBuffer                 buffer = VK_NULL_HANDLE;
+            VkCommandBufferInheritanceInfo  inheritance {};
+            record_function                 function {};
+        };
+
+        struct thread_data
+        {
+            eastl::array<VkCommandPool, glfw_swapchain::NUM_SWAPCHAIN_IMAGES> pools {};
+            //note: every buffer allocated from a pool so far, the first used ones are handed out this frame
+            eastl::array<eastl::vector<VkCommandBuffer>, glfw_swapchain::NUM_SWAPCHAIN_IMAGES> buffers {};
+            uint32_t            used = 0;
+            uint64_t            weight = 0;
+            eastl::vector<job>  jobs {};
+        };
+
+        void start_workers(uint32_t count);
+        void work(uint32_t thread_id, uint64_t generation);
+        void record_jobs(uint32_t thread_id);
+
+        static uint32_t _num_threads;
+
+        device*     _device = nullptr;
+        uint32_t    _image_id = 0;
+        uint32_t    _active_threads = 0;
+        uint32_t    _num_recorded = 0;
+        uint64_t    _frame = 0;
+
+        eastl::array<thread_data, MAX_THREADS> _threads {};
+        eastl::fixed_vector<std::thread, MAX_THREADS, false> _workers {};
+
+        //note: guarded by _mutex
+        std::mutex                  _mutex;
+        std::condition_variable     _work_available;
+        std::condition_variable     _work_finished;
+        uint64_t                    _generation = 0;
+        uint32_t                    _remaining = 0;
+        bool                        _quit = false;
+    };
+}
@@ -8,18 +8,18 @@
 
 #include "material_base.h"
 #include <iostream>
+#include "EASTL/algorithm.h"
+#include "profiler.h"
 
 using namespace vk;
 
+uint32_t material_base::_image_generation = 0;
+
 void material_base::deallocate_parameters()
 {
     for (eastl::pair<parameter_stage , dynamic_buffer_info >& pair : _uniform_dynamic_buffers)
     {
-        vkFreeMemory(_device->_logical_device, pair.second.device_memory, nullptr);
-        vkDestroyBuffer(_device->_logical_device, pair.second.uniform_buffer, nullptr);
-        
-        pair.second.uniform_buffer = VK_NULL_HANDLE;
-        pair.second.device_memory = VK_NULL_HANDLE;
+        destroy_dynamic_buffer(pair.second);
     }
     
     for (eastl::pair<parameter_stage , resource::buffer_info >& pair : _uniform_buffers)
@@ -36,6 +36,71 @@ void material_base::deallocate_parameters()
 }
 
 
+size_t material_base::get_num_bindings()
+{
+    size_t count = _uniform_buffers.size() + _uniform_dynamic_buffers.size();
+    for(eastl::pair<parameter_stage, buffer_parameter >& pair : _sampler_buffers)
+    {
+        count += pair.second.size();
+    }
+    for(eastl::pair<parameter_stage, buffer_parameter >& pair : _storage_buffers)
+    {
+        count += pair.second.size();
+    }
+    return count;
+}
+
+void material_base::create_dynamic_buffer(dynamic_buffer_info& mem, size_t num_objects)
+{
+    EA_ASSERT(mem.device_memory == VK_NULL_HANDLE && mem.uniform_buffer == VK_NULL_HANDLE);
+    EA_ASSERT(mem.parameters_size != 0 && num_objects != 0);
+    
+    mem.capacity = num_objects;
+    mem.size = mem.parameters_size * num_objects;
+    create_buffer(_device->_logical_device, _device->_physical_device, mem.size, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, mem.uniform_buffer,
+                  VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, mem.device_memory);
+    
+    VkResult result = vkMapMemory(_device->_logical_device, mem.device_memory, 0, VK_WHOLE_SIZE, 0, &mem.mapped_memory);
+    ASSERT_VULKAN(result);
+}
+
+void material_base::destroy_dynamic_buffer(dynamic_buffer_info& mem)
+{
+    if(mem.mapped_memory != nullptr)
+        vkUnmapMemory(_device->_logical_device, mem.device_memory);
+    
+    vkFreeMemory(_device->_logical_device, mem.device_memory, nullptr);
+    vkDestroyBuffer(_device->_logical_device, mem.uniform_buffer, nullptr);
+    
+    mem.uniform_buffer = VK_NULL_HANDLE;
+    mem.device_memory = VK_NULL_HANDLE;
+    mem.mapped_memory = nullptr;
+    mem.capacity = 0;
+}
+
+void material_base::write_dynamic_descriptor(dynamic_buffer_info& mem)
+{
+    VkDescriptorBufferInfo descriptor_buffer_info {};
+    descriptor_buffer_info.buffer = mem.uniform_buffer;
+    descriptor_buffer_info.offset = 0;
+    descriptor_buffer_info.range = mem.parameters_size;
+    
+    VkWriteDescriptorSet write_descriptor_set {};
+    write_descriptor_set.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write_descriptor_set.pNext = nullptr;
+    write_descriptor_set.dstSet = _descriptor_set;
+    write_descriptor_set.dstBinding = mem.binding;
+    write_descriptor_set.dstArrayElement = 0;
+    write_descriptor_set.descriptorCount = 1;
+    write_descriptor_set.descriptorType = static_cast<VkDescriptorType>(mem.usage_type);
+    write_descriptor_set.pImageInfo = nullptr;
+    write_descriptor_set.pBufferInfo = &descriptor_buffer_info;
+    write_descriptor_set.pTexelBufferView = nullptr;
+    
+    vkUpdateDescriptorSets(_device->_logical_device, 1, &write_descriptor_set, 0, nullptr);
+    ++_descriptor_writes;
+}
+
 void material_base::create_descriptor_sets()
 {
     VkDescriptorSetAllocateInfo descriptor_set_allocate_info = {};
@@ -51,12 +116,16 @@ void material_base::create_descriptor_sets()
 
         VkResult result = vkAllocateDescriptorSets(_device->_logical_device, &descriptor_set_allocate_info, &_descriptor_set);
         ASSERT_VULKAN(result);
-        eastl::array<VkWriteDescriptorSet,BINDING_MAX> write_descriptor_sets;
+        //note: sized up front, the writes point into the infos
+        size_t num_bindings = get_num_bindings();
+        eastl::fixed_vector<VkWriteDescriptorSet, BINDING_MAX, true> write_descriptor_sets(num_bindings);
 
-        eastl::array<VkDescriptorBufferInfo, BINDING_MAX> descriptor_buffer_infos;
-        eastl::array<VkDescriptorImageInfo, BINDING_MAX>  descriptor_image_infos;
+        eastl::fixed_vector<VkDescriptorBufferInfo, BINDING_MAX, true> descriptor_buffer_infos(num_bindings);
+        eastl::fixed_vector<VkDescriptorImageInfo, BINDING_MAX, true>  descriptor_image_infos(num_bindings);
 
         int count = 0;
+        _image_views.clear();
+        _image_views_generation = _image_generation;
 
         for(eastl::pair<parameter_stage, sampler_parameter >& pair : _sampler_parameters)
         {
@@ -65,6 +134,7 @@ void material_base::create_descriptor_sets()
               EA_ASSERT_FORMATTED( pair2.second.get_image()->get_image_view() != VK_NULL_HANDLE, ("Image parameter '%s' has not been initialized", pair2.first));
               descriptor_image_infos[count].sampler = pair2.second.get_image()->get_sampler();
               descriptor_image_infos[count].imageView = pair2.second.get_image()->get_image_view();
+              _image_views.push_back(descriptor_image_infos[count].imageView);
               
               parameter_stage stage = pair.first;
               const char* name = pair2.first;
@@ -85,8 +155,6 @@ void material_base::create_descriptor_sets()
               write_descriptor_sets[count].pTexelBufferView = nullptr;
               
               ++count;
-              
-              EA_ASSERT( count < BINDING_MAX);
           }
         }
 
@@ -112,7 +180,6 @@ void material_base::create_descriptor_sets()
           write_descriptor_sets[count].pTexelBufferView = nullptr;
           
           ++count;
-          EA_ASSERT( count < BINDING_MAX);
         }
 
         for (eastl::pair<parameter_stage , material_base::dynamic_buffer_info >& pair : _uniform_dynamic_buffers)
@@ -137,17 +204,95 @@ void material_base::create_descriptor_sets()
           write_descriptor_sets[count].pTexelBufferView = nullptr;
           
           ++count;
-          EA_ASSERT( count < BINDING_MAX);
         }
 
+        for (eastl::pair<parameter_stage , buffer_parameter >& pair : _storage_buffers)
+        {
+            for(eastl::pair<const char*, buffer_info>& pair2 : pair.second)
+            {
+                EA_ASSERT(usage_type::STORAGE_BUFFER == pair2.second.usage_type);
+                
+                descriptor_buffer_infos[count].buffer = pair2.second.uniform_buffer;
+                descriptor_buffer_infos[count].offset = 0;
+                descriptor_buffer_infos[count].range = pair2.second.size;
+                
+                write_descriptor_sets[count].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                write_descriptor_sets[count].pNext = nullptr;
+                write_descriptor_sets[count].dstSet = _descriptor_set;
+                
+                write_descriptor_sets[count].dstBinding = _descriptor_set_layout_bindings[count].binding;
+                write_descriptor_sets[count].dstArrayElement = 0;
+                write_descriptor_sets[count].descriptorCount = 1;
+                write_descriptor_sets[count].descriptorType = static_cast<VkDescriptorType>(pair2.second.usage_type);
+                write_descriptor_sets[count].pImageInfo = nullptr;
+                write_descriptor_sets[count].pBufferInfo = &descriptor_buffer_infos[count];
+                write_descriptor_sets[count].pTexelBufferView = nullptr;
+                
+                ++count;
+            }
+        }
+
+        EA_ASSERT(count == num_bindings);
         vkUpdateDescriptorSets(_device->_logical_device, count, write_descriptor_sets.data(), 0, nullptr);
+        ++_descriptor_writes;
     }
 
 }
 
+//note: streamed textures replace their image when their resident mip level changes, see texture_streamer.h.  Materials are
+//committed once the fence of their swapchain image is waited on, the gpu is not using this descriptor set
+void material_base::refresh_image_descriptors()
+{
+    if(_descriptor_set == VK_NULL_HANDLE)
+        return;
+    
+    eastl::fixed_vector<VkWriteDescriptorSet, BINDING_MAX, true> write_descriptor_sets {};
+    eastl::fixed_vector<VkDescriptorImageInfo, BINDING_MAX, true> descriptor_image_infos(_image_views.size());
+    
+    bool rewrite_all = _image_views_generation != _image_generation;
+    _image_views_generation = _image_generation;
+    
+    uint32_t count = 0;
+    for(eastl::pair<parameter_stage, sampler_parameter >& pair : _sampler_parameters)
+    {
+        for( eastl::pair<const char*, shader_parameter>& pair2 : pair.second)
+        {
+            image* texture = pair2.second.get_image();
+            if(rewrite_all || texture->get_image_view() != _image_views[count])
+            {
+                parameter_stage stage = pair.first;
+                const char* name = pair2.first;
+                
+                _image_views[count] = texture->get_image_view();
+                descriptor_image_infos[count].sampler = texture->get_sampler();
+                descriptor_image_infos[count].imageView = texture->get_image_view();
+                descriptor_image_infos[count].imageLayout = static_cast<VkImageLayout>(texture->get_usage_layout(_sampler_buffers[stage][name].usage_type));
+                
+                VkWriteDescriptorSet write {};
+                write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                write.dstSet = _descriptor_set;
+                write.dstBinding = _descriptor_set_layout_bindings[count].binding;
+                write.dstArrayElement = 0;
+                write.descriptorCount = 1;
+                write.descriptorType = static_cast<VkDescriptorType>(_sampler_buffers[stage][name].usage_type);
+                write.pImageInfo = &descriptor_image_infos[count];
+                write_descriptor_sets.push_back(write);
+            }
+            ++count;
+        }
+    }
+    
+    if(!write_descriptor_sets.empty())
+    {
+        vkUpdateDescriptorSets(_device->_logical_device, static_cast<uint32_t>(write_descriptor_sets.size()),
+                               write_descriptor_sets.data(), 0, nullptr);
+        ++_descriptor_writes;
+    }
+}
+
 void material_base::create_descriptor_pool()
 {
-    eastl::array<VkDescriptorPoolSize, BINDING_MAX> descriptor_pool_sizes;
+    eastl::fixed_vector<VkDescriptorPoolSize, BINDING_MAX, true> descriptor_pool_sizes(get_num_bindings());
     
     int count = 0;
     _samplers_added_on_init = 0;
@@ -159,7 +304,6 @@ void material_base::create_descriptor_pool()
             descriptor_pool_sizes[count].descriptorCount = 1;
             _samplers_added_on_init++;
             ++count;
-            EA_ASSERT(count < BINDING_MAX);
         }
     }
     
@@ -169,7 +313,6 @@ void material_base::create_descriptor_pool()
         descriptor_pool_sizes[count].descriptorCount = 1;
         
         ++count;
-        EA_ASSERT(count < BINDING_MAX);
     }
     
     for( eastl::pair<parameter_stage, dynamic_buffer_info >& pair : _uniform_dynamic_buffers)
@@ -179,6 +322,16 @@ void material_base::create_descriptor_pool()
         ++count;
     }
     
+    for(eastl::pair<parameter_stage, buffer_parameter >& pair : _storage_buffers)
+    {
+        for(eastl::pair<const char*, buffer_info>& pair2: pair.second)
+        {
+            descriptor_pool_sizes[count].type = static_cast<VkDescriptorType>(pair2.second.usage_type);
+            descriptor_pool_sizes[count].descriptorCount = 1;
+            ++count;
+        }
+    }
+    
     //assert(count != 0 && "shaders need some sort of input (samplers/uniform buffers)");
     if(count != 0)
     {
@@ -200,6 +353,8 @@ void material_base::create_descriptor_pool()
 void material_base::create_descriptor_set_layout()
 {
     int count = 0;
+    _descriptor_set_layout_bindings.clear();
+    _descriptor_set_layout_bindings.resize(get_num_bindings());
     
     //note: always go through the sampler buffers first, then the uniform buffers because
     //the descriptor bindings will be set up this way.
@@ -214,7 +369,6 @@ void material_base::create_descriptor_set_layout()
             _descriptor_set_layout_bindings[count].pImmutableSamplers = nullptr;
             
             ++count;
-            EA_ASSERT(BINDING_MAX > count);
         }
     }
     
@@ -226,7 +380,6 @@ void material_base::create_descriptor_set_layout()
         _descriptor_set_layout_bindings[count].stageFlags = static_cast<VkShaderStageFlagBits>(pair.first);
         _descriptor_set_layout_bindings[count].pImmutableSamplers = nullptr;
         ++count;
-        EA_ASSERT(BINDING_MAX > count);
     }
     
     for( eastl::pair<parameter_stage, dynamic_buffer_info > &pair : _uniform_dynamic_buffers )
@@ -237,7 +390,21 @@ void material_base::create_descriptor_set_layout()
         _descriptor_set_layout_bindings[count].stageFlags = static_cast<VkShaderStageFlagBits>(pair.first);
         _descriptor_set_layout_bindings[count].pImmutableSamplers = nullptr;
         ++count;
-        EA_ASSERT(BINDING_MAX > count);
+    }
+    
+    //note: storage buffers go last, create_descriptor_sets walks them in the same order
+    for (eastl::pair<parameter_stage , buffer_parameter > &pair : _storage_buffers)
+    {
+        for(eastl::pair<const char*, buffer_info>& pair2 : pair.second)
+        {
+            _descriptor_set_layout_bindings[count].binding = pair2.second.binding;
+            _descriptor_set_layout_bindings[count].descriptorType = static_cast<VkDescriptorType>(pair2.second.usage_type);
+            _descriptor_set_layout_bindings[count].descriptorCount = 1;
+            _descriptor_set_layout_bindings[count].stageFlags = static_cast<VkShaderStageFlagBits>(pair.first);
+            _descriptor_set_layout_bindings[count].pImmutableSamplers = nullptr;
+            
+            ++count;
+        }
     }
     
     VkDescriptorSetLayoutCreateInfo descriptor_set_layout_create_info = {};
@@ -289,8 +456,9 @@ void material_base::destroy()
 void material_base::init_shader_parameters()
 {
     size_t total_size = 0;
-    EA_ASSERT_FORMATTED((_uniform_parameters.size() != 0 || _uniform_dynamic_buffers.size() != 0 ||  _sampler_parameters.size() != 0),
-                  ("No inputs (uniform params, uniform dynamic params, samplers) where created for material %s", _name));
+    EA_ASSERT_FORMATTED((_uniform_parameters.size() != 0 || _uniform_dynamic_buffers.size() != 0 ||  _sampler_parameters.size() != 0 ||
+                         _storage_buffers.size() != 0),
+                  ("No inputs (uniform params, uniform dynamic params, samplers, storage buffers) where created for material %s", _name));
     _uniform_parameters_added_on_init = 0;
     //note: textures don't need to be initialized here because the texture classes take care of that
     for (eastl::pair<parameter_stage , buffer_info > &pair : _uniform_buffers)
@@ -301,7 +469,7 @@ void material_base::init_shader_parameters()
         {
 //            std::string_view name = pair.first;
 //            std::cout << name << std::endl;
-            shader_parameter setting = pair.second;
+            shader_parameter& setting = pair.second;
             total_size += setting.get_max_std140_aligned_size_in_bytes();
             ++_uniform_parameters_added_on_init;
         }
@@ -328,26 +496,17 @@ void material_base::init_shader_parameters()
         shader_parameter::shader_params_group& group = obj_group[0];
         for (eastl::pair<string_key_type, shader_parameter >& pair : group)
         {
-            shader_parameter setting = pair.second;
+            shader_parameter& setting = pair.second;
             total_size += setting.get_max_std140_aligned_size_in_bytes();
         }
         EA_ASSERT(total_size != 0);
         total_size = get_ubo_alignment(total_size);
         mem.parameters_size = total_size;
-        total_size *= obj_group.size() ;
-
-        
-        _uniform_dynamic_buffers[pair.first].size = total_size;
         
-        if(total_size != 0)
-        {
-            EA_ASSERT(mem.device_memory == VK_NULL_HANDLE && mem.uniform_buffer == VK_NULL_HANDLE);
-            create_buffer(_device->_logical_device, _device->_physical_device, total_size, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, mem.uniform_buffer,
-                          VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, mem.device_memory);
-        }
+        create_dynamic_buffer(mem, obj_group.size());
         
+        //note: the object group is not frozen, objects can be added later on and the buffer grows to fit them
         group.freeze();
-        obj_group.freeze();
         total_size = 0;
     }
     
@@ -387,8 +546,67 @@ void material_base::set_image_sampler(texture_3d* texture, const char* parameter
     set_image_sampler(static_cast<image*>(texture), parameter_name, stage, binding,usage);
 }
 
+void material_base::set_storage_buffer(storage_buffer* buffer, const char* parameter_name, parameter_stage stage, uint32_t binding)
+{
+    EA_ASSERT_MSG( buffer->is_initialized(), "This storage buffer has not been created.  Call 'create' on the buffer");
+    buffer_info& mem = _storage_buffers[stage][parameter_name];
+    mem.binding = binding;
+    mem.usage_type = usage_type::STORAGE_BUFFER;
+    mem.uniform_buffer = buffer->get_vk_buffer();
+    mem.size = buffer->get_size();
+    _storage_sources[stage][parameter_name] = buffer;
+}
+
+//note: like refresh_image_descriptors, the material is committed once the fence of its swapchain image was waited on
+void material_base::refresh_storage_descriptors()
+{
+    eastl::fixed_vector<VkWriteDescriptorSet, BINDING_MAX, true> write_descriptor_sets {};
+    eastl::fixed_vector<VkDescriptorBufferInfo, BINDING_MAX, true> descriptor_buffer_infos {};
+    descriptor_buffer_infos.reserve(get_num_bindings());
+    
+    for(eastl::pair<parameter_stage, storage_source_parameter>& pair : _storage_sources)
+    {
+        for(eastl::pair<const char*, storage_buffer*>& pair2 : pair.second)
+        {
+            buffer_info& mem = _storage_buffers[pair.first][pair2.first];
+            storage_buffer* buffer = pair2.second;
+            if(buffer->get_vk_buffer() == mem.uniform_buffer && buffer->get_size() == mem.size)
+                continue;
+            
+            mem.uniform_buffer = buffer->get_vk_buffer();
+            mem.size = buffer->get_size();
+            if(_descriptor_set == VK_NULL_HANDLE)
+                continue;
+            
+            VkDescriptorBufferInfo info {};
+            info.buffer = mem.uniform_buffer;
+            info.offset = 0;
+            info.range = mem.size;
+            descriptor_buffer_infos.push_back(info);
+            
+            VkWriteDescriptorSet write {};
+            write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            write.dstSet = _descriptor_set;
+            write.dstBinding = mem.binding;
+            write.dstArrayElement = 0;
+            write.descriptorCount = 1;
+            write.descriptorType = static_cast<VkDescriptorType>(mem.usage_type);
+            write.pBufferInfo = &descriptor_buffer_infos.back();
+            write_descriptor_sets.push_back(write);
+        }
+    }
+    
+    if(!write_descriptor_sets.empty())
+    {
+        vkUpdateDescriptorSets(_device->_logical_device, static_cast<uint32_t>(write_descriptor_sets.size()),
+                               write_descriptor_sets.data(), 0, nullptr);
+        ++_descriptor_writes;
+    }
+}
+
 void material_base::commit_dynamic_parameters_to_gpu()
 {
+    PROFILE_ZONE("material_base::commit_dynamic_parameters_to_gpu");
     //todo: we should implement this so that only those objects that have updated get updated, not the whole list of them
     
     EA_ASSERT(_uniform_dynamic_parameters.size() == 0 || _uniform_dynamic_parameters.size() == 1 && "only support 1 dynamic uniform buffer");
@@ -400,9 +618,17 @@ void material_base::commit_dynamic_parameters_to_gpu()
         
         EA_ASSERT(mem.device_memory != VK_NULL_HANDLE);
         
-        void* data = nullptr;
-        //todo: avoid mapping every time this function gets called
-        vkMapMemory(_device->_logical_device, mem.device_memory, 0, mem.size, 0, &data);
+        //note: objects were added since the buffer was made, it doubles so that a scene that keeps growing doesn't reallocate
+        //every frame.  Materials are committed when recording, after the fence of their swapchain image, the gpu is done with it
+        if(pair.second.size() > mem.capacity)
+        {
+            size_t capacity = eastl::max(pair.second.size(), mem.capacity * 2);
+            destroy_dynamic_buffer(mem);
+            create_dynamic_buffer(mem, capacity);
+            write_dynamic_descriptor(mem);
+        }
+        
+        void* data = mem.mapped_memory;
         u_char* start = static_cast<u_char*>(data);
         size_t mem_size = (mem.size);
     
@@ -423,27 +649,29 @@ void material_base::commit_dynamic_parameters_to_gpu()
             EA_ASSERT(prev_obj_parameters_count == 0 || prev_obj_parameters_count == uniform_parameters_count && "not all objects have the same amount of dynamic parameters...");
             prev_obj_parameters_count = uniform_parameters_count;
             uniform_parameters_count = 0;
-            start += get_dynamic_ubo_stride();
+            start += mem.parameters_size;
             
             pair2.second.freeze();
-            pair.second.freeze();
         }
         
         VkMappedMemoryRange mapped_memory_range {};
         mapped_memory_range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
         mapped_memory_range.memory = mem.device_memory;
-        mapped_memory_range.size = mem.size;
+        mapped_memory_range.offset = 0;
+        mapped_memory_range.size = VK_WHOLE_SIZE;
         
         vkFlushMappedMemoryRanges(_device->_logical_device, 1, &mapped_memory_range);
-        
-        vkUnmapMemory(_device->_logical_device, mem.device_memory);
     }
 }
 
 void material_base::commit_parameters_to_gpu( )
 {
+    PROFILE_ZONE("material_base::commit_parameters_to_gpu");
+    refresh_storage_descriptors();
     if(!_initialized)
         init_shader_parameters();
+    else
+        refresh_image_descriptors();
     
     uint32_t uniform_parameters_count = 0;
     for (eastl::pair<parameter_stage , shader_parameter::shader_params_group >& pair : _uniform_parameters)
@@ -12,8 +12,11 @@
 #include "shader_parameter.h"
 #include "ordered_map.h"
 #include "depth_texture.h"
+#include "storage_buffer.h"
+#include "arena.h"
 
 #include "EASTL/array.h"
+#include "EASTL/fixed_vector.h"
 #include "EASTL/shared_ptr.h"
 #include <assert.h>
 
@@ -64,12 +67,19 @@ namespace vk
         void commit_dynamic_parameters_to_gpu();
         void print_uniform_argument_names();
         
+        //note: every material writes all of its image descriptors again the next time it is committed.  Views of images that were
+        //destroyed and made again (i.e. render targets of a window that was resized) can get the handle the old view had
+        static inline void invalidate_image_descriptors(){ ++_image_generation; }
+        
     protected:
         void init_shader_parameters();
         void create_descriptor_set_layout();
         void create_descriptor_pool();
         void create_descriptor_sets();
+        void refresh_image_descriptors();
+        void refresh_storage_descriptors();
         void deallocate_parameters();
+        size_t get_num_bindings();
         
         inline size_t get_ubo_alignment( size_t mem_size )
         {
@@ -83,6 +93,9 @@ namespace vk
         inline VkDescriptorSetLayout* get_descriptor_set_layout(){ return &_descriptor_set_layout; }
         inline VkDescriptorSet* get_descriptor_set(){ return &_descriptor_set; }
         
+        //note: counts updates to the descriptor set, command buffers recorded before the last one can't be submitted again
+        inline uint64_t get_descriptor_writes(){ return _descriptor_writes; }
+        
         
         inline size_t get_num_dynamic_buffer_elements(){ return _uniform_dynamic_buffers.size(); }
         
@@ -91,10 +104,9 @@ namespace vk
             uint32_t bytes = 0;
             //todo: we only support one uniform dynamic buffer per material, but I think that's all we need....
             assert(_uniform_dynamic_parameters.size() == 0 || _uniform_dynamic_parameters.size() == 1);
-            for(eastl::pair<parameter_stage, object_shader_params_group> pair : _uniform_dynamic_parameters)
+            for(eastl::pair<parameter_stage, dynamic_buffer_info>& pair : _uniform_dynamic_buffers)
             {
-                dynamic_buffer_info& mem = _uniform_dynamic_buffers[pair.first];
-                bytes = static_cast<uint32_t>(mem.size / pair.second.size() );
+                bytes = static_cast<uint32_t>(pair.second.parameters_size);
             }
             
             return bytes;
@@ -109,6 +121,9 @@ namespace vk
         void set_image_smapler(texture_2d* texture, const char* parameter_name, parameter_stage stage, uint32_t binding, usage_type usage);
         void set_image_sampler(texture_3d* texture, const char* parameter_name, parameter_stage stage, uint32_t binding, usage_type usage);
         void set_vec4_array(glm::vec4* vec4s, size_t, const char* parameter_name, parameter_stage stage, uint32_t binding, usage_type usage);
+        void set_storage_buffer(storage_buffer* buffer, const char* parameter_name, parameter_stage stage, uint32_t binding);
+        
+        static const size_t MAX_SHADER_STAGES = 2;
         
         virtual VkPipelineShaderStageCreateInfo* get_shader_stages() = 0;
         virtual size_t get_shader_stages_size() = 0;
@@ -129,19 +144,27 @@ namespace vk
             using object_shader_params_group = ordered_map<uint32_t, shader_parameter::shader_params_group >  ;
     protected:
         
+        //note: parameters_size is the stride of one object, the buffer has room for capacity objects.  It stays mapped
         struct dynamic_buffer_info : public resource::buffer_info
         {
             shader_parameter::Type type = shader_parameter::Type::NONE;
             size_t parameters_size = 0;
+            size_t capacity = 0;
+            void* mapped_memory = nullptr;
             dynamic_buffer_info()
             {}
         };
         
+        void create_dynamic_buffer(dynamic_buffer_info& mem, size_t num_objects);
+        void destroy_dynamic_buffer(dynamic_buffer_info& mem);
+        void write_dynamic_descriptor(dynamic_buffer_info& mem);
+        
         VkDescriptorSetLayout _descriptor_set_layout =  VK_NULL_HANDLE;
         VkDescriptorPool      _descriptor_pool =        VK_NULL_HANDLE;
         VkDescriptorSet       _descriptor_set =         VK_NULL_HANDLE;
         
-        //TODO: check out the VkPhysicalDeviceLimits structure: https://vulkan.lunarg.com/doc/view/1.0.30.0/linux/vkspec.chunked/ch31s02.html
+        //note: bindings kept inline, materials with more grow.  The device limits are in VkPhysicalDeviceLimits:
+        //https://vulkan.lunarg.com/doc/view/1.0.30.0/linux/vkspec.chunked/ch31s02.html
         static const int BINDING_MAX = 30;
         
         ordered_map<parameter_stage, resource::buffer_info>                       _uniform_buffers;
@@ -161,13 +184,24 @@ namespace vk
         
         typedef ordered_map< const char*, shader_parameter>                      sampler_parameter;
         ordered_map<parameter_stage, sampler_parameter>                          _sampler_parameters;
-        eastl::array<VkDescriptorSetLayoutBinding, BINDING_MAX>                    _descriptor_set_layout_bindings;
         
-        static const size_t MAX_SHADER_STAGES = 2;
+        //note: storage buffers are owned by the client, the material only keeps track of the vulkan handles
+        ordered_map<parameter_stage, buffer_parameter>                      _storage_buffers;
+        //note: the buffer every storage binding was set with.  Buffers that grow (see instance_pool.h) are made again with a
+        //new handle, the descriptor is written again the next time the material is committed
+        typedef ordered_map<const char*, storage_buffer*>                   storage_source_parameter;
+        ordered_map<parameter_stage, storage_source_parameter>              _storage_sources;
+        eastl::fixed_vector<VkDescriptorSetLayoutBinding, BINDING_MAX, true, arena_allocator>   _descriptor_set_layout_bindings;
+        //note: the view every image binding was last written with, in the order of _sampler_parameters
+        eastl::fixed_vector<VkImageView, BINDING_MAX, true>                 _image_views;
+        uint32_t                                                            _image_views_generation = 0;
+        static uint32_t                                                     _image_generation;
+        
         eastl::array<VkPipelineShaderStageCreateInfo, MAX_SHADER_STAGES>           _pipeline_shader_stages;
         
         bool _initialized = false;
         device* _device = nullptr;
+        uint64_t _descriptor_writes = 0;
         
         uint32_t _uniform_parameters_added_on_init = 0;
         uint32_t _uniform_dynamic_parameters_added_on_init = 0;
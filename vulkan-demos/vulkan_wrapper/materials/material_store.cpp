@@ -51,6 +51,10 @@ void material_store::create(device* device)
     shader_shared_ptr clear_3d_texture_comp =  add_shader("compute/clear_3d_texture.comp", shader::shader_type::COMPUTE);
     shader_shared_ptr avg_texture_comp = add_shader("compute/downsize.comp", shader::shader_type::COMPUTE);
     shader_shared_ptr lut_comp =  add_shader("compute/lut.comp", shader::shader_type::COMPUTE);
+    shader_shared_ptr frustum_cull_comp = add_shader("compute/frustum_cull.comp", shader::shader_type::COMPUTE);
+    shader_shared_ptr occlusion_cull_early_comp = add_shader("compute/occlusion_cull_early.comp", shader::shader_type::COMPUTE);
+    shader_shared_ptr occlusion_cull_late_comp = add_shader("compute/occlusion_cull_late.comp", shader::shader_type::COMPUTE);
+    shader_shared_ptr depth_pyramid_comp = add_shader("compute/depth_pyramid.comp", shader::shader_type::COMPUTE);
     
     
     shader_shared_ptr gauss_blur_vert = add_shader("graphics/gaussblur.vert", shader::shader_type::VERTEX);
@@ -75,7 +79,13 @@ void material_store::create(device* device)
     mat_shared_ptr fxaa_mat = CREATE_MAT<visual_material>("fxaa", fxaa_vert, fxaa_frag, device);
     add_material(fxaa_mat);
 
-    
+    shader_shared_ptr upscale_vert = add_shader("graphics/upscale.vert", shader::shader_type::VERTEX);
+    shader_shared_ptr upscale_frag = add_shader("graphics/upscale.frag", shader::shader_type::FRAGMENT);
+
+    mat_shared_ptr upscale_mat = CREATE_MAT<visual_material>("upscale", upscale_vert, upscale_frag, device);
+    add_material(upscale_mat);
+
+
     shader_shared_ptr env_brdf_vert = add_shader("graphics/environment_brdf.vert", shader::shader_type::VERTEX);
     shader_shared_ptr env_brdf_frag = add_shader("graphics/environment_brdf.frag", shader::shader_type::FRAGMENT);
     
@@ -140,6 +150,18 @@ void material_store::create(device* device)
     
     mat_shared_ptr lut_mat = CREATE_MAT<compute_material>("color_lut", lut_comp, device);
     add_material(lut_mat);
+    
+    mat_shared_ptr frustum_cull_mat = CREATE_MAT<compute_material>("frustum_cull", frustum_cull_comp, device);
+    add_material(frustum_cull_mat);
+    
+    mat_shared_ptr occlusion_cull_early_mat = CREATE_MAT<compute_material>("occlusion_cull_early", occlusion_cull_early_comp, device);
+    add_material(occlusion_cull_early_mat);
+    
+    mat_shared_ptr occlusion_cull_late_mat = CREATE_MAT<compute_material>("occlusion_cull_late", occlusion_cull_late_comp, device);
+    add_material(occlusion_cull_late_mat);
+    
+    mat_shared_ptr depth_pyramid_mat = CREATE_MAT<compute_material>("depth_pyramid", depth_pyramid_comp, device);
+    add_material(depth_pyramid_mat);
 
 }
 
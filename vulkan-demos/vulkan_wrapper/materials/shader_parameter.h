@@ -22,6 +22,7 @@
 #include "EASTL/array.h"
 #include <map>
 #include "ordered_map.h"
+#include "arena.h"
 
 /// <summary> Represents a setting for a material that can be used for a shader </summary>
 
@@ -33,11 +34,13 @@ namespace vk
     {
         
     private:
-        static constexpr size_t MAX_UNIFORM_BUFFER_SIZE = 512;
+        //note: arrays live in the persistent arena, a parameter only holds on to them.  Copies of a parameter get an array of
+        //their own (materials are copied, see material_store::get_material), a parameter that is moved hands its array over
         struct values_array
         {
-            char* memory[MAX_UNIFORM_BUFFER_SIZE] {};
-            size_t num_elements = 0;
+            glm::vec4* memory;
+            uint32_t num_elements;
+            uint32_t capacity;
         };
         
     public:
@@ -84,7 +87,9 @@ namespace vk
             
             setting_value()
             {
-                buffer = {};
+                buffer.memory = nullptr;
+                buffer.num_elements = 0;
+                buffer.capacity = 0;
             }
             
         };
@@ -104,6 +109,55 @@ namespace vk
         shader_parameter():value(),type(Type::NONE)
         {}
         
+        shader_parameter(const shader_parameter& other):value(),type(Type::NONE)
+        {
+            *this = other;
+        }
+        
+        shader_parameter(shader_parameter&& other):value(other.value),type(other.type),name(other.name)
+        {
+            if(other.type == Type::VEC4_ARRAY)
+                other.value = setting_value();
+        }
+        
+        //note: the array this parameter had is written over when it is big enough
+        shader_parameter& operator=(const shader_parameter& other)
+        {
+            if(this == &other)
+                return *this;
+            
+            values_array own {};
+            if(type == Type::VEC4_ARRAY)
+                own = value.buffer;
+            
+            type = other.type;
+            name = other.name;
+            if(type != Type::VEC4_ARRAY)
+            {
+                value = other.value;
+                return *this;
+            }
+            
+            value.buffer = own;
+            glm::vec4* data = reserve_vectors(other.value.buffer.num_elements);
+            if(other.value.buffer.num_elements != 0)
+                std::memcpy(data, other.value.buffer.memory, other.value.buffer.num_elements * sizeof(glm::vec4));
+            return *this;
+        }
+        
+        shader_parameter& operator=(shader_parameter&& other)
+        {
+            if(this == &other)
+                return *this;
+            
+            value = other.value;
+            type = other.type;
+            name = other.name;
+            if(other.type == Type::VEC4_ARRAY)
+                other.value = setting_value();
+            return *this;
+        }
+        
         //the size returned here should be big enough ( safe enough) to store whatever bytes we pass it.
         static size_t aligned_size(size_t alignment, size_t bytes)
         {
@@ -238,7 +292,7 @@ namespace vk
             char* ptr = nullptr;
             if(type == Type::VEC4_ARRAY)
             {
-                glm::vec4* vecs = reinterpret_cast<glm::vec4*>(value.buffer.memory);
+                glm::vec4* vecs = value.buffer.memory;
                 for(size_t i = 0; i < value.buffer.num_elements; ++i)
                 {
                     void* result = std::align( get_std140_alignment(), sizeof(glm::vec4), p, mem_size);
@@ -319,13 +373,25 @@ namespace vk
             return static_cast<image*>(value.sampler3D);
         }
         
-        inline void set_vectors_array(const glm::vec4* vecs, size_t num_vectors)
+        //note: the array is allocated the first time it is set and whenever it gets bigger, setting it again every frame with the
+        //same size writes over it
+        inline glm::vec4* reserve_vectors(size_t num_vectors)
         {
             EA_ASSERT( type == Type::NONE || type == Type::VEC4_ARRAY);
             type = Type::VEC4_ARRAY;
-            value.buffer.num_elements = num_vectors;
-            void* data = reinterpret_cast<void*>(value.buffer.memory);
-            EA_ASSERT((value.buffer.num_elements * sizeof(glm::vec4)) < MAX_UNIFORM_BUFFER_SIZE);
+            if(num_vectors > value.buffer.capacity)
+            {
+                value.buffer.memory = static_cast<glm::vec4*>(arena::get_persistent().allocate(num_vectors * sizeof(glm::vec4), alignof(glm::vec4)));
+                value.buffer.capacity = static_cast<uint32_t>(num_vectors);
+            }
+            value.buffer.num_elements = static_cast<uint32_t>(num_vectors);
+            
+            return value.buffer.memory;
+        }
+        
+        inline void set_vectors_array(const glm::vec4* vecs, size_t num_vectors)
+        {
+            glm::vec4* data = reserve_vectors(num_vectors);
             std::memcpy(data, &vecs[0], num_vectors * sizeof(glm::vec4));
         }
         
@@ -334,17 +400,12 @@ namespace vk
         {
             //note: as  you can see here int arrays are actually vec4 arrays due to the layout we've chosen for parameters to shaders (std140).
             //If you can avoid int arrays as arguments to shaders, due so.  There is lots of memory that doesn't get used
-            EA_ASSERT( type == Type::NONE || type == Type::VEC4_ARRAY);
-            type = Type::VEC4_ARRAY;
-            value.buffer.num_elements = arr.size();
-            void* data = reinterpret_cast<void*>(value.buffer.memory);
-            EA_ASSERT((value.buffer.num_elements * sizeof(glm::vec4)) < MAX_UNIFORM_BUFFER_SIZE);
+            glm::vec4* data = reserve_vectors(arr.size());
+            std::memset(data, 0, arr.size() * sizeof(glm::vec4));
             
-            char* ptr = reinterpret_cast<char*>(data);
             for(int i = 0; i < MAX_SIZE; ++i)
             {
-                ptr += sizeof(glm::vec4);
-                std::memcpy(ptr, &arr[i], sizeof(int32_t));
+                std::memcpy(&data[i], &arr[i], sizeof(int32_t));
             }
             
             return *this;
@@ -13,6 +13,7 @@
 #include "resource.h"
 #include "resource_set.h"
 #include "material_store.h"
+#include "storage_buffer.h"
 
 
 namespace vk
@@ -107,6 +108,37 @@ namespace vk
             }
         }
 
+        //note: unlike the overloads above, this binds a single image to the material of one swapchain image and lets the
+        //client pick the usage, this is how a compute shader samples an image instead of loading/storing to it
+        inline void set_image_sampler(uint32_t image_id, image& texture, const char* parameter_name, uint32_t binding, usage_type usage)
+        {
+            EA_ASSERT(image_id < NUM_MATERIALS);
+            _material[image_id]->set_image_sampler(&texture, parameter_name, vk::parameter_stage::COMPUTE, binding, usage);
+        }
+
+        inline void set_storage_buffer(eastl::array<storage_buffer, NUM_MATERIALS>& buffers, const char* parameter_name, uint32_t binding)
+        {
+            for( int i = 0; i < NUM_MATERIALS; ++i)
+            {
+                _material[i]->set_storage_buffer(&buffers[i], parameter_name, vk::parameter_stage::COMPUTE, binding);
+            }
+        }
+
+        //note: the same buffer is shared by all swapchain images, the client is responsible for synchronizing access to it
+        inline void set_storage_buffer(storage_buffer& buffer, const char* parameter_name, uint32_t binding)
+        {
+            for( int i = 0; i < NUM_MATERIALS; ++i)
+            {
+                _material[i]->set_storage_buffer(&buffer, parameter_name, vk::parameter_stage::COMPUTE, binding);
+            }
+        }
+        
+        inline shader_parameter::shader_params_group& get_uniform_parameters(uint32_t image_id, uint32_t binding)
+        {
+            EA_ASSERT(image_id < NUM_MATERIALS);
+            return _material[image_id]->get_uniform_parameters(parameter_stage::COMPUTE, binding);
+        }
+
         void record_dispatch_commands(VkCommandBuffer&  command_buffer, uint32_t image_id,
                                        uint32_t local_groups_in_x, uint32_t local_groups_in_y, uint32_t local_groups_in_z);
         
@@ -140,6 +172,10 @@ namespace vk
             
             _material[image_id]->commit_parameters_to_gpu();
         }
+        
+        //note: the pipeline is created the first time it is recorded, until then this is VK_NULL_HANDLE
+        inline VkPipeline get_vk_pipeline(uint32_t image_id){ return _pipeline[image_id]; }
+        inline uint64_t get_descriptor_writes(uint32_t image_id){ return _material[image_id]->get_descriptor_writes(); }
 
         //LOCAL_GROUP_SIZE was chosen here because of an example I saw on the internet, if you decide to change this number
         //make sure the local group sizes in  your particular shader is changed as well. Or maybe this needs to be configurable by
@@ -18,6 +18,7 @@
 
 //#include "graphics_pipeline.h"
 #include "vertex.h"
+#include "packed_vertex.h"
 
 namespace vk
 {
@@ -95,6 +96,13 @@ namespace vk
             _multisampling = b;
         }
         
+        inline void set_vertex_format(vertex_format format)
+        {
+            _vertex_format = format;
+        }
+        
+        inline vertex_format get_vertex_format(){ return _vertex_format; }
+        
         void set_material(visual_mat_shared_ptr material )
         {
             _material[0] = material;
@@ -175,7 +183,8 @@ namespace vk
             _material[0]->init_parameter(parameter_name, stage, vecs, num_vectors, binding);
         }
         
-        inline void init_dynamic_params(const char* parameter_name, parameter_stage stage, glm::mat4& val, size_t num_objs, int binding)
+        template< typename T>
+        inline void init_dynamic_params(const char* parameter_name, parameter_stage stage, const T& val, size_t num_objs, int binding)
         {
             for( int j = 0; j < num_objs; ++j)
                 _material[0]->get_dynamic_parameters(stage, binding)[j][parameter_name] = val;
@@ -190,6 +199,11 @@ namespace vk
             }
         }
         
+        inline void set_storage_buffer(storage_buffer& buffer, const char* parameter_name, parameter_stage parameter_stage, uint32_t binding)
+        {
+            _material[0]->set_storage_buffer(&buffer, parameter_name, parameter_stage, binding);
+        }
+        
         inline void set_number_of_blend_attachments(uint32_t num_blend_attacments)
         {
             assert( num_blend_attacments <= BLEND_ATTACHMENTS);
@@ -241,6 +255,8 @@ namespace vk
             _material[0]->commit_parameters_to_gpu();
         }
         
+        inline uint64_t get_descriptor_writes(){ return _material[0]->get_descriptor_writes(); }
+        
         ~graphics_pipeline(){};
     private:
         void init_blend_attachments();
@@ -254,6 +270,7 @@ namespace vk
         cull_mode _cull_mode = cull_mode::BACK_FACE;
         polygon_mode _polygon_mode = polygon_mode::FILL;
         bool _multisampling = false;
+        vertex_format _vertex_format = vertex_format::FLOAT32;
         
         std::array<VkPipeline, 1 >       _pipeline {};
         std::array<VkPipelineLayout, 1>  _pipeline_layout {};
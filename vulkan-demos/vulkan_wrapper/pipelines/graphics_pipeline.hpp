@@ -26,8 +26,7 @@ template< uint32_t NUM_ATTACHMENTS>
 void graphics_pipeline<NUM_ATTACHMENTS>::create(VkRenderPass& vk_render_passes, uint32_t subpass_id)
 {
     
-    auto vertex_binding_description = vertex::get_binding_description();
-    auto vertex_attribute_descriptos = vertex::get_attribute_descriptions();
+    vertex_input_description vertex_input = get_vertex_input_description(_vertex_format);
 
     //note: this call guarantees that material resources are ready to create a pipeline
     _material[0]->commit_parameters_to_gpu();
@@ -37,9 +36,31 @@ void graphics_pipeline<NUM_ATTACHMENTS>::create(VkRenderPass& vk_render_passes,
     vertex_input_state_create_info.pNext = nullptr;
     vertex_input_state_create_info.flags = 0;
     vertex_input_state_create_info.vertexBindingDescriptionCount = 1;
-    vertex_input_state_create_info.pVertexBindingDescriptions = &vertex_binding_description;
-    vertex_input_state_create_info.vertexAttributeDescriptionCount = static_cast<uint32_t>(vertex_attribute_descriptos.size());
-    vertex_input_state_create_info.pVertexAttributeDescriptions = vertex_attribute_descriptos.data();
+    vertex_input_state_create_info.pVertexBindingDescriptions = &vertex_input.binding;
+    vertex_input_state_create_info.vertexAttributeDescriptionCount = static_cast<uint32_t>(vertex_input.attributes.size());
+    vertex_input_state_create_info.pVertexAttributeDescriptions = vertex_input.attributes.data();
+    
+    //note: tells the vertex shader how to decode its inputs, shaders without a VERTEX_FORMAT constant ignore it
+    uint32_t vertex_format_constant = static_cast<uint32_t>(_vertex_format);
+    VkSpecializationMapEntry vertex_format_entry {};
+    vertex_format_entry.constantID = VERTEX_FORMAT_CONSTANT_ID;
+    vertex_format_entry.offset = 0;
+    vertex_format_entry.size = sizeof(uint32_t);
+    
+    VkSpecializationInfo vertex_specialization {};
+    vertex_specialization.mapEntryCount = 1;
+    vertex_specialization.pMapEntries = &vertex_format_entry;
+    vertex_specialization.dataSize = sizeof(uint32_t);
+    vertex_specialization.pData = &vertex_format_constant;
+    
+    eastl::array<VkPipelineShaderStageCreateInfo, material_base::MAX_SHADER_STAGES> shader_stages {};
+    size_t num_shader_stages = _material[0]->get_shader_stages_size();
+    for( size_t i = 0; i < num_shader_stages; ++i)
+    {
+        shader_stages[i] = _material[0]->get_shader_stages()[i];
+        if(shader_stages[i].stage == VK_SHADER_STAGE_VERTEX_BIT)
+            shader_stages[i].pSpecializationInfo = &vertex_specialization;
+    }
 
 
     VkPipelineInputAssemblyStateCreateInfo input_assembly_create_info {};
@@ -164,8 +185,8 @@ void graphics_pipeline<NUM_ATTACHMENTS>::create(VkRenderPass& vk_render_passes,
     pipeline_create_info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
     pipeline_create_info.pNext = nullptr;
     pipeline_create_info.flags = 0;
-    pipeline_create_info.stageCount = static_cast<uint32_t>(_material[0]->get_shader_stages_size());
-    pipeline_create_info.pStages = _material[0]->get_shader_stages();
+    pipeline_create_info.stageCount = static_cast<uint32_t>(num_shader_stages);
+    pipeline_create_info.pStages = shader_stages.data();
     pipeline_create_info.pVertexInputState = &vertex_input_state_create_info;
     pipeline_create_info.pInputAssemblyState = &input_assembly_create_info;
     pipeline_create_info.pTessellationState = nullptr;
@@ -10,7 +10,12 @@
 
 
 #include <filesystem>
+#include <chrono>
+#include <iostream>
 #include "assimp_obj.h"
+#include "lod_view.h"
+#include "instance_pool.h"
+#include "transform_hierarchy.h"
 
 #include "device.h"
 #include "node.h"
@@ -49,6 +54,16 @@ namespace vk
             return static_cast<vk::obj_shape*>(&_mesh_lods[l-1]);
         }
         
+        //note: every lod gets the same format, the passes that draw this node build their vertex input from it
+        void set_vertex_format(vk::vertex_format format)
+        {
+            for(int i = 0; i < _mesh_lods.size(); ++i)
+            {
+                _mesh_lods[i].set_vertex_format(format);
+            }
+            _vertex_format = format;
+        }
+        
         void set_texture_relative_path(const char* p, uint32_t id)
         {
             for( int i = 0; i < _num_lods; ++i)
@@ -57,57 +72,194 @@ namespace vk
             }
         }
         
+        //note: levels are looked up next to the mesh first, "car.fbx" is followed by "car_lod1.fbx", "car_lod2.fbx"...  If there
+        //are none on disk, this many levels are generated with mesh_simplifier instead, each one with a quarter of the triangles
+        inline void set_generated_lods(uint32_t count)
+        {
+            EA_ASSERT(count < MAX_LODS);
+            _generated_lods = count;
+        }
+        
+        inline uint32_t get_num_lods(){ return _num_lods; }
+        
+        //object space error of every level, level 0 is the reference and has none
+        inline float get_lod_error(uint32_t l)
+        {
+            EA_ASSERT(l < _num_lods);
+            return _lod_errors[l];
+        }
+        
+        //picks the level for this view with the world matrices of this frame, see lod_view.  Every pass and cull node that shares a
+        //lod_view gets the same answer within a frame, no matter the order they ask in.  All instances are drawn with one level,
+        //the one the closest instance needs
+        vk::obj_shape* select_lod(const vk::lod_view& view, vk::camera& graph_camera, uint32_t image_id)
+        {
+            EA_ASSERT(view.get_id() < _selected_lods.size());
+            vk::camera& cam = view.get_camera(graph_camera);
+            
+            float pixels_per_unit = 0.0f;
+            for( uint32_t i = 0; i < get_num_instances(); ++i)
+            {
+                pixels_per_unit = glm::max(pixels_per_unit,
+                                           view.get_pixels_per_unit(_bounds, get_world_matrix(i), cam));
+            }
+            
+            uint32_t& current = _selected_lods[view.get_id()];
+            current = view.select(_lod_errors.data(), _num_lods, pixels_per_unit, current);
+            return get_lod(current);
+        }
+        
+        //note: the transform of this node and its instances becomes relative to instance 0 of parent.  Parents have to be set before
+        //init_transforms or add_instance are called
+        void set_parent(assimp_node& parent)
+        {
+            EA_ASSERT_MSG(_transform_ids.empty(), "set the parent before the transforms of this node");
+            _parent_transform = static_cast<int32_t>(parent.get_transform_id(0));
+        }
+        
+        //note: adds a copy of this mesh that is drawn with the same instanced draw as instance 0 (see init_transforms).  Instances
+        //have to be added before the graph is initialized, returns the id of the new instance
+        uint32_t add_instance(const vk::transform& transform, uint32_t material_id = 0)
+        {
+            EA_ASSERT_MSG(!_instances_allocated, "instances must be added before the graph is initialized");
+            get_transform_id(0);
+            _transform_ids.push_back(get_transform_hierarchy().add(transform, _parent_transform));
+            _instance_materials.push_back(material_id);
+            
+            return get_num_instances() - 1;
+        }
+        
+        inline uint32_t get_num_instances(){ return _transform_ids.empty() ? 1u : static_cast<uint32_t>(_transform_ids.size()); }
+        
+        //note: the new world matrix is picked up the next time the graph is updated
+        inline void set_instance_transform(uint32_t instance_id, const vk::transform& transform)
+        {
+            get_transform_hierarchy().set_local(get_transform_id(instance_id), transform);
+        }
+        
+        //note: computed once per frame in graph::update
+        inline const glm::mat4& get_world_matrix(uint32_t instance_id)
+        {
+            return get_transform_hierarchy().get_world(get_transform_id(instance_id));
+        }
+        
+        //node in the device transform hierarchy, instance 0 is added the first time it is asked for
+        inline uint32_t get_transform_id(uint32_t instance_id)
+        {
+            if(_transform_ids.empty())
+            {
+                _transform_ids.push_back(get_transform_hierarchy().add(vk::transform(), _parent_transform));
+            }
+            EA_ASSERT(instance_id < _transform_ids.size());
+            return _transform_ids[instance_id];
+        }
+        
+        inline void set_material_id(uint32_t instance_id, uint32_t material_id)
+        {
+            EA_ASSERT(instance_id < get_num_instances());
+            _instance_materials[instance_id] = material_id;
+        }
+        
+        //world space box around a mesh of this node (i.e. obj_shape::get_bounds) in every instance
+        vk::aabb get_instance_bounds(const vk::aabb& bounds, uint32_t image_id)
+        {
+            vk::aabb result {};
+            for( uint32_t i = 0; i < get_num_instances(); ++i)
+            {
+                result.expand(bounds.transform(get_world_matrix(i)));
+            }
+            return result;
+        }
+        
         virtual void init_node() override
         {
             EA_ASSERT_MSG(node_type::_device != nullptr, "vk::device is nullptr");
             EA_ASSERT_MSG(_path != nullptr, "path directory is empty for this mesh");
+            
+            //note: nodes nobody gave a transform to are still in the hierarchy before the graph is first updated
+            get_transform_id(0);
+            
+            name_string name = _path;
+            size_t p = name.find_last_of('.', name.length());
+            name_string lod_name = name.substr(0, p);
+            name_string extension = name.substr(p, name.length());
+            
+            std::chrono::time_point start = std::chrono::high_resolution_clock::now();
+            
+            texture_path cache_path = resource::resource_root + obj_shape::_shape_resource_path + name + mesh_cache::EXTENSION;
+            uint64_t hash = get_cache_hash(name, lod_name, extension);
+            bool cached = mesh_cache::is_enabled() && create_cached(cache_path.c_str(), hash);
+            if(!cached)
+            {
+                import_lods(name, lod_name, extension);
+                if(mesh_cache::is_enabled())
+                    write_cache(cache_path.c_str(), hash);
+            }
+            
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+            mesh_cache::record_load(name.c_str(), cached, _num_lods, elapsed.count());
+            
+            //note: selection needs errors that grow with the level
+            _bounds = {};
+            for( uint32_t mesh_id = 0; mesh_id < _mesh_lods[0].get_num_meshes(); ++mesh_id)
+            {
+                _bounds.expand(_mesh_lods[0].get_bounds(mesh_id));
+            }
+            
+            _lod_errors[0] = 0.0f;
+            for( uint32_t i = 1; i < _num_lods; ++i)
+            {
+                _lod_errors[i] = glm::max(_mesh_lods[i].get_geometric_error(), _lod_errors[i - 1]);
+            }
+            
+            //note: every level draws the same instances
+            vk::instance_pool::range instances = node_type::_device->get_instance_pool().allocate(get_num_instances());
             for( int i = 0; i < _mesh_lods.size(); ++i)
             {
-                eastl::fixed_string<char, 250> name = _path;
-                _mesh_lods[i].set_device(node_type::_device);
-                _mesh_lods[i].set_path(name.c_str());
-                if( i != 0)
-                {
-                    size_t p = name.find_last_of('.', name.length());
-                    eastl::fixed_string<char, 250> lod_name;
-                    lod_name = name.substr(0, p);
-                    
-                    //size_t p = name.find_last_of('.', name.length());
-                    eastl::fixed_string<char, 250> lod_final = {};
-                    
-                    eastl::fixed_string<char, 250> extension = name.substr(p, name.length());
-                    lod_final.sprintf("%s_lod%i%s", lod_name.c_str(), i, extension.c_str());
-                    
-                    if (!std::filesystem::exists(lod_name.c_str()))
-                        break;
-                    //name.sprintf("%s_lod%i", _path, i);
-                    _mesh_lods[i].set_path(lod_name.c_str());
-                    ++_num_lods;
-                }
-                _mesh_lods[i].create();
+                _mesh_lods[i].set_instances(instances);
             }
+            _instances_allocated = true;
         }
         
-        void init_transforms(vk::transform& transform)
+        //note: transform of instance 0, same as set_instance_transform(0, transform)
+        void init_transforms(const vk::transform& transform)
         {
-            for( int image = 0; image < glfw_swapchain::NUM_SWAPCHAIN_IMAGES; ++image)
-            {
-                transforms[image] = transform;
-                transforms[image].update_transform_matrix();
-            }
+            set_instance_transform(0, transform);
         }
         
+        //note: refresh_node_parameters writes the instances of this node and nothing else, meshes update in parallel
+        virtual bool is_thread_safe() override
+        {
+            return true;
+        }
         
         virtual void update_node(vk::camera& camera, uint32_t image_id) override
+        {}
+        
+        //note: mesh nodes record nothing, their instance data is written in refresh_node_parameters
+        virtual bool record_node_commands(command_recorder& buffer, uint32_t image_id) override
         {
-            for( int i = 0; i < _mesh_lods.size(); ++i)
+            return true;
+        }
+        
+        virtual bool hash_node_commands(uint64_t& state, uint32_t image_id) override
+        {
+            return true;
+        }
+        
+        //note: the fence for this image has been waited on by the time we refresh, the gpu is done with its instances
+        virtual void refresh_node_parameters(uint32_t image_id) override
+        {
+            const vk::instance_pool::range& range = _mesh_lods[0].get_instances();
+            vk::instance_pool::instance* instances = node_type::_device->get_instance_pool().get_instances(image_id) + range.first_instance;
+            
+            for( uint32_t i = 0; i < range.instance_count; ++i)
             {
-                _mesh_lods[i].transform = transforms[image_id];
+                instances[i].model = get_world_matrix(i);
+                instances[i].material_id = _instance_materials[i];
             }
         }
         
-        virtual bool record_node_commands(command_recorder& buffer, uint32_t image_id) override { return true; }
-        
         VkPipelineStageFlagBits get_producer_stage() override {  return VK_PIPELINE_STAGE_TRANSFER_BIT; };
         VkPipelineStageFlagBits get_consumer_stage() override {  return VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT; };
         
@@ -122,18 +274,154 @@ namespace vk
             }
         }
         
-        eastl::array<vk::transform, glfw_swapchain::NUM_SWAPCHAIN_IMAGES> transforms {} ;
-        
         virtual char const * const * get_instance_type() override { return (&_node_type); };
         static char const * const *  get_class_type(){ return (&_node_type); }
         
     private:
         
+        using name_string = eastl::fixed_string<char, 250>;
+        
+        //note: the source of every authored level and the settings that change what is uploaded, see mesh_cache
+        uint64_t get_cache_hash(const name_string& name, const name_string& lod_name, const name_string& extension)
+        {
+            uint32_t settings[] = { mesh_cache::VERSION, static_cast<uint32_t>(_vertex_format), _generated_lods, MIN_GENERATED_TRIANGLES };
+            uint64_t hash = mesh_cache::hash_bytes(settings, sizeof(settings));
+            
+            if(_vertex_format == vertex_format::FLOAT32)
+            {
+                const vk::vertex_components& components = _mesh_lods[0].get_vertex_components();
+                hash = mesh_cache::hash_bytes(components.data(), components.size() * sizeof(components[0]), hash);
+            }
+            
+            texture_path full_path = resource::resource_root + obj_shape::_shape_resource_path + name;
+            hash = mesh_cache::hash_file(full_path.c_str(), hash);
+            for( uint32_t i = 1; i < MAX_LODS; ++i)
+            {
+                name_string lod_final = {};
+                lod_final.sprintf("%s_lod%u%s", lod_name.c_str(), i, extension.c_str());
+                
+                full_path = resource::resource_root + obj_shape::_shape_resource_path + lod_final;
+                if (!std::filesystem::exists(full_path.c_str()))
+                    break;
+                hash = mesh_cache::hash_file(full_path.c_str(), hash);
+            }
+            return hash;
+        }
+        
+        bool create_cached(const char* cache_path, uint64_t hash)
+        {
+            mesh_cache cache;
+            if(!cache.open(cache_path, hash))
+                return false;
+            
+            if(cache.get_vertex_format() != _vertex_format || cache.get_vertex_stride() != _mesh_lods[0].get_vertex_stride())
+                return false;
+            
+            for( uint32_t i = 0; i < cache.get_num_levels(); ++i)
+            {
+                _mesh_lods[i].set_device(node_type::_device);
+                _mesh_lods[i].set_path(_path);
+                _mesh_lods[i].create_cached(cache, i);
+            }
+            _num_lods = cache.get_num_levels();
+            
+            return true;
+        }
+        
+        //note: authored levels are looked up on disk, if there are none they are generated
+        void import_lods(const name_string& name, const name_string& lod_name, const name_string& extension)
+        {
+            _mesh_lods[0].set_device(node_type::_device);
+            _mesh_lods[0].set_path(name.c_str());
+            _mesh_lods[0].set_keep_source(_generated_lods != 0);
+            _mesh_lods[0].set_keep_stream(mesh_cache::is_enabled());
+            _mesh_lods[0].create();
+            
+            for( int i = 1; i < _mesh_lods.size(); ++i)
+            {
+                name_string lod_final = {};
+                lod_final.sprintf("%s_lod%i%s", lod_name.c_str(), i, extension.c_str());
+                
+                texture_path full_path = resource::resource_root + obj_shape::_shape_resource_path + lod_final;
+                if (!std::filesystem::exists(full_path.c_str()))
+                    break;
+                
+                _mesh_lods[i].set_device(node_type::_device);
+                _mesh_lods[i].set_path(lod_final.c_str());
+                _mesh_lods[i].set_keep_stream(mesh_cache::is_enabled());
+                _mesh_lods[i].create();
+                ++_num_lods;
+            }
+            
+            if(_num_lods == 1)
+            {
+                for( uint32_t i = 1; i <= _generated_lods; ++i)
+                {
+                    assimp_obj& previous = _mesh_lods[i - 1];
+                    size_t target = ((previous.get_source_index_count() / 3) / 4) * 3;
+                    if(target < MIN_GENERATED_TRIANGLES * 3)
+                        break;
+                    
+                    _mesh_lods[i].set_keep_source(i != _generated_lods);
+                    _mesh_lods[i].set_keep_stream(mesh_cache::is_enabled());
+                    if(!_mesh_lods[i].create_simplified(previous, target))
+                        break;
+                    
+                    previous.release_source();
+                    ++_num_lods;
+                }
+            }
+            _mesh_lods[_num_lods - 1].release_source();
+        }
+        
+        void write_cache(const char* cache_path, uint64_t hash)
+        {
+            eastl::fixed_vector<mesh_cache::level, MAX_LODS, false> levels {};
+            for( uint32_t i = 0; i < _num_lods; ++i)
+            {
+                levels.push_back(_mesh_lods[i].get_cache_level());
+            }
+            
+            mesh_cache::texture_refs textures {};
+            _mesh_lods[0].get_texture_refs(textures);
+            
+            if(!mesh_cache::write(cache_path, hash, _vertex_format, _mesh_lods[0].get_vertex_stride(), levels.data(), _num_lods, textures))
+                std::cout << "could not write mesh cache " << cache_path << std::endl;
+            
+            for( uint32_t i = 0; i < _num_lods; ++i)
+            {
+                _mesh_lods[i].release_stream();
+            }
+        }
+        
+        inline vk::transform_hierarchy& get_transform_hierarchy()
+        {
+            return node_type::_device->get_transform_hierarchy();
+        }
+        
         static constexpr char const * _node_type = nullptr;
+        static constexpr uint32_t MAX_LODS = 10u;
+        static constexpr uint32_t DEFAULT_GENERATED_LODS = 3u;
+        static constexpr uint32_t MIN_GENERATED_TRIANGLES = 64u;
+        static_assert(MAX_LODS <= mesh_cache::MAX_LEVELS, "the mesh cache cannot hold every level");
         
-        eastl::array<vk::assimp_obj, 10> _mesh_lods;
+        eastl::array<vk::assimp_obj, MAX_LODS> _mesh_lods;
+        eastl::array<float, MAX_LODS> _lod_errors {};
         uint32_t    _num_lods = 1;
+        uint32_t    _generated_lods = DEFAULT_GENERATED_LODS;
+        vk::aabb    _bounds {};
         const char* _path;
+        vk::vertex_format _vertex_format = vk::vertex_format::FLOAT32;
+        
+        //note: level each lod_view picked last, hysteresis needs it
+        eastl::array<uint32_t, vk::lod_view::MAX_VIEWS> _selected_lods {};
+        
+        //note: one node in the transform hierarchy per instance, world matrices are shared by every swapchain image since they
+        //are written into the instance buffer of the image being recorded
+        eastl::vector<uint32_t> _transform_ids {};
+        int32_t _parent_transform = vk::transform_hierarchy::NO_PARENT;
+        eastl::vector<uint32_t> _instance_materials { 0u };
+        bool _instances_allocated = false;
     };
 
 }
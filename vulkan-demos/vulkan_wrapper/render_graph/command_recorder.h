@@ -10,11 +10,24 @@
 
 #include "glfw_swapchain.h"
 #include "device.h"
+#include "profiler.h"
 #include "EASTL/fixed_vector.h"
+#include "EASTL/vector.h"
 #include "EASTL/array.h"
+#include <algorithm>
+#include <limits>
 
 namespace vk
 {
+    //note: what the graph records for one swapchain image is split in submissions.  Without a queue for compute alone there is
+    //one, on the graphics queue, like there always was.  With one, nodes that can run there (see node::is_async_compatible)
+    //are recorded into submissions of the compute queue and everything else into submissions of the graphics queue.
+    //
+    //a node that uses an image the other queue used last starts a new submission, which waits on a semaphore the submission
+    //of the other queue signals.  The image is released by the queue that used it and acquired by the one that is about to,
+    //see record_image_barrier.  A submission that another waits on takes no more nodes, the nodes after it go to a new one, this
+    //is what lets both queues work at the same time.  At the end of the frame everything is handed back to the graphics queue
+    //and its last submission waits on the compute queue, so the fence of the image covers both, see join_queues
     class command_recorder : public object
     {
     public:
@@ -25,21 +38,26 @@ namespace vk
             COMPUTE
         };
         
+        static constexpr uint32_t MAX_SEGMENTS = 16u;
+        //note: after the start and end of every submission, see get_gpu_time
+        static constexpr uint32_t ACQUIRE_QUERY = 2 * MAX_SEGMENTS;
+        
+        //note: the state of a command buffer is a hash of everything recorded into it besides parameter data (nodes, objects,
+        //pipelines, descriptor sets, attachments), see graph::record.  States fold values in with hash_state starting from
+        //EMPTY_STATE, UNKNOWN_STATE never matches anything
+        static constexpr uint64_t EMPTY_STATE = 14695981039346656037ull;
+        static constexpr uint64_t UNKNOWN_STATE = 0u;
+        
+        static inline void hash_state(uint64_t& state, uint64_t value)
+        {
+            state = (state ^ value) * 1099511628211ull;
+        }
+        
         
         command_recorder(device* dev, glfw_swapchain& swapchain):
         _device(dev),
         _swapchain(swapchain)
         {
-            VkCommandBufferAllocateInfo command_buffer_allocate_info {};
-            command_buffer_allocate_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-            command_buffer_allocate_info.pNext = nullptr;
-            command_buffer_allocate_info.commandPool = _device->_present_command_pool;
-            command_buffer_allocate_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-            command_buffer_allocate_info.commandBufferCount = glfw_swapchain::NUM_SWAPCHAIN_IMAGES;
-            
-            VkResult result = vkAllocateCommandBuffers(_device->_logical_device, &command_buffer_allocate_info, _graphics_buffer.data());
-            ASSERT_VULKAN(result);
-            
             create_sync_objects();
         }
         
@@ -48,64 +66,254 @@ namespace vk
         
         VkCommandBuffer& get_raw_graphics_command( uint32_t image_id)
         {
-            return _graphics_buffer[image_id];
+            frame& f = _frames[image_id];
+            EA_ASSERT_MSG(f.segments[f.current].type == command_type::GRAPHICS, "the node being recorded runs on the compute queue");
+            return f.segments[f.current].buffer;
         };
         
         void begin_command_recording(uint32_t swapchain_image_id)
         {
-            VkCommandBufferBeginInfo command_buffer_begin_info {};
-            command_buffer_begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-            command_buffer_begin_info.pNext = nullptr;
-            command_buffer_begin_info.flags = VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT;
-            command_buffer_begin_info.pInheritanceInfo = nullptr;
+            frame& f = _frames[swapchain_image_id];
+            f.segments.clear();
+            f.owners.clear();
+            f.used.fill(0);
             
-            VkResult result = vkBeginCommandBuffer(_graphics_buffer[swapchain_image_id], &command_buffer_begin_info);
-            ASSERT_VULKAN(result);
+            //note: the first submission is always on the graphics queue, it is the one that waits for the swapchain image
+            open_segment(swapchain_image_id, command_type::GRAPHICS);
         }
-    
+        
+        //note: the queue the node being recorded runs on.  The graphics queue runs compute too, compute nodes that stay on it
+        //record here as well
         VkCommandBuffer& get_raw_compute_command( uint32_t image_id )
         {
-            assert( _device->_queue_family_indices.graphics_family.value() ==
-                   _device->_queue_family_indices.compute_family.value());
+            frame& f = _frames[image_id];
+            return f.segments[f.current].buffer;
+        }
+        
+        //note: where work for type ends up, compute work goes to the graphics queue when the device has no queue for it alone
+        inline command_type get_queue(command_type type) const
+        {
+            return _device->has_async_compute() ? type : command_type::GRAPHICS;
+        }
+        
+        //note: true if the image was used last by the other queue and is to be transferred before a node on type uses it.  Images
+        //not used yet this frame belong to the graphics queue
+        bool needs_transfer(uint32_t image_id, VkImage image, command_type type)
+        {
+            frame& f = _frames[image_id];
+            image_owner* owner = find_owner(f, image);
+            uint32_t segment = owner != nullptr ? owner->segment : 0;
+            return f.segments[segment].type != get_queue(type);
+        }
+        
+        //note: called by node::record before a node records anything.  The node goes to the last submission of its queue unless
+        //another submission waits on it already, or the node has to wait on the other queue itself, then a new one is started
+        void begin_node(uint32_t image_id, command_type type, bool waits)
+        {
+            frame& f = _frames[image_id];
+            type = get_queue(type);
             
-            return _graphics_buffer[image_id];
+            if(!waits)
+            {
+                for( int32_t i = static_cast<int32_t>(f.segments.size()) - 1; i >= 0; --i)
+                {
+                    if(f.segments[i].type != type)
+                        continue;
+                    
+                    if(!f.segments[i].sealed)
+                    {
+                        f.current = static_cast<uint32_t>(i);
+                        return;
+                    }
+                    break;
+                }
+            }
             
+            open_segment(image_id, type);
         }
         
+        //note: records barrier for the node being recorded.  If the image was used last by the other queue, it is released there
+        //and acquired here, and this submission waits on the one that used it.  The queue family indices of barrier are filled in
+        void record_image_barrier(uint32_t image_id, VkImageMemoryBarrier barrier, VkPipelineStageFlags producer,
+                                  VkPipelineStageFlags consumer)
+        {
+            frame& f = _frames[image_id];
+            image_owner* owner = find_owner(f, barrier.image);
+            uint32_t from = owner != nullptr ? owner->segment : 0;
+            
+            if(f.segments[from].type == f.segments[f.current].type)
+            {
+                if(f.segments[f.current].type == command_type::COMPUTE)
+                {
+                    //note: the compute queue only runs compute shaders, stages and accesses of graphics producers don't exist there
+                    producer = consumer = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+                    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+                }
+                
+                barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                vkCmdPipelineBarrier(f.segments[f.current].buffer, producer, consumer, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+            }
+            else
+            {
+                transfer(f, from, f.current, barrier, consumer);
+            }
+            
+            if(owner == nullptr)
+            {
+                f.owners.push_back(image_owner {});
+                owner = &f.owners.back();
+            }
+            owner->image = barrier.image;
+            owner->segment = f.current;
+            owner->barrier = barrier;
+        }
+        
+        //note: called once every node is recorded.  Images the compute queue used last are handed back to the graphics queue,
+        //the last submission is on the graphics queue and waits on every compute submission nobody waited on yet
+        void join_queues(uint32_t image_id)
+        {
+            frame& f = _frames[image_id];
+            if(f.segments.back().type != command_type::GRAPHICS)
+                open_segment(image_id, command_type::GRAPHICS);
+            f.current = static_cast<uint32_t>(f.segments.size()) - 1;
+            
+            for( image_owner& owner : f.owners)
+            {
+                if(f.segments[owner.segment].type == command_type::GRAPHICS)
+                    continue;
+                
+                VkImageMemoryBarrier barrier = owner.barrier;
+                barrier.oldLayout = barrier.newLayout;
+                barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+                barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+                transfer(f, owner.segment, f.current, barrier, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+                owner.segment = f.current;
+            }
+            
+            for( uint32_t i = 0; i < f.segments.size(); ++i)
+            {
+                if(f.segments[i].type == command_type::COMPUTE && !f.segments[i].sealed)
+                    add_wait(f, f.current, i);
+            }
+        }
+        
+        //note: nanoseconds from the start of the first submission of image_id to the end of its last, the last time its fence
+        //was waited on.  The first submission waits for the swapchain image before it draws to it, the time spent waiting is
+        //not counted, under fifo that is the wait for vsync and not work.  0 while nothing is timed, see is_timing
+        inline uint64_t get_gpu_time(uint32_t image_id) const
+        {
+#if PROFILER_ENABLED
+            return _frames[image_id].gpu_time;
+#else
+            return 0;
+#endif
+        }
+        
+        inline uint32_t get_num_submissions(uint32_t image_id) const
+        {
+            return static_cast<uint32_t>(_frames[image_id].segments.size());
+        }
+        
+        uint32_t get_num_compute_submissions(uint32_t image_id) const
+        {
+            uint32_t count = 0;
+            for( const segment& s : _frames[image_id].segments)
+            {
+                count += s.type == command_type::COMPUTE ? 1u : 0u;
+            }
+            return count;
+        }
     
         void end_command_recording(uint32_t image_id)
         {
-            vkEndCommandBuffer(_graphics_buffer[image_id]);
+            frame& f = _frames[image_id];
+#if PROFILER_ENABLED
+            f.timed_segments = 0;
+            if(is_timing())
+            {
+                for( uint32_t i = 0; i < f.segments.size(); ++i)
+                {
+                    vkCmdWriteTimestamp(f.segments[i].buffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, f.queries, 2 * i + 1);
+                }
+                f.timed_segments = static_cast<uint32_t>(f.segments.size());
+            }
+            f.timed_acquire = f.timed_segments != 0 && f.segments[0].type == command_type::GRAPHICS;
+#endif
+            for( segment& s : f.segments)
+            {
+                vkEndCommandBuffer(s.buffer);
+            }
         }
         
         void submit_graphics_commands( uint32_t image_id )
         {
+            PROFILE_ZONE("command_recorder::submit_graphics_commands");
             uint32_t acquired_image = 0;
-            vkAcquireNextImageKHR(_device->_logical_device, _swapchain.get_vk_swapchain(),
+            VkResult acquired = vkAcquireNextImageKHR(_device->_logical_device, _swapchain.get_vk_swapchain(),
             std::numeric_limits<uint64_t>::max(),
             _acquire_semaphores[image_id], VK_NULL_HANDLE, &acquired_image);
             
+            //note: the window changed size and nothing was acquired, the frame is dropped until the swapchain is resized
+            if(acquired == VK_ERROR_OUT_OF_DATE_KHR)
+            {
+                _swapchain.set_out_of_date();
+                return;
+            }
+            if(acquired == VK_SUBOPTIMAL_KHR)
+                _swapchain.set_out_of_date();
+            
             assert(image_id == acquired_image);
             
-            VkResult result = {};
-            VkSubmitInfo submit_info = {};
-            submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-            submit_info.pNext = nullptr;
-            submit_info.waitSemaphoreCount = 1;
-            submit_info.pWaitSemaphores = &_acquire_semaphores[acquired_image];
+            //note: one semaphore for every submission another one waits on, handed out in the same order every frame
+            frame& f = _frames[acquired_image];
+            eastl::array<semaphore_list, MAX_SEGMENTS> signals {};
+            eastl::array<semaphore_list, MAX_SEGMENTS> waits {};
+            eastl::array<stage_list, MAX_SEGMENTS> wait_stages {};
             
-            VkPipelineStageFlags wait_stage_mask[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
+            waits[0].push_back(_acquire_semaphores[acquired_image]);
+            wait_stages[0].push_back(VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+            
+            uint32_t semaphore_count = 0;
+            for( uint32_t i = 0; i < f.segments.size(); ++i)
+            {
+                for( uint32_t signaler : f.segments[i].waits)
+                {
+                    VkSemaphore semaphore = get_semaphore(f, semaphore_count++);
+                    signals[signaler].push_back(semaphore);
+                    waits[i].push_back(semaphore);
+                    wait_stages[i].push_back(VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+                }
+            }
             
-            submit_info.pWaitDstStageMask = wait_stage_mask;
-            submit_info.commandBufferCount = 1;
-            submit_info.pCommandBuffers = &_graphics_buffer[acquired_image];
-            submit_info.signalSemaphoreCount = 1;
-            submit_info.pSignalSemaphores = &_semaphores[acquired_image];
+            uint32_t last = static_cast<uint32_t>(f.segments.size()) - 1;
+            signals[last].push_back(_semaphores[acquired_image]);
             
+            VkResult result = {};
+#if PROFILER_ENABLED
+            f.submit_time = profiler::now();
+            f.pending_segments = f.timed_segments;
+            f.pending_acquire = f.timed_acquire;
+#endif
             vkResetFences(_device->_logical_device, 1, &_fences[image_id]);
-            result = vkQueueSubmit(_device->_graphics_queue, 1, &submit_info, _fences[acquired_image]);
+            for( uint32_t i = 0; i < f.segments.size(); ++i)
+            {
+                VkSubmitInfo submit_info = {};
+                submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+                submit_info.pNext = nullptr;
+                submit_info.waitSemaphoreCount = static_cast<uint32_t>(waits[i].size());
+                submit_info.pWaitSemaphores = waits[i].data();
+                submit_info.pWaitDstStageMask = wait_stages[i].data();
+                submit_info.commandBufferCount = 1;
+                submit_info.pCommandBuffers = &f.segments[i].buffer;
+                submit_info.signalSemaphoreCount = static_cast<uint32_t>(signals[i].size());
+                submit_info.pSignalSemaphores = signals[i].data();
+                
+                VkQueue queue = f.segments[i].type == command_type::GRAPHICS ? _device->_graphics_queue : _device->_async_compute_queue;
+                result = vkQueueSubmit(queue, 1, &submit_info, i == last ? _fences[acquired_image] : VK_NULL_HANDLE);
+                ASSERT_VULKAN(result);
+            }
             
-            ASSERT_VULKAN(result);
             //present the scene to viewer
             VkPresentInfoKHR present_info {};
             present_info.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
@@ -116,7 +324,25 @@ namespace vk
             present_info.pSwapchains = &(_swapchain.get_vk_swapchain());
             present_info.pImageIndices = &acquired_image;
             present_info.pResults = nullptr;
+#if defined(VK_KHR_present_wait) && defined(VK_KHR_present_id)
+            //note: the id lets frame_pacer find out when this frame was shown
+            VkPresentIdKHR present_id {};
+            uint64_t id = 0;
+            if(_swapchain.has_present_wait())
+            {
+                id = _swapchain.next_present_id();
+                present_id.sType = VK_STRUCTURE_TYPE_PRESENT_ID_KHR;
+                present_id.swapchainCount = 1;
+                present_id.pPresentIds = &id;
+                present_info.pNext = &present_id;
+            }
+#endif
             result = vkQueuePresentKHR(_device->_present_queue, &present_info);
+            if(result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR)
+            {
+                _swapchain.set_out_of_date();
+                return;
+            }
 
             ASSERT_VULKAN(result);
         }
@@ -129,21 +355,70 @@ namespace vk
             submit_graphics_commands(image_id);
         }
         
-        void reset( uint32_t image_id )
+        void wait( uint32_t image_id )
         {
             vkWaitForFences(_device->_logical_device, 1, &_fences[image_id], VK_TRUE, std::numeric_limits<uint64_t>::max());
+#if PROFILER_ENABLED
+            read_timestamps(image_id);
+#endif
+        }
+        
+        void reset( uint32_t image_id )
+        {
+            wait(image_id);
             
             static const VkCommandBufferResetFlags flags = 0;
-            vkResetCommandBuffer( _graphics_buffer[image_id], flags );
+            for( segment& s : _frames[image_id].segments)
+            {
+                vkResetCommandBuffer( s.buffer, flags );
+            }
+            _frames[image_id].segments.clear();
+            _recorded_states[image_id] = UNKNOWN_STATE;
+        }
+        
+        //note: called once the command buffer of image_id was recorded with state, it can then be submitted again for as long
+        //as the state stays the same
+        inline void set_recorded_state(uint32_t image_id, uint64_t state){ _recorded_states[image_id] = state; }
+        
+        inline bool is_recorded(uint32_t image_id, uint64_t state)
+        {
+            return state != UNKNOWN_STATE && _recorded_states[image_id] == state;
+        }
+        
+        //note: every image is recorded again the next time it is used
+        inline void invalidate()
+        {
+            _recorded_states.fill(UNKNOWN_STATE);
         }
         
         void destroy() override
         {
-            vkFreeCommandBuffers(_device->_logical_device, _device->_graphics_command_pool,
-                                 glfw_swapchain::NUM_SWAPCHAIN_IMAGES, _graphics_buffer.data()) ;
-            
             for( int  i = 0; i < glfw_swapchain::NUM_SWAPCHAIN_IMAGES; ++i)
             {
+                frame& f = _frames[i];
+                if(!f.buffers[GRAPHICS_BUFFERS].empty())
+                    vkFreeCommandBuffers(_device->_logical_device, _device->_graphics_command_pool,
+                                         static_cast<uint32_t>(f.buffers[GRAPHICS_BUFFERS].size()), f.buffers[GRAPHICS_BUFFERS].data());
+                if(!f.buffers[COMPUTE_BUFFERS].empty())
+                    vkFreeCommandBuffers(_device->_logical_device, _device->_async_compute_command_pool,
+                                         static_cast<uint32_t>(f.buffers[COMPUTE_BUFFERS].size()), f.buffers[COMPUTE_BUFFERS].data());
+                f.buffers[GRAPHICS_BUFFERS].clear();
+                f.buffers[COMPUTE_BUFFERS].clear();
+                f.segments.clear();
+                
+                for( VkSemaphore semaphore : f.semaphores)
+                {
+                    vkDestroySemaphore(_device->_logical_device, semaphore, nullptr);
+                }
+                f.semaphores.clear();
+                
+#if PROFILER_ENABLED
+                if(f.queries != VK_NULL_HANDLE)
+                    vkDestroyQueryPool(_device->_logical_device, f.queries, nullptr);
+                f.queries = VK_NULL_HANDLE;
+                f.pending_segments = 0;
+#endif
+                
                 vkDestroyFence(_device->_logical_device, _fences[i] , nullptr);
                 _fences[i] = VK_NULL_HANDLE;
                 vkDestroySemaphore(_device->_logical_device, _semaphores[i], nullptr);
@@ -154,6 +429,230 @@ namespace vk
         };
     private:
         
+        static constexpr uint32_t GRAPHICS_BUFFERS = 0u;
+        static constexpr uint32_t COMPUTE_BUFFERS = 1u;
+        
+        using semaphore_list = eastl::fixed_vector<VkSemaphore, MAX_SEGMENTS + 1, false>;
+        using stage_list = eastl::fixed_vector<VkPipelineStageFlags, MAX_SEGMENTS + 1, false>;
+        
+        //note: one submission, waits are the submissions before it that it waits on
+        struct segment
+        {
+            command_type    type = command_type::GRAPHICS;
+            VkCommandBuffer buffer = VK_NULL_HANDLE;
+            eastl::fixed_vector<uint32_t, MAX_SEGMENTS, false> waits {};
+            //note: another submission waits on this one, nodes are not added to it anymore
+            bool            sealed = false;
+        };
+        
+        //note: the submission that used an image last this frame and the barrier it used it with
+        struct image_owner
+        {
+            VkImage                 image = VK_NULL_HANDLE;
+            uint32_t                segment = 0;
+            VkImageMemoryBarrier    barrier {};
+        };
+        
+        struct frame
+        {
+            eastl::fixed_vector<segment, MAX_SEGMENTS, false> segments {};
+            uint32_t current = 0;
+            eastl::fixed_vector<image_owner, 64, true> owners {};
+            
+            //note: every command buffer allocated for the image so far, the first used ones belong to this frame's submissions
+            eastl::array<eastl::fixed_vector<VkCommandBuffer, MAX_SEGMENTS, false>, 2> buffers {};
+            eastl::array<uint32_t, 2> used {};
+            eastl::vector<VkSemaphore> semaphores {};
+            
+#if PROFILER_ENABLED
+            //note: two timestamps per submission, when it starts and when it ends.  Segments recorded with them and segments
+            //submitted with them whose fence was not waited on yet
+            VkQueryPool queries = VK_NULL_HANDLE;
+            uint32_t timed_segments = 0;
+            uint32_t pending_segments = 0;
+            //note: the first submission has a third timestamp, when the swapchain image it waits for was acquired
+            bool timed_acquire = false;
+            bool pending_acquire = false;
+            uint64_t submit_time = 0;
+            uint64_t gpu_time = 0;
+#endif
+        };
+        
+        void open_segment(uint32_t image_id, command_type type)
+        {
+            frame& f = _frames[image_id];
+            EA_ASSERT_MSG(f.segments.size() < MAX_SEGMENTS, "too many submissions, the graph switches queues too often");
+            
+            uint32_t kind = type == command_type::GRAPHICS ? GRAPHICS_BUFFERS : COMPUTE_BUFFERS;
+            if(f.used[kind] == f.buffers[kind].size())
+            {
+                VkCommandBufferAllocateInfo command_buffer_allocate_info {};
+                command_buffer_allocate_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+                command_buffer_allocate_info.pNext = nullptr;
+                command_buffer_allocate_info.commandPool = type == command_type::GRAPHICS ? _device->_graphics_command_pool :
+                                                                                           _device->_async_compute_command_pool;
+                command_buffer_allocate_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+                command_buffer_allocate_info.commandBufferCount = 1;
+                
+                VkCommandBuffer buffer = VK_NULL_HANDLE;
+                VkResult result = vkAllocateCommandBuffers(_device->_logical_device, &command_buffer_allocate_info, &buffer);
+                ASSERT_VULKAN(result);
+                f.buffers[kind].push_back(buffer);
+            }
+            
+            segment s {};
+            s.type = type;
+            s.buffer = f.buffers[kind][f.used[kind]++];
+            f.segments.push_back(s);
+            f.current = static_cast<uint32_t>(f.segments.size()) - 1;
+            
+            VkCommandBufferBeginInfo command_buffer_begin_info {};
+            command_buffer_begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+            command_buffer_begin_info.pNext = nullptr;
+            command_buffer_begin_info.flags = VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT;
+            command_buffer_begin_info.pInheritanceInfo = nullptr;
+            
+            VkResult result = vkBeginCommandBuffer(s.buffer, &command_buffer_begin_info);
+            ASSERT_VULKAN(result);
+            
+#if PROFILER_ENABLED
+            if(is_timing())
+            {
+                uint32_t query = 2 * f.current;
+                if(f.queries == VK_NULL_HANDLE)
+                {
+                    VkQueryPoolCreateInfo query_info {};
+                    query_info.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+                    query_info.queryType = VK_QUERY_TYPE_TIMESTAMP;
+                    query_info.queryCount = 2 * MAX_SEGMENTS + 1;
+                    result = vkCreateQueryPool(_device->_logical_device, &query_info, nullptr, &f.queries);
+                    ASSERT_VULKAN(result);
+                }
+                vkCmdResetQueryPool(s.buffer, f.queries, query, 2);
+                vkCmdWriteTimestamp(s.buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, f.queries, query);
+                
+                //note: the acquire semaphore is waited on at color attachment output, a timestamp at that stage is written once
+                //the image is there.  Compute queues don't have the stage, see end_command_recording
+                if(f.current == 0 && type == command_type::GRAPHICS)
+                {
+                    vkCmdResetQueryPool(s.buffer, f.queries, ACQUIRE_QUERY, 1);
+                    vkCmdWriteTimestamp(s.buffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, f.queries, ACQUIRE_QUERY);
+                }
+            }
+#endif
+        }
+        
+#if PROFILER_ENABLED
+        //note: submissions are timed while the profiler is on and every graphics and compute queue of the device has timestamps
+        inline bool is_timing() const
+        {
+            return profiler::is_enabled() && _device->_properties.limits.timestampComputeAndGraphics;
+        }
+        
+        //note: the fence of image_id was just waited on, the timestamps of its last submission are written
+        void read_timestamps(uint32_t image_id)
+        {
+            frame& f = _frames[image_id];
+            if(f.pending_segments == 0)
+                return;
+            
+            eastl::array<uint64_t, 2 * MAX_SEGMENTS> ticks {};
+            VkResult result = vkGetQueryPoolResults(_device->_logical_device, f.queries, 0, 2 * f.pending_segments,
+                                                    sizeof(ticks), ticks.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+            if(result == VK_SUCCESS)
+            {
+                double period = _device->_properties.limits.timestampPeriod;
+                uint64_t first = std::numeric_limits<uint64_t>::max();
+                uint64_t last = 0;
+                for( uint32_t i = 0; i < f.pending_segments; ++i)
+                {
+                    const char* name = f.segments[i].type == command_type::GRAPHICS ? "graphics submission" : "compute submission";
+                    uint64_t start = static_cast<uint64_t>(ticks[2 * i] * period);
+                    uint64_t end = static_cast<uint64_t>(ticks[2 * i + 1] * period);
+                    profiler::record_gpu(name, start, end, f.submit_time);
+                    first = std::min(first, start);
+                    last = std::max(last, end);
+                }
+                
+                uint64_t acquired = 0;
+                if(f.pending_acquire &&
+                   vkGetQueryPoolResults(_device->_logical_device, f.queries, ACQUIRE_QUERY, 1, sizeof(acquired), &acquired,
+                                         sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) == VK_SUCCESS)
+                {
+                    first = std::max(first, static_cast<uint64_t>(acquired * period));
+                }
+                f.gpu_time = last > first ? last - first : 0;
+            }
+            f.pending_segments = 0;
+        }
+#endif
+        
+        image_owner* find_owner(frame& f, VkImage image)
+        {
+            for( image_owner& owner : f.owners)
+            {
+                if(owner.image == image)
+                    return &owner;
+            }
+            return nullptr;
+        }
+        
+        inline uint32_t get_family(command_type type) const
+        {
+            return type == command_type::GRAPHICS ? _device->_queue_family_indices.graphics_family.value() :
+                                                    _device->_queue_family_indices.async_compute_family.value();
+        }
+        
+        //note: the release and the acquire name the same families and layouts, the layout changes once, in between the two
+        void transfer(frame& f, uint32_t from, uint32_t to, VkImageMemoryBarrier barrier, VkPipelineStageFlags consumer)
+        {
+            bool from_compute = f.segments[from].type == command_type::COMPUTE;
+            barrier.srcQueueFamilyIndex = get_family(f.segments[from].type);
+            barrier.dstQueueFamilyIndex = get_family(f.segments[to].type);
+            
+            VkImageMemoryBarrier release = barrier;
+            release.srcAccessMask = from_compute ? VK_ACCESS_SHADER_WRITE_BIT : VK_ACCESS_MEMORY_WRITE_BIT;
+            release.dstAccessMask = 0;
+            vkCmdPipelineBarrier(f.segments[from].buffer,
+                                 from_compute ? VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT : VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                                 VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &release);
+            
+            VkImageMemoryBarrier acquire = barrier;
+            acquire.srcAccessMask = 0;
+            if(f.segments[to].type == command_type::COMPUTE)
+                consumer = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+            vkCmdPipelineBarrier(f.segments[to].buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, consumer,
+                                 0, 0, nullptr, 0, nullptr, 1, &acquire);
+            
+            add_wait(f, to, from);
+        }
+        
+        void add_wait(frame& f, uint32_t waiter, uint32_t signaler)
+        {
+            EA_ASSERT(signaler < waiter);
+            f.segments[signaler].sealed = true;
+            for( uint32_t w : f.segments[waiter].waits)
+            {
+                if(w == signaler)
+                    return;
+            }
+            f.segments[waiter].waits.push_back(signaler);
+        }
+        
+        VkSemaphore get_semaphore(frame& f, uint32_t i)
+        {
+            if(i == f.semaphores.size())
+            {
+                VkSemaphoreCreateInfo semaphore_create_info {};
+                semaphore_create_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+                VkSemaphore semaphore = VK_NULL_HANDLE;
+                VkResult result = vkCreateSemaphore(_device->_logical_device, &semaphore_create_info, nullptr, &semaphore);
+                ASSERT_VULKAN(result);
+                f.semaphores.push_back(semaphore);
+            }
+            return f.semaphores[i];
+        }
+        
         void create_sync_objects()
         {
             for( int i = 0; i < glfw_swapchain::NUM_SWAPCHAIN_IMAGES; ++i)
@@ -189,10 +688,11 @@ namespace vk
         const char* _name = nullptr;
         glfw_swapchain& _swapchain;
         
-        eastl::array<VkCommandBuffer, glfw_swapchain::NUM_SWAPCHAIN_IMAGES> _graphics_buffer {};
+        eastl::array<frame, glfw_swapchain::NUM_SWAPCHAIN_IMAGES> _frames {};
         eastl::array<VkSemaphore, glfw_swapchain::NUM_SWAPCHAIN_IMAGES> _semaphores {};
         eastl::array<VkSemaphore, glfw_swapchain::NUM_SWAPCHAIN_IMAGES> _acquire_semaphores{};
         eastl::array<VkFence, glfw_swapchain::NUM_SWAPCHAIN_IMAGES>  _fences {};
+        eastl::array<uint64_t, glfw_swapchain::NUM_SWAPCHAIN_IMAGES> _recorded_states {};
 
     };
 }
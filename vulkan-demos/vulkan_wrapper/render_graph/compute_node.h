@@ -59,6 +59,20 @@ namespace vk
             return true;
         }
         
+        virtual void refresh_node_parameters(uint32_t image_id) override
+        {
+            _compute_pipelines.commit_parameter_to_gpu(image_id);
+        }
+        
+        virtual bool hash_node_commands(uint64_t& state, uint32_t image_id) override
+        {
+            command_recorder::hash_state(state, reinterpret_cast<uintptr_t>(_compute_pipelines.get_vk_pipeline(image_id)));
+            command_recorder::hash_state(state, _compute_pipelines.get_descriptor_writes(image_id));
+            command_recorder::hash_state(state, static_cast<uint64_t>(_group_x) << 32 | _group_y);
+            command_recorder::hash_state(state, _group_z);
+            return true;
+        }
+        
         virtual void destroy() override
         {
             _compute_pipelines.destroy();
@@ -15,6 +15,11 @@
 #include "graphics_node.h"
 #include "compute_node.h"
 #include "command_recorder.h"
+#include "transform_hierarchy.h"
+#include "asset_loader.h"
+#include "texture_streamer.h"
+#include "job_system.h"
+#include "frame_capture.h"
 
 namespace vk
 {
@@ -30,6 +35,7 @@ namespace vk
         graph(device* dev, material_store& mat_store, glfw_swapchain& swapchain):
         node_type::node_type(dev),
         _commands(dev, swapchain),
+        _secondary(dev),
         _material_store(mat_store),
         _texture_registry(dev)
         {
@@ -62,18 +68,132 @@ namespace vk
         }
         
         
+        //note: the command buffer of an image is only recorded again when what it records changed, see node::hash_commands.
+        //Parameters and draw data are written every frame either way
         inline void record(uint32_t image_id)
         {
+            PROFILE_ZONE("graph::record");
+            _commands.wait(image_id);
+            //note: the fence of image_id was just waited on, the feedback its last frame wrote is complete
+            node_type::_device->get_texture_streamer().read_feedback(image_id);
+            
+            //note: shader parameters and draw data of nodes that are thread safe are written on several threads, see job_system
+            node_type::reset_node(node_type::_level, node_type::_device);
+            job_system& jobs = node_type::_device->get_job_system();
+            typename node_type::job_walk walk {};
+            jobs.begin();
+            for( eastl_size_t i = 0; i < node_type::_children.size(); ++i)
+            {
+                node_type::_children[i]->add_refresh_jobs(jobs, walk, image_id);
+            }
+            jobs.run();
+            
+            uint64_t state = command_recorder::EMPTY_STATE;
+            command_recorder::hash_state(state, node_type::_device->get_texture_streamer().is_feedback_enabled());
+            command_recorder::hash_state(state, node_type::_device->has_async_compute());
+            command_recorder::hash_state(state, profiler::is_enabled());
+            //note: a capture always records, the copy has to know the frame it is in
+            bool capturing = _capture != nullptr && _capture->is_requested();
+            command_recorder::hash_state(state, capturing);
             node_type::reset_node(node_type::_level, node_type::_device);
+            if(!node_type::hash_commands(state, image_id))
+                state = command_recorder::UNKNOWN_STATE;
             
+            if(_reuse_commands && !capturing && _commands.is_recorded(image_id, state))
+            {
+                ++_num_reused;
+                return;
+            }
+            
+            node_type::reset_node(node_type::_level, node_type::_device);
             _commands.reset(image_id);
+            ++_num_recorded;
+            
+            //note: draws go to secondary command buffers recorded on several threads first, the walk below executes them in the
+            //order it always recorded them
+            _secondary.begin_frame(image_id);
+            if(secondary_recorder::get_num_threads() != 0)
+            {
+                node_type::prepare(_secondary, image_id);
+                _secondary.run();
+                node_type::reset_node(node_type::_level, node_type::_device);
+            }
+            
             _commands.begin_command_recording(image_id);
             record(_commands, image_id);
+            _commands.join_queues(image_id);
             _texture_registry.reset_render_textures(image_id);
             //reset_textures(_commands, image_id);
+            node_type::_device->get_texture_streamer().record_feedback_barrier(_commands.get_raw_graphics_command(image_id));
+            if(capturing)
+                _capture->record(_commands.get_raw_graphics_command(image_id), image_id);
             _commands.end_command_recording(image_id);
+            _commands.set_recorded_state(image_id, state);
+        }
+        
+        //note: false records every frame, like it used to
+        inline void set_reuse_commands(bool reuse)
+        {
+            _reuse_commands = reuse;
+            _commands.invalidate();
         }
         
+        //note: the frame recorded after capture.request() copies its swapchain image to capture, null captures nothing.  A frame
+        //with a copy is never reused, the one after it is recorded again without
+        inline void set_capture(frame_capture* capture)
+        {
+            _capture = capture;
+        }
+        
+        //note: call after glfw_swapchain::resize, old_size is the extent the swapchain had before.  Render and depth textures of
+        //that size are made again at the new one along with the framebuffers and descriptors that use them, nodes update what
+        //else depends on the size (see node::resize_node).  Pipelines, shaders and the rest of the textures are kept.  The next
+        //frame has to be image 0, the new swapchain hands its images out from the start
+        inline void resize(glm::vec2 old_size, glm::vec2 new_size)
+        {
+            PROFILE_ZONE("graph::resize");
+            node_type::_device->wait_for_all_operations_to_finish();
+            _texture_registry.resize(old_size, new_size);
+            
+            node_type::reset_node(node_type::_level, node_type::_device);
+            for( eastl_size_t i = 0; i < node_type::_children.size(); ++i)
+            {
+                node_type::_children[i]->resize(old_size, new_size);
+            }
+            _commands.invalidate();
+        }
+        
+        //note: passes with dynamic resolution (see graphics_node::set_dynamic_resolution) draw to the top left part of their
+        //targets, scale_dimensions of their size.  The targets keep the size of the swapchain, a node like upscale stretches
+        //the result back over the whole target before it is presented.  Nodes that read the scaled targets update the shader
+        //parameters that depend on it in render_scale_node.  Command buffers recorded at another scale are recorded again
+        inline void set_render_scale(float scale)
+        {
+            EA_ASSERT_MSG(scale > 0.0f && scale <= 1.0f, "the render scale goes from 0 to 1, targets are as big as they get at 1");
+            if(scale == _render_scale)
+                return;
+            
+            _render_scale = scale;
+            node_type::reset_node(node_type::_level, node_type::_device);
+            for( eastl_size_t i = 0; i < node_type::_children.size(); ++i)
+            {
+                node_type::_children[i]->set_render_scale(scale);
+            }
+        }
+        
+        inline float get_render_scale() const { return _render_scale; }
+        
+        //note: frames submitted with the command buffer they had and frames that were recorded, since the graph was created
+        inline uint64_t get_num_reused() const { return _num_reused; }
+        inline uint64_t get_num_recorded() const { return _num_recorded; }
+        
+        //note: submissions the last recording of image_id is split in and how many of them go to the compute queue, see
+        //command_recorder
+        inline uint32_t get_num_submissions(uint32_t image_id) const { return _commands.get_num_submissions(image_id); }
+        inline uint32_t get_num_async_submissions(uint32_t image_id) const { return _commands.get_num_compute_submissions(image_id); }
+        //note: gpu time of the frame image_id showed before the last call to record(image_id), see command_recorder::get_gpu_time
+        inline uint64_t get_gpu_time(uint32_t image_id) const { return _commands.get_gpu_time(image_id); }
+        
         //submits all commands
         virtual void execute(uint32_t image_id)
         {
@@ -82,16 +202,29 @@ namespace vk
         
         void update(vk::camera& camera, uint32_t image_id) override
         {
+            PROFILE_ZONE("graph::update");
             node_type::reset_node(node_type::_level, node_type::_device);
             
+            //note: textures whose pixels the workers finished decoding are copied to their images before this frame samples them.
+            //Both submit to the graphics queue, they stay on this thread
+            node_type::_device->get_asset_loader().upload_completed();
+            node_type::_device->get_texture_streamer().update();
+            
+            //note: world matrices are computed once here, before any node reads them.  Nodes update after them
+            job_system& jobs = node_type::_device->get_job_system();
+            typename node_type::job_walk walk {};
+            jobs.begin();
+            walk.barrier = node_type::_device->get_transform_hierarchy().add_update_jobs(jobs);
             for( eastl_size_t i = 0; i < node_type::_children.size(); ++i)
             {
-                node_type::_children[i]->update(camera,  image_id);
+                node_type::_children[i]->add_update_jobs(jobs, walk, camera, image_id);
             }
+            jobs.run();
         }
         
         void destroy() override
         {
+            _secondary.destroy();
             _commands.destroy();
             _texture_registry.destroy();
         }
@@ -190,7 +323,14 @@ namespace vk
         
         texture_registry<NUM_CHILDREN> _texture_registry;
         command_recorder _commands;
+        secondary_recorder _secondary;
         material_store& _material_store;
+        frame_capture* _capture = nullptr;
+        
+        bool _reuse_commands = true;
+        float _render_scale = 1.0f;
+        uint64_t _num_reused = 0;
+        uint64_t _num_recorded = 0;
     };
 }
 
@@ -30,7 +30,8 @@ namespace vk {
         using render_pass_type =  render_pass<NUM_ATTACHMENTS>;
         using mesh_node = vk::assimp_node<NUM_CHILDREN>;
         using object_subpass_mask = eastl::fixed_map<mesh_node*, uint32_t, 20, true>;
-        using object_vector_type = eastl::fixed_vector<vk::assimp_node<NUM_CHILDREN>*, 20, true>;
+        using object_vector_type = eastl::fixed_vector<vk::assimp_node<NUM_CHILDREN>*, 20, true, arena_allocator>;
+        using object_subpass_vector = eastl::fixed_vector<uint32_t, 20, true, arena_allocator>;
         
         graphics_node(){}
         
@@ -41,18 +42,75 @@ namespace vk {
         
         virtual bool record_node_commands(command_recorder& buffer, uint32_t image_id) override
         {
-            _node_render_pass.commit_parameters_to_gpu(image_id);
-            static constexpr uint32_t instance_count = 1;
-            _node_render_pass.record_draw_commands(buffer.get_raw_graphics_command(image_id), image_id, instance_count);
+            _node_render_pass.record_draw_commands(buffer.get_raw_graphics_command(image_id), image_id);
             
             return true;
         }
         
+        virtual void prepare_node_commands(secondary_recorder& recorder, uint32_t image_id) override
+        {
+            _node_render_pass.prepare_draw_commands(recorder, image_id);
+        }
+        
+        virtual void refresh_node_parameters(uint32_t image_id) override
+        {
+            _node_render_pass.commit_parameters_to_gpu(image_id);
+        }
+        
+        virtual bool hash_node_commands(uint64_t& state, uint32_t image_id) override
+        {
+            _node_render_pass.hash_draw_commands(state, image_id);
+            //note: the viewport is recorded
+            glm::vec2 render_dims = _node_render_pass.get_render_dimensions();
+            command_recorder::hash_state(state, static_cast<uint64_t>(render_dims.x));
+            command_recorder::hash_state(state, static_cast<uint64_t>(render_dims.y));
+            return true;
+        }
+        
+        //note: the pass draws to part of its targets when the graph renders below full resolution, everything that samples
+        //them has to know.  See graph::set_render_scale
+        inline void set_dynamic_resolution(bool b){ _dynamic_resolution = b; }
+        inline bool has_dynamic_resolution() const { return _dynamic_resolution; }
+        
+        virtual void render_scale_node(float scale) override
+        {
+            if(_dynamic_resolution)
+                _node_render_pass.set_render_scale(scale);
+        }
+        
         inline void set_dimensions( uint32_t width, uint32_t height)
         {
             _node_render_pass.set_dimensions(glm::vec2(width, height));
         }
         
+        //note: passes the size of the swapchain follow it, the ones with a size of their own (voxels, environment maps) keep it
+        virtual void resize_node(glm::vec2 old_size, glm::vec2 new_size) override
+        {
+            if(_node_render_pass.get_dimensions() == old_size)
+                _node_render_pass.resize(new_size);
+        }
+        
+        //note: the node that fills out the draws (i.e. frustum_cull) should be a child of this node so that it records first.
+        //Levels of detail are then picked with the view of the cull node
+        inline void set_indirect_draws(indirect_draws& draws)
+        {
+            _node_render_pass.set_indirect_draws(&draws);
+            _indirect_draws = &draws;
+        }
+        
+        //note: without a lod_view (here or from the indirect draws) objects are drawn at full detail
+        inline void set_lod_view(const lod_view& view)
+        {
+            _lod_view = &view;
+        }
+        
+        //note: select_lods writes the level it picks into every mesh, nodes that pick levels with the same lod_view would write
+        //the same ones.  Those nodes are not thread safe
+        inline bool picks_lods() const
+        {
+            return _lod_view != nullptr || (_indirect_draws != nullptr && _indirect_draws->get_lod_view() != nullptr);
+        }
+        
         virtual void init() override
         {
             assert(node_type::_device != nullptr);
@@ -87,41 +145,67 @@ namespace vk {
         }
         
         
+        template< typename T>
         bool set_dynamic_param(const char* name, uint32_t image_id,
-                                uint32_t subpass_id, obj_shape* obj,  glm::mat4 mat, uint32_t binding)
+                                uint32_t subpass_id, obj_shape* obj, const T& mat, uint32_t binding)
         {
             typename render_pass_type::subpass_s& subpass = _node_render_pass.get_subpass(subpass_id);
             
-            //TODO: This is slow. This will not be a factor in the near futre since we don't have that many
-            //objects.  Possible solution?: eastl::fixed_map.
+            uint32_t obj_id = _node_render_pass.find_object(obj);
+            if(subpass.is_ignored(obj_id))
+            {
+                EA_FAIL_MSG("you are trying to set a dynamic parameter to an object not included in this subpass");
+                return false;
+            }
+            
+            //use the index to access the dynamic parameter memory for this object
+            uint32_t dynamic_id = subpass.get_dynamic_index(obj_id, _node_render_pass.get_num_objs());
+            subpass.get_pipeline(image_id).get_dynamic_parameters(parameter_stage::VERTEX, binding)[dynamic_id][name] = mat;
+            
+            return true;
+        }
+        
+        //note: takes the mesh to object space, instances then place it in the world (see instance_pool.h).  This is the
+        //dequantization of packed shapes, every level of detail has its own so the one of the level that is drawn is used.
+        //"instance_base" follows it in the same block, it is what the shader adds to gl_InstanceIndex: the first instance of the
+        //shape when draws start at instance 0, see device::has_draw_indirect_first_instance
+        bool set_mesh_param(const char* name, uint32_t image_id, uint32_t subpass_id, obj_shape* obj, uint32_t binding)
+        {
+            obj_shape* drawn = _node_render_pass.get_drawn_shape(obj);
+            uint32_t instance_base = node_type::_device->has_draw_indirect_first_instance() ? 0 : drawn->get_instances().first_instance;
+            return set_dynamic_param(name, image_id, subpass_id, obj, drawn->get_dequantization_matrix(), binding) &&
+                   set_dynamic_param("instance_base", image_id, subpass_id, obj, instance_base, binding);
+        }
+        
+        void add_mesh_param(const char* name, uint32_t subpass_id, uint32_t binding)
+        {
+            add_dynamic_param(name, subpass_id, parameter_stage::VERTEX, glm::mat4(1.0f), binding);
+            add_dynamic_param("instance_base", subpass_id, parameter_stage::VERTEX, uint32_t(0), binding);
+        }
+        
+        //picks the level of detail every object is drawn with this frame, call it in update_node before setting model parameters
+        void select_lods(vk::camera& camera, uint32_t image_id)
+        {
+            const lod_view* view = _lod_view;
+            if(_indirect_draws != nullptr && _indirect_draws->get_lod_view() != nullptr)
+            {
+                EA_ASSERT_MSG(view == nullptr || view == _indirect_draws->get_lod_view(),
+                              "this node and its cull node pick levels of detail with different views, they would not agree");
+                view = _indirect_draws->get_lod_view();
+            }
             
-            int32_t count = 0;
-            int i = 0;
+            if(view == nullptr)
+                return;
             
-            bool result = false;
-            while(i < _node_render_pass.get_num_objs())
+            for( mesh_node* obj : _obj_vector)
             {
-                if(!subpass.is_ignored(i))
-                {
-                    if(obj == _node_render_pass.get_object(i))
-                    {
-                        //use the index to access the dynamic parameter memory for this object
-                        subpass.get_pipeline(image_id).
-                                            get_dynamic_parameters(parameter_stage::VERTEX, binding)[count][name] = mat;
-                        
-                        result = true;
-                        break;
-                    }
-                    ++count;
-                }
-                ++i;
+                _node_render_pass.set_drawn_shape(obj->get_lod(0), obj->select_lod(*view, camera, image_id));
             }
-            EA_ASSERT_MSG(result != false, "you are trying to set a dynamic parameter to an object not included in this subpass");
-            return result;
         }
         
+        template< typename T>
         void add_dynamic_param(const char* name, uint32_t subpass_id,
-                               parameter_stage stage, glm::mat4 mat, uint32_t binding)
+                               parameter_stage stage, const T& mat, uint32_t binding)
         {
             int count = 0;
             typename render_pass_type::subpass_s& subpass = _node_render_pass.get_subpass(subpass_id);
@@ -161,6 +245,10 @@ namespace vk {
         render_pass_type _node_render_pass;
         object_vector_type  _obj_vector;
         
+        indirect_draws* _indirect_draws = nullptr;
+        const lod_view* _lod_view = nullptr;
+        bool _dynamic_resolution = false;
+        
         
     };
 }
@@ -0,0 +1,269 @@
+//
+//  indirect_draws.h
+//  vulkan-demos
+//
+//  Created by Rafael Sabino on 10/19/26.
+//  Copyright © 2026 Rafael Sabino. All rights reserved.
+//
+
+#pragma once
+
+#include "EASTL/array.h"
+#include "EASTL/fixed_vector.h"
+#include "EASTL/fixed_map.h"
+
+#include "../core/object.h"
+#include "../core/device.h"
+#include "../core/arena.h"
+#include "glfw_swapchain.h"
+#include "storage_buffer.h"
+#include "obj_shape.h"
+#include "lod_view.h"
+#include <cstring>
+
+namespace vk
+{
+    //note: holds one VkDrawIndexedIndirectCommand per mesh (a "slot") that is filled out on the gpu by a culling shader,
+    //render passes that are handed this object draw their meshes through the slots instead of vkCmdDrawIndexed.
+    //
+    //the slots of a shape make up its range.  When the device has VK_KHR_draw_indirect_count and the level that is drawn lives
+    //in one geometry block, the culling shader packs the visible meshes of a shape at the start of its range and counts them,
+    //the shape then goes out in one vkCmdDrawIndexedIndirectCountKHR.  Otherwise every mesh keeps its own slot and culled
+    //meshes get an instance count of zero.  A range can't span shapes, every object has its own dynamic parameters
+    class indirect_draws : public object
+    {
+    public:
+
+        //note: draws kept inline, more grow into the persistent arena
+        static constexpr uint32_t MAX_DRAWS = 256u;
+        static constexpr uint32_t COMMAND_STRIDE = sizeof(VkDrawIndexedIndirectCommand);
+        //note: written into the draw infos of meshes that are not packed, must match frustum_cull.comp
+        static constexpr uint32_t NO_RANGE = 0xffffffffu;
+
+        struct slot
+        {
+            obj_shape*  shape = nullptr;
+            uint32_t    mesh_id = 0;
+            uint32_t    range = 0;
+        };
+
+        struct range
+        {
+            uint32_t    first_slot = 0;
+            uint32_t    num_slots = 0;
+        };
+
+        indirect_draws(){}
+        indirect_draws(device* dev){ _device = dev; }
+
+        indirect_draws & operator=(const indirect_draws&) = delete;
+        indirect_draws(const indirect_draws&) = delete;
+        indirect_draws & operator=(indirect_draws&) = delete;
+        indirect_draws(indirect_draws&) = delete;
+
+        inline void set_device(device* dev)
+        {
+            _device = dev;
+        }
+
+        //note: the meshes of a shape have to be added in order, one after the other, their slots are found from the first one
+        inline uint32_t add_draw(obj_shape* shape, uint32_t mesh_id)
+        {
+            EA_ASSERT_MSG(!is_initialized(), "draws must be added before the indirect buffers are created");
+            EA_ASSERT_MSG(get_slot(shape, mesh_id) == -1, "this mesh already has a draw slot");
+
+            uint32_t slot_id = static_cast<uint32_t>(_slots.size());
+            if(mesh_id == 0)
+            {
+                _first_slots[shape] = slot_id;
+                range r {};
+                r.first_slot = slot_id;
+                _ranges.push_back(r);
+            }
+            EA_ASSERT_MSG(!_ranges.empty(), "the first mesh of a shape has to be added first");
+            ++_ranges.back().num_slots;
+
+            slot s {};
+            s.shape = shape;
+            s.mesh_id = mesh_id;
+            s.range = static_cast<uint32_t>(_ranges.size() - 1);
+            _slots.push_back(s);
+
+            EA_ASSERT_MSG(get_slot(shape, mesh_id) == static_cast<int32_t>(slot_id), "meshes of a shape must be added in order");
+
+            return slot_id;
+        }
+
+        inline int32_t get_slot(obj_shape* shape, uint32_t mesh_id)
+        {
+            first_slot_map::iterator it = _first_slots.find(shape);
+            if(it == _first_slots.end())
+                return -1;
+
+            uint32_t slot_id = it->second + mesh_id;
+            if(slot_id >= _slots.size() || _slots[slot_id].shape != shape || _slots[slot_id].mesh_id != mesh_id)
+                return -1;
+
+            return static_cast<int32_t>(slot_id);
+        }
+
+        inline slot& get_draw(uint32_t slot_id)
+        {
+            EA_ASSERT(slot_id < _slots.size());
+            return _slots[slot_id];
+        }
+
+        inline uint32_t get_num_draws(){ return static_cast<uint32_t>(_slots.size()); }
+
+        inline range& get_range(uint32_t range_id)
+        {
+            EA_ASSERT(range_id < _ranges.size());
+            return _ranges[range_id];
+        }
+
+        //note: drawn is the level of detail that is drawn through the range, the culling shader and the render pass both
+        //ask so that they agree on where the commands of the shape are
+        inline bool is_packed(obj_shape* drawn)
+        {
+            return _device->has_draw_indirect_count() && is_single_block(drawn);
+        }
+
+        inline static bool is_single_block(obj_shape* drawn)
+        {
+            for( uint32_t mesh_id = 1; mesh_id < drawn->get_num_meshes(); ++mesh_id)
+            {
+                if(drawn->get_geometry_block(mesh_id) != drawn->get_geometry_block(0))
+                    return false;
+            }
+            return true;
+        }
+
+        //note: the culling node writes the geometry of the level it picked into the commands, passes that draw through them
+        //have to pick levels with the same view
+        inline void set_lod_view(const lod_view* view){ _lod_view = view; }
+        inline const lod_view* get_lod_view(){ return _lod_view; }
+
+        void create()
+        {
+            EA_ASSERT_MSG(_device != nullptr, "no device set for indirect draws");
+            EA_ASSERT_MSG(!_slots.empty(), "no draws were added");
+
+            for( int i = 0; i < _commands.size(); ++i)
+            {
+                _commands[i].set_device(_device);
+                _commands[i].create(COMMAND_STRIDE * _slots.size(),
+                                    VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+                                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+                //note: the total comes first, the count of every range follows it
+                _visible_count[i].set_device(_device);
+                _visible_count[i].create(sizeof(uint32_t) * (1 + _ranges.size()),
+                                         VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+                                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+                reset_visible_count(i);
+            }
+        }
+
+        inline bool is_initialized(){ return _commands[0].is_initialized(); }
+
+        inline storage_buffer& get_commands(uint32_t image_id){ return _commands[image_id]; }
+        inline storage_buffer& get_visible_count_buffer(uint32_t image_id){ return _visible_count[image_id]; }
+
+        inline eastl::array<storage_buffer, glfw_swapchain::NUM_SWAPCHAIN_IMAGES>& get_commands(){ return _commands; }
+        inline eastl::array<storage_buffer, glfw_swapchain::NUM_SWAPCHAIN_IMAGES>& get_visible_count_buffers(){ return _visible_count; }
+
+        //note: only safe to call once the fence for this image has been waited on
+        inline uint32_t get_visible_count(uint32_t image_id)
+        {
+            return *static_cast<uint32_t*>(_visible_count[image_id].get_mapped_memory());
+        }
+
+        //note: the range counts are cleared with the total, the culling shader packs every range from its start again
+        inline void reset_visible_count(uint32_t image_id)
+        {
+            memset(_visible_count[image_id].get_mapped_memory(), 0, sizeof(uint32_t) * (1 + _ranges.size()));
+        }
+
+        inline void record_draw(VkCommandBuffer& buffer, uint32_t image_id, uint32_t slot_id)
+        {
+            EA_ASSERT(slot_id < _slots.size());
+            vkCmdDrawIndexedIndirect(buffer, _commands[image_id].get_vk_buffer(), slot_id * COMMAND_STRIDE, 1, COMMAND_STRIDE);
+        }
+
+        //draws every mesh of the range of slot_id's shape, drawn has to live in one geometry block and it has to be bound
+        inline void record_range(VkCommandBuffer& buffer, uint32_t image_id, uint32_t slot_id, obj_shape* drawn)
+        {
+            EA_ASSERT(slot_id < _slots.size());
+            EA_ASSERT_MSG(is_single_block(drawn), "meshes of a range are drawn with one vertex and index buffer");
+            const range& r = _ranges[_slots[slot_id].range];
+            VkDeviceSize offset = r.first_slot * COMMAND_STRIDE;
+
+            if(is_packed(drawn))
+            {
+                VkDeviceSize count_offset = sizeof(uint32_t) * (1 + _slots[slot_id].range);
+                _device->get_draw_indexed_indirect_count()(buffer, _commands[image_id].get_vk_buffer(), offset,
+                                                           _visible_count[image_id].get_vk_buffer(), count_offset,
+                                                           r.num_slots, COMMAND_STRIDE);
+            }
+            else if(_device->has_multi_draw_indirect())
+            {
+                vkCmdDrawIndexedIndirect(buffer, _commands[image_id].get_vk_buffer(), offset, r.num_slots, COMMAND_STRIDE);
+            }
+            else
+            {
+                for( uint32_t i = 0; i < r.num_slots; ++i)
+                    record_draw(buffer, image_id, r.first_slot + i);
+            }
+        }
+
+        //makes the commands and counts written by the culling shader visible to the draw indirect stage
+        void record_barrier(VkCommandBuffer& buffer, uint32_t image_id)
+        {
+            eastl::array<VkBufferMemoryBarrier, 2> barriers {};
+            eastl::array<VkBuffer, 2> buffers = { _commands[image_id].get_vk_buffer(), _visible_count[image_id].get_vk_buffer() };
+            for( int i = 0; i < barriers.size(); ++i)
+            {
+                VkBufferMemoryBarrier& barrier = barriers[i];
+                barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+                barrier.pNext = nullptr;
+                barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+                barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+                barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                barrier.buffer = buffers[i];
+                barrier.offset = 0;
+                barrier.size = VK_WHOLE_SIZE;
+            }
+
+            vkCmdPipelineBarrier(buffer,
+                                 VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                 VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+                                 0,
+                                 0, nullptr,
+                                 static_cast<uint32_t>(barriers.size()), barriers.data(),
+                                 0, nullptr);
+        }
+
+        virtual void destroy() override
+        {
+            for( int i = 0; i < _commands.size(); ++i)
+            {
+                _commands[i].destroy();
+                _visible_count[i].destroy();
+            }
+        }
+
+    private:
+
+        device* _device = nullptr;
+        const lod_view* _lod_view = nullptr;
+        using first_slot_map = eastl::fixed_map<obj_shape*, uint32_t, MAX_DRAWS, true, eastl::less<obj_shape*>, arena_allocator>;
+
+        eastl::fixed_vector<slot, MAX_DRAWS, true, arena_allocator> _slots {};
+        eastl::fixed_vector<range, MAX_DRAWS, true, arena_allocator> _ranges {};
+        first_slot_map _first_slots {};
+
+        eastl::array<storage_buffer, glfw_swapchain::NUM_SWAPCHAIN_IMAGES> _commands {};
+        eastl::array<storage_buffer, glfw_swapchain::NUM_SWAPCHAIN_IMAGES> _visible_count {};
+    };
+}
@@ -11,6 +11,8 @@
 #include "EASTL/fixed_vector.h"
 
 #include "command_recorder.h"
+#include "secondary_recorder.h"
+#include "job_system.h"
 #include "camera.h"
 #include "texture_registry.h"
 #include "material_store.h"
@@ -31,6 +33,14 @@ namespace  vk
         using tex_registry_type = texture_registry<NUM_CHILDREN>;
         using material_store_type = material_store;
         
+        //note: carried through add_update_jobs and add_refresh_jobs.  Nodes that are not thread safe run alone, after every job
+        //added before them and before every job added after them, so they see what they saw when the graph updated on one thread
+        struct job_walk
+        {
+            uint32_t barrier = job_system::NO_JOB;
+            eastl::vector<uint32_t> since_barrier {};
+        };
+        
         node(){}
         
         node(device* device)
@@ -115,9 +125,30 @@ namespace  vk
         virtual void init_node() = 0;
         virtual bool record_node_commands(command_recorder& buffer, uint32_t image_id) = 0;
         
+        //note: called before record, nodes hand the work that can be recorded on other threads to the recorder here.  Whatever
+        //is prepared is executed by record_node_commands, nodes that prepare nothing record the way they always have
+        virtual void prepare_node_commands(secondary_recorder& recorder, uint32_t image_id){}
+        
+        //note: writes what changes from frame to frame without recording anything, shader parameters and draw data.  Called
+        //every frame before record, whether the command buffer is recorded again or submitted as it was
+        virtual void refresh_node_parameters(uint32_t image_id){}
+        
+        //note: folds into state everything record_node_commands would record besides what refresh_node_parameters writes:
+        //pipelines, objects, descriptor sets, dispatch sizes.  Nodes that can't tell return false and the graph is recorded again
+        virtual bool hash_node_commands(uint64_t& state, uint32_t image_id){ return false; }
+        
         virtual VkPipelineStageFlagBits get_producer_stage() = 0;
         virtual VkPipelineStageFlagBits get_consumer_stage() = 0;
         
+        //note: true if the node can run on a queue for compute alone.  Only nodes whose every resource comes from the texture
+        //registry can, queue ownership of other resources is not transferred.  See command_recorder
+        virtual bool is_async_compatible(){ return false; }
+        
+        //note: true if update_node and refresh_node_parameters only write what belongs to this node and only read what no other
+        //node writes while the graph updates, besides what its children wrote.  These nodes update on the threads of the job
+        //system in parallel with each other, see add_update_jobs
+        virtual bool is_thread_safe(){ return false; }
+        
         
         inline void set_enable(bool b){ _enable = b; }
         
@@ -151,6 +182,10 @@ namespace  vk
                     result = result && node_type::_children[i]->record(buffer, image_id);
                 }
                 
+                command_recorder::command_type queue = is_async_compatible() ? command_recorder::command_type::COMPUTE :
+                                                                               command_recorder::command_type::GRAPHICS;
+                buffer.begin_node(image_id, queue, needs_queue_transfer(buffer, image_id, queue));
+                
                 //TODO: always record transitions.  typically all nodes in a graph would be executed, but in debug mode this may not happen.
                 record_transitions(buffer, image_id);
                 if( result && _active)
@@ -163,6 +198,116 @@ namespace  vk
             return result;
         }
         
+        //note: same walk as record, children first
+        virtual void prepare(secondary_recorder& recorder, uint32_t image_id)
+        {
+            if(!_visited)
+            {
+                _visited = true;
+                for( int i = 0; i < _children.size(); ++i)
+                {
+                    node_type::_children[i]->prepare(recorder, image_id);
+                }
+                
+                if(_active)
+                    prepare_node_commands(recorder, image_id);
+            }
+        }
+        
+        //note: same walk as update, children first.  Adds a job per node that calls update_node once, a node with several parents
+        //used to be updated once per parent.  Jobs run after walk.barrier, the job the walk starts with
+        void add_update_jobs(job_system& jobs, job_walk& walk, vk::camera& camera, uint32_t image_id)
+        {
+            if(!_visited)
+            {
+                _visited = true;
+                for( int i = 0; i < _children.size(); ++i)
+                {
+                    node_type::_children[i]->add_update_jobs(jobs, walk, camera, image_id);
+                }
+                
+                add_job(jobs, walk, [this, &camera, image_id](){ update_node(camera, image_id); });
+            }
+        }
+        
+        //note: same walk as record, children first.  Adds a job per node that calls refresh_node_parameters
+        void add_refresh_jobs(job_system& jobs, job_walk& walk, uint32_t image_id)
+        {
+            if(!_visited)
+            {
+                _visited = true;
+                for( int i = 0; i < _children.size(); ++i)
+                {
+                    node_type::_children[i]->add_refresh_jobs(jobs, walk, image_id);
+                }
+                
+                add_job(jobs, walk, [this, image_id]()
+                {
+                    if(_active)
+                        refresh_node_parameters(image_id);
+                });
+            }
+        }
+        
+        //note: same walk as init, children first.  The swapchain went from old_size to new_size and the texture registry made
+        //the render targets that were its size again, see graph::resize
+        void resize(glm::vec2 old_size, glm::vec2 new_size)
+        {
+            if(!_visited)
+            {
+                _visited = true;
+                for( int i = 0; i < _children.size(); ++i)
+                {
+                    node_type::_children[i]->resize(old_size, new_size);
+                }
+                
+                resize_node(old_size, new_size);
+            }
+        }
+        
+        //note: nodes make again whatever else was sized after the swapchain (framebuffers, images of their own, shader parameters).
+        //Pipelines and textures that are not render targets are kept
+        virtual void resize_node(glm::vec2 old_size, glm::vec2 new_size){}
+        
+        //note: same walk as resize.  Nodes that draw at the render scale draw to part of their targets, the ones that read those
+        //targets scale what they sample, see graph::set_render_scale
+        void set_render_scale(float scale)
+        {
+            if(!_visited)
+            {
+                _visited = true;
+                for( int i = 0; i < _children.size(); ++i)
+                {
+                    node_type::_children[i]->set_render_scale(scale);
+                }
+                
+                render_scale_node(scale);
+            }
+        }
+        
+        virtual void render_scale_node(float scale){}
+        
+        //note: same walk as record, returns false if any active node can't tell what it records
+        virtual bool hash_commands(uint64_t& state, uint32_t image_id)
+        {
+            bool result = true;
+            if(!_visited)
+            {
+                _visited = true;
+                for( int i = 0; i < _children.size(); ++i)
+                {
+                    result = node_type::_children[i]->hash_commands(state, image_id) && result;
+                }
+                
+                command_recorder::hash_state(state, reinterpret_cast<uintptr_t>(this));
+                command_recorder::hash_state(state, _active);
+                command_recorder::hash_state(state, is_async_compatible());
+                if(_active)
+                    result = hash_node_commands(state, image_id) && result;
+            }
+            return result;
+        }
+        
         inline void set_name(const char* name)
         {
             _name = name;
@@ -199,6 +344,30 @@ namespace  vk
         
         virtual void create_gpu_resources() = 0;
         
+        //note: children have added their jobs by now
+        void add_job(job_system& jobs, job_walk& walk, job_system::job_function function)
+        {
+            _job = jobs.add(_name.c_str(), eastl::move(function));
+            jobs.depend(_job, walk.barrier);
+            if(is_thread_safe())
+            {
+                for( int i = 0; i < _children.size(); ++i)
+                {
+                    jobs.depend(_job, node_type::_children[i]->_job);
+                }
+                walk.since_barrier.push_back(_job);
+            }
+            else
+            {
+                for( uint32_t job : walk.since_barrier)
+                {
+                    jobs.depend(_job, job);
+                }
+                walk.since_barrier.clear();
+                walk.barrier = _job;
+            }
+        }
+        
         
         VkAccessFlagBits get_dst_access_maks(VkPipelineStageFlags flag)
         {
@@ -262,15 +431,46 @@ namespace  vk
             return "";
         }
         
+        //note: the image of a dependee, the one of image_id for resource sets.  Null for resources that aren't images
+        vk::image* get_dependee_image(eastl::shared_ptr<vk::object>& res, uint32_t image_id)
+        {
+            if(res->get_instance_type() == texture_2d::get_class_type() ||
+               res->get_instance_type() == texture_3d::get_class_type() ||
+               res->get_instance_type() == texture_cube::get_class_type() ||
+               res->get_instance_type() == render_texture::get_class_type())
+                return eastl::static_pointer_cast<vk::image>(res).get();
+            if(res->get_instance_type() == resource_set<vk::texture_2d>::get_class_type())
+                return &((*eastl::static_pointer_cast< resource_set<vk::texture_2d>>(res))[image_id]);
+            if(res->get_instance_type() == resource_set<vk::texture_3d>::get_class_type())
+                return &((*eastl::static_pointer_cast< resource_set<vk::texture_3d>>(res))[image_id]);
+            if(res->get_instance_type() == resource_set<vk::depth_texture>::get_class_type())
+                return &((*eastl::static_pointer_cast< resource_set<vk::depth_texture>>(res))[image_id]);
+            if(res->get_instance_type() == resource_set<vk::render_texture>::get_class_type())
+                return &((*eastl::static_pointer_cast< resource_set<vk::render_texture>>(res))[image_id]);
+            if(res->get_instance_type() == resource_set<vk::texture_cube>::get_class_type())
+                return &((*eastl::static_pointer_cast< resource_set<vk::texture_cube>>(res))[image_id]);
+            return nullptr;
+        }
+        
+        //note: true if an image this node depends on was used last by the other queue, the node then waits on it
+        bool needs_queue_transfer(command_recorder& buffer, uint32_t image_id, command_recorder::command_type queue)
+        {
+            typename tex_registry_type::node_dependees& dependees = _texture_registry->get_dependees(this);
+            for( typename tex_registry_type::dependant_data& d : dependees)
+            {
+                eastl::shared_ptr<vk::object> res = eastl::static_pointer_cast<vk::object>(d.data.resource);
+                vk::image* p_image = get_dependee_image(res, image_id);
+                if(p_image != nullptr && buffer.needs_transfer(image_id, p_image->get_image(), queue))
+                    return true;
+            }
+            return false;
+        }
+        
         void create_barrier(command_recorder& buffer, vk::image* p_image, node_type* node,
                             uint32_t image_id, vk::usage_transition transition)
         {
             node_type* dependee_node = node;
             
-            EA_ASSERT_MSG( _device->_queue_family_indices.graphics_family.value() ==
-                   _device->_queue_family_indices.compute_family.value(), "If this assert fails, we will need to transfer dependent "
-                                                                            "resources from compute to graphics queues and vice versa");
-            
             {
 
                 //TODO: this data could be received from vk::usage_transition struct by making  producer node and consumer node specify who is the producer stage
@@ -292,7 +492,7 @@ namespace  vk
                 barrier.image = p_image->get_image();
                 barrier.subresourceRange = { p_image->get_aspect_flag() , 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS };
                 
-                //we are not transferring ownership
+                //note: the recorder transfers ownership when the image was used last by the other queue, see command_recorder
                 barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
                 barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
 
@@ -302,23 +502,12 @@ namespace  vk
 //                
 //                debug_print(msg.c_str());
                 
-                vkCmdPipelineBarrier(
-                                     buffer.get_raw_graphics_command(image_id),
-                                     producer,
-                                     consumer,
-                                     0,
-                                     0, nullptr,
-                                     0, nullptr,
-                                     1, &barrier);
+                buffer.record_image_barrier(image_id, barrier, producer, consumer);
             }
         }
         
         void record_transitions(command_recorder& buffer,  uint32_t image_id)
         {
-            EA_ASSERT_MSG( _device->_queue_family_indices.graphics_family.value() ==
-                   _device->_queue_family_indices.compute_family.value(), "If this assert fails, we will need to transfer dependent "
-                                                                            "resources from compute to graphics queues and vice versa");
-            
             using tex_registry_type = texture_registry<NUM_CHILDREN>;
 
             //note: here we are only grabbing those image resources this node depends on
@@ -432,6 +621,8 @@ namespace  vk
         bool _enable = true;
         
         uint32_t _level = 0;
+        //note: the job the last add_update_jobs or add_refresh_jobs walk added for this node
+        uint32_t _job = job_system::NO_JOB;
         
     };
 }
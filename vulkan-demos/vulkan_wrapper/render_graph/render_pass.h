@@ -10,6 +10,8 @@
 
 #include <vector>
 #include "EASTL/array.h"
+#include "EASTL/fixed_vector.h"
+#include "EASTL/fixed_map.h"
 
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
@@ -27,6 +29,7 @@
 #include <glm/mat4x4.hpp>
 #include "../core/glfw_swapchain.h"
 #include "../core/object.h"
+#include "../core/arena.h"
 
 #include "../shapes/obj_shape.h"
 #include "depth_texture.h"
@@ -35,9 +38,18 @@
 #include "material_store.h"
 #include "attachment_group.h"
 #include "obj_shape.h"
+#include "indirect_draws.h"
+#include "../core/secondary_recorder.h"
+#include "command_recorder.h"
 
 namespace vk
 {
+    //note: the part of a target of size dims that is drawn to at a render scale, from its top left corner.  Everything that
+    //reads a scaled target goes through here so it agrees on the pixels, see graph::set_render_scale
+    inline glm::vec2 scale_dimensions(glm::vec2 dims, float scale)
+    {
+        return glm::max(glm::floor(dims * scale), glm::vec2(1.0f));
+    }
     
     //TODO: You might need another argument for number of subpasses...
     template< uint32_t NUM_ATTACHMENTS>
@@ -49,8 +61,16 @@ namespace vk
         
         static constexpr uint32_t MAX_NUMBER_OF_ATTACHMENTS = 50;
         static constexpr uint32_t MAX_SUBPASSES = 20u;
+        
+        //note: objects kept inline, scenes with more grow into the persistent arena (see arena.h)
         static constexpr uint32_t MAX_OBJECTS = 50u;
         
+        //note: subpasses drawing fewer objects than this are recorded by one thread, see prepare_draw_commands
+        static constexpr uint32_t MIN_OBJECTS_PER_RANGE = 32u;
+        
+        template< typename T>
+        using object_vector = eastl::fixed_vector<T, MAX_OBJECTS, true, arena_allocator>;
+        
         render_pass & operator=(const render_pass&) = delete;
         render_pass(const render_pass&) = delete;
         render_pass & operator=(render_pass&) = delete;
@@ -89,26 +109,51 @@ namespace vk
                 ignore_all_objs(false);
             }
             
+            //note: objects that were never set one way or the other follow the last call to ignore_all_objs, this way subpasses
+            //can be set up before all objects are added
             inline void ignore_object( uint32_t obj, bool b)
             {
+                if(obj >= _subass_ignore.size())
+                    _subass_ignore.resize(obj + 1, _ignore_all);
+                
                 _subass_ignore[obj] = b;
+                _dynamic_ids.clear();
             }
             
             inline void ignore_all_objs(bool b)
             {
-                eastl::fill(_subass_ignore.begin(), _subass_ignore.end(), b);
+                _ignore_all = b;
+                _subass_ignore.clear();
+                _dynamic_ids.clear();
             }
              
             inline void ignore_object(uint32_t obj_id)
             {
-                EA_ASSERT(obj_id < _subass_ignore.size() );
-                _subass_ignore[obj_id] = true;
+                ignore_object(obj_id, true);
             }
             
             inline bool is_ignored(uint32_t obj_id)
             {
-                EA_ASSERT(obj_id < _subass_ignore.size() );
-                return _subass_ignore[obj_id];
+                return obj_id < _subass_ignore.size() ? _subass_ignore[obj_id] : _ignore_all;
+            }
+            
+            //the slot of an object in the dynamic parameters of this subpass, objects that are ignored don't take one.  The
+            //slots are worked out once after objects or ignore flags change, the capacity stays so this doesn't allocate again
+            inline uint32_t get_dynamic_index(uint32_t obj_id, uint32_t num_objs)
+            {
+                if(_dynamic_ids.size() != num_objs)
+                {
+                    _dynamic_ids.clear();
+                    int32_t count = 0;
+                    for( uint32_t i = 0; i < num_objs; ++i)
+                    {
+                        _dynamic_ids.push_back(is_ignored(i) ? -1 : count++);
+                    }
+                }
+                
+                EA_ASSERT(obj_id < _dynamic_ids.size());
+                EA_ASSERT_MSG(_dynamic_ids[obj_id] != -1, "this object is ignored by the subpass, it has no dynamic parameters");
+                return static_cast<uint32_t>(_dynamic_ids[obj_id]);
             }
             
             inline void set_cull_mode(typename graphics_pipeline_type::cull_mode mode)
@@ -386,8 +431,9 @@ namespace vk
                 }
             }
             
+            template< typename T>
             inline void init_dynamic_params(const char* parameter_name, parameter_stage stage,
-                                            glm::mat4& val, size_t num_objs, int32_t binding)
+                                            const T& val, size_t num_objs, int32_t binding)
             {
                 
                 for( int chain_id = 0; chain_id < glfw_swapchain::NUM_SWAPCHAIN_IMAGES; ++chain_id)
@@ -443,6 +489,24 @@ namespace vk
                 }
             }
             
+            //note: one buffer per swapchain image, i.e. the buffers of the device instance pool
+            inline void set_storage_buffer(eastl::array<storage_buffer, glfw_swapchain::NUM_SWAPCHAIN_IMAGES>& buffers, const char* parameter_name,
+                                           parameter_stage parameter_stage, uint32_t binding)
+            {
+                for( int chain_id = 0; chain_id < glfw_swapchain::NUM_SWAPCHAIN_IMAGES; ++chain_id)
+                {
+                    _pipeline[chain_id].set_storage_buffer(buffers[chain_id], parameter_name, parameter_stage, binding);
+                }
+            }
+            
+            inline void set_vertex_format(vertex_format format)
+            {
+                for( int chain_id = 0; chain_id < _pipeline.size(); ++chain_id)
+                {
+                    _pipeline[chain_id].set_vertex_format(format);
+                }
+            }
+            
             inline void set_polygon_fill(polygon_mode mode)
             {
                 for( int chain_id = 0; chain_id < glfw_swapchain::NUM_SWAPCHAIN_IMAGES; ++chain_id)
@@ -544,7 +608,9 @@ namespace vk
             eastl::array<VkAttachmentReference, MAX_NUMBER_OF_ATTACHMENTS> _resolve_references {};
             
             eastl::array<graphics_pipeline_type, glfw_swapchain::NUM_SWAPCHAIN_IMAGES> _pipeline;
-            eastl::array< bool, MAX_OBJECTS> _subass_ignore {};
+            object_vector<bool> _subass_ignore {};
+            object_vector<int32_t> _dynamic_ids {};
+            bool _ignore_all = false;
             
             attachment_group<NUM_ATTACHMENTS>* _attachment_group = nullptr;
             device* _device = nullptr;
@@ -560,7 +626,10 @@ namespace vk
         
         inline void add_object( obj_shape* obj)
         {
-            _shapes[_num_objects] = obj;
+            EA_ASSERT_MSG(_object_ids.find(obj) == _object_ids.end(), "this object was already added to the render pass");
+            _object_ids[obj] = _num_objects;
+            _shapes.push_back(obj);
+            _drawn_shapes.push_back(obj);
             _num_objects++;
         }
         
@@ -570,6 +639,32 @@ namespace vk
             return _shapes[obj_id];
         }
         
+        //note: objects are known by the shape they were added with (their full detail level), dynamic parameters and indirect
+        //draw slots are looked up with it.  What actually gets drawn can be swapped for another level of the same object, it must
+        //have the same vertex format
+        inline void set_drawn_shape(obj_shape* obj, obj_shape* drawn)
+        {
+            uint32_t obj_id = find_object(obj);
+            EA_ASSERT_MSG(drawn->get_vertex_format() == obj->get_vertex_format(), "levels of detail must have the same vertex format");
+            _drawn_shapes[obj_id] = drawn;
+        }
+        
+        inline obj_shape* get_drawn_shape(obj_shape* obj)
+        {
+            return _drawn_shapes[find_object(obj)];
+        }
+        
+        inline uint32_t find_object(obj_shape* obj)
+        {
+            typename object_id_map::iterator it = _object_ids.find(obj);
+            if(it == _object_ids.end())
+            {
+                EA_FAIL_MSG("this object was never added to the render pass");
+                return 0;
+            }
+            return it->second;
+        }
+        
         inline void commit_parameters_to_gpu(uint32_t swapchain_id)
         {
             for( int subpass_id = 0; subpass_id < _subpasses.size(); ++subpass_id)
@@ -580,9 +675,9 @@ namespace vk
             }
         }
         
-        inline void next_subpass(VkCommandBuffer& buffer)
+        inline void next_subpass(VkCommandBuffer& buffer, VkSubpassContents contents = VK_SUBPASS_CONTENTS_INLINE)
         {
-            vkCmdNextSubpass(buffer, VK_SUBPASS_CONTENTS_INLINE);
+            vkCmdNextSubpass(buffer, contents);
         }
         attachment_group<NUM_ATTACHMENTS>& get_attachment_group();
 
@@ -601,7 +696,21 @@ namespace vk
         
         void init(uint32_t swapchain_id);
         
-        void record_draw_commands(VkCommandBuffer& buffer, uint32_t swapchain_id, uint32_t instance_count);
+        void record_draw_commands(VkCommandBuffer& buffer, uint32_t swapchain_id);
+        
+        //note: the draws of every subpass are recorded into secondary command buffers by the threads of the recorder, the
+        //objects of large subpasses are split in ranges with one command buffer each.  The next call to record_draw_commands
+        //executes them in order instead of recording the draws itself
+        void prepare_draw_commands(secondary_recorder& recorder, uint32_t swapchain_id);
+        
+        //note: only what was prepared this frame counts, the command buffers of earlier frames went back to their pools
+        inline bool is_prepared(uint32_t swapchain_id)
+        {
+            return _recorder != nullptr && _prepared_frame[swapchain_id] == _recorder->get_frame();
+        }
+        
+        //note: folds the render pass, its framebuffer and everything record_draw_commands binds and draws into state
+        void hash_draw_commands(uint64_t& state, uint32_t swapchain_id);
         
         inline VkRenderPass& get_vk_render_pass(uint32_t i)
         {
@@ -651,6 +760,7 @@ namespace vk
         
         inline subpass_s& add_subpass(vk::material_store& store,  const char* material_name, const char* subpass_name = "" )
         {
+            EA_ASSERT_MSG(_num_subpasses < MAX_SUBPASSES, "too many subpasses, objects drawn with the same material arguments should share one");
             _subpasses[_num_subpasses]._name = subpass_name;
             _subpasses[_num_subpasses].set_active();
             _subpasses[_num_subpasses].set_device(_device);
@@ -680,14 +790,34 @@ namespace vk
         {
             EA_ASSERT_MSG(_num_subpasses != 0, "you need at least one subpass");
             init(swapchain_id);
+            find_draw_slots();
             for( int subpass_id = 0; subpass_id < _num_subpasses; ++subpass_id)
             {
                 if(!_subpasses[subpass_id].is_active()) break;
                 //TODO: make _vk_render_passes of size 1.  It might be possible to just have one, frame buffers however, you'll need one per swapchain image
+                _subpasses[subpass_id].set_vertex_format(get_vertex_format(subpass_id));
                 _subpasses[subpass_id].create(_vk_render_passes[swapchain_id], swapchain_id);
             }
         }
         
+        //note: the vertex input of a subpass comes from the shapes it draws, they must all agree
+        inline vertex_format get_vertex_format(uint32_t subpass_id)
+        {
+            vertex_format format = vertex_format::FLOAT32;
+            bool found = false;
+            for( uint32_t obj_id = 0; obj_id < _num_objects; ++obj_id)
+            {
+                if(_subpasses[subpass_id].is_ignored(obj_id))
+                    continue;
+                
+                vertex_format obj_format = _shapes[obj_id]->get_vertex_format();
+                EA_ASSERT_MSG(!found || obj_format == format, "a subpass can't draw shapes with different vertex formats");
+                format = obj_format;
+                found = true;
+            }
+            return format;
+        }
+        
         inline void set_dimensions(glm::vec2 dims)
         {
             _dimensions = dims;
@@ -699,13 +829,57 @@ namespace vk
             return _dimensions;
         }
         
+        //note: 1 draws to the whole attachments.  Less draws to the top left part of them, the render area, viewport and scissor
+        //shrink and the attachments keep their size, see scale_dimensions
+        inline void set_render_scale(float scale)
+        {
+            _render_scale = scale;
+        }
+        
+        inline float get_render_scale() const { return _render_scale; }
+        inline glm::vec2 get_render_dimensions() const { return scale_dimensions(_dimensions, _render_scale); }
+        
+        //note: the attachments were made again at dims (see texture_registry::resize), only the framebuffers are.  The render
+        //passes and the pipelines of the subpasses don't depend on the size, viewport and scissor are dynamic state
+        void resize(glm::vec2 dims);
+        
+        //note: meshes that have a slot in the indirect draws will be drawn with vkCmdDrawIndexedIndirect, a whole object at a time
+        //when its meshes share a geometry block, see indirect_draws.h
+        inline void set_indirect_draws(indirect_draws* draws)
+        {
+            _indirect_draws = draws;
+        }
+        
         void destroy() override;
         
     private:
         
         void create_frame_buffers(uint32_t swapchain_id);
-        void begin_render_pass(VkCommandBuffer& buffer, uint32_t swapchain_image_id);
+        void begin_render_pass(VkCommandBuffer& buffer, uint32_t swapchain_image_id, VkSubpassContents contents = VK_SUBPASS_CONTENTS_INLINE);
         void end_render_pass(VkCommandBuffer& buffer);
+        void set_viewport(VkCommandBuffer buffer);
+        void record_objects(VkCommandBuffer buffer, uint32_t swapchain_id, uint32_t subpass_id, uint32_t first_obj, uint32_t last_obj,
+                            uint32_t drawn_obj, uint32_t& bound_block);
+        
+        //note: the cull node, a child of the node of this pass, added the draws before the pass is created.  The slots of the
+        //meshes of an object follow each other, the first one is looked up here once instead of every time the pass is recorded
+        inline void find_draw_slots()
+        {
+            _first_slots.clear();
+            for( uint32_t obj_id = 0; obj_id < _num_objects; ++obj_id)
+            {
+                _first_slots.push_back(_indirect_draws != nullptr ? _indirect_draws->get_slot(_shapes[obj_id], 0) : -1);
+            }
+        }
+        
+        //note: -1 when the mesh has no slot, it is drawn directly then
+        inline int32_t get_draw_slot(uint32_t obj_id, uint32_t mesh_id)
+        {
+            EA_ASSERT_MSG(obj_id < _first_slots.size(), "objects must be added before the render pass is created");
+            if(_first_slots[obj_id] == -1 || mesh_id >= _shapes[obj_id]->get_num_meshes())
+                return -1;
+            return _first_slots[obj_id] + static_cast<int32_t>(mesh_id);
+        }
 
         
     private:
@@ -715,11 +889,24 @@ namespace vk
         eastl::array<VkFramebuffer, glfw_swapchain::NUM_SWAPCHAIN_IMAGES> _vk_frame_buffer_infos {};
         
         eastl::array<subpass_s, MAX_SUBPASSES> _subpasses {};
-        eastl::array<obj_shape*, MAX_OBJECTS> _shapes {};
+        using object_id_map = eastl::fixed_map<obj_shape*, uint32_t, MAX_OBJECTS, true, eastl::less<obj_shape*>, arena_allocator>;
+        
+        object_vector<obj_shape*> _shapes {};
+        object_vector<obj_shape*> _drawn_shapes {};
+        object_id_map _object_ids {};
+        indirect_draws* _indirect_draws = nullptr;
+        //note: indirect draw slot of the first mesh of every object, see find_draw_slots
+        object_vector<int32_t> _first_slots {};
+        
+        using secondary_buffers = eastl::fixed_vector<VkCommandBuffer, 4, true>;
+        eastl::array<eastl::array<secondary_buffers, MAX_SUBPASSES>, glfw_swapchain::NUM_SWAPCHAIN_IMAGES> _secondary_buffers {};
+        eastl::array<uint64_t, glfw_swapchain::NUM_SWAPCHAIN_IMAGES> _prepared_frame {};
+        secondary_recorder* _recorder = nullptr;
         
         static_assert(MAX_NUMBER_OF_ATTACHMENTS > NUM_ATTACHMENTS, "Number of attachments in your render pass excees what we can handle, increase limit??");
 
         glm::vec2 _dimensions {};
+        float _render_scale = 1.0f;
         device* _device = nullptr;
         uint32_t _num_subpasses = 0;
         uint32_t _num_objects = 0;
@@ -10,33 +10,145 @@
 //note: this file is #included render_pass.h
 
 template<uint32_t NUM_ATTACHMENTS>
- void render_pass< NUM_ATTACHMENTS>::record_draw_commands(VkCommandBuffer& buffer, uint32_t swapchain_id, uint32_t instance_count)
+ void render_pass< NUM_ATTACHMENTS>::record_draw_commands(VkCommandBuffer& buffer, uint32_t swapchain_id)
  {
      EA_ASSERT_MSG(_num_objects != 0, "you must have objects to render in a subpass");
-     begin_render_pass(buffer, swapchain_id);
+     
+     //note: barriers are not allowed inside of a render pass without a self dependency, so this goes first
+     if(_indirect_draws != nullptr)
+         _indirect_draws->record_barrier(buffer, swapchain_id);
+     
+     bool prepared = is_prepared(swapchain_id);
+     _prepared_frame[swapchain_id] = 0;
+     VkSubpassContents contents = prepared ? VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS : VK_SUBPASS_CONTENTS_INLINE;
+     begin_render_pass(buffer, swapchain_id, contents);
+
+     //note: vertex and index bindings survive pipeline binds and subpasses, only bind again when a mesh lives in another block
+     uint32_t bound_block = vk::geometry_pool::INVALID_BLOCK;
+     
+     for( uint32_t subpass_id = 0; subpass_id < _num_subpasses; ++subpass_id)
+     {
+         if(prepared)
+         {
+             secondary_buffers& buffers = _secondary_buffers[swapchain_id][subpass_id];
+             if(!buffers.empty())
+                 vkCmdExecuteCommands(buffer, static_cast<uint32_t>(buffers.size()), buffers.data());
+         }
+         else
+         {
+             record_objects(buffer, swapchain_id, subpass_id, 0, _num_objects, 0, bound_block);
+         }
+         
+         if(_num_subpasses != (subpass_id + 1))
+             next_subpass(buffer, contents);
+     }
+     
+     end_render_pass(buffer);
+ }
 
+ template<uint32_t NUM_ATTACHMENTS>
+ void render_pass< NUM_ATTACHMENTS>::prepare_draw_commands(secondary_recorder& recorder, uint32_t swapchain_id)
+ {
+     EA_ASSERT_MSG(_num_objects != 0, "you must have objects to render in a subpass");
      
+     uint32_t num_threads = std::max(1u, secondary_recorder::get_num_threads());
      for( uint32_t subpass_id = 0; subpass_id < _num_subpasses; ++subpass_id)
      {
-         int drawn_obj = 0;
+         secondary_buffers& buffers = _secondary_buffers[swapchain_id][subpass_id];
+         buffers.clear();
+         
+         uint32_t num_drawn = 0;
          for( uint32_t obj_id = 0; obj_id < _num_objects; ++obj_id)
          {
              if(!_subpasses[subpass_id].is_ignored(obj_id))
+                 ++num_drawn;
+         }
+         
+         //note: one range per thread at most, ranges with fewer objects than MIN_OBJECTS_PER_RANGE cost more than they save
+         uint32_t num_ranges = std::min(num_threads, std::max(1u, num_drawn / MIN_OBJECTS_PER_RANGE));
+         uint32_t per_range = (num_drawn + num_ranges - 1) / num_ranges;
+         
+         VkCommandBufferInheritanceInfo inheritance {};
+         inheritance.renderPass = _vk_render_passes[swapchain_id];
+         inheritance.subpass = subpass_id;
+         inheritance.framebuffer = _vk_frame_buffer_infos[swapchain_id];
+         
+         uint32_t first_obj = 0;
+         uint32_t drawn_obj = 0;
+         while(drawn_obj < num_drawn)
+         {
+             uint32_t last_obj = first_obj;
+             uint32_t count = 0;
+             while(last_obj < _num_objects && count < per_range)
+             {
+                 if(!_subpasses[subpass_id].is_ignored(last_obj))
+                     ++count;
+                 ++last_obj;
+             }
+             
+             //note: state set in the primary command buffer is not inherited, every range sets its own viewport and bindings
+             buffers.push_back(recorder.add(inheritance, count,
+                 [this, swapchain_id, subpass_id, first_obj, last_obj, drawn_obj](VkCommandBuffer secondary)
+                 {
+                     set_viewport(secondary);
+                     uint32_t bound_block = vk::geometry_pool::INVALID_BLOCK;
+                     record_objects(secondary, swapchain_id, subpass_id, first_obj, last_obj, drawn_obj, bound_block);
+                 }));
+             
+             drawn_obj += count;
+             first_obj = last_obj;
+         }
+     }
+     
+     _recorder = &recorder;
+     _prepared_frame[swapchain_id] = recorder.get_frame();
+ }
+
+ //note: drawn_obj is how many objects of the subpass come before first_obj, their dynamic parameters come before this one's
+ template<uint32_t NUM_ATTACHMENTS>
+ void render_pass< NUM_ATTACHMENTS>::record_objects(VkCommandBuffer buffer, uint32_t swapchain_id, uint32_t subpass_id,
+                                                    uint32_t first_obj, uint32_t last_obj, uint32_t drawn_obj, uint32_t& bound_block)
+ {
+     for( uint32_t obj_id = first_obj; obj_id < last_obj; ++obj_id)
+     {
+         if(!_subpasses[subpass_id].is_ignored(obj_id))
+         {
+             _subpasses[subpass_id].begin_subpass_recording(buffer, swapchain_id, drawn_obj );
+             obj_shape* shape = _drawn_shapes[obj_id];
+             
+             //note: a shape that lives in one geometry block goes out as one range, the cull node packed or zeroed its slots
+             int32_t first_slot = get_draw_slot(obj_id, 0);
+             if(first_slot != -1 && indirect_draws::is_single_block(shape))
              {
-                 _subpasses[subpass_id].begin_subpass_recording(buffer, swapchain_id, drawn_obj );
-                 for( uint32_t mesh_id = 0; mesh_id < _shapes[obj_id]->get_num_meshes(); ++mesh_id)
+                 if(shape->get_geometry_block(0) != bound_block)
                  {
-                     _shapes[obj_id]->bind_verteces(buffer, mesh_id);
-                     _shapes[obj_id]->draw_indexed(buffer, mesh_id, instance_count);
+                     shape->bind_verteces(buffer, 0);
+                     bound_block = shape->get_geometry_block(0);
                  }
+                 _indirect_draws->record_range(buffer, swapchain_id, static_cast<uint32_t>(first_slot), shape);
                  ++drawn_obj;
+                 continue;
+             }
+             
+             for( uint32_t mesh_id = 0; mesh_id < shape->get_num_meshes(); ++mesh_id)
+             {
+                 uint32_t block = shape->get_geometry_block(mesh_id);
+                 if(block != bound_block)
+                 {
+                     shape->bind_verteces(buffer, mesh_id);
+                     bound_block = block;
+                 }
+                 
+                 //note: slots belong to the full detail shape, the cull node wrote the range of the level that is drawn
+                 int32_t slot = get_draw_slot(obj_id, mesh_id);
+                 if(slot != -1)
+                     _indirect_draws->record_draw(buffer, swapchain_id, static_cast<uint32_t>(slot));
+                 else
+                     shape->draw_indexed(buffer, mesh_id, _device->has_draw_indirect_first_instance());
              }
+             ++drawn_obj;
          }
-         if(_num_subpasses != (subpass_id + 1))
-             next_subpass(buffer);
      }
-     
-     end_render_pass(buffer);
  }
 
  template< uint32_t NUM_ATTACHMENTS>
@@ -96,6 +208,14 @@ template<uint32_t NUM_ATTACHMENTS>
              resource_set<image*>& depths =  get_depth_textures();
              depth_texture* t = static_cast<depth_texture*>( depths[swapchain_id]);
              attachment_descriptions[attachment_id] =  t->get_depth_attachment();
+             if(_attachment_group.should_keep_contents(i))
+             {
+                 //note: depth is kept from an earlier pass (i.e. the late pass of occlusion culling).  It is in the layout the
+                 //last transition added left it in, the one that belongs to this render pass, same as color attachments below
+                 attachment_descriptions[attachment_id].loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+                 if(_attachment_group[i].has_transitions())
+                     attachment_descriptions[attachment_id].initialLayout = static_cast<VkImageLayout>(_attachment_group[i].get_last_transition_added().current);
+             }
              depth_reference.attachment = attachment_id;
              depth_reference.layout = static_cast<VkImageLayout>(depths[swapchain_id]->get_usage_layout(vk::usage_type::STORAGE_IMAGE));
              ++attachment_id;
@@ -104,7 +224,8 @@ template<uint32_t NUM_ATTACHMENTS>
          else
          {
              attachment_descriptions[attachment_id].samples = _attachment_group.is_multisample_attachment(i) ? _device->get_max_usable_sample_count() : VK_SAMPLE_COUNT_1_BIT;
-             attachment_descriptions[attachment_id].loadOp =  _attachment_group.should_clear(i) ? VK_ATTACHMENT_LOAD_OP_CLEAR : VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+             attachment_descriptions[attachment_id].loadOp =  _attachment_group.should_clear(i) ? VK_ATTACHMENT_LOAD_OP_CLEAR :
+                                                           _attachment_group.should_keep_contents(i) ? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_DONT_CARE;
 
              attachment_descriptions[attachment_id].storeOp = _attachment_group.should_store(i) ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
              attachment_descriptions[attachment_id].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
@@ -249,6 +370,23 @@ template<uint32_t NUM_ATTACHMENTS>
      
  }
 
+ template < uint32_t NUM_ATTACHMENTS>
+ void render_pass< NUM_ATTACHMENTS>::resize(glm::vec2 dims)
+ {
+     set_dimensions(dims);
+     for( int subpass_id = 0; subpass_id < _subpasses.size(); ++subpass_id )
+     {
+         _subpasses[subpass_id].set_viewport(dims);
+     }
+     
+     for( uint32_t i = 0; i < _vk_frame_buffer_infos.size(); ++i)
+     {
+         vkDestroyFramebuffer(_device->_logical_device, _vk_frame_buffer_infos[i], nullptr);
+         _vk_frame_buffer_infos[i] = VK_NULL_HANDLE;
+         create_frame_buffers(i);
+     }
+ }
+
  template < uint32_t NUM_ATTACHMENTS>
  void render_pass< NUM_ATTACHMENTS>::destroy()
  {
@@ -270,8 +408,45 @@ template<uint32_t NUM_ATTACHMENTS>
      }
  }
 
+ //note: parameter data is written every frame and is left out, dynamic offsets only depend on the order of the objects
+ template<uint32_t NUM_ATTACHMENTS>
+ void render_pass< NUM_ATTACHMENTS>::hash_draw_commands(uint64_t& state, uint32_t swapchain_id)
+ {
+     command_recorder::hash_state(state, reinterpret_cast<uintptr_t>(_vk_render_passes[swapchain_id]));
+     command_recorder::hash_state(state, reinterpret_cast<uintptr_t>(_vk_frame_buffer_infos[swapchain_id]));
+     command_recorder::hash_state(state, static_cast<uint64_t>(_dimensions.x) << 32 | static_cast<uint64_t>(_dimensions.y));
+     command_recorder::hash_state(state, reinterpret_cast<uintptr_t>(_indirect_draws));
+     command_recorder::hash_state(state, _num_objects);
+     
+     for( uint32_t subpass_id = 0; subpass_id < _num_subpasses; ++subpass_id)
+     {
+         graphics_pipeline_type& pipeline = _subpasses[subpass_id].get_pipeline(swapchain_id);
+         command_recorder::hash_state(state, reinterpret_cast<uintptr_t>(pipeline.get_vk_pipeline()));
+         command_recorder::hash_state(state, pipeline.get_descriptor_writes());
+         
+         for( uint32_t obj_id = 0; obj_id < _num_objects; ++obj_id)
+         {
+             command_recorder::hash_state(state, _subpasses[subpass_id].is_ignored(obj_id));
+         }
+     }
+     
+     for( uint32_t obj_id = 0; obj_id < _num_objects; ++obj_id)
+     {
+         obj_shape* shape = _drawn_shapes[obj_id];
+         command_recorder::hash_state(state, reinterpret_cast<uintptr_t>(shape));
+         command_recorder::hash_state(state, static_cast<uint64_t>(shape->get_instances().first_instance) << 32 |
+                                             shape->get_instances().instance_count);
+         for( uint32_t mesh_id = 0; mesh_id < shape->get_num_meshes(); ++mesh_id)
+         {
+             command_recorder::hash_state(state, shape->get_geometry_block(mesh_id));
+             if(_indirect_draws != nullptr)
+                 command_recorder::hash_state(state, static_cast<uint32_t>(get_draw_slot(obj_id, mesh_id)));
+         }
+     }
+ }
+
  template< uint32_t NUM_ATTACHMENTS>
- void render_pass< NUM_ATTACHMENTS>::begin_render_pass(VkCommandBuffer& buffer, uint32_t swapchain_image_id)
+ void render_pass< NUM_ATTACHMENTS>::begin_render_pass(VkCommandBuffer& buffer, uint32_t swapchain_image_id, VkSubpassContents contents)
  {
      VkRenderPassBeginInfo render_pass_create_info = {};
      render_pass_create_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
@@ -280,26 +455,36 @@ template<uint32_t NUM_ATTACHMENTS>
      assert(get_vk_render_pass(swapchain_image_id) != VK_NULL_HANDLE && "call init on this render pass");
      render_pass_create_info.renderPass = get_vk_render_pass(swapchain_image_id);
      render_pass_create_info.framebuffer = get_vk_frame_buffer( swapchain_image_id);
+     glm::vec2 render_dims = get_render_dimensions();
      render_pass_create_info.renderArea.offset = { 0, 0 };
-     render_pass_create_info.renderArea.extent = { (uint32_t)_dimensions.x, (uint32_t)_dimensions.y };
+     render_pass_create_info.renderArea.extent = { (uint32_t)render_dims.x, (uint32_t)render_dims.y };
      
      render_pass_create_info.clearValueCount = NUM_ATTACHMENTS;
      render_pass_create_info.pClearValues = _attachment_group.get_clear_values();
 
-     vkCmdBeginRenderPass(buffer, &render_pass_create_info, VK_SUBPASS_CONTENTS_INLINE);
+     vkCmdBeginRenderPass(buffer, &render_pass_create_info, contents);
      
+     //note: only vkCmdExecuteCommands is allowed in subpasses made of secondary command buffers, they set the viewport themselves
+     if(contents == VK_SUBPASS_CONTENTS_INLINE)
+         set_viewport(buffer);
+ }
+
+ template< uint32_t NUM_ATTACHMENTS>
+ void render_pass< NUM_ATTACHMENTS>::set_viewport(VkCommandBuffer buffer)
+ {
+     glm::vec2 render_dims = get_render_dimensions();
      VkViewport viewport;
      viewport.x = 0.0f;
      viewport.y = 0.0f;
-     viewport. width = _dimensions.x;
-     viewport.height = _dimensions.y;
+     viewport. width = render_dims.x;
+     viewport.height = render_dims.y;
      viewport.minDepth = 0.0f;
      viewport.maxDepth = 1.0f;
      vkCmdSetViewport(buffer, 0, 1, &viewport);
      
      VkRect2D scissor;
      scissor.offset = { 0, 0};
-     scissor.extent = { (uint32_t)_dimensions.x,(uint32_t)_dimensions.y};
+     scissor.extent = { (uint32_t)render_dims.x,(uint32_t)render_dims.y};
      vkCmdSetScissor(buffer, 0, 1, &scissor);
  }
 
@@ -17,6 +17,7 @@
 #include "texture_2d.h"
 #include "texture_3d.h"
 #include "texture_cube.h"
+#include "texture_cache.h"
 #include "depth_texture.h"
 #include "glfw_present_texture.h"
 #include "command_recorder.h"
@@ -54,6 +55,8 @@ namespace vk
             node_type* node;
             resource_ptr resource = nullptr;
             bool consumed = false;
+            //note: the resource is shared with another name and destroyed through that one, see get_loaded_texture_2d
+            bool alias = false;
         };
         
         struct dependant_data
@@ -205,9 +208,31 @@ namespace vk
             return result;
         }
 
+        //note: files that were loaded before under another name, or that hold the same bytes as one that was, are not loaded
+        //again.  The name is made to point at the texture that was, see texture_cache.h
         inline vk::texture_2d& get_loaded_texture_2d( const char* name, node_type* node, device* dev, const char* path)
         {
-            return get_loaded_texture<vk::texture_2d>( name, node, dev,path);
+            if(_dependee_data_map.find(name) != _dependee_data_map.end())
+                return get_loaded_texture<vk::texture_2d>( name, node, dev,path);
+            
+            texture_cache::texture_key key {};
+            eastl::shared_ptr<vk::texture_2d> shared = dev->get_texture_cache().find_texture(path, key);
+            if(shared != nullptr)
+            {
+                dependee_data info {};
+                info.resource = eastl::static_pointer_cast<vk::object>(shared);
+                info.node = node;
+                info.consumed = false;
+                info.alias = true;
+                
+                _dependee_data_map[name] = info;
+                make_dependency(*shared, info, node, vk::usage_type::COMBINED_IMAGE_SAMPLER);
+                return *shared;
+            }
+            
+            vk::texture_2d& result = get_loaded_texture<vk::texture_2d>( name, node, dev,path);
+            dev->get_texture_cache().add_texture(key, eastl::static_pointer_cast<vk::texture_2d>(_dependee_data_map[name].resource));
+            return result;
         }
         
         
@@ -251,7 +276,8 @@ namespace vk
             typename dependee_data_map::iterator end = _dependee_data_map.end();
             while(b != end)
             {
-                b->second.resource->destroy();
+                if(!b->second.alias)
+                    b->second.resource->destroy();
                 ++b;
             }
         }
@@ -301,8 +327,44 @@ namespace vk
             }
         }
         
+        //note: render and depth textures the size of old_size are made again at new_size, the rest keep their size.  Materials
+        //write the descriptors of the new views the next time they are committed, render passes make their framebuffers again
+        //(see render_pass::resize)
+        void resize(glm::vec2 old_size, glm::vec2 new_size)
+        {
+            typename dependee_data_map::iterator iter = _dependee_data_map.begin();
+            
+            while( iter != _dependee_data_map.end())
+            {
+                dependee_data& d = iter->second;
+                eastl::shared_ptr<vk::object> res = eastl::static_pointer_cast<vk::object>(d.resource);
+                
+                if(!d.alias && res->get_instance_type() == resource_set<vk::render_texture>::get_class_type())
+                {
+                    resize_set(*eastl::static_pointer_cast< resource_set<vk::render_texture>>(res), old_size, new_size);
+                }
+                else if(!d.alias && res->get_instance_type() == resource_set<vk::depth_texture>::get_class_type())
+                {
+                    resize_set(*eastl::static_pointer_cast< resource_set<vk::depth_texture>>(res), old_size, new_size);
+                }
+                ++iter;
+            }
+            material_base::invalidate_image_descriptors();
+        }
+        
     private:
         
+        template<typename T>
+        static void resize_set(resource_set<T>& set, glm::vec2 old_size, glm::vec2 new_size)
+        {
+            glm::vec3 dims = set.get_dimensions();
+            if(dims.x != old_size.x || dims.y != old_size.y || !set[0].is_initialized())
+                return;
+            
+            set.destroy();
+            set.set_dimensions(static_cast<uint32_t>(new_size.x), static_cast<uint32_t>(new_size.y));
+            set.init();
+        }
         
         template<typename T>
         void make_dependency(T& type, dependee_data& d, node_type* node, vk::usage_type usage_type)
@@ -147,10 +147,10 @@ namespace vk
             _device = dev;
         }
         
-        virtual void draw_indexed(VkCommandBuffer command_buffer, uint32_t instance_count) override
+        virtual void draw_indexed(VkCommandBuffer command_buffer, uint32_t instance_count, uint32_t first_instance) override
         {
             EA_ASSERT(_index_size != 0);
-            vkCmdDrawIndexed(command_buffer,_index_size, instance_count, 0, 0, 0);
+            vkCmdDrawIndexed(command_buffer,_index_size, instance_count, 0, 0, first_instance);
         }
         virtual void draw(VkCommandBuffer command_buffer) override
         {
@@ -26,6 +26,9 @@
 #include "obj_shape.h"
 #include "core/device.h"
 #include "mesh.h"
+#include "mesh_optimizer.h"
+#include "mesh_simplifier.h"
+#include "mesh_cache.h"
 #include "assimp/texture.h"
 
 #include <glm/glm.hpp>
@@ -64,29 +67,46 @@ namespace vk
             this->components = components;
         }
 
+        static uint32_t component_size(vertex_componets component)
+        {
+            switch (component)
+            {
+            case vertex_componets::VERTEX_COMPONENT_UV:
+                return 2 * sizeof(float);
+            case vertex_componets::VERTEX_COMPONENT_COLOR:
+                return 4 * sizeof(float);
+            case vertex_componets::VERTEX_COMPONENT_DUMMY_FLOAT:
+                return sizeof(float);
+            case vertex_componets::VERTEX_COMPONENT_DUMMY_VEC4:
+                return 4 * sizeof(float);
+            default:
+                // All components except the ones listed above are made up of 3 floats
+                return 3 * sizeof(float);
+            }
+        }
+
         uint32_t stride()
         {
             uint32_t res = 0;
             for (auto& component : components)
             {
-                switch (component)
-                {
-                case vertex_componets::VERTEX_COMPONENT_UV:
-                    res += 2 * sizeof(float);
-                    break;
-                case vertex_componets::VERTEX_COMPONENT_DUMMY_FLOAT:
-                    res += sizeof(float);
-                    break;
-                case vertex_componets::VERTEX_COMPONENT_DUMMY_VEC4:
-                    res += 4 * sizeof(float);
-                    break;
-                default:
-                    // All components except the ones listed above are made up of 3 floats
-                    res += 3 * sizeof(float);
-                }
+                res += component_size(component);
             }
             return res;
         }
+
+        //byte offset of the first occurrence of a component, mesh_optimizer::NO_POSITION if the layout doesn't have it
+        size_t offset(vertex_componets component)
+        {
+            size_t res = 0;
+            for (auto& c : components)
+            {
+                if(c == component)
+                    return res;
+                res += component_size(c);
+            }
+            return mesh_optimizer::NO_POSITION;
+        }
     };
 
     /** @brief Used to parametrize model loading */
@@ -126,13 +146,6 @@ namespace vk
             uint32_t index_count = 0;
         };
         
-        struct dimension
-        {
-            glm::vec3 min = glm::vec3(FLT_MAX);
-            glm::vec3 max = glm::vec3(-FLT_MAX);
-            glm::vec3 size;
-        } dim;
-        
         //eastl::vector<model_part> _parts;
         
         uint32_t _vertex_size = 0;
@@ -150,42 +163,77 @@ namespace vk
             _device = dev;
         }
         
-        virtual void draw_indexed(VkCommandBuffer command_buffer, uint32_t instance_count) override
+        virtual void draw_indexed(VkCommandBuffer command_buffer, uint32_t instance_count, uint32_t first_instance) override
         {
             EA_ASSERT(_index_size != 0);
-            vkCmdDrawIndexed(command_buffer,_index_size, instance_count, 0, 0, 0);
+            vkCmdDrawIndexed(command_buffer,_index_size, instance_count, _geometry.first_index, _geometry.vertex_offset, first_instance);
         }
         virtual void draw(VkCommandBuffer command_buffer) override
         {
             EA_ASSERT(_vertex_size != 0);
-            vkCmdDraw(command_buffer, _vertex_size, 1, 0,0 );
+            vkCmdDraw(command_buffer, _vertex_size, 1, static_cast<uint32_t>(_geometry.vertex_offset), 0 );
         }
         
-        void create( VkMemoryPropertyFlags memoryPropertyFlags, eastl::vector<float>& vertexBuffer, eastl::vector<uint32_t>& indexBuffer)
+        virtual uint32_t get_index_count() override
         {
-            _vertex_size = static_cast<uint32_t>(vertexBuffer.size());
-            _index_size = static_cast<uint32_t>(indexBuffer.size());
-
-            create_and_upload_buffer_void( _device->_graphics_command_pool, vertexBuffer,
-                                     VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | memoryPropertyFlags,
-                                     _vertex_buffer, _vertex_buffer_device_memory);
+            return _index_size;
+        }
 
-            create_and_upload_buffer_void(_device->_graphics_command_pool, indexBuffer,
-                                     VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | memoryPropertyFlags,
-                                     _index_buffer, _index_buffer_device_memory);
+        inline uint32_t get_vertex_count() const
+        {
+            return _vertex_size;
         }
 
-        /** @brief Release all Vulkan resources of this model */
-        virtual void destroy() override
+        void create( uint32_t vertex_stride, eastl::vector<float>& vertexBuffer, eastl::vector<uint32_t>& indexBuffer,
+                    const aabb& bounds)
         {
-            mesh::destroy();
-            vkDestroyBuffer(_device->_logical_device, _vertex_buffer, nullptr);
-            vkFreeMemory(_device->_logical_device, _vertex_buffer_device_memory, nullptr);
-            if (_index_buffer != VK_NULL_HANDLE)
+            EA_ASSERT_MSG((vertex_stride % sizeof(float)) == 0, "assimp vertices are made up of floats");
+            _bounds = bounds;
+            _vertex_size = static_cast<uint32_t>((vertexBuffer.size() * sizeof(float)) / vertex_stride);
+            _index_size = static_cast<uint32_t>(indexBuffer.size());
+
+            upload_geometry(vertex_stride, vertexBuffer.data(), _vertex_size, indexBuffer.data(), _index_size);
+        }
+        
+        //note: packed_vertices is filled with what was uploaded
+        void create( eastl::vector<vertex>& vertices, eastl::vector<uint32_t>& indexBuffer, const aabb& bounds,
+                    eastl::vector<packed_vertex>& packed_vertices)
+        {
+            _bounds = bounds;
+            _vertex_format = vertex_format::PACKED;
+            _quantization = packed_vertex::quantization::from_bounds(bounds);
+            _vertex_size = static_cast<uint32_t>(vertices.size());
+            _index_size = static_cast<uint32_t>(indexBuffer.size());
+            
+            packed_vertices.clear();
+            packed_vertices.reserve(vertices.size());
+            for( const vertex& v : vertices)
             {
-                vkDestroyBuffer(_device->_logical_device, _index_buffer, nullptr);
-                vkFreeMemory(_device->_logical_device, _index_buffer_device_memory, nullptr);
+                packed_vertices.push_back(packed_vertex::pack(v, _quantization));
             }
+#if EA_DEBUG
+            quantization_error error {};
+            for( uint32_t i = 0; i < vertices.size(); ++i)
+            {
+                error.accumulate(vertices[i], packed_vertices[i], _quantization);
+            }
+            EA_ASSERT_FORMATTED(error.is_within_bounds(), ("packed vertices are off by: position %f steps, normal %f rad, tangent %f rad, uv %f, color %f, %u handedness flips",
+                                                           error.position, error.normal, error.tangent, error.uv, error.color, error.handedness_flips));
+#endif
+            upload_geometry(sizeof(packed_vertex), packed_vertices.data(), _vertex_size, indexBuffer.data(), _index_size);
+        }
+        
+        //note: the streams are already in their final form, they go from the mapping of the cache to the geometry pool
+        void create( vertex_format format, uint32_t vertex_stride, const mesh_cache::level& level)
+        {
+            _bounds = level.bounds;
+            _vertex_format = format;
+            if(format == vertex_format::PACKED)
+                _quantization = packed_vertex::quantization::from_bounds(level.bounds);
+            _vertex_size = level.vertex_count;
+            _index_size = level.index_count;
+            
+            upload_geometry(vertex_stride, level.vertices, _vertex_size, level.indices, _index_size);
         }
     };
 
@@ -197,8 +245,36 @@ namespace vk
         vk::device* _device = nullptr;
         
         vertex_layout _vertex_layout;
+        vertex_format _vertex_format = vertex_format::FLOAT32;
         model_create_info create_info = model_create_info(1.0f, 1.0f, 0.0f);
 
+        //note: cpu copy of the geometry that was uploaded, only kept around when coarser levels are built out of this shape
+        struct source_geometry
+        {
+            eastl::vector<float>    vertex_buffer;
+            eastl::vector<vertex>   unpacked_vertices;
+            eastl::vector<uint32_t> index_buffer;
+        };
+
+        bool _keep_source = false;
+        source_geometry _source {};
+
+        //note: copy of the streams that were uploaded, only kept around to write them to a mesh cache
+        struct gpu_stream
+        {
+            eastl::vector<uint8_t>  vertices;
+            eastl::vector<uint32_t> indices;
+            aabb                    bounds;
+        };
+
+        bool _keep_stream = false;
+        gpu_stream _stream {};
+
+        //farthest this shape strays from the full detail mesh, in object space.  Zero for shapes loaded at full detail
+        float _geometric_error = 0.0f;
+        //note: the shape was made by create_simplified, its error is measured from the full detail mesh
+        bool _simplified = false;
+
         static const uint32_t defaultFlags = aiProcess_ConvertToLeftHanded;
         using texture_path_vec = eastl::array< texture_path, 20>;
         using texture_type_vec = eastl::array<texture_path_vec, 20>;
@@ -263,6 +339,7 @@ namespace vk
             }
 
             eastl::vector<float> vertexBuffer;
+            eastl::vector<vertex> unpacked_vertices;
             eastl::vector<uint32_t> indexBuffer;
 
             uint32_t indexCount = 0;
@@ -305,48 +382,56 @@ namespace vk
 
                 const aiVector3D Zero3D(0.0f, 0.0f, 0.0f);
 
+                aiNode* pNode = findNode(pScene->mRootNode, paiMesh->mName.data);
+                EA_ASSERT_MSG(pNode != nullptr, "The root node must match the name of the mesh");
+
+                aiMatrix4x4 normal_transform = pNode->mTransformation;
+                aiMatrix4Inverse(&normal_transform);
+                aiTransposeMatrix4(&normal_transform);
+
                 for (unsigned int j = 0; j < paiMesh->mNumVertices; j++)
                 {
                     const aiVector3D* pPos = &(paiMesh->mVertices[j]);
-                    const aiVector3D* pNormal = &(paiMesh->mNormals[j]);
+                    const aiVector3D* pNormal = (paiMesh->HasNormals()) ? &(paiMesh->mNormals[j]) : &Zero3D;
                     const aiVector3D* pTexCoord = (paiMesh->HasTextureCoords(0)) ? &(paiMesh->mTextureCoords[0][j]) : &Zero3D;
                     const aiVector3D* pTangent = (paiMesh->HasTangentsAndBitangents()) ? &(paiMesh->mTangents[j]) : &Zero3D;
                     const aiVector3D* pBiTangent = (paiMesh->HasTangentsAndBitangents()) ? &(paiMesh->mBitangents[j]) : &Zero3D;
 
-                    
+                    aiVector3D pos = *pPos;
+                    aiTransformVecByMatrix4(&pos, &(pNode->mTransformation));
+                    glm::vec3 p = glm::vec3(pos.x, pos.y, pos.z) * scale + center;
+
+                    aiVector3D normal = *pNormal;
+                    if(paiMesh->HasNormals())
+                    {
+                        aiTransformVecByMatrix4(&normal, &normal_transform);
+                        aiVector3Normalize(&normal);
+                    }
+
+                    if(_vertex_format == vertex_format::PACKED)
+                    {
+                        //note: the packed layout is fixed, it always carries every component
+                        vertex v(p, glm::vec4(pColor.r, pColor.g, pColor.b, 1.0f), glm::vec2(pTexCoord->x * uvscale.s, pTexCoord->y * uvscale.t),
+                                 glm::vec3(normal.x, normal.y, normal.z));
+                        v._tangent = glm::vec3(pTangent->x, pTangent->y, pTangent->z);
+                        v._bitangent = glm::vec3(pBiTangent->x, pBiTangent->y, pBiTangent->z);
+                        unpacked_vertices.push_back(v);
+                        continue;
+                    }
+
                     for (auto& component : layout.components)
                     {
                         switch (component) {
                         case vertex_componets::VERTEX_COMPONENT_POSITION:
-                            {
-                                aiVector3D pos = *pPos;
-                                aiNode* pNode = findNode(pScene->mRootNode, paiMesh->mName.data);
-                                EA_ASSERT_MSG(pNode != nullptr, "The root node must match the name of the mesh");
-                                aiTransformVecByMatrix4(&pos, &(pNode->mTransformation));
-                                
-                                vertexBuffer.push_back(pos.x * scale.x + center.x);
-                                vertexBuffer.push_back(pos.y * scale.y + center.y);
-                                vertexBuffer.push_back(pos.z * scale.z + center.z);
-                                break;
-                            }
+                            vertexBuffer.push_back(p.x);
+                            vertexBuffer.push_back(p.y);
+                            vertexBuffer.push_back(p.z);
+                            break;
                         case vertex_componets::VERTEX_COMPONENT_NORMAL:
-                            {
-                                aiNode* pNode = findNode(pScene->mRootNode, paiMesh->mName.data);
-                                EA_ASSERT_MSG(pNode != nullptr, "The root node must match the name of the mesh");
-                                aiVector3D normal = *pNormal;
- 
-                                aiMatrix4x4 transform = pNode->mTransformation;
-                                aiMatrix4Inverse(&transform);
-                                aiTransposeMatrix4(&transform);
-                                
-                                aiTransformVecByMatrix4(&normal, &transform);
-                                aiVector3Normalize(&normal);
-                                
-                                vertexBuffer.push_back(normal.x);
-                                vertexBuffer.push_back(normal.y);
-                                vertexBuffer.push_back(normal.z);
-                                break;
-                            }
+                            vertexBuffer.push_back(normal.x);
+                            vertexBuffer.push_back(normal.y);
+                            vertexBuffer.push_back(normal.z);
+                            break;
                         case vertex_componets::VERTEX_COMPONENT_UV:
                             vertexBuffer.push_back(pTexCoord->x * uvscale.s);
                             vertexBuffer.push_back(pTexCoord->y * uvscale.t);
@@ -382,21 +467,11 @@ namespace vk
                             break;
                         };
                     }
-
-//                    dim.max.x = fmax(pPos->x, dim.max.x);
-//                    dim.max.y = fmax(pPos->y, dim.max.y);
-//                    dim.max.z = fmax(pPos->z, dim.max.z);
-//
-//                    dim.min.x = fmin(pPos->x, dim.min.x);
-//                    dim.min.y = fmin(pPos->y, dim.min.y);
-//                    dim.min.z = fmin(pPos->z, dim.min.z);
                 }
 
-//                dim.size = dim.max - dim.min;
-
                 //_parts[i].vertex_count = paiMesh->mNumVertices;
 
-                uint32_t indexBase = static_cast<uint32_t>(indexBuffer.size());
+                uint32_t indexBase = vertexCount - paiMesh->mNumVertices;
                 for (unsigned int j = 0; j < paiMesh->mNumFaces; j++)
                 {
                     const aiFace& Face = paiMesh->mFaces[j];
@@ -408,11 +483,78 @@ namespace vk
                 }
             }
             
+            //note: all meshes in the scene were merged into one buffer above, so they are optimized together
+            create_mesh(vertexBuffer, unpacked_vertices, indexBuffer);
+
+            //note: an authored level has nothing to be measured against, see mesh_simplifier::estimate_error
+            if(_vertex_format == vertex_format::PACKED)
+                _geometric_error = mesh_simplifier::estimate_error(unpacked_vertices.data(), sizeof(vertex), offsetof(vertex, _pos),
+                                                                   indexBuffer.data(), indexBuffer.size());
+            else if(layout.offset(vertex_componets::VERTEX_COMPONENT_POSITION) != mesh_optimizer::NO_POSITION)
+                _geometric_error = mesh_simplifier::estimate_error(vertexBuffer.data(), layout.stride(),
+                                                                   layout.offset(vertex_componets::VERTEX_COMPONENT_POSITION),
+                                                                   indexBuffer.data(), indexBuffer.size());
+
+            if(_keep_source)
+            {
+                _source.vertex_buffer = vertexBuffer;
+                _source.unpacked_vertices = unpacked_vertices;
+                _source.index_buffer = indexBuffer;
+            }
+        }
+
+        //optimizes the geometry for the gpu and uploads it as the one mesh of this shape.  Either vertexBuffer (laid out as
+        //_vertex_layout) or unpacked_vertices (for PACKED) is used
+        void create_mesh(eastl::vector<float>& vertexBuffer, eastl::vector<vertex>& unpacked_vertices, eastl::vector<uint32_t>& indexBuffer)
+        {
+            mesh_optimizer::report report {};
+            aabb bounds {};
+            if(_vertex_format == vertex_format::PACKED)
+            {
+                report = mesh_optimizer::optimize(unpacked_vertices.data(), unpacked_vertices.size(), sizeof(vertex), offsetof(vertex, _pos),
+                                                  indexBuffer.data(), indexBuffer.size());
+                unpacked_vertices.resize(report.vertex_count_after);
+
+                for( const vertex& v : unpacked_vertices)
+                    bounds.expand(v._pos);
+            }
+            else
+            {
+                uint32_t stride = _vertex_layout.stride();
+                size_t position_offset = _vertex_layout.offset(vertex_componets::VERTEX_COMPONENT_POSITION);
+                report = mesh_optimizer::optimize(vertexBuffer.data(), (vertexBuffer.size() * sizeof(float)) / stride, stride,
+                                                  position_offset, indexBuffer.data(), indexBuffer.size());
+                vertexBuffer.resize((report.vertex_count_after * stride) / sizeof(float));
+
+                if(position_offset != mesh_optimizer::NO_POSITION)
+                {
+                    for( uint32_t v = 0; v < report.vertex_count_after; ++v)
+                    {
+                        const float* p = &vertexBuffer[(v * stride + position_offset) / sizeof(float)];
+                        bounds.expand(glm::vec3(p[0], p[1], p[2]));
+                    }
+                }
+            }
+            mesh_optimizer::record(report, _path.c_str());
+
             vk::assimp_mesh* assimp_m = new assimp_mesh();
             assimp_m->set_device(_device);
             _meshes.push_back( assimp_m );
-            assimp_m->create( createInfo->memoryPropertyFlags, vertexBuffer, indexBuffer );
-
+            
+            eastl::vector<packed_vertex> packed_vertices;
+            if(_vertex_format == vertex_format::PACKED)
+                assimp_m->create( unpacked_vertices, indexBuffer, bounds, packed_vertices );
+            else
+                assimp_m->create( _vertex_layout.stride(), vertexBuffer, indexBuffer, bounds );
+            
+            if(_keep_stream)
+            {
+                const uint8_t* vertices = _vertex_format == vertex_format::PACKED ? reinterpret_cast<const uint8_t*>(packed_vertices.data()) :
+                                                                                    reinterpret_cast<const uint8_t*>(vertexBuffer.data());
+                _stream.vertices.assign(vertices, vertices + size_t(get_vertex_stride()) * assimp_m->get_vertex_count());
+                _stream.indices = indexBuffer;
+                _stream.bounds = bounds;
+            }
         }
         
         bool load(const char* path)
@@ -489,12 +631,171 @@ namespace vk
             setup_vertex_layout();
         }
         
+        //note: PACKED ignores the vertex layout, see packed_vertex.h
+        inline void set_vertex_format(vertex_format format)
+        {
+            _vertex_format = format;
+        }
+        
+        //note: must be set before create, see create_simplified
+        inline void set_keep_source(bool b)
+        {
+            _keep_source = b;
+        }
+        
+        inline void release_source()
+        {
+            _source = {};
+        }
+        
+        //note: must be set before create, see get_cache_level
+        inline void set_keep_stream(bool b)
+        {
+            _keep_stream = b;
+        }
+        
+        inline void release_stream()
+        {
+            _stream = {};
+        }
+        
+        inline uint32_t get_vertex_stride()
+        {
+            return _vertex_format == vertex_format::PACKED ? static_cast<uint32_t>(sizeof(packed_vertex)) : _vertex_layout.stride();
+        }
+        
+        //what this shape uploaded, to be written to a mesh cache.  The shape must have been created with set_keep_stream(true)
+        mesh_cache::level get_cache_level()
+        {
+            EA_ASSERT_MSG(!_stream.indices.empty(), "the shape did not keep its streams, call set_keep_stream");
+            
+            mesh_cache::level level {};
+            level.vertices = _stream.vertices.data();
+            level.indices = _stream.indices.data();
+            level.vertex_count = static_cast<uint32_t>(_stream.vertices.size() / get_vertex_stride());
+            level.index_count = static_cast<uint32_t>(_stream.indices.size());
+            level.bounds = _stream.bounds;
+            level.geometric_error = _geometric_error;
+            return level;
+        }
+        
+        void get_texture_refs(mesh_cache::texture_refs& refs)
+        {
+            for( uint32_t m = 0; m < _textures.size(); ++m)
+            {
+                for( uint32_t t = 0; t < _textures[m].size(); ++t)
+                {
+                    for( uint32_t c = 0; c < _textures[m][t].size(); ++c)
+                    {
+                        if(_textures[m][t][c].empty())
+                            continue;
+                        
+                        mesh_cache::texture_ref ref {};
+                        ref.mesh = m;
+                        ref.type = t;
+                        ref.slot = c;
+                        strncpy(ref.path, _textures[m][t][c].c_str(), mesh_cache::MAX_TEXTURE_PATH - 1);
+                        refs.push_back(ref);
+                    }
+                }
+            }
+        }
+        
+        //builds this shape out of a level of a cache instead of importing it.  Textures that were set on this shape win over
+        //the ones in the cache, like they do over the ones in the source asset
+        void create_cached(const mesh_cache& cache, uint32_t level_id)
+        {
+            EA_ASSERT(level_id < cache.get_num_levels());
+            EA_ASSERT_MSG(cache.get_vertex_format() == _vertex_format, "the cache was built for another vertex format");
+            
+            for( const mesh_cache::texture_ref& ref : cache.get_textures())
+            {
+                if(ref.mesh < _textures.size() && ref.type < _textures[ref.mesh].size() && ref.slot < _textures[ref.mesh][ref.type].size() &&
+                   _textures[ref.mesh][ref.type][ref.slot].empty())
+                {
+                    _textures[ref.mesh][ref.type][ref.slot] = ref.path;
+                }
+            }
+            
+            const mesh_cache::level& level = cache.get_level(level_id);
+            _geometric_error = level.geometric_error;
+            
+            vk::assimp_mesh* assimp_m = new assimp_mesh();
+            assimp_m->set_device(_device);
+            _meshes.push_back( assimp_m );
+            assimp_m->create(cache.get_vertex_format(), cache.get_vertex_stride(), level);
+        }
+        
+        inline float get_geometric_error() const
+        {
+            return _geometric_error;
+        }
+        
+        inline uint32_t get_source_index_count() const
+        {
+            return static_cast<uint32_t>(_source.index_buffer.size());
+        }
+        
+        //builds this shape out of a simplified copy of source, which must have been created with set_keep_source(true).
+        //Returns false if the mesh could not get any smaller
+        bool create_simplified(assimp_obj& source, size_t target_index_count)
+        {
+            EA_ASSERT_MSG(!source._source.index_buffer.empty(), "the source shape did not keep its geometry, call set_keep_source");
+            
+            _device = source._device;
+            _path = source._path;
+            _textures = source._textures;
+            _vertex_layout = source._vertex_layout;
+            _vertex_format = source._vertex_format;
+            
+            eastl::vector<float> vertexBuffer = source._source.vertex_buffer;
+            eastl::vector<vertex> unpacked_vertices = source._source.unpacked_vertices;
+            eastl::vector<uint32_t> indexBuffer = source._source.index_buffer;
+            
+            mesh_simplifier::result result {};
+            if(_vertex_format == vertex_format::PACKED)
+            {
+                result = mesh_simplifier::simplify(unpacked_vertices.data(), unpacked_vertices.size(), sizeof(vertex), offsetof(vertex, _pos),
+                                                   indexBuffer, target_index_count);
+            }
+            else
+            {
+                size_t position_offset = _vertex_layout.offset(vertex_componets::VERTEX_COMPONENT_POSITION);
+                EA_ASSERT_MSG(position_offset != mesh_optimizer::NO_POSITION, "meshes without positions cannot be simplified");
+                uint32_t stride = _vertex_layout.stride();
+                result = mesh_simplifier::simplify(vertexBuffer.data(), (vertexBuffer.size() * sizeof(float)) / stride, stride, position_offset,
+                                                   indexBuffer, target_index_count);
+            }
+            
+            if(indexBuffer.empty() || indexBuffer.size() >= source._source.index_buffer.size())
+                return false;
+            
+            //note: the simplifier measures how far vertices moved from the source, a level that was simplified from another
+            //simplified level strays from the full detail mesh by at most the sum of both
+            _geometric_error = (source._simplified ? source._geometric_error : 0.0f) + result.error;
+            _simplified = true;
+            create_mesh(vertexBuffer, unpacked_vertices, indexBuffer);
+            
+            if(_keep_source)
+            {
+                _source.vertex_buffer = vertexBuffer;
+                _source.unpacked_vertices = unpacked_vertices;
+                _source.index_buffer = indexBuffer;
+            }
+            return true;
+        }
+        
         void set_vertex_layout(vk::vertex_components& comps)
         {
             _vertex_layout.components.clear();
             _vertex_layout.components = comps;
         }
         
+        inline const vertex_components& get_vertex_components() const
+        {
+            return _vertex_layout.components;
+        }
+        
         
         void set_device(device* dev)
         {
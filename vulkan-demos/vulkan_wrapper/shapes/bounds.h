@@ -0,0 +1,79 @@
+//
+//  bounds.h
+//  vulkan-demos
+//
+//  Created by Rafael Sabino on 10/19/26.
+//  Copyright © 2026 Rafael Sabino. All rights reserved.
+//
+
+#pragma once
+
+#include <cfloat>
+#include <cmath>
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+namespace vk
+{
+    //axis aligned bounding box, an empty box has min > max so that the first expand initializes it
+    struct aabb
+    {
+        glm::vec3 min = glm::vec3(FLT_MAX);
+        glm::vec3 max = glm::vec3(-FLT_MAX);
+
+        inline void expand(const glm::vec3& p)
+        {
+            min = glm::min(min, p);
+            max = glm::max(max, p);
+        }
+
+        inline void expand(const aabb& box)
+        {
+            if(box.is_valid())
+            {
+                expand(box.min);
+                expand(box.max);
+            }
+        }
+
+        inline bool is_valid() const
+        {
+            return min.x <= max.x && min.y <= max.y && min.z <= max.z;
+        }
+
+        inline glm::vec3 get_center() const
+        {
+            return (min + max) * .5f;
+        }
+
+        //note: these are half extents
+        inline glm::vec3 get_extents() const
+        {
+            return (max - min) * .5f;
+        }
+
+        inline float get_radius() const
+        {
+            return glm::length(get_extents());
+        }
+
+        //returns the box that encloses this box after it has been transformed by the matrix,
+        //see Arvo's "Transforming Axis-Aligned Bounding Boxes", Graphics Gems 1990
+        inline aabb transform(const glm::mat4& m) const
+        {
+            glm::vec3 center = glm::vec3(m * glm::vec4(get_center(), 1.0f));
+            glm::vec3 extents = get_extents();
+
+            glm::vec3 new_extents = glm::abs(glm::vec3(m[0])) * extents.x +
+                                    glm::abs(glm::vec3(m[1])) * extents.y +
+                                    glm::abs(glm::vec3(m[2])) * extents.z;
+
+            aabb result {};
+            result.min = center - new_extents;
+            result.max = center + new_extents;
+            return result;
+        }
+    };
+}
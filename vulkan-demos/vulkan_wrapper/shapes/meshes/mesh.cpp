@@ -12,6 +12,7 @@
 #include "tiny_obj_loader.h"
 
 #include "vertex.h"
+#include "mesh_optimizer.h"
 #include "visual_material.h"
 #include "graphics_pipeline.h"
 
@@ -51,47 +52,38 @@ mesh::mesh( device* device, tinyobj::attrib_t &vertex_attributes, tinyobj::shape
         {
             map_vertices[vert] = static_cast<uint32_t>(map_vertices.size());
             _vertices.push_back(vert);
+            _bounds.expand(pos);
         }
         
         _indices.push_back(map_vertices[vert]);
     }
     
+    mesh_optimizer::report report = mesh_optimizer::optimize(_vertices.data(), _vertices.size(), sizeof(vertex), offsetof(vertex, _pos),
+                                                             _indices.data(), _indices.size());
+    _vertices.resize(report.vertex_count_after);
+    mesh_optimizer::record(report, shape.name.c_str());
+    
     allocate_gpu_memory();
 }
 
 
 
-void mesh::create_vertex_buffer()
-{
-    create_and_upload_buffer(_device->_graphics_command_pool,
-                          _vertices, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, _vertex_buffer, _vertex_buffer_device_memory);
-}
-
-void mesh::create_index_buffer()
+void mesh::upload_geometry(uint32_t vertex_stride, const void* vertices, uint32_t vertex_count, const uint32_t* indices, uint32_t index_count)
 {
-    create_and_upload_buffer( _device->_graphics_command_pool,
-                          _indices, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, _index_buffer, _index_buffer_device_memory);
+    EA_ASSERT_MSG(!_geometry.is_valid(), "this mesh has already been uploaded");
+    _geometry = _device->get_geometry_pool().allocate(vertex_stride, vertices, vertex_count, indices, index_count);
 }
 
 void mesh::allocate_gpu_memory()
 {
-    create_vertex_buffer();
-    create_index_buffer();
+    upload_geometry(sizeof(vertex), _vertices.data(), static_cast<uint32_t>(_vertices.size()),
+                    _indices.data(), static_cast<uint32_t>(_indices.size()));
 }
 
+//note: the vertices and indices stay in the geometry pool until the device is destroyed
 void mesh::destroy()
 {
-    vkFreeMemory(_device->_logical_device, _index_buffer_device_memory, nullptr);
-    vkDestroyBuffer(_device->_logical_device, _index_buffer, nullptr);
-    
-    _index_buffer_device_memory = VK_NULL_HANDLE;
-    _index_buffer = VK_NULL_HANDLE;
-    
-    vkFreeMemory(_device->_logical_device, _vertex_buffer_device_memory, nullptr);
-    vkDestroyBuffer(_device->_logical_device, _vertex_buffer, nullptr);
-    
-    _vertex_buffer_device_memory = VK_NULL_HANDLE;
-    _vertex_buffer = VK_NULL_HANDLE;
+    _geometry = {};
 }
 mesh::~mesh()
 {
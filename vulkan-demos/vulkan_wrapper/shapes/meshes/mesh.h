@@ -15,8 +15,11 @@
 #include <unordered_map>
 
 #include "vertex.h"
+#include "packed_vertex.h"
 #include "visual_material.h"
 #include "compute_pipeline.h"
+#include "bounds.h"
+#include "geometry_pool.h"
 
 #include "tiny_obj_loader.h"
 
@@ -32,10 +35,14 @@ namespace vk
         std::vector<uint32_t> _indices;
         device* _device = nullptr;
         
-        VkBuffer        _vertex_buffer = VK_NULL_HANDLE;
-        VkDeviceMemory  _vertex_buffer_device_memory = VK_NULL_HANDLE;
-        VkBuffer        _index_buffer = VK_NULL_HANDLE;
-        VkDeviceMemory  _index_buffer_device_memory = VK_NULL_HANDLE;
+        //note: where this mesh lives inside of the device's geometry pool
+        geometry_pool::range _geometry {};
+        
+        vertex_format                   _vertex_format = vertex_format::FLOAT32;
+        packed_vertex::quantization     _quantization {};
+        
+        //note: bounds are in mesh space, use aabb::transform to take them to world space
+        aabb            _bounds {};
         
     protected:
         mesh(){};
@@ -51,62 +58,6 @@ namespace vk
         
         ~mesh();
         
-        template<typename T>
-        void create_and_upload_buffer(VkCommandPool command_pool,
-                                          std::vector<T>& data, VkBufferUsageFlags usage, VkBuffer &buffer, VkDeviceMemory &device_memory)
-        {
-            VkDeviceSize buffer_size = sizeof(T) * data.size();
-            assert(data.size() != 0);
-            VkBuffer staging_buffer {};
-            VkDeviceMemory staging_buffer_memory {};
-            
-            create_buffer(_device->_logical_device, _device->_physical_device, buffer_size,  VK_BUFFER_USAGE_TRANSFER_SRC_BIT, staging_buffer,
-                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, staging_buffer_memory);
-            
-            void* raw_data= nullptr;
-            VkResult r = vkMapMemory(_device->_logical_device, staging_buffer_memory, 0, buffer_size, 0, &raw_data);
-            ASSERT_VULKAN(r);
-            memcpy(raw_data, data.data(), buffer_size);
-            vkUnmapMemory(_device->_logical_device, staging_buffer_memory);
-            
-            
-            create_buffer(_device->_logical_device, _device->_physical_device, buffer_size, usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT, buffer,
-                         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, device_memory);
-            
-            _device->copy_buffer(command_pool, _device->_graphics_queue, staging_buffer, buffer, buffer_size);
-            vkDestroyBuffer(_device->_logical_device, staging_buffer, nullptr);
-            vkFreeMemory(_device->_logical_device, staging_buffer_memory, nullptr);
-            
-        }
-        
-        template<typename T>
-        void create_and_upload_buffer_void(VkCommandPool command_pool,
-                                          eastl::vector<T> &data, VkBufferUsageFlags usage, VkBuffer &buffer, VkDeviceMemory &device_memory)
-        {
-            VkDeviceSize buffer_size = sizeof(T) * data.size();
-            EA_ASSERT(data.size() != 0);
-            VkBuffer staging_buffer {};
-            VkDeviceMemory staging_buffer_memory {};
-            
-            create_buffer(_device->_logical_device, _device->_physical_device, buffer_size,  VK_BUFFER_USAGE_TRANSFER_SRC_BIT, staging_buffer,
-                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, staging_buffer_memory);
-  
-            void* raw_data= nullptr;
-            VkResult r = vkMapMemory(_device->_logical_device, staging_buffer_memory, 0, buffer_size, 0, &raw_data);
-            ASSERT_VULKAN(r);
-            memcpy(raw_data, data.data(), buffer_size);
-            vkUnmapMemory(_device->_logical_device, staging_buffer_memory);
-            
-            
-            create_buffer(_device->_logical_device, _device->_physical_device, buffer_size, usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT, buffer,
-                         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, device_memory);
-            
-            _device->copy_buffer(command_pool, _device->_graphics_queue, staging_buffer, buffer, buffer_size);
-            vkDestroyBuffer(_device->_logical_device, staging_buffer, nullptr);
-            vkFreeMemory(_device->_logical_device, staging_buffer_memory, nullptr);
-            
-        }
-
         static const eastl::string _mesh_resource_path;
         
         template<uint32_t NUM_ATTACHMENTS>
@@ -114,22 +65,44 @@ namespace vk
         
         virtual void destroy() override;
         
+        //note: binds the whole geometry pool block this mesh lives in, meshes in the same block can be drawn without binding again
         inline void bind_verteces(VkCommandBuffer& command_buffer)
         {
-            VkDeviceSize offsets[] = { 0 };
-            assert(_vertex_buffer != nullptr);
-
-            vkCmdBindVertexBuffers(command_buffer, 0, 1, &_vertex_buffer, offsets);
-            vkCmdBindIndexBuffer(command_buffer, _index_buffer, 0, VK_INDEX_TYPE_UINT32);
+            EA_ASSERT_MSG(_geometry.is_valid(), "this mesh has not been uploaded to the gpu");
+            _device->get_geometry_pool().bind(command_buffer, _geometry.block_id);
         }
         
-        virtual void draw_indexed(VkCommandBuffer command_buffer, uint32_t instance_count)
+        virtual void draw_indexed(VkCommandBuffer command_buffer, uint32_t instance_count, uint32_t first_instance)
         {
-            vkCmdDrawIndexed(command_buffer, static_cast<uint32_t>(get_indices().size()), instance_count, 0, 0, 0);
+            vkCmdDrawIndexed(command_buffer, static_cast<uint32_t>(get_indices().size()), instance_count, _geometry.first_index, _geometry.vertex_offset, first_instance);
         }
         virtual void draw(VkCommandBuffer command_buffer)
         {
-            vkCmdDraw(command_buffer, static_cast<uint32_t>(_vertices.size()), 1, 0,0 );
+            vkCmdDraw(command_buffer, static_cast<uint32_t>(_vertices.size()), 1, static_cast<uint32_t>(_geometry.vertex_offset), 0 );
+        }
+        
+        inline uint32_t get_geometry_block() const
+        {
+            return _geometry.block_id;
+        }
+        inline uint32_t get_first_index() const
+        {
+            return _geometry.first_index;
+        }
+        inline int32_t get_vertex_offset() const
+        {
+            return _geometry.vertex_offset;
+        }
+        
+        inline vertex_format get_vertex_format() const
+        {
+            return _vertex_format;
+        }
+        
+        //note: identity for FLOAT32 meshes, packed positions are in [-1, 1] and this takes them back to mesh space
+        inline glm::mat4 get_dequantization_matrix() const
+        {
+            return _quantization.get_matrix();
         }
     
         inline std::vector<vertex>& get_vertices()
@@ -141,11 +114,20 @@ namespace vk
             return _indices;
         }
         
+        inline const aabb& get_bounds() const
+        {
+            return _bounds;
+        }
+        
+        virtual uint32_t get_index_count()
+        {
+            return static_cast<uint32_t>(_indices.size());
+        }
+        
     protected:
         
         bool _active = true;
-        void create_vertex_buffer();
-        void create_index_buffer();
         void allocate_gpu_memory();
+        void upload_geometry(uint32_t vertex_stride, const void* vertices, uint32_t vertex_count, const uint32_t* indices, uint32_t index_count);
     };
 }
@@ -0,0 +1,278 @@
+//
+//  mesh_cache.cpp
+//  vulkan-demos
+//
+//  Created by Rafael Sabino on 10/19/26.
+//  Copyright © 2026 Rafael Sabino. All rights reserved.
+//
+
+#include "mesh_cache.h"
+#include "EASTL/fixed_string.h"
+#include "EAAssert/eaassert.h"
+
+#include <cstdio>
+#include <iostream>
+#include <cstring>
+#include <filesystem>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace vk;
+
+bool mesh_cache::_enabled = true;
+bool mesh_cache::_verbose = false;
+mesh_cache::load_totals mesh_cache::_totals {};
+
+namespace
+{
+    inline uint64_t align_up(uint64_t offset, uint64_t alignment)
+    {
+        return (offset + alignment - 1) & ~(alignment - 1);
+    }
+
+    bool write_padding(FILE* file, uint64_t& offset, uint64_t alignment)
+    {
+        static const char zeros[64] = {};
+        uint64_t padding = align_up(offset, alignment) - offset;
+        offset += padding;
+        return padding == 0 || fwrite(zeros, 1, padding, file) == padding;
+    }
+}
+
+uint64_t mesh_cache::hash_bytes(const void* data, size_t size, uint64_t seed)
+{
+    constexpr uint64_t PRIME = 1099511628211ull;
+
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    uint64_t hash = seed;
+    for( size_t i = 0; i < size; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= PRIME;
+    }
+    return hash;
+}
+
+//note: the contents are not read, hashing a large fbx and its levels on every launch costs about as much as the cache saves.  Any
+//edit, copy or checkout of the file changes its modification time, at worst the mesh is imported again
+uint64_t mesh_cache::hash_file(const char* path, uint64_t seed)
+{
+    std::error_code error {};
+    uint64_t stamp[2] = {};
+    stamp[0] = static_cast<uint64_t>(std::filesystem::file_size(path, error));
+    if(error)
+        return seed;
+
+    stamp[1] = static_cast<uint64_t>(std::filesystem::last_write_time(path, error).time_since_epoch().count());
+    if(error)
+        return seed;
+
+    return hash_bytes(stamp, sizeof(stamp), seed);
+}
+
+bool mesh_cache::open(const char* path, uint64_t hash)
+{
+    close();
+
+    int fd = ::open(path, O_RDONLY);
+    if(fd < 0)
+        return false;
+
+    struct stat info {};
+    if(fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(file_header))
+    {
+        ::close(fd);
+        return false;
+    }
+
+    _mapping_size = static_cast<size_t>(info.st_size);
+    _mapping = mmap(nullptr, _mapping_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    //note: the mapping keeps the file alive, the descriptor is not needed anymore
+    ::close(fd);
+
+    if(_mapping == MAP_FAILED)
+    {
+        _mapping = nullptr;
+        return false;
+    }
+
+    const uint8_t* base = static_cast<const uint8_t*>(_mapping);
+    const file_header* header = reinterpret_cast<const file_header*>(base);
+
+    bool valid = header->magic == MAGIC && header->version == VERSION && header->hash == hash &&
+                 header->num_levels != 0 && header->num_levels <= MAX_LEVELS && header->vertex_stride != 0;
+
+    uint64_t tables_size = sizeof(file_header) + uint64_t(header->num_levels) * sizeof(level_header) +
+                           uint64_t(header->num_textures) * sizeof(texture_ref);
+    valid = valid && tables_size <= _mapping_size;
+
+    if(valid)
+    {
+        _format = static_cast<vertex_format>(header->vertex_format);
+        _vertex_stride = header->vertex_stride;
+
+        const level_header* levels = reinterpret_cast<const level_header*>(header + 1);
+        for( uint32_t l = 0; l < header->num_levels && valid; ++l)
+        {
+            const level_header& lh = levels[l];
+            uint64_t vertex_bytes = uint64_t(lh.vertex_count) * _vertex_stride;
+            uint64_t index_bytes = uint64_t(lh.index_count) * sizeof(uint32_t);
+
+            valid = lh.vertex_count != 0 && lh.index_count != 0 &&
+                    (lh.vertex_offset % STREAM_ALIGNMENT) == 0 && (lh.index_offset % STREAM_ALIGNMENT) == 0 &&
+                    lh.vertex_offset + vertex_bytes <= _mapping_size && lh.index_offset + index_bytes <= _mapping_size;
+            if(!valid)
+                break;
+
+            //note: the indices go to the gpu as they are, one past the vertices of its level would read another mesh's vertices
+            const uint32_t* indices = reinterpret_cast<const uint32_t*>(base + lh.index_offset);
+            for( uint32_t i = 0; i < lh.index_count && valid; ++i)
+            {
+                valid = indices[i] < lh.vertex_count;
+            }
+            if(!valid)
+                break;
+
+            level lvl {};
+            lvl.vertices = base + lh.vertex_offset;
+            lvl.indices = indices;
+            lvl.vertex_count = lh.vertex_count;
+            lvl.index_count = lh.index_count;
+            lvl.bounds.min = glm::vec3(lh.bounds_min[0], lh.bounds_min[1], lh.bounds_min[2]);
+            lvl.bounds.max = glm::vec3(lh.bounds_max[0], lh.bounds_max[1], lh.bounds_max[2]);
+            lvl.geometric_error = lh.geometric_error;
+            _levels.push_back(lvl);
+        }
+
+        const texture_ref* textures = reinterpret_cast<const texture_ref*>(levels + header->num_levels);
+        for( uint32_t t = 0; t < header->num_textures && valid; ++t)
+        {
+            _textures.push_back(textures[t]);
+            _textures.back().path[MAX_TEXTURE_PATH - 1] = '\0';
+        }
+    }
+
+    if(!valid)
+    {
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void mesh_cache::close()
+{
+    if(_mapping != nullptr)
+    {
+        munmap(_mapping, _mapping_size);
+    }
+    _mapping = nullptr;
+    _mapping_size = 0;
+    _levels.clear();
+    _textures.clear();
+}
+
+bool mesh_cache::write(const char* path, uint64_t hash, vertex_format format, uint32_t vertex_stride,
+                       const level* levels, uint32_t num_levels, const texture_refs& textures)
+{
+    EA_ASSERT(num_levels != 0 && num_levels <= MAX_LEVELS);
+
+    file_header header {};
+    header.hash = hash;
+    header.vertex_format = static_cast<uint32_t>(format);
+    header.vertex_stride = vertex_stride;
+    header.num_levels = num_levels;
+    header.num_textures = static_cast<uint32_t>(textures.size());
+
+    //note: the streams follow the tables, every one of them aligned
+    eastl::fixed_vector<level_header, MAX_LEVELS, false> level_headers {};
+    uint64_t offset = sizeof(file_header) + uint64_t(num_levels) * sizeof(level_header) + textures.size() * sizeof(texture_ref);
+    for( uint32_t l = 0; l < num_levels; ++l)
+    {
+        const level& lvl = levels[l];
+        level_header lh {};
+        lh.vertex_count = lvl.vertex_count;
+        lh.index_count = lvl.index_count;
+        memcpy(lh.bounds_min, &lvl.bounds.min[0], sizeof(lh.bounds_min));
+        memcpy(lh.bounds_max, &lvl.bounds.max[0], sizeof(lh.bounds_max));
+        lh.geometric_error = lvl.geometric_error;
+
+        offset = align_up(offset, STREAM_ALIGNMENT);
+        lh.vertex_offset = offset;
+        offset += uint64_t(lvl.vertex_count) * vertex_stride;
+
+        offset = align_up(offset, STREAM_ALIGNMENT);
+        lh.index_offset = offset;
+        offset += uint64_t(lvl.index_count) * sizeof(uint32_t);
+
+        level_headers.push_back(lh);
+    }
+
+    eastl::fixed_string<char, 260> temp_path {};
+    temp_path.sprintf("%s.tmp", path);
+
+    FILE* file = fopen(temp_path.c_str(), "wb");
+    if(file == nullptr)
+        return false;
+
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    ok = ok && fwrite(level_headers.data(), sizeof(level_header), level_headers.size(), file) == level_headers.size();
+    ok = ok && (textures.empty() || fwrite(textures.data(), sizeof(texture_ref), textures.size(), file) == textures.size());
+
+    offset = sizeof(file_header) + uint64_t(num_levels) * sizeof(level_header) + textures.size() * sizeof(texture_ref);
+    for( uint32_t l = 0; l < num_levels && ok; ++l)
+    {
+        const level& lvl = levels[l];
+        size_t vertex_bytes = size_t(lvl.vertex_count) * vertex_stride;
+        size_t index_bytes = size_t(lvl.index_count) * sizeof(uint32_t);
+
+        ok = write_padding(file, offset, STREAM_ALIGNMENT) && fwrite(lvl.vertices, 1, vertex_bytes, file) == vertex_bytes;
+        offset += vertex_bytes;
+        ok = ok && write_padding(file, offset, STREAM_ALIGNMENT) && fwrite(lvl.indices, 1, index_bytes, file) == index_bytes;
+        offset += index_bytes;
+    }
+
+    ok = (fclose(file) == 0) && ok;
+    ok = ok && std::rename(temp_path.c_str(), path) == 0;
+    if(!ok)
+        std::remove(temp_path.c_str());
+
+    return ok;
+}
+
+void mesh_cache::record_load(const char* mesh_name, bool cached, uint32_t num_levels, double milliseconds)
+{
+    if(_verbose)
+    {
+        eastl::fixed_string<char, 300> msg {};
+        msg.sprintf("%s %s, %u levels in %.2f ms", cached ? "loaded from mesh cache" : "imported", mesh_name, num_levels, milliseconds);
+        std::cout << msg.c_str() << std::endl;
+    }
+
+    if(cached)
+    {
+        ++_totals.num_cached;
+        _totals.cached_milliseconds += milliseconds;
+    }
+    else
+    {
+        ++_totals.num_imported;
+        _totals.imported_milliseconds += milliseconds;
+    }
+}
+
+void mesh_cache::print_totals()
+{
+    if(_totals.num_cached + _totals.num_imported == 0)
+        return;
+
+    eastl::fixed_string<char, 200> msg {};
+    msg.sprintf("meshes: %u loaded from their cache in %.2f ms, %u imported in %.2f ms", _totals.num_cached, _totals.cached_milliseconds,
+                _totals.num_imported, _totals.imported_milliseconds);
+    std::cout << msg.c_str() << std::endl;
+
+    _totals = load_totals {};
+}
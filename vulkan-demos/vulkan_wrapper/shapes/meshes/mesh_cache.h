@@ -0,0 +1,147 @@
+//
+//  mesh_cache.h
+//  vulkan-demos
+//
+//  Created by Rafael Sabino on 10/19/26.
+//  Copyright © 2026 Rafael Sabino. All rights reserved.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include "EASTL/fixed_vector.h"
+#include "EASTL/vector.h"
+#include "bounds.h"
+#include "packed_vertex.h"
+
+namespace vk
+{
+    //note: binary copy of what a mesh node uploads to the geometry pool, every level of detail with its vertices and indices already
+    //optimized and packed, plus bounds, errors and the textures the source asset referenced.  The first time a mesh is imported
+    //through assimp the cache is written next to it ("car.fbx" -> "car.fbx.vkmesh"), later runs map the file and hand the
+    //geometry pool pointers into the mapping, nothing is parsed or repacked.
+    //
+    //a cache is only used if it was built from source files of the same size and modification time and the same import settings,
+    //see hash_file and hash_bytes.  Bump VERSION whenever import, optimization or packing change what ends up in the streams
+    class mesh_cache
+    {
+    public:
+
+        static constexpr uint32_t MAGIC = 0x534d4b56u; //"VKMS"
+        static constexpr uint32_t VERSION = 2u;
+        static constexpr uint32_t MAX_LEVELS = 10u;
+        static constexpr uint32_t MAX_TEXTURE_PATH = 256u;
+        static constexpr uint64_t HASH_SEED = 14695981039346656037ull;
+        static constexpr const char* EXTENSION = ".vkmesh";
+
+        //note: pointers are into the mapping when read, into the caller's memory when written
+        struct level
+        {
+            const void*     vertices = nullptr;
+            const uint32_t* indices = nullptr;
+            uint32_t        vertex_count = 0;
+            uint32_t        index_count = 0;
+            aabb            bounds {};
+            float           geometric_error = 0.0f;
+        };
+
+        //note: one texture slot of the source materials, i.e. the _textures array of assimp_obj
+        struct texture_ref
+        {
+            uint32_t    mesh = 0;
+            uint32_t    type = 0;
+            uint32_t    slot = 0;
+            char        path[MAX_TEXTURE_PATH] = {};
+        };
+
+        using texture_refs = eastl::vector<texture_ref>;
+
+        mesh_cache(){}
+        ~mesh_cache(){ close(); }
+
+        mesh_cache & operator=(const mesh_cache&) = delete;
+        mesh_cache(const mesh_cache&) = delete;
+
+        //maps the file and checks it against hash, returns false if it is missing, stale or damaged.  Damaged includes an index
+        //that is not below the vertex count of its level
+        bool open(const char* path, uint64_t hash);
+        void close();
+
+        inline bool is_open() const { return _mapping != nullptr; }
+        inline vertex_format get_vertex_format() const { return _format; }
+        inline uint32_t get_vertex_stride() const { return _vertex_stride; }
+        inline uint32_t get_num_levels() const { return static_cast<uint32_t>(_levels.size()); }
+        inline const level& get_level(uint32_t l) const { return _levels[l]; }
+        inline const texture_refs& get_textures() const { return _textures; }
+
+        //note: written to a temporary file that is renamed over the old cache, a half written cache is never opened
+        static bool write(const char* path, uint64_t hash, vertex_format format, uint32_t vertex_stride,
+                          const level* levels, uint32_t num_levels, const texture_refs& textures);
+
+        //fnv-1a, pass the result of one call as the seed of the next to combine
+        static uint64_t hash_bytes(const void* data, size_t size, uint64_t seed = HASH_SEED);
+        //note: size and modification time of the file, not its contents.  A missing file leaves seed as it is
+        static uint64_t hash_file(const char* path, uint64_t seed = HASH_SEED);
+
+        //note: when disabled caches are neither read nor written, meshes are imported with assimp every time.  This is how load
+        //times are compared, see --no-mesh-cache in main.mm
+        static inline void set_enabled(bool b){ _enabled = b; }
+        static inline bool is_enabled(){ return _enabled; }
+
+        //note: every mesh node records how long it took to load and whether it came from its cache, print_totals writes one line
+        //for the scene.  Verbose prints a line for every mesh as well, see --mesh-report in main.mm.  Main thread only
+        static void record_load(const char* mesh_name, bool cached, uint32_t num_levels, double milliseconds);
+        //note: prints what was recorded since the last call and starts over, nothing if no mesh was recorded
+        static void print_totals();
+        static inline void set_verbose(bool b){ _verbose = b; }
+
+    private:
+
+        struct file_header
+        {
+            uint32_t    magic = MAGIC;
+            uint32_t    version = VERSION;
+            uint64_t    hash = 0;
+            uint32_t    vertex_format = 0;
+            uint32_t    vertex_stride = 0;
+            uint32_t    num_levels = 0;
+            uint32_t    num_textures = 0;
+        };
+
+        struct level_header
+        {
+            uint64_t    vertex_offset = 0;
+            uint64_t    index_offset = 0;
+            uint32_t    vertex_count = 0;
+            uint32_t    index_count = 0;
+            float       bounds_min[3] = {};
+            float       bounds_max[3] = {};
+            float       geometric_error = 0.0f;
+            uint32_t    pad = 0;
+        };
+
+        //note: streams start on this boundary in the file, mappings start on a page
+        static constexpr size_t STREAM_ALIGNMENT = 16u;
+
+        static bool _enabled;
+        static bool _verbose;
+
+        struct load_totals
+        {
+            uint32_t    num_cached = 0;
+            uint32_t    num_imported = 0;
+            double      cached_milliseconds = 0.0;
+            double      imported_milliseconds = 0.0;
+        };
+        static load_totals _totals;
+
+        void*   _mapping = nullptr;
+        size_t  _mapping_size = 0;
+
+        vertex_format   _format = vertex_format::FLOAT32;
+        uint32_t        _vertex_stride = 0;
+        eastl::fixed_vector<level, MAX_LEVELS, false> _levels {};
+        texture_refs    _textures {};
+    };
+}
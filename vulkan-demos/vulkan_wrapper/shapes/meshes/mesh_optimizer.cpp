@@ -0,0 +1,471 @@
+//
+//  mesh_optimizer.cpp
+//  vulkan-demos
+//
+//  Created by Rafael Sabino on 10/19/26.
+//  Copyright © 2026 Rafael Sabino. All rights reserved.
+//
+
+#include "mesh_optimizer.h"
+
+#include "EASTL/vector.h"
+#include "EASTL/array.h"
+#include "EASTL/sort.h"
+#include "EASTL/fixed_string.h"
+#include "EAAssert/eaassert.h"
+
+#include <glm/glm.hpp>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+using namespace vk;
+
+bool mesh_optimizer::_verbose = false;
+mesh_optimizer::report mesh_optimizer::_totals {};
+uint32_t mesh_optimizer::_num_recorded = 0;
+
+namespace
+{
+    //note: Forsyth's tuning values, the cache here is a scoring model and is bigger than the fifo we measure with
+    constexpr uint32_t FORSYTH_CACHE_SIZE = 32u;
+    constexpr float CACHE_DECAY_POWER = 1.5f;
+    constexpr float LAST_TRIANGLE_SCORE = 0.75f;
+    constexpr float VALENCE_BOOST_SCALE = 2.0f;
+    constexpr float VALENCE_BOOST_POWER = 0.5f;
+
+    constexpr uint32_t INVALID_INDEX = ~0u;
+
+    float vertex_score(int32_t cache_position, uint32_t remaining_valence)
+    {
+        if(remaining_valence == 0)
+            return -1.0f;
+
+        float score = 0.0f;
+        if(cache_position >= 0)
+        {
+            if(cache_position < 3)
+            {
+                //note: the triangle that was just emitted, a fixed score so they are not favored too much
+                score = LAST_TRIANGLE_SCORE;
+            }
+            else
+            {
+                float scaler = 1.0f / (FORSYTH_CACHE_SIZE - 3);
+                score = powf(1.0f - (cache_position - 3) * scaler, CACHE_DECAY_POWER);
+            }
+        }
+
+        //note: vertices with few triangles left get a boost so that they are finished off and don't leave lone triangles behind
+        score += VALENCE_BOOST_SCALE * powf(static_cast<float>(remaining_valence), -VALENCE_BOOST_POWER);
+        return score;
+    }
+
+    //counts misses the way a fifo cache would, timestamps avoid clearing the cache between clusters
+    struct fifo_cache
+    {
+        eastl::vector<uint32_t> timestamps;
+        uint32_t time = 0;
+        uint32_t size = 0;
+
+        fifo_cache(size_t vertex_count, uint32_t cache_size): timestamps(vertex_count, 0), time(cache_size + 1), size(cache_size) {}
+
+        inline uint32_t add_triangle(const uint32_t* triangle)
+        {
+            uint32_t misses = 0;
+            for( uint32_t k = 0; k < 3; ++k)
+            {
+                uint32_t v = triangle[k];
+                if(time - timestamps[v] > size)
+                {
+                    timestamps[v] = time++;
+                    ++misses;
+                }
+            }
+            return misses;
+        }
+
+        inline void flush()
+        {
+            time += size + 1;
+        }
+    };
+
+    inline glm::vec3 get_position(const void* vertices, size_t vertex_stride, size_t position_offset, uint32_t index)
+    {
+        const float* p = reinterpret_cast<const float*>(static_cast<const uint8_t*>(vertices) + index * vertex_stride + position_offset);
+        return glm::vec3(p[0], p[1], p[2]);
+    }
+}
+
+mesh_optimizer::cache_statistics mesh_optimizer::analyze_vertex_cache(const uint32_t* indices, size_t index_count, size_t vertex_count,
+                                                                     uint32_t cache_size)
+{
+    EA_ASSERT(index_count % 3 == 0);
+
+    cache_statistics result {};
+    if(index_count == 0 || vertex_count == 0)
+        return result;
+
+    fifo_cache cache(vertex_count, cache_size);
+    uint32_t misses = 0;
+    for( size_t i = 0; i < index_count; i += 3)
+    {
+        misses += cache.add_triangle(&indices[i]);
+    }
+
+    result.acmr = static_cast<float>(misses) / static_cast<float>(index_count / 3);
+    result.atvr = static_cast<float>(misses) / static_cast<float>(vertex_count);
+    return result;
+}
+
+void mesh_optimizer::optimize_vertex_cache(uint32_t* indices, size_t index_count, size_t vertex_count)
+{
+    EA_ASSERT(index_count % 3 == 0);
+    size_t triangle_count = index_count / 3;
+    if(triangle_count == 0)
+        return;
+
+    //every vertex keeps a list of the triangles that use it, the first remaining_valence entries haven't been emitted yet
+    eastl::vector<uint32_t> remaining_valence(vertex_count, 0);
+    for( size_t i = 0; i < index_count; ++i)
+    {
+        EA_ASSERT(indices[i] < vertex_count);
+        ++remaining_valence[indices[i]];
+    }
+
+    eastl::vector<uint32_t> adjacency_offsets(vertex_count + 1, 0);
+    for( size_t v = 0; v < vertex_count; ++v)
+    {
+        adjacency_offsets[v + 1] = adjacency_offsets[v] + remaining_valence[v];
+    }
+
+    eastl::vector<uint32_t> adjacency(index_count, 0);
+    {
+        eastl::vector<uint32_t> fill(adjacency_offsets.begin(), adjacency_offsets.end() - 1);
+        for( size_t i = 0; i < index_count; ++i)
+        {
+            adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+        }
+    }
+
+    eastl::vector<int32_t> cache_position(vertex_count, -1);
+    eastl::vector<float> vertex_scores(vertex_count, 0.0f);
+    for( size_t v = 0; v < vertex_count; ++v)
+    {
+        vertex_scores[v] = vertex_score(-1, remaining_valence[v]);
+    }
+
+    eastl::vector<float> triangle_scores(triangle_count, 0.0f);
+    for( size_t t = 0; t < triangle_count; ++t)
+    {
+        triangle_scores[t] = vertex_scores[indices[t * 3 + 0]] + vertex_scores[indices[t * 3 + 1]] + vertex_scores[indices[t * 3 + 2]];
+    }
+
+    eastl::vector<uint8_t> emitted(triangle_count, 0);
+    eastl::vector<uint32_t> result(index_count, 0);
+
+    eastl::array<uint32_t, FORSYTH_CACHE_SIZE + 3> cache {};
+    eastl::array<uint32_t, FORSYTH_CACHE_SIZE + 3> new_cache {};
+    uint32_t cache_count = 0;
+
+    uint32_t best_triangle = 0;
+    for( uint32_t t = 1; t < triangle_count; ++t)
+    {
+        if(triangle_scores[t] > triangle_scores[best_triangle])
+            best_triangle = t;
+    }
+
+    size_t input_cursor = 0;
+    for( size_t output = 0; output < triangle_count; ++output)
+    {
+        if(best_triangle == INVALID_INDEX)
+        {
+            //note: nothing in the cache has triangles left, carry on with the next triangle in input order
+            while(emitted[input_cursor])
+                ++input_cursor;
+            best_triangle = static_cast<uint32_t>(input_cursor);
+        }
+
+        const uint32_t* triangle = &indices[best_triangle * 3];
+        result[output * 3 + 0] = triangle[0];
+        result[output * 3 + 1] = triangle[1];
+        result[output * 3 + 2] = triangle[2];
+        emitted[best_triangle] = 1;
+
+        for( uint32_t k = 0; k < 3; ++k)
+        {
+            uint32_t v = triangle[k];
+            uint32_t* list = &adjacency[adjacency_offsets[v]];
+            uint32_t count = remaining_valence[v];
+            for( uint32_t j = 0; j < count; ++j)
+            {
+                if(list[j] == best_triangle)
+                {
+                    list[j] = list[count - 1];
+                    break;
+                }
+            }
+            --remaining_valence[v];
+        }
+
+        //note: the emitted triangle goes to the front of the cache, everything else is pushed back
+        uint32_t new_cache_count = 0;
+        new_cache[new_cache_count++] = triangle[0];
+        new_cache[new_cache_count++] = triangle[1];
+        new_cache[new_cache_count++] = triangle[2];
+        for( uint32_t i = 0; i < cache_count; ++i)
+        {
+            uint32_t v = cache[i];
+            if(v != triangle[0] && v != triangle[1] && v != triangle[2])
+                new_cache[new_cache_count++] = v;
+        }
+
+        //note: vertices that fell out of the cache still need their score updated
+        for( uint32_t i = 0; i < new_cache_count; ++i)
+        {
+            uint32_t v = new_cache[i];
+            cache_position[v] = i < FORSYTH_CACHE_SIZE ? static_cast<int32_t>(i) : -1;
+
+            float score = vertex_score(cache_position[v], remaining_valence[v]);
+            float delta = score - vertex_scores[v];
+            vertex_scores[v] = score;
+
+            const uint32_t* list = &adjacency[adjacency_offsets[v]];
+            for( uint32_t j = 0; j < remaining_valence[v]; ++j)
+            {
+                triangle_scores[list[j]] += delta;
+            }
+        }
+
+        cache_count = eastl::min(new_cache_count, FORSYTH_CACHE_SIZE);
+        for( uint32_t i = 0; i < cache_count; ++i)
+        {
+            cache[i] = new_cache[i];
+        }
+
+        best_triangle = INVALID_INDEX;
+        float best_score = -FLT_MAX;
+        for( uint32_t i = 0; i < cache_count; ++i)
+        {
+            uint32_t v = cache[i];
+            const uint32_t* list = &adjacency[adjacency_offsets[v]];
+            for( uint32_t j = 0; j < remaining_valence[v]; ++j)
+            {
+                if(triangle_scores[list[j]] > best_score)
+                {
+                    best_score = triangle_scores[list[j]];
+                    best_triangle = list[j];
+                }
+            }
+        }
+    }
+
+    memcpy(indices, result.data(), index_count * sizeof(uint32_t));
+}
+
+void mesh_optimizer::optimize_overdraw(uint32_t* indices, size_t index_count, const void* vertices, size_t vertex_count,
+                                       size_t vertex_stride, size_t position_offset, float threshold)
+{
+    EA_ASSERT(index_count % 3 == 0);
+    uint32_t triangle_count = static_cast<uint32_t>(index_count / 3);
+    if(triangle_count == 0)
+        return;
+
+    cache_statistics input_statistics = analyze_vertex_cache(indices, index_count, vertex_count);
+
+    //note: a triangle that misses all of its vertices is where the cache optimizer started over, those are hard boundaries
+    eastl::vector<uint32_t> hard_clusters;
+    {
+        fifo_cache cache(vertex_count, CACHE_SIZE);
+        for( uint32_t t = 0; t < triangle_count; ++t)
+        {
+            if(cache.add_triangle(&indices[t * 3]) == 3)
+                hard_clusters.push_back(t);
+        }
+    }
+
+    //note: hard clusters are split again wherever starting over with a cold cache keeps the ACMR under the threshold
+    eastl::vector<uint32_t> clusters;
+    {
+        fifo_cache cache(vertex_count, CACHE_SIZE);
+        for( size_t c = 0; c < hard_clusters.size(); ++c)
+        {
+            uint32_t start = hard_clusters[c];
+            uint32_t end = c + 1 < hard_clusters.size() ? hard_clusters[c + 1] : triangle_count;
+
+            cache.flush();
+            uint32_t cluster_misses = 0;
+            for( uint32_t t = start; t < end; ++t)
+            {
+                cluster_misses += cache.add_triangle(&indices[t * 3]);
+            }
+            float cluster_acmr = static_cast<float>(cluster_misses) / static_cast<float>(end - start);
+
+            clusters.push_back(start);
+            cache.flush();
+            uint32_t running_misses = 0;
+            uint32_t running_triangles = 0;
+            for( uint32_t t = start; t < end; ++t)
+            {
+                running_misses += cache.add_triangle(&indices[t * 3]);
+                ++running_triangles;
+
+                if(t + 1 < end && running_misses <= threshold * cluster_acmr * running_triangles)
+                {
+                    clusters.push_back(t + 1);
+                    cache.flush();
+                    running_misses = 0;
+                    running_triangles = 0;
+                }
+            }
+        }
+    }
+
+    //note: area weighted centroid for the mesh and every cluster, clusters facing away from the center are drawn first since
+    //they are the most likely to cover the rest
+    glm::vec3 mesh_centroid = glm::vec3(0.0f);
+    float mesh_area = 0.0f;
+
+    eastl::vector<glm::vec3> cluster_centroids(clusters.size(), glm::vec3(0.0f));
+    eastl::vector<glm::vec3> cluster_normals(clusters.size(), glm::vec3(0.0f));
+    for( size_t c = 0; c < clusters.size(); ++c)
+    {
+        uint32_t start = clusters[c];
+        uint32_t end = c + 1 < clusters.size() ? clusters[c + 1] : triangle_count;
+
+        float cluster_area = 0.0f;
+        for( uint32_t t = start; t < end; ++t)
+        {
+            glm::vec3 a = get_position(vertices, vertex_stride, position_offset, indices[t * 3 + 0]);
+            glm::vec3 b = get_position(vertices, vertex_stride, position_offset, indices[t * 3 + 1]);
+            glm::vec3 d = get_position(vertices, vertex_stride, position_offset, indices[t * 3 + 2]);
+
+            glm::vec3 n = glm::cross(b - a, d - a);
+            float area = glm::length(n);
+            glm::vec3 center = (a + b + d) / 3.0f;
+
+            cluster_centroids[c] += center * area;
+            cluster_normals[c] += n;
+            cluster_area += area;
+        }
+
+        mesh_centroid += cluster_centroids[c];
+        mesh_area += cluster_area;
+        cluster_centroids[c] = cluster_area > 0.0f ? cluster_centroids[c] / cluster_area : glm::vec3(0.0f);
+    }
+    mesh_centroid = mesh_area > 0.0f ? mesh_centroid / mesh_area : glm::vec3(0.0f);
+
+    eastl::vector<float> sort_keys(clusters.size(), 0.0f);
+    eastl::vector<uint32_t> order(clusters.size(), 0);
+    for( size_t c = 0; c < clusters.size(); ++c)
+    {
+        float length = glm::length(cluster_normals[c]);
+        glm::vec3 n = length > 0.0f ? cluster_normals[c] / length : glm::vec3(0.0f);
+        sort_keys[c] = glm::dot(cluster_centroids[c] - mesh_centroid, n);
+        order[c] = static_cast<uint32_t>(c);
+    }
+
+    //note: ties keep their original order, this has to give the same answer every time
+    eastl::stable_sort(order.begin(), order.end(), [&sort_keys](uint32_t a, uint32_t b)
+    {
+        return sort_keys[a] > sort_keys[b];
+    });
+
+    eastl::vector<uint32_t> result;
+    result.reserve(index_count);
+    for( uint32_t c : order)
+    {
+        uint32_t start = clusters[c];
+        uint32_t end = c + 1 < clusters.size() ? clusters[c + 1] : triangle_count;
+        result.insert(result.end(), &indices[start * 3], &indices[end * 3]);
+    }
+
+    cache_statistics output_statistics = analyze_vertex_cache(result.data(), index_count, vertex_count);
+    if(output_statistics.acmr <= input_statistics.acmr * threshold)
+        memcpy(indices, result.data(), index_count * sizeof(uint32_t));
+}
+
+size_t mesh_optimizer::optimize_vertex_fetch(void* vertices, size_t vertex_count, size_t vertex_stride, uint32_t* indices, size_t index_count)
+{
+    eastl::vector<uint32_t> remap(vertex_count, INVALID_INDEX);
+    uint32_t next_vertex = 0;
+    for( size_t i = 0; i < index_count; ++i)
+    {
+        uint32_t& r = remap[indices[i]];
+        if(r == INVALID_INDEX)
+            r = next_vertex++;
+        indices[i] = r;
+    }
+
+    eastl::vector<uint8_t> scratch(static_cast<const uint8_t*>(vertices), static_cast<const uint8_t*>(vertices) + vertex_count * vertex_stride);
+    uint8_t* destination = static_cast<uint8_t*>(vertices);
+    for( size_t v = 0; v < vertex_count; ++v)
+    {
+        if(remap[v] != INVALID_INDEX)
+            memcpy(destination + remap[v] * vertex_stride, scratch.data() + v * vertex_stride, vertex_stride);
+    }
+
+    return next_vertex;
+}
+
+mesh_optimizer::report mesh_optimizer::optimize(void* vertices, size_t vertex_count, size_t vertex_stride, size_t position_offset,
+                                                uint32_t* indices, size_t index_count)
+{
+    report r {};
+    r.triangle_count = static_cast<uint32_t>(index_count / 3);
+    r.vertex_count_before = static_cast<uint32_t>(vertex_count);
+    r.before = analyze_vertex_cache(indices, index_count, vertex_count);
+
+    optimize_vertex_cache(indices, index_count, vertex_count);
+    if(position_offset != NO_POSITION)
+        optimize_overdraw(indices, index_count, vertices, vertex_count, vertex_stride, position_offset);
+    size_t new_vertex_count = optimize_vertex_fetch(vertices, vertex_count, vertex_stride, indices, index_count);
+
+    r.vertex_count_after = static_cast<uint32_t>(new_vertex_count);
+    r.after = analyze_vertex_cache(indices, index_count, new_vertex_count);
+    return r;
+}
+
+void mesh_optimizer::report::print(const char* mesh_name) const
+{
+    eastl::fixed_string<char, 250> msg;
+    msg.sprintf("mesh optimizer %s: %u triangles, %u -> %u vertices, ACMR %.3f -> %.3f, ATVR %.3f -> %.3f", mesh_name, triangle_count,
+                vertex_count_before, vertex_count_after, before.acmr, after.acmr, before.atvr, after.atvr);
+    std::cout << msg.c_str() << std::endl;
+}
+
+void mesh_optimizer::record(const report& r, const char* mesh_name)
+{
+    if(_verbose)
+        r.print(mesh_name);
+
+    //note: the ratios are vertices transformed over triangles and over vertices, they are added up as vertices transformed
+    double transformed_before = double(_totals.before.acmr) * _totals.triangle_count + double(r.before.acmr) * r.triangle_count;
+    double transformed_after = double(_totals.after.acmr) * _totals.triangle_count + double(r.after.acmr) * r.triangle_count;
+
+    _totals.triangle_count += r.triangle_count;
+    _totals.vertex_count_before += r.vertex_count_before;
+    _totals.vertex_count_after += r.vertex_count_after;
+
+    double triangles = eastl::max(_totals.triangle_count, 1u);
+    _totals.before.acmr = static_cast<float>(transformed_before / triangles);
+    _totals.after.acmr = static_cast<float>(transformed_after / triangles);
+    _totals.before.atvr = static_cast<float>(transformed_before / eastl::max(_totals.vertex_count_before, 1u));
+    _totals.after.atvr = static_cast<float>(transformed_after / eastl::max(_totals.vertex_count_after, 1u));
+    ++_num_recorded;
+}
+
+void mesh_optimizer::print_totals()
+{
+    if(_num_recorded == 0)
+        return;
+
+    eastl::fixed_string<char, 32> name;
+    name.sprintf("%u meshes", _num_recorded);
+    _totals.print(name.c_str());
+
+    _totals = report {};
+    _num_recorded = 0;
+}
@@ -0,0 +1,82 @@
+//
+//  mesh_optimizer.h
+//  vulkan-demos
+//
+//  Created by Rafael Sabino on 10/19/26.
+//  Copyright © 2026 Rafael Sabino. All rights reserved.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace vk
+{
+    //note: reorders triangle lists when meshes are imported, in the spirit of meshoptimizer (https://github.com/zeux/meshoptimizer):
+    //
+    //  1. vertex cache:  Forsyth's "Linear-Speed Vertex Cache Optimisation" to reuse post transform vertices
+    //  2. overdraw:      splits the result in clusters that start with a cold cache and sorts them front to back, outward
+    //                    facing first, see Sander et al. "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw"
+    //  3. vertex fetch:  vertices are renumbered in the order the index buffer first uses them, unused vertices are dropped
+    //
+    //every pass is deterministic, the same input always produces the same output.
+    class mesh_optimizer
+    {
+    public:
+
+        //note: size of the fifo used to measure meshes, it is a pessimistic guess of what hardware has
+        static constexpr uint32_t CACHE_SIZE = 16u;
+
+        //how much worse than the cache optimized order the overdraw pass is allowed to make the ACMR
+        static constexpr float OVERDRAW_THRESHOLD = 1.05f;
+
+        struct cache_statistics
+        {
+            float acmr = 0.0f;      //average cache miss ratio, vertices transformed per triangle, 0.5 is ideal
+            float atvr = 0.0f;      //average transformed vertex ratio, vertices transformed per vertex, 1.0 is ideal
+        };
+
+        struct report
+        {
+            cache_statistics before {};
+            cache_statistics after {};
+            uint32_t triangle_count = 0;
+            uint32_t vertex_count_before = 0;
+            uint32_t vertex_count_after = 0;
+
+            void print(const char* mesh_name) const;
+        };
+
+        static cache_statistics analyze_vertex_cache(const uint32_t* indices, size_t index_count, size_t vertex_count,
+                                                     uint32_t cache_size = CACHE_SIZE);
+
+        static void optimize_vertex_cache(uint32_t* indices, size_t index_count, size_t vertex_count);
+
+        //note: expects indices that went through optimize_vertex_cache, positions are 3 floats at the start of every vertex_stride bytes
+        static void optimize_overdraw(uint32_t* indices, size_t index_count, const void* vertices, size_t vertex_count,
+                                      size_t vertex_stride, size_t position_offset, float threshold = OVERDRAW_THRESHOLD);
+
+        //returns how many vertices are left
+        static size_t optimize_vertex_fetch(void* vertices, size_t vertex_count, size_t vertex_stride, uint32_t* indices, size_t index_count);
+
+        //runs all three passes, vertices and indices are modified in place.  Pass position_offset = NO_POSITION to skip the
+        //overdraw pass for vertices without a position
+        static constexpr size_t NO_POSITION = ~size_t(0);
+        static report optimize(void* vertices, size_t vertex_count, size_t vertex_stride, size_t position_offset,
+                               uint32_t* indices, size_t index_count);
+
+        //note: a scene with thousands of meshes would print thousands of lines, reports are added up instead and print_totals
+        //writes them as one line.  Verbose prints the report of every mesh as well, see --mesh-report in main.mm.  Main thread only
+        static void record(const report& r, const char* mesh_name);
+        //note: prints what was recorded since the last call and starts over, nothing if no mesh was recorded
+        static void print_totals();
+        static inline void set_verbose(bool b){ _verbose = b; }
+
+    private:
+
+        static bool _verbose;
+        static report _totals;
+        static uint32_t _num_recorded;
+    };
+}
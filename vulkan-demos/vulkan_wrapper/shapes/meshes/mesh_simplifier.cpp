@@ -0,0 +1,319 @@
+//
+//  mesh_simplifier.cpp
+//  vulkan-demos
+//
+//  Created by Rafael Sabino on 10/19/26.
+//  Copyright © 2026 Rafael Sabino. All rights reserved.
+//
+
+#include "mesh_simplifier.h"
+
+#include "EASTL/sort.h"
+#include "EAAssert/eaassert.h"
+
+#include <glm/glm.hpp>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+using namespace vk;
+
+namespace
+{
+    constexpr uint32_t INVALID_INDEX = ~0u;
+    constexpr uint32_t MAX_GRID_RESOLUTION = 1024u;
+
+    inline glm::vec3 get_position(const void* vertices, size_t vertex_stride, size_t position_offset, uint32_t index)
+    {
+        const float* p = reinterpret_cast<const float*>(static_cast<const uint8_t*>(vertices) + index * vertex_stride + position_offset);
+        return glm::vec3(p[0], p[1], p[2]);
+    }
+
+    inline void set_position(void* vertices, size_t vertex_stride, size_t position_offset, uint32_t index, const glm::vec3& pos)
+    {
+        float* p = reinterpret_cast<float*>(static_cast<uint8_t*>(vertices) + index * vertex_stride + position_offset);
+        p[0] = pos.x;
+        p[1] = pos.y;
+        p[2] = pos.z;
+    }
+
+    //sum of squared distances to a set of planes, Q(x) = x'Ax + 2b'x + c.  Doubles, the planes of tiny triangles add up
+    struct quadric
+    {
+        double a00 = 0.0, a01 = 0.0, a02 = 0.0, a11 = 0.0, a12 = 0.0, a22 = 0.0;
+        double b0 = 0.0, b1 = 0.0, b2 = 0.0;
+
+        inline void add_plane(const glm::dvec3& n, double d, double weight)
+        {
+            a00 += weight * n.x * n.x; a01 += weight * n.x * n.y; a02 += weight * n.x * n.z;
+            a11 += weight * n.y * n.y; a12 += weight * n.y * n.z;
+            a22 += weight * n.z * n.z;
+            b0 += weight * d * n.x; b1 += weight * d * n.y; b2 += weight * d * n.z;
+        }
+
+        //note: only trusts the solution when the planes pin a point down, flat or creased clusters return false
+        inline bool solve(glm::dvec3& x) const
+        {
+            double c00 = a11 * a22 - a12 * a12;
+            double c01 = a02 * a12 - a01 * a22;
+            double c02 = a01 * a12 - a02 * a11;
+            double det = a00 * c00 + a01 * c01 + a02 * c02;
+
+            double trace = a00 + a11 + a22;
+            if(trace <= 0.0 || std::abs(det) < 1e-3 * trace * trace * trace)
+                return false;
+
+            double c11 = a00 * a22 - a02 * a02;
+            double c12 = a01 * a02 - a00 * a12;
+            double c22 = a00 * a11 - a01 * a01;
+
+            double inv = 1.0 / det;
+            x.x = -(c00 * b0 + c01 * b1 + c02 * b2) * inv;
+            x.y = -(c01 * b0 + c11 * b1 + c12 * b2) * inv;
+            x.z = -(c02 * b0 + c12 * b1 + c22 * b2) * inv;
+            return true;
+        }
+    };
+
+    struct cluster_entry
+    {
+        uint64_t key = 0;
+        uint32_t vertex = 0;
+    };
+}
+
+float mesh_simplifier::simplify_clustered(void* vertices, size_t vertex_count, size_t vertex_stride, size_t position_offset,
+                                          eastl::vector<uint32_t>& indices, uint32_t grid_resolution)
+{
+    EA_ASSERT(indices.size() % 3 == 0);
+    EA_ASSERT(grid_resolution != 0);
+    if(indices.empty())
+        return 0.0f;
+
+    //note: only the vertices the triangles use count towards the bounds
+    eastl::vector<uint8_t> used(vertex_count, 0);
+    glm::vec3 min_corner = glm::vec3(FLT_MAX);
+    glm::vec3 max_corner = glm::vec3(-FLT_MAX);
+    for( uint32_t index : indices)
+    {
+        EA_ASSERT(index < vertex_count);
+        if(used[index])
+            continue;
+        used[index] = 1;
+
+        glm::vec3 p = get_position(vertices, vertex_stride, position_offset, index);
+        min_corner = glm::min(min_corner, p);
+        max_corner = glm::max(max_corner, p);
+    }
+
+    glm::vec3 extents = max_corner - min_corner;
+    float longest = glm::max(glm::max(extents.x, extents.y), glm::max(extents.z, FLT_MIN));
+    float cell_size = longest / static_cast<float>(grid_resolution);
+
+    glm::uvec3 dims = glm::max(glm::uvec3(glm::ceil(extents / cell_size)), glm::uvec3(1u));
+
+    eastl::vector<cluster_entry> entries;
+    for( uint32_t v = 0; v < vertex_count; ++v)
+    {
+        if(!used[v])
+            continue;
+
+        glm::vec3 p = get_position(vertices, vertex_stride, position_offset, v);
+        glm::uvec3 cell = glm::min(glm::uvec3((p - min_corner) / cell_size), dims - 1u);
+
+        cluster_entry e {};
+        e.key = cell.x + uint64_t(dims.x) * (cell.y + uint64_t(dims.y) * cell.z);
+        e.vertex = v;
+        entries.push_back(e);
+    }
+
+    //note: the lowest vertex index of a cluster represents it, this keeps the output independent of the sort implementation
+    eastl::sort(entries.begin(), entries.end(), [](const cluster_entry& a, const cluster_entry& b)
+    {
+        return a.key != b.key ? a.key < b.key : a.vertex < b.vertex;
+    });
+
+    eastl::vector<uint32_t> cluster_of(vertex_count, INVALID_INDEX);
+    eastl::vector<uint32_t> representatives;
+    for( size_t i = 0; i < entries.size(); ++i)
+    {
+        if(i == 0 || entries[i].key != entries[i - 1].key)
+            representatives.push_back(entries[i].vertex);
+        cluster_of[entries[i].vertex] = static_cast<uint32_t>(representatives.size() - 1);
+    }
+
+    eastl::vector<quadric> quadrics(representatives.size());
+    eastl::vector<glm::dvec3> centroids(representatives.size(), glm::dvec3(0.0));
+    eastl::vector<uint32_t> cluster_sizes(representatives.size(), 0);
+
+    for( const cluster_entry& e : entries)
+    {
+        centroids[cluster_of[e.vertex]] += glm::dvec3(get_position(vertices, vertex_stride, position_offset, e.vertex));
+        ++cluster_sizes[cluster_of[e.vertex]];
+    }
+
+    for( size_t t = 0; t < indices.size(); t += 3)
+    {
+        glm::dvec3 a = glm::dvec3(get_position(vertices, vertex_stride, position_offset, indices[t + 0]));
+        glm::dvec3 b = glm::dvec3(get_position(vertices, vertex_stride, position_offset, indices[t + 1]));
+        glm::dvec3 c = glm::dvec3(get_position(vertices, vertex_stride, position_offset, indices[t + 2]));
+
+        glm::dvec3 n = glm::cross(b - a, c - a);
+        double area = glm::length(n);
+        if(area <= 0.0)
+            continue;
+        n /= area;
+
+        double d = -glm::dot(n, a);
+        uint32_t c0 = cluster_of[indices[t + 0]];
+        uint32_t c1 = cluster_of[indices[t + 1]];
+        uint32_t c2 = cluster_of[indices[t + 2]];
+
+        quadrics[c0].add_plane(n, d, area);
+        if(c1 != c0)
+            quadrics[c1].add_plane(n, d, area);
+        if(c2 != c0 && c2 != c1)
+            quadrics[c2].add_plane(n, d, area);
+    }
+
+    //note: the optimal point is thrown out when it lands outside of its cell (plus half a cell), the average is safer there
+    eastl::vector<glm::vec3> cluster_positions(representatives.size());
+    for( size_t c = 0; c < representatives.size(); ++c)
+    {
+        glm::dvec3 mean = centroids[c] / static_cast<double>(cluster_sizes[c]);
+        glm::vec3 cell_center = min_corner + (glm::floor((glm::vec3(mean) - min_corner) / cell_size) + 0.5f) * cell_size;
+
+        glm::dvec3 optimal {};
+        if(quadrics[c].solve(optimal) && glm::all(glm::lessThanEqual(glm::abs(glm::vec3(optimal) - cell_center), glm::vec3(cell_size))))
+            cluster_positions[c] = glm::vec3(optimal);
+        else
+            cluster_positions[c] = glm::vec3(mean);
+    }
+
+    float error = 0.0f;
+    for( const cluster_entry& e : entries)
+    {
+        glm::vec3 p = get_position(vertices, vertex_stride, position_offset, e.vertex);
+        error = glm::max(error, glm::length(p - cluster_positions[cluster_of[e.vertex]]));
+    }
+
+    for( size_t c = 0; c < representatives.size(); ++c)
+    {
+        set_position(vertices, vertex_stride, position_offset, representatives[c], cluster_positions[c]);
+    }
+
+    //triangles that collapsed are dropped, so are copies of a triangle that is already in the list
+    struct triangle_key
+    {
+        uint32_t v[3];
+        uint32_t order;
+    };
+
+    eastl::vector<triangle_key> triangles;
+    for( size_t t = 0; t < indices.size(); t += 3)
+    {
+        uint32_t r0 = representatives[cluster_of[indices[t + 0]]];
+        uint32_t r1 = representatives[cluster_of[indices[t + 1]]];
+        uint32_t r2 = representatives[cluster_of[indices[t + 2]]];
+        if(r0 == r1 || r1 == r2 || r0 == r2)
+            continue;
+
+        //note: rotated so the lowest index comes first, the winding stays the same
+        triangle_key k {};
+        if(r0 < r1 && r0 < r2)      { k.v[0] = r0; k.v[1] = r1; k.v[2] = r2; }
+        else if(r1 < r2)            { k.v[0] = r1; k.v[1] = r2; k.v[2] = r0; }
+        else                        { k.v[0] = r2; k.v[1] = r0; k.v[2] = r1; }
+        k.order = static_cast<uint32_t>(t / 3);
+        triangles.push_back(k);
+    }
+
+    eastl::sort(triangles.begin(), triangles.end(), [](const triangle_key& a, const triangle_key& b)
+    {
+        if(a.v[0] != b.v[0]) return a.v[0] < b.v[0];
+        if(a.v[1] != b.v[1]) return a.v[1] < b.v[1];
+        if(a.v[2] != b.v[2]) return a.v[2] < b.v[2];
+        return a.order < b.order;
+    });
+
+    eastl::vector<triangle_key> unique_triangles;
+    for( size_t i = 0; i < triangles.size(); ++i)
+    {
+        const triangle_key& k = triangles[i];
+        if(i != 0 && memcmp(k.v, triangles[i - 1].v, sizeof(k.v)) == 0)
+            continue;
+        unique_triangles.push_back(k);
+    }
+
+    eastl::sort(unique_triangles.begin(), unique_triangles.end(), [](const triangle_key& a, const triangle_key& b)
+    {
+        return a.order < b.order;
+    });
+
+    indices.clear();
+    for( const triangle_key& k : unique_triangles)
+    {
+        indices.push_back(k.v[0]);
+        indices.push_back(k.v[1]);
+        indices.push_back(k.v[2]);
+    }
+
+    return error;
+}
+
+mesh_simplifier::result mesh_simplifier::simplify(void* vertices, size_t vertex_count, size_t vertex_stride, size_t position_offset,
+                                                  eastl::vector<uint32_t>& indices, size_t target_index_count)
+{
+    result r {};
+    if(indices.size() <= target_index_count)
+        return r;
+
+    //note: finer grids keep more triangles, look for the finest grid that gets under the target.  Every try works on a copy
+    const uint8_t* source = static_cast<const uint8_t*>(vertices);
+    eastl::vector<uint8_t> scratch_vertices;
+    eastl::vector<uint32_t> scratch_indices;
+
+    uint32_t low = 1u;
+    uint32_t high = MAX_GRID_RESOLUTION;
+    uint32_t best = 1u;
+    while(low <= high)
+    {
+        uint32_t resolution = (low + high) / 2u;
+
+        scratch_vertices.assign(source, source + vertex_count * vertex_stride);
+        scratch_indices = indices;
+        simplify_clustered(scratch_vertices.data(), vertex_count, vertex_stride, position_offset, scratch_indices, resolution);
+
+        if(scratch_indices.size() <= target_index_count)
+        {
+            best = resolution;
+            low = resolution + 1u;
+        }
+        else
+        {
+            high = resolution - 1u;
+        }
+    }
+
+    r.grid_resolution = best;
+    r.error = simplify_clustered(vertices, vertex_count, vertex_stride, position_offset, indices, best);
+    return r;
+}
+
+float mesh_simplifier::estimate_error(const void* vertices, size_t vertex_stride, size_t position_offset,
+                                      const uint32_t* indices, size_t index_count)
+{
+    EA_ASSERT(index_count % 3 == 0);
+    if(index_count == 0)
+        return 0.0f;
+
+    double total = 0.0;
+    for( size_t t = 0; t < index_count; t += 3)
+    {
+        glm::vec3 a = get_position(vertices, vertex_stride, position_offset, indices[t + 0]);
+        glm::vec3 b = get_position(vertices, vertex_stride, position_offset, indices[t + 1]);
+        glm::vec3 c = get_position(vertices, vertex_stride, position_offset, indices[t + 2]);
+        total += glm::length(b - a) + glm::length(c - b) + glm::length(a - c);
+    }
+
+    return static_cast<float>(0.5 * total / static_cast<double>(index_count));
+}
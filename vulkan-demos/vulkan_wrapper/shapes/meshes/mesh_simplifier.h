@@ -0,0 +1,49 @@
+//
+//  mesh_simplifier.h
+//  vulkan-demos
+//
+//  Created by Rafael Sabino on 10/19/26.
+//  Copyright © 2026 Rafael Sabino. All rights reserved.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include "EASTL/vector.h"
+
+namespace vk
+{
+    //note: builds coarser levels of detail for meshes that don't ship with them.  Vertices are clustered in a grid and every
+    //cluster collapses to the point that minimizes the sum of squared distances to the planes of its triangles, see Lindstrom
+    //"Out-of-Core Simplification of Large Polygonal Models" (2000).  It runs in linear time and it is deterministic.
+    //
+    //the error reported with each level is the farthest any vertex moved, in the units of the positions.  It is what lod_view
+    //projects to the screen to pick a level.
+    class mesh_simplifier
+    {
+    public:
+
+        struct result
+        {
+            float       error = 0.0f;
+            uint32_t    grid_resolution = 0;
+        };
+
+        //collapses clusters of a grid with grid_resolution cells along the longest axis of the bounds.  The representative of a
+        //cluster is moved in place, indices are rewritten and triangles that collapsed are removed.  Vertices that are no longer
+        //referenced are left behind, mesh_optimizer::optimize_vertex_fetch drops them
+        static float simplify_clustered(void* vertices, size_t vertex_count, size_t vertex_stride, size_t position_offset,
+                                        eastl::vector<uint32_t>& indices, uint32_t grid_resolution);
+
+        //picks a grid resolution that leaves roughly target_index_count indices and simplifies with it
+        static result simplify(void* vertices, size_t vertex_count, size_t vertex_stride, size_t position_offset,
+                               eastl::vector<uint32_t>& indices, size_t target_index_count);
+
+        //note: for levels that were authored offline there is nothing to measure against, half of the average edge length is
+        //used as their error
+        static float estimate_error(const void* vertices, size_t vertex_stride, size_t position_offset,
+                                    const uint32_t* indices, size_t index_count);
+    };
+}
@@ -0,0 +1,269 @@
+//
+//  packed_vertex.h
+//  vulkan-demos
+//
+//  Created by Rafael Sabino on 10/19/26.
+//  Copyright © 2026 Rafael Sabino. All rights reserved.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include "vertex.h"
+#include "bounds.h"
+
+#include "EASTL/array.h"
+#include "EASTL/fixed_vector.h"
+#include "EAAssert/eaassert.h"
+
+#include <glm/gtc/packing.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace vk
+{
+    //note: FLOAT32 is vk::vertex, 72 bytes.  PACKED is vk::packed_vertex, 24 bytes.  Shaders that need to know which one they
+    //are reading declare a specialization constant with id VERTEX_FORMAT_CONSTANT_ID, graphics_pipeline fills it in.
+    enum class vertex_format : uint32_t
+    {
+        FLOAT32 = 0,
+        PACKED = 1
+    };
+
+    static constexpr uint32_t VERTEX_FORMAT_CONSTANT_ID = 0;
+
+    struct vertex_input_description
+    {
+        VkVertexInputBindingDescription binding {};
+        eastl::fixed_vector<VkVertexInputAttributeDescription, 6, false> attributes {};
+    };
+
+    //  position:  snorm16 x3 relative to the mesh bounds, w holds the sign of the bitangent
+    //  color:     unorm8 x4
+    //  uv:        half x2
+    //  normal:    octahedral snorm16 x2
+    //  tangent:   octahedral snorm16 x2
+    //
+    //the bitangent is rebuilt in the shader as sign * cross(normal, tangent)
+    class packed_vertex
+    {
+    public:
+
+        //note: positions are quantized inside of a cube around the mesh bounds, the scale is the same in every axis so that
+        //dequantizing can be folded into the model matrix without bending normals
+        struct quantization
+        {
+            glm::vec3 center = glm::vec3(0.0f);
+            float     scale = 1.0f;
+
+            inline glm::mat4 get_matrix() const
+            {
+                return glm::scale(glm::translate(glm::mat4(1.0f), center), glm::vec3(scale));
+            }
+
+            static inline quantization from_bounds(const aabb& bounds)
+            {
+                EA_ASSERT(bounds.is_valid());
+                glm::vec3 extents = bounds.get_extents();
+
+                quantization q {};
+                q.center = bounds.get_center();
+                q.scale = glm::max(glm::max(extents.x, extents.y), glm::max(extents.z, FLT_MIN));
+                return q;
+            }
+        };
+
+        int16_t     _pos[4];
+        uint32_t    _color;
+        uint32_t    _uv_coord;
+        uint32_t    _normal;
+        uint32_t    _tangent;
+
+        static inline packed_vertex pack(const vertex& v, const quantization& q)
+        {
+            glm::vec3 p = glm::clamp((v._pos - q.center) / q.scale, glm::vec3(-1.0f), glm::vec3(1.0f));
+
+            packed_vertex result {};
+            result._pos[0] = static_cast<int16_t>(glm::packSnorm1x16(p.x));
+            result._pos[1] = static_cast<int16_t>(glm::packSnorm1x16(p.y));
+            result._pos[2] = static_cast<int16_t>(glm::packSnorm1x16(p.z));
+            result._pos[3] = static_cast<int16_t>(glm::packSnorm1x16(get_handedness(v._normal, v._tangent, v._bitangent)));
+            result._color = glm::packUnorm4x8(v._color);
+            result._uv_coord = glm::packHalf2x16(v._uv_coord);
+            result._normal = glm::packSnorm2x16(octahedral_encode(v._normal));
+            result._tangent = glm::packSnorm2x16(octahedral_encode(v._tangent));
+            return result;
+        }
+
+        //note: these decode the same way the gpu does, they are here for error checks
+        inline glm::vec3 get_position(const quantization& q) const
+        {
+            glm::vec3 p = glm::vec3(glm::unpackSnorm1x16(static_cast<uint16_t>(_pos[0])),
+                                    glm::unpackSnorm1x16(static_cast<uint16_t>(_pos[1])),
+                                    glm::unpackSnorm1x16(static_cast<uint16_t>(_pos[2])));
+            return p * q.scale + q.center;
+        }
+        inline float get_handedness() const { return glm::unpackSnorm1x16(static_cast<uint16_t>(_pos[3])); }
+        inline glm::vec4 get_color() const { return glm::unpackUnorm4x8(_color); }
+        inline glm::vec2 get_uv_coord() const { return glm::unpackHalf2x16(_uv_coord); }
+        inline glm::vec3 get_normal() const { return octahedral_decode(glm::unpackSnorm2x16(_normal)); }
+        inline glm::vec3 get_tangent() const { return octahedral_decode(glm::unpackSnorm2x16(_tangent)); }
+
+        //see "A Survey of Efficient Representations for Independent Unit Vectors", Cigolle et al. 2014.  Zero vectors (meshes
+        //without tangents) come back as +z
+        static inline glm::vec2 octahedral_encode(glm::vec3 n)
+        {
+            float l1 = glm::abs(n.x) + glm::abs(n.y) + glm::abs(n.z);
+            if(l1 < FLT_EPSILON)
+                return glm::vec2(0.0f);
+
+            n /= l1;
+            glm::vec2 e = glm::vec2(n.x, n.y);
+            if(n.z < 0.0f)
+            {
+                glm::vec2 sign_not_zero = glm::vec2(e.x >= 0.0f ? 1.0f : -1.0f, e.y >= 0.0f ? 1.0f : -1.0f);
+                e = (glm::vec2(1.0f) - glm::abs(glm::vec2(e.y, e.x))) * sign_not_zero;
+            }
+            return e;
+        }
+
+        //note: must match octahedral_decode in the vertex shaders
+        static inline glm::vec3 octahedral_decode(glm::vec2 e)
+        {
+            glm::vec3 n = glm::vec3(e.x, e.y, 1.0f - glm::abs(e.x) - glm::abs(e.y));
+            float t = glm::max(-n.z, 0.0f);
+            n.x += n.x >= 0.0f ? -t : t;
+            n.y += n.y >= 0.0f ? -t : t;
+            return glm::normalize(n);
+        }
+
+        //1 for a right handed tangent frame, -1 when the uvs are mirrored
+        static inline float get_handedness(const glm::vec3& normal, const glm::vec3& tangent, const glm::vec3& bitangent)
+        {
+            return glm::dot(glm::cross(normal, tangent), bitangent) < 0.0f ? -1.0f : 1.0f;
+        }
+
+        static VkVertexInputBindingDescription get_binding_description()
+        {
+            VkVertexInputBindingDescription vertex_input_binding_description;
+            vertex_input_binding_description.binding = 0;
+            vertex_input_binding_description.stride = sizeof(packed_vertex);
+            vertex_input_binding_description.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+            return vertex_input_binding_description;
+        }
+
+        //note: same locations as vk::vertex, location 5 has no data of its own and aliases the tangent
+        static eastl::array<VkVertexInputAttributeDescription, 6> get_attribute_descriptions()
+        {
+            eastl::array<VkVertexInputAttributeDescription, 6> vertex_input_attributes_description {};
+
+            vertex_input_attributes_description[0].location = 0;
+            vertex_input_attributes_description[0].binding = 0;
+            vertex_input_attributes_description[0].format = VK_FORMAT_R16G16B16A16_SNORM;
+            vertex_input_attributes_description[0].offset = offsetof(packed_vertex, _pos);
+
+            vertex_input_attributes_description[1].location = 1;
+            vertex_input_attributes_description[1].binding = 0;
+            vertex_input_attributes_description[1].format = VK_FORMAT_R8G8B8A8_UNORM;
+            vertex_input_attributes_description[1].offset = offsetof(packed_vertex, _color);
+
+            vertex_input_attributes_description[2].location = 2;
+            vertex_input_attributes_description[2].binding = 0;
+            vertex_input_attributes_description[2].format = VK_FORMAT_R16G16_SFLOAT;
+            vertex_input_attributes_description[2].offset = offsetof(packed_vertex, _uv_coord);
+
+            vertex_input_attributes_description[3].location = 3;
+            vertex_input_attributes_description[3].binding = 0;
+            vertex_input_attributes_description[3].format = VK_FORMAT_R16G16_SNORM;
+            vertex_input_attributes_description[3].offset = offsetof(packed_vertex, _normal);
+
+            vertex_input_attributes_description[4].location = 4;
+            vertex_input_attributes_description[4].binding = 0;
+            vertex_input_attributes_description[4].format = VK_FORMAT_R16G16_SNORM;
+            vertex_input_attributes_description[4].offset = offsetof(packed_vertex, _tangent);
+
+            vertex_input_attributes_description[5].location = 5;
+            vertex_input_attributes_description[5].binding = 0;
+            vertex_input_attributes_description[5].format = VK_FORMAT_R16G16_SNORM;
+            vertex_input_attributes_description[5].offset = offsetof(packed_vertex, _tangent);
+
+            return vertex_input_attributes_description;
+        }
+    };
+
+    static_assert(sizeof(packed_vertex) == 24, "packed_vertex must match the attribute descriptions");
+
+    inline vertex_input_description get_vertex_input_description(vertex_format format)
+    {
+        vertex_input_description description {};
+
+        if(format == vertex_format::PACKED)
+        {
+            description.binding = packed_vertex::get_binding_description();
+            for( const VkVertexInputAttributeDescription& attribute : packed_vertex::get_attribute_descriptions())
+                description.attributes.push_back(attribute);
+        }
+        else
+        {
+            description.binding = vertex::get_binding_description();
+            for( const VkVertexInputAttributeDescription& attribute : vertex::get_attribute_descriptions())
+                description.attributes.push_back(attribute);
+        }
+
+        return description;
+    }
+
+    //largest difference between a mesh and its packed copy.  Position error is in units of the quantization step, normal and
+    //tangent errors are angles in radians, uv error is relative to the size of the uv.
+    struct quantization_error
+    {
+        static constexpr float MAX_POSITION_STEPS = 0.87f;      //sqrt(3) * half a step
+        static constexpr float MAX_DIRECTION_ERROR = 0.001f;
+        static constexpr float MAX_UV_ERROR = 1.0f / 1024.0f;    //half has an 11 bit significand
+        static constexpr float MAX_COLOR_ERROR = 0.5f / 255.0f;
+
+        float position = 0.0f;
+        float normal = 0.0f;
+        float tangent = 0.0f;
+        float uv = 0.0f;
+        float color = 0.0f;
+        uint32_t handedness_flips = 0;
+
+        inline void accumulate(const vertex& original, const packed_vertex& packed, const packed_vertex::quantization& q)
+        {
+            float step = q.scale / 32767.0f;
+            position = glm::max(position, glm::length(packed.get_position(q) - original._pos) / step);
+            normal = glm::max(normal, angle(original._normal, packed.get_normal()));
+            if(glm::length(original._tangent) > FLT_EPSILON)
+                tangent = glm::max(tangent, angle(original._tangent, packed.get_tangent()));
+
+            glm::vec2 uv_error = glm::abs(packed.get_uv_coord() - original._uv_coord) / glm::max(glm::abs(original._uv_coord), glm::vec2(1.0f));
+            uv = glm::max(uv, glm::max(uv_error.x, uv_error.y));
+
+            glm::vec4 color_error = glm::abs(packed.get_color() - glm::clamp(original._color, glm::vec4(0.0f), glm::vec4(1.0f)));
+            color = glm::max(color, glm::max(glm::max(color_error.x, color_error.y), glm::max(color_error.z, color_error.w)));
+
+            if(packed.get_handedness() != packed_vertex::get_handedness(original._normal, original._tangent, original._bitangent))
+                ++handedness_flips;
+        }
+
+        inline bool is_within_bounds() const
+        {
+            //note: a little slack on top of the rounding error for float math in the decode
+            return position <= MAX_POSITION_STEPS * 1.01f && normal <= MAX_DIRECTION_ERROR && tangent <= MAX_DIRECTION_ERROR &&
+                   uv <= MAX_UV_ERROR && color <= MAX_COLOR_ERROR * 1.01f && handedness_flips == 0;
+        }
+
+    private:
+
+        static inline float angle(const glm::vec3& a, const glm::vec3& b)
+        {
+            float la = glm::length(a);
+            if(la < FLT_EPSILON)
+                return 0.0f;
+            return glm::acos(glm::clamp(glm::dot(a / la, glm::normalize(b)), -1.0f, 1.0f));
+        }
+    };
+}
@@ -14,7 +14,9 @@
 
 #include "mesh.h"
 #include "../core/object.h"
+#include "../core/arena.h"
 #include "transform.h"
+#include "instance_pool.h"
 #include <limits>
 
 
@@ -59,10 +61,12 @@ namespace vk {
             _meshes[mesh_id]->bind_verteces(buffer);
         }
         
-        inline void draw_indexed(VkCommandBuffer& buffer, uint32_t mesh_id, uint32_t instance_count)
+        //note: draws every instance of this shape, see set_instances.  With offset_instances false gl_InstanceIndex starts at
+        //0 and the shader adds the first instance itself, see device::has_draw_indirect_first_instance
+        inline void draw_indexed(VkCommandBuffer& buffer, uint32_t mesh_id, bool offset_instances = true)
         {
             assert(_meshes.size() > mesh_id);
-            _meshes[mesh_id]->draw_indexed(buffer, instance_count);
+            _meshes[mesh_id]->draw_indexed(buffer, _instances.instance_count, offset_instances ? _instances.first_instance : 0);
         }
         
         inline void draw(VkCommandBuffer& buffer, uint32_t mesh_id)
@@ -71,6 +75,63 @@ namespace vk {
             _meshes[mesh_id]->draw(buffer);
         }
         
+        inline const aabb& get_bounds(uint32_t mesh_id)
+        {
+            assert(_meshes.size() > mesh_id);
+            return _meshes[mesh_id]->get_bounds();
+        }
+        
+        inline uint32_t get_index_count(uint32_t mesh_id)
+        {
+            assert(_meshes.size() > mesh_id);
+            return _meshes[mesh_id]->get_index_count();
+        }
+        
+        inline uint32_t get_geometry_block(uint32_t mesh_id)
+        {
+            assert(_meshes.size() > mesh_id);
+            return _meshes[mesh_id]->get_geometry_block();
+        }
+        
+        inline uint32_t get_first_index(uint32_t mesh_id)
+        {
+            assert(_meshes.size() > mesh_id);
+            return _meshes[mesh_id]->get_first_index();
+        }
+        
+        inline int32_t get_vertex_offset(uint32_t mesh_id)
+        {
+            assert(_meshes.size() > mesh_id);
+            return _meshes[mesh_id]->get_vertex_offset();
+        }
+        
+        //note: every mesh in a shape has the same vertex format, a subpass picks its vertex input from the shapes it draws
+        inline vertex_format get_vertex_format()
+        {
+            EA_ASSERT_MSG(!_meshes.empty(), "the shape has not been created yet");
+            for( mesh* m : _meshes)
+            {
+                EA_ASSERT_MSG(m->get_vertex_format() == _meshes[0]->get_vertex_format(), "all meshes in a shape must have the same vertex format");
+            }
+            return _meshes[0]->get_vertex_format();
+        }
+        
+        //note: packed meshes fold this into their model matrix, see packed_vertex::quantization
+        inline glm::mat4 get_dequantization_matrix()
+        {
+            EA_ASSERT_MSG(_meshes.size() == 1 || get_vertex_format() == vertex_format::FLOAT32,
+                          "packed shapes must have a single mesh, there is one model matrix per shape");
+            return _meshes.empty() ? glm::mat4(1.0f) : _meshes[0]->get_dequantization_matrix();
+        }
+        
+        //note: the range of the device instance pool this shape is drawn with, shapes that are not instanced draw once
+        inline void set_instances(const instance_pool::range& instances)
+        {
+            _instances = instances;
+        }
+        
+        inline const instance_pool::range& get_instances(){ return _instances; }
+        
         inline size_t get_num_meshes(){ return _meshes.size(); }
         static const eastl::fixed_string<char, 250> _shape_resource_path;
         
@@ -86,9 +147,11 @@ namespace vk {
     protected:
         
         glm::vec3 _diffuse = glm::vec3(1.0f);
-        eastl::fixed_vector<mesh*, 20> _meshes;
+        //note: models with more meshes than this grow into the persistent arena
+        eastl::fixed_vector<mesh*, 20, true, arena_allocator> _meshes;
         device* _device = nullptr;
         uint32_t _id = std::numeric_limits<uint32_t>::max();
+        instance_pool::range _instances {};
         eastl::fixed_string<char, 250> _path = {};
     };
 }
@@ -0,0 +1,191 @@
+//
+//  transform_hierarchy.cpp
+//  vulkan-demos
+//
+//  Created by Rafael Sabino on 10/19/26.
+//  Copyright © 2026 Rafael Sabino. All rights reserved.
+//
+
+#include "transform_hierarchy.h"
+#include "EASTL/algorithm.h"
+
+#if defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define TRANSFORM_HIERARCHY_SSE 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define TRANSFORM_HIERARCHY_NEON 1
+#endif
+
+using namespace vk;
+
+uint32_t transform_hierarchy::add(const transform& local, int32_t parent)
+{
+    uint32_t id = get_num_nodes();
+    EA_ASSERT_MSG(parent < static_cast<int32_t>(id), "parents have to be added before their children");
+
+    _positions.push_back(local.position);
+    _rotations.push_back(local.rotation);
+    _scales.push_back(local.scale);
+    _parents.push_back(parent);
+    _locals.push_back(glm::mat4(1.0f));
+    _worlds.push_back(glm::mat4(1.0f));
+    _dirty.push_back(LOCAL_DIRTY | WORLD_DIRTY);
+    _any_dirty = true;
+
+    return id;
+}
+
+void transform_hierarchy::set_local(uint32_t id, const transform& local)
+{
+    EA_ASSERT(id < get_num_nodes());
+    _positions[id] = local.position;
+    _rotations[id] = local.rotation;
+    _scales[id] = local.scale;
+    _dirty[id] = LOCAL_DIRTY | WORLD_DIRTY;
+    _any_dirty = true;
+}
+
+void transform_hierarchy::set_parent(uint32_t id, int32_t parent)
+{
+    EA_ASSERT(id < get_num_nodes());
+    EA_ASSERT_MSG(parent < static_cast<int32_t>(id), "parents have to come before their children");
+    _parents[id] = parent;
+    _dirty[id] |= WORLD_DIRTY;
+    _any_dirty = true;
+}
+
+//note: same matrix as translate * mat4_cast(quat(rotation)) * scale in transform::update_transform_matrix, without the two full
+//matrix products.  Scaling the columns and writing the translation gives the same bits
+void transform_hierarchy::update_local(uint32_t id)
+{
+    glm::mat4& local = _locals[id];
+    local = glm::mat4_cast(glm::quat(_rotations[id]));
+    local[0] *= _scales[id].x;
+    local[1] *= _scales[id].y;
+    local[2] *= _scales[id].z;
+    local[3] = glm::vec4(_positions[id], 1.0f);
+}
+
+void transform_hierarchy::update()
+{
+    if(!_any_dirty)
+        return;
+
+    update_worlds(true);
+}
+
+uint32_t transform_hierarchy::add_update_jobs(job_system& jobs, uint32_t after)
+{
+    if(!_any_dirty)
+        return after;
+
+    //note: every range writes the local matrices of its own nodes and nothing else
+    uint32_t locals = jobs.add_range("transform locals", get_num_nodes(), LOCALS_PER_JOB, [this](uint32_t first, uint32_t last)
+    {
+        for( uint32_t i = first; i < last; ++i)
+        {
+            if(_dirty[i] & LOCAL_DIRTY)
+                update_local(i);
+        }
+    }, after);
+
+    uint32_t worlds = jobs.add("transform worlds", [this](){ update_worlds(false); });
+    jobs.depend(worlds, locals);
+    return worlds;
+}
+
+void transform_hierarchy::update_worlds(bool locals)
+{
+    uint32_t num_nodes = get_num_nodes();
+    for( uint32_t i = 0; i < num_nodes; ++i)
+    {
+        int32_t parent = _parents[i];
+        uint8_t& dirty = _dirty[i];
+
+        //note: parents come first, their flags are final by the time their children are visited
+        if(parent != NO_PARENT && (_dirty[parent] & WORLD_DIRTY))
+            dirty |= WORLD_DIRTY;
+
+        if(dirty == 0)
+            continue;
+
+        if(locals && (dirty & LOCAL_DIRTY))
+            update_local(i);
+
+        if(parent == NO_PARENT)
+            _worlds[i] = _locals[i];
+        else
+            multiply(_worlds[parent], _locals[i], _worlds[i]);
+    }
+
+    //note: flags are cleared once everything is visited, children read the flags of their parents above
+    eastl::fill(_dirty.begin(), _dirty.end(), uint8_t(0));
+    _any_dirty = false;
+}
+
+void transform_hierarchy::update_reference(eastl::vector<glm::mat4>& worlds) const
+{
+    uint32_t num_nodes = get_num_nodes();
+    worlds.resize(num_nodes);
+
+    transform local {};
+    for( uint32_t i = 0; i < num_nodes; ++i)
+    {
+        local.position = _positions[i];
+        local.rotation = _rotations[i];
+        local.scale = _scales[i];
+        local.update_transform_matrix();
+
+        worlds[i] = _parents[i] == NO_PARENT ? local.get_transform_matrix() : worlds[_parents[i]] * local.get_transform_matrix();
+    }
+}
+
+void transform_hierarchy::clear()
+{
+    _positions.clear();
+    _rotations.clear();
+    _scales.clear();
+    _parents.clear();
+    _locals.clear();
+    _worlds.clear();
+    _dirty.clear();
+    _any_dirty = false;
+}
+
+//note: glm matrices are column major, column j of a * b is the columns of a weighted by column j of b.  The sums are done in the
+//same order glm does them.  glm does not ask for 16 byte alignment, hence the unaligned loads
+void transform_hierarchy::multiply(const glm::mat4& a, const glm::mat4& b, glm::mat4& out)
+{
+#if TRANSFORM_HIERARCHY_SSE
+    __m128 a0 = _mm_loadu_ps(&a[0][0]);
+    __m128 a1 = _mm_loadu_ps(&a[1][0]);
+    __m128 a2 = _mm_loadu_ps(&a[2][0]);
+    __m128 a3 = _mm_loadu_ps(&a[3][0]);
+
+    for( int j = 0; j < 4; ++j)
+    {
+        __m128 r = _mm_mul_ps(a0, _mm_set1_ps(b[j][0]));
+        r = _mm_add_ps(r, _mm_mul_ps(a1, _mm_set1_ps(b[j][1])));
+        r = _mm_add_ps(r, _mm_mul_ps(a2, _mm_set1_ps(b[j][2])));
+        r = _mm_add_ps(r, _mm_mul_ps(a3, _mm_set1_ps(b[j][3])));
+        _mm_storeu_ps(&out[j][0], r);
+    }
+#elif TRANSFORM_HIERARCHY_NEON
+    float32x4_t a0 = vld1q_f32(&a[0][0]);
+    float32x4_t a1 = vld1q_f32(&a[1][0]);
+    float32x4_t a2 = vld1q_f32(&a[2][0]);
+    float32x4_t a3 = vld1q_f32(&a[3][0]);
+
+    for( int j = 0; j < 4; ++j)
+    {
+        float32x4_t r = vmulq_n_f32(a0, b[j][0]);
+        r = vmlaq_n_f32(r, a1, b[j][1]);
+        r = vmlaq_n_f32(r, a2, b[j][2]);
+        r = vmlaq_n_f32(r, a3, b[j][3]);
+        vst1q_f32(&out[j][0], r);
+    }
+#else
+    out = a * b;
+#endif
+}
@@ -0,0 +1,92 @@
+//
+//  transform_hierarchy.h
+//  vulkan-demos
+//
+//  Created by Rafael Sabino on 10/19/26.
+//  Copyright © 2026 Rafael Sabino. All rights reserved.
+//
+
+#pragma once
+
+#include <cstdint>
+#include "EASTL/vector.h"
+#include "EAAssert/eaassert.h"
+#include "transform.h"
+#include "job_system.h"
+
+namespace vk
+{
+    //note: local to world matrices of every node in the scene, stored as parallel arrays instead of one object per node.  A node
+    //is always added after its parent, so walking the arrays front to back visits parents first and a single pass updates the
+    //whole hierarchy.  Only nodes whose local transform changed, or that sit under one that did, are recomputed.
+    //
+    //world matrices are computed once per frame in graph::update, every pass and cull node reads the same ones
+    class transform_hierarchy
+    {
+    public:
+
+        static constexpr int32_t NO_PARENT = -1;
+
+        //note: parent must be a node that has already been added, returns the id of the new node
+        uint32_t add(const transform& local, int32_t parent = NO_PARENT);
+
+        void set_local(uint32_t id, const transform& local);
+
+        //note: the new parent has to come before id as well, the arrays stay in parent first order.  Children of id follow it
+        //to its new parent on the next update
+        void set_parent(uint32_t id, int32_t parent);
+
+        inline const glm::mat4& get_world(uint32_t id) const
+        {
+            EA_ASSERT(id < _worlds.size());
+            return _worlds[id];
+        }
+
+        inline int32_t get_parent(uint32_t id) const
+        {
+            EA_ASSERT(id < _parents.size());
+            return _parents[id];
+        }
+
+        inline uint32_t get_num_nodes() const { return static_cast<uint32_t>(_parents.size()); }
+
+        //recomputes the world matrices of dirty nodes and their descendants
+        void update();
+
+        //note: same as update, as jobs.  Local matrices are recomputed in parallel, world matrices by one job after them since
+        //every node needs its parent first.  Returns the job world matrices are ready after, after itself if nothing is dirty
+        uint32_t add_update_jobs(job_system& jobs, uint32_t after = job_system::NO_JOB);
+
+        //note: same results as update, with glm and one vk::transform at a time.  Everything is recomputed, this is the reference
+        //the simd path is checked and timed against
+        void update_reference(eastl::vector<glm::mat4>& worlds) const;
+
+        void clear();
+
+        //out = a * b, with sse or neon where the target has them
+        static void multiply(const glm::mat4& a, const glm::mat4& b, glm::mat4& out);
+
+    private:
+
+        enum dirty_flags : uint8_t
+        {
+            LOCAL_DIRTY = 1u,
+            WORLD_DIRTY = 2u
+        };
+
+        static constexpr uint32_t LOCALS_PER_JOB = 1024u;
+
+        void update_local(uint32_t id);
+        void update_worlds(bool locals);
+
+        eastl::vector<glm::vec3>    _positions {};
+        eastl::vector<glm::vec3>    _rotations {};
+        eastl::vector<glm::vec3>    _scales {};
+        eastl::vector<int32_t>      _parents {};
+        eastl::vector<glm::mat4>    _locals {};
+        eastl::vector<glm::mat4>    _worlds {};
+        eastl::vector<uint8_t>      _dirty {};
+
+        bool _any_dirty = false;
+    };
+}
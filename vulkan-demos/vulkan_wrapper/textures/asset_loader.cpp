@@ -0,0 +1,321 @@
+//
+//  asset_loader.cpp
+//  vulkan-demos
+//
+//  Created by Rafael Sabino on 10/19/26.
+//  Copyright © 2026 Rafael Sabino. All rights reserved.
+//
+
+#include "asset_loader.h"
+#include "texture_2d.h"
+#include "texture_container.h"
+#include "profiler.h"
+#include "EASTL/algorithm.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+using namespace vk;
+
+bool asset_loader::_enabled = true;
+
+void asset_loader::start_workers()
+{
+    //note: one core is left to the main thread, it records and submits frames while the workers decode
+    uint32_t hardware_threads = std::thread::hardware_concurrency();
+    uint32_t num_workers = std::min(MAX_WORKERS, std::max(1u, hardware_threads > 1 ? hardware_threads - 1 : 1u));
+
+    for( uint32_t i = 0; i < num_workers; ++i)
+    {
+        _workers.push_back(std::thread(&asset_loader::work, this));
+    }
+}
+
+void asset_loader::submit(texture_2d* texture, const char* path)
+{
+    EA_ASSERT(texture != nullptr && path != nullptr);
+    if(_workers.empty())
+        start_workers();
+
+    if(_requests.empty())
+        _first_submit = std::chrono::steady_clock::now();
+
+    request* r = new request();
+    r->path = path;
+    r->texture = texture;
+    r->build_chain = texture->is_mip_streamed();
+    r->filter = texture->get_mip_filter();
+    _requests.push_back(r);
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _queued.push_back(r);
+    }
+    _work_available.notify_one();
+}
+
+void asset_loader::work()
+{
+    profiler::set_thread_name("asset loader");
+    std::unique_lock<std::mutex> lock(_mutex);
+    while(true)
+    {
+        _work_available.wait(lock, [this]{ return _quit || !_queued.empty(); });
+        if(_quit)
+            return;
+
+        request* r = _queued.front();
+        _queued.pop_front();
+        _decoding.push_back(r);
+
+        //note: decoded outside the lock, the only state stb_image shares between threads is its failure reason
+        lock.unlock();
+        {
+            PROFILE_ZONE("asset_loader decode");
+            r->pixels = stbi_load(r->path.c_str(), &r->width, &r->height, &r->channels, STBI_default);
+            if(r->build_chain && r->pixels != nullptr)
+                build_chain(r);
+        }
+        lock.lock();
+
+        _decoding.erase(eastl::find(_decoding.begin(), _decoding.end(), r));
+        _decoded.push_back(r);
+        _work_finished.notify_all();
+    }
+}
+
+//note: every level down to 1x1, one after the other.  The pixels stb_image decoded are level 0 and are freed once copied
+void asset_loader::build_chain(request* r)
+{
+    uint32_t width = static_cast<uint32_t>(r->width);
+    uint32_t height = static_cast<uint32_t>(r->height);
+    uint32_t channels = static_cast<uint32_t>(r->channels);
+
+    size_t size = 0;
+    for( uint32_t w = width, h = height; ; w = std::max(1u, w / 2), h = std::max(1u, h / 2))
+    {
+        size += size_t(w) * h * channels;
+        if(w == 1 && h == 1)
+            break;
+    }
+
+    r->chain.resize(size);
+    memcpy(r->chain.data(), r->pixels, size_t(width) * height * channels);
+    stbi_image_free(r->pixels);
+    r->pixels = nullptr;
+
+    uint8_t* level = r->chain.data();
+    while(width != 1 || height != 1)
+    {
+        uint8_t* next = level + size_t(width) * height * channels;
+        texture_container::downsample(level, width, height, channels, next, r->filter);
+        width = std::max(1u, width / 2);
+        height = std::max(1u, height / 2);
+        level = next;
+    }
+}
+
+void asset_loader::release(request* r)
+{
+    auto it = eastl::find(_requests.begin(), _requests.end(), r);
+    EA_ASSERT(it != _requests.end());
+    _requests.erase(it);
+
+    if(r->pixels != nullptr)
+        stbi_image_free(r->pixels);
+    delete r;
+}
+
+void asset_loader::upload_completed()
+{
+    PROFILE_ZONE("asset_loader::upload_completed");
+    release_finished_uploads(false);
+    if(_requests.empty())
+        return;
+
+    //note: textures that have not been through init yet have no image to copy to, they wait for a later update
+    eastl::vector<request*> ready {};
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        VkDeviceSize budget = 0;
+        for( auto it = _decoded.begin(); it != _decoded.end() && budget < UPLOAD_BUDGET; )
+        {
+            request* r = *it;
+            if(!r->texture->is_initialized())
+            {
+                ++it;
+                continue;
+            }
+            budget += VkDeviceSize(r->width) * r->height * r->channels;
+            ready.push_back(r);
+            it = _decoded.erase(it);
+        }
+    }
+
+    if(ready.empty())
+        return;
+
+    upload u {};
+    u.command_buffer = _device->start_single_time_command_buffer(_device->_graphics_command_pool);
+
+    for( request* r : ready)
+    {
+        texture_2d* texture = r->texture;
+        bool decoded = r->pixels != nullptr || !r->chain.empty();
+        if(!decoded || uint32_t(r->width) != texture->get_width() || uint32_t(r->height) != texture->get_height() ||
+           uint32_t(r->channels) != texture->get_channels())
+        {
+            printf("%s did not load, its placeholder stays\n", r->path.c_str());
+            release(r);
+            continue;
+        }
+
+        bool streamed = texture->is_mip_streamed();
+        VkDeviceSize size = streamed ? texture->get_staging_size(texture->get_resident_level(), texture->get_num_source_levels()) :
+                                       VkDeviceSize(r->width) * r->height * r->channels;
+        VkBuffer staging_buffer = VK_NULL_HANDLE;
+        VkDeviceMemory staging_buffer_memory = VK_NULL_HANDLE;
+        create_buffer(_device->_logical_device, _device->_physical_device, size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, staging_buffer,
+                      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, staging_buffer_memory);
+
+        void* data = nullptr;
+        VkResult result = vkMapMemory(_device->_logical_device, staging_buffer_memory, 0, VK_WHOLE_SIZE, 0, &data);
+        ASSERT_VULKAN(result);
+        if(streamed)
+        {
+            texture->set_level_data(eastl::move(r->chain));
+            texture->write_levels(texture->get_resident_level(), texture->get_num_source_levels(), static_cast<uint8_t*>(data));
+        }
+        else
+        {
+            memcpy(data, r->pixels, size);
+        }
+        vkUnmapMemory(_device->_logical_device, staging_buffer_memory);
+
+        texture->record_upload(u.command_buffer, staging_buffer);
+
+        u.textures.push_back(texture);
+        u.buffers.push_back(staging_buffer);
+        u.memories.push_back(staging_buffer_memory);
+        release(r);
+        ++_num_uploaded;
+    }
+
+    VkResult result = vkEndCommandBuffer(u.command_buffer);
+    ASSERT_VULKAN(result);
+
+    VkFenceCreateInfo fence_info {};
+    fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    result = vkCreateFence(_device->_logical_device, &fence_info, nullptr, &u.fence);
+    ASSERT_VULKAN(result);
+
+    //note: same queue as the frames, the barriers in record_upload order the copy against frames before and after it
+    VkSubmitInfo submit_info {};
+    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submit_info.commandBufferCount = 1;
+    submit_info.pCommandBuffers = &u.command_buffer;
+    result = vkQueueSubmit(_device->_graphics_queue, 1, &submit_info, u.fence);
+    ASSERT_VULKAN(result);
+
+    _uploads.push_back(eastl::move(u));
+
+    if(_requests.empty())
+    {
+        auto elapsed = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - _first_submit);
+        printf("%u textures streamed in %.1f ms after the first request\n", _num_uploaded, elapsed.count());
+        _num_uploaded = 0;
+    }
+}
+
+void asset_loader::release_finished_uploads(bool wait)
+{
+    for( auto it = _uploads.begin(); it != _uploads.end(); )
+    {
+        if(wait)
+        {
+            VkResult result = vkWaitForFences(_device->_logical_device, 1, &it->fence, VK_TRUE, UINT64_MAX);
+            ASSERT_VULKAN(result);
+        }
+        else if(vkGetFenceStatus(_device->_logical_device, it->fence) != VK_SUCCESS)
+        {
+            ++it;
+            continue;
+        }
+
+        for( size_t i = 0; i < it->buffers.size(); ++i)
+        {
+            vkDestroyBuffer(_device->_logical_device, it->buffers[i], nullptr);
+            vkFreeMemory(_device->_logical_device, it->memories[i], nullptr);
+        }
+        vkFreeCommandBuffers(_device->_logical_device, _device->_graphics_command_pool, 1, &it->command_buffer);
+        vkDestroyFence(_device->_logical_device, it->fence, nullptr);
+        it = _uploads.erase(it);
+    }
+}
+
+void asset_loader::cancel(texture_2d* texture)
+{
+    auto belongs = [texture](request* r){ return r->texture == texture; };
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _work_finished.wait(lock, [&]{ return eastl::none_of(_decoding.begin(), _decoding.end(), belongs); });
+        _queued.erase(eastl::remove_if(_queued.begin(), _queued.end(), belongs), _queued.end());
+        _decoded.erase(eastl::remove_if(_decoded.begin(), _decoded.end(), belongs), _decoded.end());
+    }
+
+    for( auto it = eastl::find_if(_requests.begin(), _requests.end(), belongs); it != _requests.end();
+         it = eastl::find_if(_requests.begin(), _requests.end(), belongs))
+    {
+        release(*it);
+    }
+
+    bool uploading = false;
+    for( upload& u : _uploads)
+    {
+        uploading = uploading || eastl::find(u.textures.begin(), u.textures.end(), texture) != u.textures.end();
+    }
+    if(uploading)
+        release_finished_uploads(true);
+}
+
+void asset_loader::flush()
+{
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _work_finished.wait(lock, [this]{ return _queued.empty() && _decoding.empty(); });
+    }
+
+    //note: no budget here, every decoded image of an initialized texture goes out before returning
+    size_t pending = 0;
+    do
+    {
+        pending = _requests.size();
+        upload_completed();
+    } while(!_requests.empty() && _requests.size() != pending);
+
+    release_finished_uploads(true);
+}
+
+void asset_loader::destroy()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _quit = true;
+    }
+    _work_available.notify_all();
+    for( std::thread& worker : _workers)
+    {
+        worker.join();
+    }
+    _workers.clear();
+
+    while(!_requests.empty())
+    {
+        release(_requests.back());
+    }
+    _queued.clear();
+    _decoding.clear();
+    _decoded.clear();
+
+    release_finished_uploads(true);
+}
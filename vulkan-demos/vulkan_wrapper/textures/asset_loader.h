@@ -0,0 +1,126 @@
+//
+//  asset_loader.h
+//  vulkan-demos
+//
+//  Created by Rafael Sabino on 10/19/26.
+//  Copyright © 2026 Rafael Sabino. All rights reserved.
+//
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include "EASTL/fixed_string.h"
+#include "EASTL/fixed_vector.h"
+#include "EASTL/vector.h"
+#include "EASTL/deque.h"
+#include "stb_image.h"
+#include "resource.h"
+#include "device.h"
+#include "mip_generator.h"
+
+namespace vk
+{
+    class texture_2d;
+
+    //note: images are read and decoded by worker threads while the main thread keeps rendering.  A texture_2d made from a path
+    //creates its image with a placeholder color and hands the path to submit, the first graph update after the pixels are decoded
+    //records the copy into that same image.  Descriptors are never rewritten, they point at the placeholder until the copy lands.
+    //
+    //workers only read files and decode them with stb_image, vulkan objects and the arena are only touched on the main thread.
+    //Compressed containers are not loaded here, they are mapped and copied as they are, see texture_container.h
+    class asset_loader : public resource
+    {
+    public:
+
+        static constexpr uint32_t MAX_WORKERS = 8u;
+        //note: bytes copied to the gpu in one graph update, a single image larger than this is still uploaded on its own
+        static constexpr VkDeviceSize UPLOAD_BUDGET = 32ull * 1024ull * 1024ull;
+
+        asset_loader(){}
+        asset_loader(device* dev){ _device = dev; }
+
+        //note: textures created from a path while this is false load synchronously in their constructor, like they used to
+        static void set_enabled(bool enabled){ _enabled = enabled; }
+        static bool is_enabled(){ return _enabled; }
+
+        //main thread only: path is decoded on a worker, texture gets its pixels in a later call to upload_completed
+        void submit(texture_2d* texture, const char* path);
+
+        //main thread only: forgets about texture, waits for a worker still decoding it and for uploads to it still on the gpu
+        void cancel(texture_2d* texture);
+
+        //main thread only: records the copies of decoded images into their textures, at most UPLOAD_BUDGET bytes per call, and
+        //frees staging memory of earlier copies the gpu is done with.  Called once per frame from graph::update
+        void upload_completed();
+
+        //main thread only: blocks until every submitted image is decoded and uploaded
+        void flush();
+
+        inline uint32_t get_num_pending() const { return static_cast<uint32_t>(_requests.size()); }
+
+        virtual void destroy() override;
+
+        virtual char const * const * get_instance_type() override { return (&_type); };
+        static char const * const *  get_class_type(){ return (&_type); }
+
+    private:
+
+        struct request
+        {
+            eastl::fixed_string<char, 250> path {};
+            texture_2d* texture = nullptr;
+            //note: written by a worker, read by the main thread once the request is in _decoded
+            stbi_uc*    pixels = nullptr;
+            int         width = 0;
+            int         height = 0;
+            int         channels = 0;
+            //note: mip streamed textures get their whole chain built by the worker, see texture_streamer.h
+            bool        build_chain = false;
+            mip_filter  filter = mip_filter::LINEAR;
+            eastl::vector<uint8_t> chain {};
+        };
+
+        //note: one command buffer per call to upload_completed, its staging buffers live until its fence signals
+        struct upload
+        {
+            VkCommandBuffer command_buffer = VK_NULL_HANDLE;
+            VkFence         fence = VK_NULL_HANDLE;
+            eastl::vector<texture_2d*>      textures {};
+            eastl::vector<VkBuffer>         buffers {};
+            eastl::vector<VkDeviceMemory>   memories {};
+        };
+
+        void start_workers();
+        void work();
+        static void build_chain(request* r);
+        void release_finished_uploads(bool wait);
+        void release(request* r);
+
+        static bool _enabled;
+        static constexpr char const * _type = nullptr;
+
+        device*                         _device = nullptr;
+
+        eastl::fixed_vector<std::thread, MAX_WORKERS, false> _workers {};
+
+        //note: guarded by _mutex
+        std::mutex                      _mutex;
+        std::condition_variable         _work_available;
+        std::condition_variable         _work_finished;
+        eastl::deque<request*>          _queued {};
+        eastl::vector<request*>         _decoding {};
+        eastl::vector<request*>         _decoded {};
+        bool                            _quit = false;
+
+        //note: main thread only, every request submitted and not uploaded yet
+        eastl::vector<request*>         _requests {};
+        eastl::vector<upload>           _uploads {};
+
+        std::chrono::steady_clock::time_point _first_submit {};
+        uint32_t                        _num_uploaded = 0;
+    };
+}
@@ -161,6 +161,18 @@ namespace vk
             return _clear[i];
         }
         
+        //note: an attachment that is not cleared starts out undefined unless its contents are kept, this is for a pass that draws
+        //on top of an earlier one (i.e. the late pass of occlusion culling).  Loading costs bandwidth, only ask for it then
+        inline void set_keep_contents( uint32_t i, bool keep)
+        {
+            _keep[i] = keep;
+        }
+        
+        inline bool should_keep_contents( uint32_t i )
+        {
+            return !_clear[i] && _keep[i];
+        }
+        
         template< typename R>
         inline void add_attachment(resource_set<R>& textures_set, glm::vec4 clear_color, bool clear = true, bool store = true)
         {
@@ -295,6 +307,7 @@ namespace vk
         eastl::array<bool, NUM_ATTACHMENTS> _multisample {};
         eastl::array<bool, NUM_ATTACHMENTS> _clear {};
         eastl::array<bool, NUM_ATTACHMENTS> _store {};
+        eastl::array<bool, NUM_ATTACHMENTS> _keep {};
         uint32_t num_attachments = 0;
     };
 }
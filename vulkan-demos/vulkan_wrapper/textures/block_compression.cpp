@@ -0,0 +1,801 @@
+//
+//  block_compression.cpp
+//  vulkan-demos
+//
+//  Created by Rafael Sabino on 10/19/26.
+//  Copyright © 2026 Rafael Sabino. All rights reserved.
+//
+
+#include "block_compression.h"
+#include "EAAssert/eaassert.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+using namespace vk;
+
+namespace
+{
+    constexpr uint32_t TEXELS = 16u;
+
+    //note: interpolation weights out of 64 for 2, 3 and 4 bit indices, straight from the BC7 specification
+    constexpr uint8_t WEIGHTS_2[4] = { 0, 21, 43, 64 };
+    constexpr uint8_t WEIGHTS_3[8] = { 0, 9, 18, 27, 37, 46, 55, 64 };
+    constexpr uint8_t WEIGHTS_4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+    struct bc7_mode
+    {
+        uint8_t subsets;
+        uint8_t partition_bits;
+        uint8_t rotation_bits;
+        uint8_t index_selection_bits;
+        uint8_t color_bits;
+        uint8_t alpha_bits;
+        uint8_t endpoint_pbits;
+        uint8_t shared_pbits;
+        uint8_t index_bits;
+        uint8_t index_bits2;
+    };
+
+    constexpr bc7_mode BC7_MODES[8] =
+    {
+        { 3, 4, 0, 0, 4, 0, 1, 0, 3, 0 },
+        { 2, 6, 0, 0, 6, 0, 0, 1, 3, 0 },
+        { 3, 6, 0, 0, 5, 0, 0, 0, 2, 0 },
+        { 2, 6, 0, 0, 7, 0, 1, 0, 2, 0 },
+        { 1, 0, 2, 1, 5, 6, 0, 0, 2, 3 },
+        { 1, 0, 2, 0, 7, 8, 0, 0, 2, 2 },
+        { 1, 0, 0, 0, 7, 7, 1, 0, 4, 0 },
+        { 2, 6, 0, 0, 5, 5, 1, 0, 2, 0 }
+    };
+
+    //note: which subset every texel of a block belongs to, for the 64 partitions of the two and three subset modes
+    constexpr uint8_t BC7_PARTITIONS_2[64][16] =
+    {
+        { 0,0,1,1,0,0,1,1,0,0,1,1,0,0,1,1 }, { 0,0,0,1,0,0,0,1,0,0,0,1,0,0,0,1 }, { 0,1,1,1,0,1,1,1,0,1,1,1,0,1,1,1 }, { 0,0,0,1,0,0,1,1,0,0,1,1,0,1,1,1 },
+        { 0,0,0,0,0,0,0,1,0,0,0,1,0,0,1,1 }, { 0,0,1,1,0,1,1,1,0,1,1,1,1,1,1,1 }, { 0,0,0,1,0,0,1,1,0,1,1,1,1,1,1,1 }, { 0,0,0,0,0,0,0,1,0,0,1,1,0,1,1,1 },
+        { 0,0,0,0,0,0,0,0,0,0,0,1,0,0,1,1 }, { 0,0,1,1,0,1,1,1,1,1,1,1,1,1,1,1 }, { 0,0,0,0,0,0,0,1,0,1,1,1,1,1,1,1 }, { 0,0,0,0,0,0,0,0,0,0,0,1,0,1,1,1 },
+        { 0,0,0,1,0,1,1,1,1,1,1,1,1,1,1,1 }, { 0,0,0,0,0,0,0,0,1,1,1,1,1,1,1,1 }, { 0,0,0,0,1,1,1,1,1,1,1,1,1,1,1,1 }, { 0,0,0,0,0,0,0,0,0,0,0,0,1,1,1,1 },
+        { 0,0,0,0,1,0,0,0,1,1,1,0,1,1,1,1 }, { 0,1,1,1,0,0,0,1,0,0,0,0,0,0,0,0 }, { 0,0,0,0,0,0,0,0,1,0,0,0,1,1,1,0 }, { 0,1,1,1,0,0,1,1,0,0,0,1,0,0,0,0 },
+        { 0,0,1,1,0,0,0,1,0,0,0,0,0,0,0,0 }, { 0,0,0,0,1,0,0,0,1,1,0,0,1,1,1,0 }, { 0,0,0,0,0,0,0,0,1,0,0,0,1,1,0,0 }, { 0,1,1,1,0,0,1,1,0,0,1,1,0,0,0,1 },
+        { 0,0,1,1,0,0,0,1,0,0,0,1,0,0,0,0 }, { 0,0,0,0,1,0,0,0,1,0,0,0,1,1,0,0 }, { 0,1,1,0,0,1,1,0,0,1,1,0,0,1,1,0 }, { 0,0,1,1,0,1,1,0,0,1,1,0,1,1,0,0 },
+        { 0,0,0,1,0,1,1,1,1,1,1,0,1,0,0,0 }, { 0,0,0,0,1,1,1,1,1,1,1,1,0,0,0,0 }, { 0,1,1,1,0,0,0,1,1,0,0,0,1,1,1,0 }, { 0,0,1,1,1,0,0,1,1,0,0,1,1,1,0,0 },
+        { 0,1,0,1,0,1,0,1,0,1,0,1,0,1,0,1 }, { 0,0,0,0,1,1,1,1,0,0,0,0,1,1,1,1 }, { 0,1,0,1,1,0,1,0,0,1,0,1,1,0,1,0 }, { 0,0,1,1,0,0,1,1,1,1,0,0,1,1,0,0 },
+        { 0,0,1,1,1,1,0,0,0,0,1,1,1,1,0,0 }, { 0,1,0,1,0,1,0,1,1,0,1,0,1,0,1,0 }, { 0,1,1,0,1,0,0,1,0,1,1,0,1,0,0,1 }, { 0,1,0,1,1,0,1,0,1,0,1,0,0,1,0,1 },
+        { 0,1,1,1,0,0,1,1,1,1,0,0,1,1,1,0 }, { 0,0,0,1,0,0,1,1,1,1,0,0,1,0,0,0 }, { 0,0,1,1,0,0,1,0,0,1,0,0,1,1,0,0 }, { 0,0,1,1,1,0,1,1,1,1,0,1,1,1,0,0 },
+        { 0,1,1,0,1,0,0,1,1,0,0,1,0,1,1,0 }, { 0,0,1,1,1,1,0,0,1,1,0,0,0,0,1,1 }, { 0,1,1,0,0,1,1,0,1,0,0,1,1,0,0,1 }, { 0,0,0,0,0,1,1,0,0,1,1,0,0,0,0,0 },
+        { 0,1,0,0,1,1,1,0,0,1,0,0,0,0,0,0 }, { 0,0,1,0,0,1,1,1,0,0,1,0,0,0,0,0 }, { 0,0,0,0,0,0,1,0,0,1,1,1,0,0,1,0 }, { 0,0,0,0,0,1,0,0,1,1,1,0,0,1,0,0 },
+        { 0,1,1,0,1,1,0,0,1,0,0,1,0,0,1,1 }, { 0,0,1,1,0,1,1,0,1,1,0,0,1,0,0,1 }, { 0,1,1,0,0,0,1,1,1,0,0,1,1,1,0,0 }, { 0,0,1,1,1,0,0,1,1,1,0,0,0,1,1,0 },
+        { 0,1,1,0,1,1,0,0,1,1,0,0,1,0,0,1 }, { 0,1,1,0,0,0,1,1,0,0,1,1,1,0,0,1 }, { 0,1,1,1,1,1,1,0,1,0,0,0,0,0,0,1 }, { 0,0,0,1,1,0,0,0,1,1,1,0,0,1,1,1 },
+        { 0,0,0,0,1,1,1,1,0,0,1,1,0,0,1,1 }, { 0,0,1,1,0,0,1,1,1,1,1,1,0,0,0,0 }, { 0,0,1,0,0,0,1,0,1,1,1,0,1,1,1,0 }, { 0,1,0,0,0,1,0,0,0,1,1,1,0,1,1,1 }
+    };
+
+    constexpr uint8_t BC7_PARTITIONS_3[64][16] =
+    {
+        { 0,0,1,1,0,0,1,1,0,2,2,1,2,2,2,2 }, { 0,0,0,1,0,0,1,1,2,2,1,1,2,2,2,1 }, { 0,0,0,0,2,0,0,1,2,2,1,1,2,2,1,1 }, { 0,2,2,2,0,0,2,2,0,0,1,1,0,1,1,1 },
+        { 0,0,0,0,0,0,0,0,1,1,2,2,1,1,2,2 }, { 0,0,1,1,0,0,1,1,0,0,2,2,0,0,2,2 }, { 0,0,2,2,0,0,2,2,1,1,1,1,1,1,1,1 }, { 0,0,1,1,0,0,1,1,2,2,1,1,2,2,1,1 },
+        { 0,0,0,0,0,0,0,0,1,1,1,1,2,2,2,2 }, { 0,0,0,0,1,1,1,1,1,1,1,1,2,2,2,2 }, { 0,0,0,0,1,1,1,1,2,2,2,2,2,2,2,2 }, { 0,0,1,2,0,0,1,2,0,0,1,2,0,0,1,2 },
+        { 0,1,1,2,0,1,1,2,0,1,1,2,0,1,1,2 }, { 0,1,2,2,0,1,2,2,0,1,2,2,0,1,2,2 }, { 0,0,1,1,0,1,1,2,1,1,2,2,1,2,2,2 }, { 0,0,1,1,2,0,0,1,2,2,0,0,2,2,2,0 },
+        { 0,0,0,1,0,0,1,1,0,1,1,2,1,1,2,2 }, { 0,1,1,1,0,0,1,1,2,0,0,1,2,2,0,0 }, { 0,0,0,0,1,1,2,2,1,1,2,2,1,1,2,2 }, { 0,0,2,2,0,0,2,2,0,0,2,2,1,1,1,1 },
+        { 0,1,1,1,0,1,1,1,0,2,2,2,0,2,2,2 }, { 0,0,0,1,0,0,0,1,2,2,2,1,2,2,2,1 }, { 0,0,0,0,0,0,1,1,0,1,2,2,0,1,2,2 }, { 0,0,0,0,1,1,0,0,2,2,1,0,2,2,1,0 },
+        { 0,1,2,2,0,1,2,2,0,0,1,1,0,0,0,0 }, { 0,0,1,2,0,0,1,2,1,1,2,2,2,2,2,2 }, { 0,1,1,0,1,2,2,1,1,2,2,1,0,1,1,0 }, { 0,0,0,0,0,1,1,0,1,2,2,1,1,2,2,1 },
+        { 0,0,2,2,1,1,0,2,1,1,0,2,0,0,2,2 }, { 0,1,1,0,0,1,1,0,2,0,0,2,2,2,2,2 }, { 0,0,1,1,0,1,2,2,0,1,2,2,0,0,1,1 }, { 0,0,0,0,2,0,0,0,2,2,1,1,2,2,2,1 },
+        { 0,0,0,0,0,0,0,2,1,1,2,2,1,2,2,2 }, { 0,2,2,2,0,0,2,2,0,0,1,2,0,0,1,1 }, { 0,0,1,1,0,0,1,2,0,0,2,2,0,2,2,2 }, { 0,1,2,0,0,1,2,0,0,1,2,0,0,1,2,0 },
+        { 0,0,0,0,1,1,1,1,2,2,2,2,0,0,0,0 }, { 0,1,2,0,1,2,0,1,2,0,1,2,0,1,2,0 }, { 0,1,2,0,2,0,1,2,1,2,0,1,0,1,2,0 }, { 0,0,1,1,2,2,0,0,1,1,2,2,0,0,1,1 },
+        { 0,0,1,1,1,1,2,2,2,2,0,0,0,0,1,1 }, { 0,1,0,1,0,1,0,1,2,2,2,2,2,2,2,2 }, { 0,0,0,0,0,0,0,0,2,1,2,1,2,1,2,1 }, { 0,0,2,2,1,1,2,2,0,0,2,2,1,1,2,2 },
+        { 0,0,2,2,0,0,1,1,0,0,2,2,0,0,1,1 }, { 0,2,2,0,1,2,2,1,0,2,2,0,1,2,2,1 }, { 0,1,0,1,2,2,2,2,2,2,2,2,0,1,0,1 }, { 0,0,0,0,2,1,2,1,2,1,2,1,2,1,2,1 },
+        { 0,1,0,1,0,1,0,1,0,1,0,1,2,2,2,2 }, { 0,2,2,2,0,1,1,1,0,2,2,2,0,1,1,1 }, { 0,0,0,2,1,1,1,2,0,0,0,2,1,1,1,2 }, { 0,0,0,0,2,1,1,2,2,1,1,2,2,1,1,2 },
+        { 0,2,2,2,0,1,1,1,0,1,1,1,0,2,2,2 }, { 0,0,0,2,1,1,1,2,1,1,1,2,0,0,0,2 }, { 0,1,1,0,0,1,1,0,0,1,1,0,2,2,2,2 }, { 0,0,0,0,0,0,0,0,2,1,1,2,2,1,1,2 },
+        { 0,1,1,0,0,1,1,0,2,2,2,2,2,2,2,2 }, { 0,0,2,2,0,0,1,1,0,0,1,1,0,0,2,2 }, { 0,0,2,2,1,1,2,2,1,1,2,2,0,0,2,2 }, { 0,0,0,0,0,0,0,0,0,0,0,0,2,1,1,2 },
+        { 0,0,0,2,0,0,0,1,0,0,0,2,0,0,0,1 }, { 0,2,2,2,1,2,2,2,0,2,2,2,1,2,2,2 }, { 0,1,0,1,2,2,2,2,2,2,2,2,2,2,2,2 }, { 0,1,1,1,2,0,1,1,2,2,0,1,2,2,2,0 }
+    };
+
+    //note: the index of the first texel of every subset has its top bit implied, these are those texels for subsets 1 and 2,
+    //subset 0 always starts at texel 0
+    constexpr uint8_t BC7_ANCHORS_2[64] =
+    {
+        15,15,15,15,15,15,15,15, 15,15,15,15,15,15,15,15, 15, 2, 8, 2, 2, 8, 8,15,  2, 8, 2, 2, 8, 8, 2, 2,
+        15,15, 6, 8, 2, 8,15,15,  2, 8, 2, 2, 2,15,15, 6,  6, 2, 6, 8,15,15, 2, 2, 15,15,15,15,15, 2, 2,15
+    };
+
+    constexpr uint8_t BC7_ANCHORS_3_SECOND[64] =
+    {
+         3, 3,15,15, 8, 3,15,15,  8, 8, 6, 6, 6, 5, 3, 3,  3, 3, 8,15, 3, 3, 6,10,  5, 8, 8, 6, 8, 5,15,15,
+         8,15, 3, 5, 6,10, 8,15, 15, 3,15, 5,15,15,15,15,  3,15, 5, 5, 5, 8, 5,10,  5,10, 8,13,15,12, 3, 3
+    };
+
+    constexpr uint8_t BC7_ANCHORS_3_THIRD[64] =
+    {
+        15, 8, 8, 3,15,15, 3, 8, 15,15,15,15,15,15,15, 8, 15, 8,15, 3,15, 8,15, 8,  3,15, 6,10,15,15,10, 8,
+        15, 3,15,10,10, 8, 9,10,  6,15, 8,15, 3, 6, 6, 8, 15, 3,15,15,15,15,15,15, 15,15,15,15, 3,15,15, 8
+    };
+
+    class bit_reader
+    {
+    public:
+        explicit bit_reader(const uint8_t* bytes) : _bytes(bytes) {}
+
+        uint32_t read(uint32_t count)
+        {
+            uint32_t value = 0;
+            for( uint32_t i = 0; i < count; ++i, ++_position)
+            {
+                value |= ((_bytes[_position >> 3] >> (_position & 7u)) & 1u) << i;
+            }
+            return value;
+        }
+
+    private:
+        const uint8_t*  _bytes = nullptr;
+        uint32_t        _position = 0;
+    };
+
+    class bit_writer
+    {
+    public:
+        explicit bit_writer(uint8_t* bytes, size_t size) : _bytes(bytes) { memset(bytes, 0, size); }
+
+        void write(uint32_t value, uint32_t count)
+        {
+            for( uint32_t i = 0; i < count; ++i, ++_position)
+            {
+                _bytes[_position >> 3] |= static_cast<uint8_t>(((value >> i) & 1u) << (_position & 7u));
+            }
+        }
+
+    private:
+        uint8_t*    _bytes = nullptr;
+        uint32_t    _position = 0;
+    };
+
+    inline uint8_t interpolate(uint32_t e0, uint32_t e1, uint32_t weight)
+    {
+        return static_cast<uint8_t>(((64u - weight) * e0 + weight * e1 + 32u) >> 6);
+    }
+
+    inline uint32_t weight_of(uint32_t index_bits, uint32_t index)
+    {
+        return index_bits == 2 ? WEIGHTS_2[index] : index_bits == 3 ? WEIGHTS_3[index] : WEIGHTS_4[index];
+    }
+
+    inline int32_t clamp_byte(float v)
+    {
+        return std::min(255, std::max(0, static_cast<int32_t>(v + .5f)));
+    }
+
+    //note: the two texels furthest apart along the axis the block varies the most on, found with a few power iterations on the
+    //covariance of the block
+    void principal_extremes(const uint8_t block[64], uint32_t channels, float e0[4], float e1[4])
+    {
+        float mean[4] = {};
+        for( uint32_t i = 0; i < TEXELS; ++i)
+            for( uint32_t c = 0; c < channels; ++c)
+                mean[c] += block[i * 4 + c];
+        for( uint32_t c = 0; c < channels; ++c)
+            mean[c] /= TEXELS;
+
+        float covariance[4][4] = {};
+        for( uint32_t i = 0; i < TEXELS; ++i)
+        {
+            for( uint32_t r = 0; r < channels; ++r)
+                for( uint32_t c = 0; c < channels; ++c)
+                    covariance[r][c] += (block[i * 4 + r] - mean[r]) * (block[i * 4 + c] - mean[c]);
+        }
+
+        float axis[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+        for( uint32_t iteration = 0; iteration < 8; ++iteration)
+        {
+            float next[4] = {};
+            float length = 0.0f;
+            for( uint32_t r = 0; r < channels; ++r)
+            {
+                for( uint32_t c = 0; c < channels; ++c)
+                    next[r] += covariance[r][c] * axis[c];
+                length = std::max(length, std::abs(next[r]));
+            }
+            if(length == 0.0f)
+                break;
+            for( uint32_t c = 0; c < channels; ++c)
+                axis[c] = next[c] / length;
+        }
+
+        float low = std::numeric_limits<float>::max();
+        float high = -std::numeric_limits<float>::max();
+        uint32_t low_texel = 0;
+        uint32_t high_texel = 0;
+        for( uint32_t i = 0; i < TEXELS; ++i)
+        {
+            float t = 0.0f;
+            for( uint32_t c = 0; c < channels; ++c)
+                t += (block[i * 4 + c] - mean[c]) * axis[c];
+            if(t < low) { low = t; low_texel = i; }
+            if(t > high) { high = t; high_texel = i; }
+        }
+
+        for( uint32_t c = 0; c < 4; ++c)
+        {
+            e0[c] = c < channels ? block[low_texel * 4 + c] : 255.0f;
+            e1[c] = c < channels ? block[high_texel * 4 + c] : 255.0f;
+        }
+    }
+
+    //note: least squares endpoints for indices that are already chosen, weights are how far every texel sits from e0 towards
+    //e1.  Returns false if every texel uses the same weight
+    bool fit_endpoints(const uint8_t block[64], uint32_t channels, const float weights[16], float e0[4], float e1[4])
+    {
+        float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+        float ax[4] = {}, bx[4] = {};
+        for( uint32_t i = 0; i < TEXELS; ++i)
+        {
+            float b = weights[i];
+            float a = 1.0f - b;
+            aa += a * a;
+            ab += a * b;
+            bb += b * b;
+            for( uint32_t c = 0; c < channels; ++c)
+            {
+                ax[c] += a * block[i * 4 + c];
+                bx[c] += b * block[i * 4 + c];
+            }
+        }
+
+        float determinant = aa * bb - ab * ab;
+        if(std::abs(determinant) < 1e-6f)
+            return false;
+
+        for( uint32_t c = 0; c < channels; ++c)
+        {
+            e0[c] = std::min(255.0f, std::max(0.0f, (ax[c] * bb - bx[c] * ab) / determinant));
+            e1[c] = std::min(255.0f, std::max(0.0f, (bx[c] * aa - ax[c] * ab) / determinant));
+        }
+        return true;
+    }
+
+    inline uint32_t squared_distance(const uint8_t* a, const uint8_t* b, uint32_t channels)
+    {
+        uint32_t d = 0;
+        for( uint32_t c = 0; c < channels; ++c)
+        {
+            int32_t delta = int32_t(a[c]) - int32_t(b[c]);
+            d += static_cast<uint32_t>(delta * delta);
+        }
+        return d;
+    }
+
+    //note: picks the closest palette entry for every texel, returns the total squared error
+    uint32_t choose_indices(const uint8_t block[64], uint32_t channels, const uint8_t palette[][4], uint32_t palette_size,
+                            uint8_t indices[16])
+    {
+        uint32_t total = 0;
+        for( uint32_t i = 0; i < TEXELS; ++i)
+        {
+            uint32_t best = std::numeric_limits<uint32_t>::max();
+            for( uint32_t p = 0; p < palette_size; ++p)
+            {
+                uint32_t d = squared_distance(&block[i * 4], palette[p], channels);
+                if(d < best)
+                {
+                    best = d;
+                    indices[i] = static_cast<uint8_t>(p);
+                }
+            }
+            total += best;
+        }
+        return total;
+    }
+
+    inline uint16_t to_565(const float color[4])
+    {
+        uint32_t r = static_cast<uint32_t>(clamp_byte(color[0]) * 31 + 127) / 255;
+        uint32_t g = static_cast<uint32_t>(clamp_byte(color[1]) * 63 + 127) / 255;
+        uint32_t b = static_cast<uint32_t>(clamp_byte(color[2]) * 31 + 127) / 255;
+        return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+    }
+
+    inline void from_565(uint16_t c, uint8_t out[4])
+    {
+        uint32_t r = (c >> 11) & 31u;
+        uint32_t g = (c >> 5) & 63u;
+        uint32_t b = c & 31u;
+        out[0] = static_cast<uint8_t>((r << 3) | (r >> 2));
+        out[1] = static_cast<uint8_t>((g << 2) | (g >> 4));
+        out[2] = static_cast<uint8_t>((b << 3) | (b >> 2));
+        out[3] = 255;
+    }
+
+    void bc1_palette(uint16_t c0, uint16_t c1, uint8_t palette[4][4])
+    {
+        from_565(c0, palette[0]);
+        from_565(c1, palette[1]);
+        for( uint32_t c = 0; c < 3; ++c)
+        {
+            if(c0 > c1)
+            {
+                palette[2][c] = static_cast<uint8_t>((2u * palette[0][c] + palette[1][c] + 1u) / 3u);
+                palette[3][c] = static_cast<uint8_t>((palette[0][c] + 2u * palette[1][c] + 1u) / 3u);
+            }
+            else
+            {
+                palette[2][c] = static_cast<uint8_t>((palette[0][c] + palette[1][c] + 1u) / 2u);
+                palette[3][c] = 0;
+            }
+        }
+        palette[2][3] = 255;
+        palette[3][3] = c0 > c1 ? 255 : 0;
+    }
+
+    //note: writes a four color block, c0 has to be larger than c1 for that
+    uint32_t bc1_try(const uint8_t block[64], const float e0[4], const float e1[4], uint8_t out[8], uint8_t indices[16])
+    {
+        uint16_t c0 = to_565(e0);
+        uint16_t c1 = to_565(e1);
+        if(c0 < c1)
+            std::swap(c0, c1);
+
+        uint8_t palette[4][4] {};
+        bc1_palette(c0, c1, palette);
+        //note: equal endpoints decode as a three color block, only its first entry is used
+        uint32_t error = choose_indices(block, 3, palette, c0 == c1 ? 1 : 4, indices);
+
+        uint32_t bits = 0;
+        for( uint32_t i = 0; i < TEXELS; ++i)
+            bits |= uint32_t(indices[i]) << (2 * i);
+
+        out[0] = static_cast<uint8_t>(c0 & 0xff);
+        out[1] = static_cast<uint8_t>(c0 >> 8);
+        out[2] = static_cast<uint8_t>(c1 & 0xff);
+        out[3] = static_cast<uint8_t>(c1 >> 8);
+        out[4] = static_cast<uint8_t>(bits & 0xff);
+        out[5] = static_cast<uint8_t>((bits >> 8) & 0xff);
+        out[6] = static_cast<uint8_t>((bits >> 16) & 0xff);
+        out[7] = static_cast<uint8_t>(bits >> 24);
+        return error;
+    }
+
+    void bc4_palette(uint32_t r0, uint32_t r1, uint8_t palette[8])
+    {
+        palette[0] = static_cast<uint8_t>(r0);
+        palette[1] = static_cast<uint8_t>(r1);
+        if(r0 > r1)
+        {
+            for( uint32_t k = 1; k < 7; ++k)
+                palette[k + 1] = static_cast<uint8_t>(((7u - k) * r0 + k * r1 + 3u) / 7u);
+        }
+        else
+        {
+            for( uint32_t k = 1; k < 5; ++k)
+                palette[k + 1] = static_cast<uint8_t>(((5u - k) * r0 + k * r1 + 2u) / 5u);
+            palette[6] = 0;
+            palette[7] = 255;
+        }
+    }
+
+    //note: BC7 endpoints are 7 bits plus a p bit shared by every channel, the p bit that reconstructs the endpoint best wins
+    void quantize_bc7_endpoint(const float endpoint[4], uint32_t quantized[4], uint32_t& pbit)
+    {
+        uint32_t best_error = std::numeric_limits<uint32_t>::max();
+        for( uint32_t p = 0; p < 2; ++p)
+        {
+            uint32_t q[4] {};
+            uint32_t error = 0;
+            for( uint32_t c = 0; c < 4; ++c)
+            {
+                int32_t v = clamp_byte(endpoint[c]);
+                q[c] = static_cast<uint32_t>(std::min(127, std::max(0, (v - int32_t(p) + 1) / 2)));
+                int32_t delta = int32_t((q[c] << 1) | p) - v;
+                error += static_cast<uint32_t>(delta * delta);
+            }
+            if(error < best_error)
+            {
+                best_error = error;
+                pbit = p;
+                memcpy(quantized, q, sizeof(q));
+            }
+        }
+    }
+
+    uint32_t bc7_mode6_try(const uint8_t block[64], const float e0[4], const float e1[4], uint8_t out[16], uint8_t indices[16])
+    {
+        uint32_t q[2][4] {};
+        uint32_t p[2] {};
+        quantize_bc7_endpoint(e0, q[0], p[0]);
+        quantize_bc7_endpoint(e1, q[1], p[1]);
+
+        uint8_t palette[16][4] {};
+        for( uint32_t i = 0; i < 16; ++i)
+            for( uint32_t c = 0; c < 4; ++c)
+                palette[i][c] = interpolate((q[0][c] << 1) | p[0], (q[1][c] << 1) | p[1], WEIGHTS_4[i]);
+
+        uint32_t error = choose_indices(block, 4, palette, 16, indices);
+
+        //note: the first index is stored without its top bit, swapping the endpoints mirrors the indices to clear it
+        if(indices[0] & 8u)
+        {
+            std::swap(q[0], q[1]);
+            std::swap(p[0], p[1]);
+            for( uint32_t i = 0; i < TEXELS; ++i)
+                indices[i] = static_cast<uint8_t>(15u - indices[i]);
+        }
+
+        bit_writer writer(out, 16);
+        writer.write(1u << 6, 7);
+        for( uint32_t c = 0; c < 4; ++c)
+        {
+            writer.write(q[0][c], 7);
+            writer.write(q[1][c], 7);
+        }
+        writer.write(p[0], 1);
+        writer.write(p[1], 1);
+        writer.write(indices[0], 3);
+        for( uint32_t i = 1; i < TEXELS; ++i)
+            writer.write(indices[i], 4);
+
+        return error;
+    }
+}
+
+uint32_t block_compression::get_block_bytes(format f)
+{
+    switch(f)
+    {
+        case format::BC1:
+        case format::BC4:
+        case format::ETC2_RGB8:
+            return 8;
+        case format::BC5:
+        case format::BC7:
+        case format::ETC2_RGBA8:
+        case format::ASTC_4X4:
+            return 16;
+        default:
+            EA_FAIL_MSG("unrecognized compressed format");
+    }
+    return 0;
+}
+
+size_t block_compression::get_compressed_size(format f, uint32_t width, uint32_t height)
+{
+    size_t blocks_x = (width + BLOCK_DIMENSION - 1) / BLOCK_DIMENSION;
+    size_t blocks_y = (height + BLOCK_DIMENSION - 1) / BLOCK_DIMENSION;
+    return blocks_x * blocks_y * get_block_bytes(f);
+}
+
+bool block_compression::can_encode(format f)
+{
+    return f == format::BC1 || f == format::BC4 || f == format::BC5 || f == format::BC7;
+}
+
+bool block_compression::can_decode(format f)
+{
+    return can_encode(f);
+}
+
+const char* block_compression::get_name(format f)
+{
+    static const char* names[] = { "bc1", "bc4", "bc5", "bc7", "etc2_rgb8", "etc2_rgba8", "astc_4x4" };
+    static_assert(sizeof(names) / sizeof(names[0]) == static_cast<size_t>(format::COUNT), "a format is missing its name");
+    return f < format::COUNT ? names[static_cast<uint32_t>(f)] : "unknown";
+}
+
+block_compression::format block_compression::get_format(const char* name)
+{
+    for( uint32_t f = 0; f < static_cast<uint32_t>(format::COUNT); ++f)
+    {
+        if(strcmp(name, get_name(static_cast<format>(f))) == 0)
+            return static_cast<format>(f);
+    }
+    return format::COUNT;
+}
+
+void block_compression::encode_bc1(const uint8_t block[64], uint8_t out[8])
+{
+    float e0[4] {}, e1[4] {};
+    principal_extremes(block, 3, e0, e1);
+
+    uint8_t indices[16] {};
+    uint32_t error = bc1_try(block, e0, e1, out, indices);
+
+    //note: one refinement pass, the endpoints are refit to the indices the extremes picked
+    uint16_t c0 = uint16_t(out[0] | (out[1] << 8));
+    uint16_t c1 = uint16_t(out[2] | (out[3] << 8));
+    if(c0 != c1)
+    {
+        static constexpr float T[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+        float weights[16] {};
+        for( uint32_t i = 0; i < TEXELS; ++i)
+            weights[i] = T[indices[i]];
+
+        float f0[4] {}, f1[4] {};
+        if(fit_endpoints(block, 3, weights, f0, f1))
+        {
+            uint8_t refined[8] {};
+            if(bc1_try(block, f0, f1, refined, indices) < error)
+                memcpy(out, refined, sizeof(refined));
+        }
+    }
+}
+
+void block_compression::encode_bc4(const uint8_t block[64], uint32_t channel, uint8_t out[8])
+{
+    uint8_t low = 255, high = 0;
+    for( uint32_t i = 0; i < TEXELS; ++i)
+    {
+        low = std::min(low, block[i * 4 + channel]);
+        high = std::max(high, block[i * 4 + channel]);
+    }
+
+    uint8_t palette[8] {};
+    bc4_palette(high, low, palette);
+
+    uint64_t bits = 0;
+    for( uint32_t i = 0; i < TEXELS && high != low; ++i)
+    {
+        uint32_t best = std::numeric_limits<uint32_t>::max();
+        uint64_t index = 0;
+        for( uint32_t p = 0; p < 8; ++p)
+        {
+            int32_t delta = int32_t(block[i * 4 + channel]) - int32_t(palette[p]);
+            if(static_cast<uint32_t>(delta * delta) < best)
+            {
+                best = static_cast<uint32_t>(delta * delta);
+                index = p;
+            }
+        }
+        bits |= index << (3 * i);
+    }
+
+    out[0] = high;
+    out[1] = low;
+    for( uint32_t b = 0; b < 6; ++b)
+        out[2 + b] = static_cast<uint8_t>((bits >> (8 * b)) & 0xff);
+}
+
+void block_compression::encode_bc5(const uint8_t block[64], uint8_t out[16])
+{
+    encode_bc4(block, 0, out);
+    encode_bc4(block, 1, out + 8);
+}
+
+void block_compression::encode_bc7(const uint8_t block[64], uint8_t out[16])
+{
+    float e0[4] {}, e1[4] {};
+    principal_extremes(block, 4, e0, e1);
+
+    uint8_t indices[16] {};
+    uint32_t error = bc7_mode6_try(block, e0, e1, out, indices);
+
+    float weights[16] {};
+    for( uint32_t i = 0; i < TEXELS; ++i)
+        weights[i] = WEIGHTS_4[indices[i]] / 64.0f;
+
+    float f0[4] {}, f1[4] {};
+    if(fit_endpoints(block, 4, weights, f0, f1))
+    {
+        uint8_t refined[16] {};
+        if(bc7_mode6_try(block, f0, f1, refined, indices) < error)
+            memcpy(out, refined, sizeof(refined));
+    }
+}
+
+void block_compression::decode_bc1(const uint8_t in[8], uint8_t block[64])
+{
+    uint16_t c0 = uint16_t(in[0] | (in[1] << 8));
+    uint16_t c1 = uint16_t(in[2] | (in[3] << 8));
+    uint32_t bits = uint32_t(in[4]) | (uint32_t(in[5]) << 8) | (uint32_t(in[6]) << 16) | (uint32_t(in[7]) << 24);
+
+    uint8_t palette[4][4] {};
+    bc1_palette(c0, c1, palette);
+    for( uint32_t i = 0; i < TEXELS; ++i)
+        memcpy(&block[i * 4], palette[(bits >> (2 * i)) & 3u], 4);
+}
+
+void block_compression::decode_bc4(const uint8_t in[8], uint32_t channel, uint8_t block[64])
+{
+    uint8_t palette[8] {};
+    bc4_palette(in[0], in[1], palette);
+
+    uint64_t bits = 0;
+    for( uint32_t b = 0; b < 6; ++b)
+        bits |= uint64_t(in[2 + b]) << (8 * b);
+
+    for( uint32_t i = 0; i < TEXELS; ++i)
+        block[i * 4 + channel] = palette[(bits >> (3 * i)) & 7u];
+}
+
+void block_compression::decode_bc5(const uint8_t in[16], uint8_t block[64])
+{
+    decode_bc4(in, 0, block);
+    decode_bc4(in + 8, 1, block);
+}
+
+void block_compression::decode_bc7(const uint8_t in[16], uint8_t block[64])
+{
+    bit_reader reader(in);
+
+    uint32_t mode = 0;
+    while(mode < 8 && reader.read(1) == 0)
+        ++mode;
+
+    //note: reserved mode, the specification decodes these as transparent black
+    if(mode == 8)
+    {
+        memset(block, 0, 64);
+        return;
+    }
+
+    const bc7_mode& m = BC7_MODES[mode];
+    uint32_t partition = reader.read(m.partition_bits);
+    uint32_t rotation = reader.read(m.rotation_bits);
+    uint32_t index_selection = reader.read(m.index_selection_bits);
+
+    uint32_t num_endpoints = m.subsets * 2u;
+    uint32_t endpoints[6][4] {};
+    for( uint32_t c = 0; c < 3; ++c)
+        for( uint32_t e = 0; e < num_endpoints; ++e)
+            endpoints[e][c] = reader.read(m.color_bits);
+    for( uint32_t e = 0; e < num_endpoints && m.alpha_bits != 0; ++e)
+        endpoints[e][3] = reader.read(m.alpha_bits);
+
+    uint32_t pbits[6] {};
+    bool has_pbits = m.endpoint_pbits != 0 || m.shared_pbits != 0;
+    if(m.endpoint_pbits)
+    {
+        for( uint32_t e = 0; e < num_endpoints; ++e)
+            pbits[e] = reader.read(1);
+    }
+    else if(m.shared_pbits)
+    {
+        for( uint32_t s = 0; s < m.subsets; ++s)
+            pbits[s * 2] = pbits[s * 2 + 1] = reader.read(1);
+    }
+
+    //note: p bits are the lowest bit of every channel, then the top bits are repeated below to reach 8 bits
+    for( uint32_t e = 0; e < num_endpoints; ++e)
+    {
+        for( uint32_t c = 0; c < 4; ++c)
+        {
+            uint32_t bits = c < 3 ? m.color_bits : m.alpha_bits;
+            if(bits == 0)
+            {
+                endpoints[e][c] = 255;
+                continue;
+            }
+            uint32_t v = endpoints[e][c];
+            if(has_pbits)
+            {
+                v = (v << 1) | pbits[e];
+                ++bits;
+            }
+            v <<= (8u - bits);
+            endpoints[e][c] = v | (v >> bits);
+        }
+    }
+
+    uint8_t subsets[16] {};
+    bool anchors[16] {};
+    anchors[0] = true;
+    for( uint32_t i = 0; i < TEXELS; ++i)
+        subsets[i] = m.subsets == 2 ? BC7_PARTITIONS_2[partition][i] : m.subsets == 3 ? BC7_PARTITIONS_3[partition][i] : 0;
+    if(m.subsets == 2)
+    {
+        anchors[BC7_ANCHORS_2[partition]] = true;
+    }
+    else if(m.subsets == 3)
+    {
+        anchors[BC7_ANCHORS_3_SECOND[partition]] = true;
+        anchors[BC7_ANCHORS_3_THIRD[partition]] = true;
+    }
+
+    uint32_t indices[16] {};
+    uint32_t indices2[16] {};
+    for( uint32_t i = 0; i < TEXELS; ++i)
+        indices[i] = reader.read(m.index_bits - (anchors[i] ? 1u : 0u));
+    for( uint32_t i = 0; i < TEXELS && m.index_bits2 != 0; ++i)
+        indices2[i] = reader.read(m.index_bits2 - (i == 0 ? 1u : 0u));
+
+    for( uint32_t i = 0; i < TEXELS; ++i)
+    {
+        uint32_t color_weight = weight_of(m.index_bits, indices[i]);
+        uint32_t alpha_weight = color_weight;
+        if(m.index_bits2 != 0)
+        {
+            uint32_t secondary = weight_of(m.index_bits2, indices2[i]);
+            color_weight = index_selection ? secondary : color_weight;
+            alpha_weight = index_selection ? alpha_weight : secondary;
+        }
+
+        const uint32_t* e0 = endpoints[subsets[i] * 2];
+        const uint32_t* e1 = endpoints[subsets[i] * 2 + 1];
+        uint8_t* texel = &block[i * 4];
+        for( uint32_t c = 0; c < 3; ++c)
+            texel[c] = interpolate(e0[c], e1[c], color_weight);
+        texel[3] = m.alpha_bits != 0 ? interpolate(e0[3], e1[3], alpha_weight) : 255;
+
+        if(rotation != 0)
+            std::swap(texel[3], texel[rotation - 1]);
+    }
+}
+
+void block_compression::compress_image(format f, const uint8_t* rgba, uint32_t width, uint32_t height, uint8_t* blocks)
+{
+    EA_ASSERT_MSG(can_encode(f), "there is no encoder for this format");
+
+    uint32_t block_bytes = get_block_bytes(f);
+    uint8_t block[64] {};
+    for( uint32_t by = 0; by < height; by += BLOCK_DIMENSION)
+    {
+        for( uint32_t bx = 0; bx < width; bx += BLOCK_DIMENSION)
+        {
+            for( uint32_t y = 0; y < BLOCK_DIMENSION; ++y)
+            {
+                for( uint32_t x = 0; x < BLOCK_DIMENSION; ++x)
+                {
+                    size_t sx = std::min(bx + x, width - 1);
+                    size_t sy = std::min(by + y, height - 1);
+                    memcpy(&block[(y * BLOCK_DIMENSION + x) * 4], &rgba[(sy * width + sx) * 4], 4);
+                }
+            }
+
+            switch(f)
+            {
+                case format::BC1: encode_bc1(block, blocks); break;
+                case format::BC4: encode_bc4(block, 0, blocks); break;
+                case format::BC5: encode_bc5(block, blocks); break;
+                case format::BC7: encode_bc7(block, blocks); break;
+                default: break;
+            }
+            blocks += block_bytes;
+        }
+    }
+}
+
+void block_compression::decompress_image(format f, const uint8_t* blocks, uint32_t width, uint32_t height, uint8_t* rgba)
+{
+    EA_ASSERT_MSG(can_decode(f), "there is no decoder for this format");
+
+    uint32_t block_bytes = get_block_bytes(f);
+    uint8_t block[64] {};
+    for( uint32_t by = 0; by < height; by += BLOCK_DIMENSION)
+    {
+        for( uint32_t bx = 0; bx < width; bx += BLOCK_DIMENSION)
+        {
+            for( uint32_t i = 0; i < TEXELS; ++i)
+            {
+                block[i * 4 + 0] = block[i * 4 + 1] = block[i * 4 + 2] = 0;
+                block[i * 4 + 3] = 255;
+            }
+
+            switch(f)
+            {
+                case format::BC1: decode_bc1(blocks, block); break;
+                case format::BC4: decode_bc4(blocks, 0, block); break;
+                case format::BC5: decode_bc5(blocks, block); break;
+                case format::BC7: decode_bc7(blocks, block); break;
+                default: break;
+            }
+            blocks += block_bytes;
+
+            for( uint32_t y = 0; y < BLOCK_DIMENSION && by + y < height; ++y)
+            {
+                for( uint32_t x = 0; x < BLOCK_DIMENSION && bx + x < width; ++x)
+                {
+                    memcpy(&rgba[(size_t(by + y) * width + bx + x) * 4], &block[(y * BLOCK_DIMENSION + x) * 4], 4);
+                }
+            }
+        }
+    }
+}
+
+float block_compression::psnr(const uint8_t* a, const uint8_t* b, size_t texels, uint32_t channels)
+{
+    double sum = 0.0;
+    for( size_t i = 0; i < texels; ++i)
+        sum += squared_distance(&a[i * 4], &b[i * 4], channels);
+
+    double mse = sum / double(texels * channels);
+    if(mse == 0.0)
+        return std::numeric_limits<float>::infinity();
+    return static_cast<float>(10.0 * std::log10(255.0 * 255.0 / mse));
+}
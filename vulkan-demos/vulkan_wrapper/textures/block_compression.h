@@ -0,0 +1,75 @@
+//
+//  block_compression.h
+//  vulkan-demos
+//
+//  Created by Rafael Sabino on 10/19/26.
+//  Copyright © 2026 Rafael Sabino. All rights reserved.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace vk
+{
+    //note: cpu side of compressed textures.  Every format here stores 4x4 texel blocks in 8 or 16 bytes, the gpu samples them
+    //directly so a texture costs 0.5 or 1 byte per texel instead of the 4 of RGBA8.
+    //
+    //BC1: rgb, 8 bytes per block.  Albedo without alpha, masks
+    //BC4: one channel, 8 bytes.  Roughness, metalness, ambient occlusion
+    //BC5: two channels, 16 bytes.  Tangent space normals whose z is rebuilt in the shader
+    //BC7: rgba, 16 bytes.  Everything else, best quality of the four
+    //
+    //the encoders are here for the offline conversion in texture_container, they favour simplicity over quality, BC7 blocks
+    //are always written in mode 6.  The decoders read every BC7 mode and are used when a device cannot sample a format and
+    //to check the encoders.  ETC2 and ASTC can be stored in a container and uploaded, there is no encoder or decoder for them
+    class block_compression
+    {
+    public:
+
+        enum class format : uint32_t
+        {
+            BC1 = 0,
+            BC4,
+            BC5,
+            BC7,
+            ETC2_RGB8,
+            ETC2_RGBA8,
+            ASTC_4X4,
+            COUNT
+        };
+
+        static constexpr uint32_t BLOCK_DIMENSION = 4u;
+
+        static uint32_t get_block_bytes(format f);
+        static size_t get_compressed_size(format f, uint32_t width, uint32_t height);
+
+        static bool can_encode(format f);
+        static bool can_decode(format f);
+
+        //note: rgba is width * height RGBA8 texels, the block size of f times the number of blocks is written to blocks.  Edges
+        //of images that are not a multiple of 4 repeat their last row and column
+        static void compress_image(format f, const uint8_t* rgba, uint32_t width, uint32_t height, uint8_t* blocks);
+
+        //note: always writes RGBA8, channels a format lacks read as a gpu would sample them: 0 for green and blue, 255 for alpha
+        static void decompress_image(format f, const uint8_t* blocks, uint32_t width, uint32_t height, uint8_t* rgba);
+
+        //peak signal to noise ratio in dB over the first channels of every texel of two RGBA8 images
+        static float psnr(const uint8_t* a, const uint8_t* b, size_t texels, uint32_t channels);
+
+        static const char* get_name(format f);
+        //returns format::COUNT if the name is not recognized
+        static format get_format(const char* name);
+
+        static void encode_bc1(const uint8_t block[64], uint8_t out[8]);
+        static void encode_bc4(const uint8_t block[64], uint32_t channel, uint8_t out[8]);
+        static void encode_bc5(const uint8_t block[64], uint8_t out[16]);
+        static void encode_bc7(const uint8_t block[64], uint8_t out[16]);
+
+        static void decode_bc1(const uint8_t in[8], uint8_t block[64]);
+        static void decode_bc4(const uint8_t in[8], uint32_t channel, uint8_t block[64]);
+        static void decode_bc5(const uint8_t in[16], uint8_t block[64]);
+        static void decode_bc7(const uint8_t in[16], uint8_t block[64]);
+    };
+}
@@ -7,6 +7,7 @@
 //
 
 #include "depth_texture.h"
+#include "texture_cache.h"
 
 using namespace vk;
 
@@ -23,7 +24,8 @@ void depth_texture::create(uint32_t width, uint32_t height)
         _aspect_flag = static_cast< image::formats>(VK_FORMAT_D32_SFLOAT) != _format ?  (VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT) : VK_IMAGE_ASPECT_DEPTH_BIT;
 
         
-        VkImageUsageFlagBits usage_flags = _write_to_texture ? static_cast<VkImageUsageFlagBits>(VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT  | VK_IMAGE_USAGE_SAMPLED_BIT) :
+        //note: depth that is written to a texture can still be read as an input attachment by later passes
+        VkImageUsageFlagBits usage_flags = _write_to_texture ? static_cast<VkImageUsageFlagBits>(VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT  | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT) :
                                 static_cast<VkImageUsageFlagBits>(VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT);
         
         create_image( depth_format,
@@ -55,8 +57,7 @@ void depth_texture::create_sampler()
     sampler_create_info.maxLod = 1.0f;
     sampler_create_info.borderColor = VK_BORDER_COLOR_FLOAT_OPAQUE_WHITE;
     
-    VkResult result = vkCreateSampler(_device->_logical_device, &sampler_create_info, nullptr, &_sampler);
-    ASSERT_VULKAN(result);
+    _sampler = _device->get_texture_cache().acquire_sampler(sampler_create_info);
 }
 
 void depth_texture::init()
@@ -85,7 +86,7 @@ void depth_texture::destroy()
         vkDestroyImageView(_device->_logical_device, _image_view, nullptr);
         vkDestroyImage(_device->_logical_device, _image, nullptr);
         vkFreeMemory(_device->_logical_device, _image_memory, nullptr);
-        vkDestroySampler(_device->_logical_device, _sampler, nullptr);
+        _device->get_texture_cache().release_sampler(_sampler);
         _created = false;
         _image = VK_NULL_HANDLE;
         _image_memory = VK_NULL_HANDLE;
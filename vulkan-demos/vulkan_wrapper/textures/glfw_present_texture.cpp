@@ -7,6 +7,7 @@
 //
 
 #include "glfw_present_texture.h"
+#include "texture_cache.h"
 #include "glfw_swapchain.h"
 #include <array>
 
@@ -33,7 +34,7 @@ void glfw_present_texture::init()
     device::swapchain_support_details swapchain_support {};
     _device->query_swapchain_support( _device->_physical_device, _swapchain->get_vk_surface(), swapchain_support);
     
-    VkExtent2D extent = _swapchain->get_vk_swap_extent(swapchain_support.capabilities, *_window);
+    VkExtent2D extent = _swapchain->get_vk_swap_extent(swapchain_support.capabilities, _window);
     
     _width = extent.width;
     _height = extent.height;
@@ -90,8 +91,7 @@ void glfw_present_texture::create_sampler()
     sampler_create_info.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
     sampler_create_info.unnormalizedCoordinates = VK_FALSE;
     
-    VkResult result = vkCreateSampler(_device->_logical_device, &sampler_create_info, nullptr, &_sampler);
-    ASSERT_VULKAN(result);
+    _sampler = _device->get_texture_cache().acquire_sampler(sampler_create_info);
 }
 
 void glfw_present_texture::create_image_view(VkImage image, VkFormat format, VkImageView& image_view)
@@ -120,7 +120,7 @@ void glfw_present_texture::create_image_view(VkImage image, VkFormat format, VkI
 
 void glfw_present_texture::destroy()
 {
-    vkDestroySampler(_device->_logical_device, _sampler, nullptr);
+    _device->get_texture_cache().release_sampler(_sampler);
     vkDestroyImageView(_device->_logical_device, _image_view, nullptr);
     
     //note: the images are destroyed when destroying the swapchain, no need to call this here
@@ -7,6 +7,7 @@
 //
 
 #include "image.h"
+#include "texture_cache.h"
 
 using namespace vk;
 
@@ -243,7 +244,7 @@ void image::write_buffer_to_image(VkCommandPool commandPool, VkQueue queue, VkBu
 
 void image::destroy()
 {
-    vkDestroySampler(_device->_logical_device, _sampler, nullptr);
+    _device->get_texture_cache().release_sampler(_sampler);
     vkDestroyImageView(_device->_logical_device, _image_view, nullptr);
     vkDestroyImage(_device->_logical_device, _image, nullptr);
     vkFreeMemory(_device->_logical_device, _image_memory, nullptr);
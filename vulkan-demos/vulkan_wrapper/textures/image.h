@@ -134,7 +134,14 @@ namespace vk
             DEPTH_32_STENCIL_8 = VK_FORMAT_D32_SFLOAT_S8_UINT,
             DEPTH_24_STENCIL_8 = VK_FORMAT_D24_UNORM_S8_UINT,
             R8G8_SIGNED_NORMALIZED =  VK_FORMAT_R8G8_SNORM,
-            R32_UINT = VK_FORMAT_R32_UINT
+            R32_UINT = VK_FORMAT_R32_UINT,
+            BC1_RGB_UNSIGNED_NORMALIZED = VK_FORMAT_BC1_RGB_UNORM_BLOCK,
+            BC4_UNSIGNED_NORMALIZED = VK_FORMAT_BC4_UNORM_BLOCK,
+            BC5_UNSIGNED_NORMALIZED = VK_FORMAT_BC5_UNORM_BLOCK,
+            BC7_UNSIGNED_NORMALIZED = VK_FORMAT_BC7_UNORM_BLOCK,
+            ETC2_R8G8B8_UNSIGNED_NORMALIZED = VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK,
+            ETC2_R8G8B8A8_UNSIGNED_NORMALIZED = VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK,
+            ASTC_4X4_UNSIGNED_NORMALIZED = VK_FORMAT_ASTC_4x4_UNORM_BLOCK
         };
         
         enum class image_layouts
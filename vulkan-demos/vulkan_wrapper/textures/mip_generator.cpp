@@ -0,0 +1,337 @@
+//
+//  mip_generator.cpp
+//  vulkan-demos
+//
+//  Created by Rafael Sabino on 10/19/26.
+//  Copyright © 2026 Rafael Sabino. All rights reserved.
+//
+
+#include "mip_generator.h"
+#include "shader.h"
+#include "EASTL/algorithm.h"
+#include <algorithm>
+#include <cstring>
+
+using namespace vk;
+
+namespace
+{
+    //note: formats a level can be read from and written to in mip_downsample.comp, and the qualifier it is compiled with
+    struct format_qualifier
+    {
+        VkFormat    format;
+        const char* qualifier;
+    };
+
+    const format_qualifier qualifiers[] =
+    {
+        { VK_FORMAT_R8G8B8A8_UNORM,         "rgba8" },
+        { VK_FORMAT_R8G8B8A8_SNORM,         "rgba8_snorm" },
+        { VK_FORMAT_R8_UNORM,               "r8" },
+        { VK_FORMAT_R16G16B16A16_UNORM,     "rgba16" },
+        { VK_FORMAT_R16G16B16A16_SFLOAT,    "rgba16f" },
+        { VK_FORMAT_R32G32B32A32_SFLOAT,    "rgba32f" },
+        { VK_FORMAT_R32G32_SFLOAT,          "rg32f" },
+        { VK_FORMAT_R32_SFLOAT,             "r32f" }
+    };
+
+    struct push_constants
+    {
+        int32_t base_size[2];
+        int32_t num_levels;
+        int32_t filter_mode;
+        int32_t num_groups;
+    };
+}
+
+void mip_generator::create_layouts()
+{
+    VkDescriptorSetLayoutBinding bindings[2] = {};
+    bindings[0].binding = 0;
+    bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    bindings[0].descriptorCount = LEVELS_PER_PASS + 1;
+    bindings[0].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    bindings[1].binding = 1;
+    bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    bindings[1].descriptorCount = 1;
+    bindings[1].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    VkDescriptorSetLayoutCreateInfo layout_info {};
+    layout_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layout_info.bindingCount = 2;
+    layout_info.pBindings = bindings;
+    VkResult result = vkCreateDescriptorSetLayout(_device->_logical_device, &layout_info, nullptr, &_descriptor_set_layout);
+    ASSERT_VULKAN(result);
+
+    VkPushConstantRange push_range {};
+    push_range.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    push_range.offset = 0;
+    push_range.size = sizeof(push_constants);
+
+    VkPipelineLayoutCreateInfo pipeline_layout_info {};
+    pipeline_layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipeline_layout_info.setLayoutCount = 1;
+    pipeline_layout_info.pSetLayouts = &_descriptor_set_layout;
+    pipeline_layout_info.pushConstantRangeCount = 1;
+    pipeline_layout_info.pPushConstantRanges = &push_range;
+    result = vkCreatePipelineLayout(_device->_logical_device, &pipeline_layout_info, nullptr, &_pipeline_layout);
+    ASSERT_VULKAN(result);
+
+    VkDescriptorPoolSize pool_sizes[2] = {};
+    pool_sizes[0].type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    pool_sizes[0].descriptorCount = MAX_SETS * (LEVELS_PER_PASS + 1);
+    pool_sizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    pool_sizes[1].descriptorCount = MAX_SETS;
+
+    VkDescriptorPoolCreateInfo pool_info {};
+    pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    pool_info.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+    pool_info.maxSets = MAX_SETS;
+    pool_info.poolSizeCount = 2;
+    pool_info.pPoolSizes = pool_sizes;
+    result = vkCreateDescriptorPool(_device->_logical_device, &pool_info, nullptr, &_descriptor_pool);
+    ASSERT_VULKAN(result);
+
+    _counters.set_device(_device);
+    _counters.create(sizeof(uint32_t) * MAX_LAYERS, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    memset(_counters.get_mapped_memory(), 0, sizeof(uint32_t) * MAX_LAYERS);
+}
+
+mip_generator::variant* mip_generator::find_variant(VkFormat format)
+{
+    for( size_t i = 0; i < _variants.size() && i < sizeof(qualifiers) / sizeof(qualifiers[0]); ++i)
+    {
+        if(qualifiers[i].format == format)
+        {
+            _variants[i].format = format;
+            _variants[i].qualifier = qualifiers[i].qualifier;
+            return &_variants[i];
+        }
+    }
+    return nullptr;
+}
+
+bool mip_generator::can_generate(VkFormat format)
+{
+    return find_variant(format) != nullptr &&
+           _device->is_format_supported(format, VK_IMAGE_TILING_OPTIMAL, VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT);
+}
+
+//note: the same shader for every format, only the qualifier of the images changes
+VkPipeline mip_generator::get_pipeline(variant& v)
+{
+    if(v.pipeline != VK_NULL_HANDLE)
+        return v.pipeline;
+
+    eastl::fixed_string<char, 250> path = resource::resource_root + shader::shaderResourcePath + "compute/mip_downsample.comp";
+    std::string text;
+    read_file(text, path);
+
+    size_t version_end = text.find('\n');
+    EA_ASSERT_MSG(version_end != std::string::npos, "mip_downsample.comp has to start with its #version line");
+    text.insert(version_end + 1, std::string("#define FORMAT ") + v.qualifier + "\n");
+
+    shader compute_shader {};
+    compute_shader._device = _device;
+    compute_shader.init(text.c_str(), shader::shader_type::COMPUTE);
+
+    VkComputePipelineCreateInfo pipeline_info {};
+    pipeline_info.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipeline_info.stage = compute_shader._pipeline_shader_stage;
+    pipeline_info.layout = _pipeline_layout;
+    VkResult result = vkCreateComputePipelines(_device->_logical_device, VK_NULL_HANDLE, 1, &pipeline_info, nullptr, &v.pipeline);
+    ASSERT_VULKAN(result);
+
+    compute_shader.destroy();
+    return v.pipeline;
+}
+
+mip_generator::target& mip_generator::get_target(VkImage image, VkFormat format, uint32_t layers, uint32_t levels)
+{
+    for( target& t : _targets)
+    {
+        if(t.image == image)
+        {
+            EA_ASSERT_MSG(t.views.size() == levels, "the image changed its number of levels without being forgotten");
+            return t;
+        }
+    }
+
+    _targets.emplace_back();
+    target& t = _targets.back();
+    t.image = image;
+
+    for( uint32_t level = 0; level < levels; ++level)
+    {
+        VkImageViewCreateInfo view_info {};
+        view_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        view_info.image = image;
+        view_info.viewType = VK_IMAGE_VIEW_TYPE_2D_ARRAY;
+        view_info.format = format;
+        view_info.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, level, 1, 0, layers };
+
+        VkImageView view = VK_NULL_HANDLE;
+        VkResult result = vkCreateImageView(_device->_logical_device, &view_info, nullptr, &view);
+        ASSERT_VULKAN(result);
+        t.views.push_back(view);
+    }
+
+    for( uint32_t base = 0; base + 1 < levels; base += LEVELS_PER_PASS)
+    {
+        VkDescriptorSetAllocateInfo allocate_info {};
+        allocate_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocate_info.descriptorPool = _descriptor_pool;
+        allocate_info.descriptorSetCount = 1;
+        allocate_info.pSetLayouts = &_descriptor_set_layout;
+
+        VkDescriptorSet set = VK_NULL_HANDLE;
+        VkResult result = vkAllocateDescriptorSets(_device->_logical_device, &allocate_info, &set);
+        EA_ASSERT_MSG(result == VK_SUCCESS, "out of mip generator descriptor sets, increase MAX_SETS");
+
+        //note: elements past the last level repeat it, the shader never writes to them but every element must be valid
+        eastl::array<VkDescriptorImageInfo, LEVELS_PER_PASS + 1> image_infos {};
+        for( uint32_t i = 0; i < image_infos.size(); ++i)
+        {
+            image_infos[i].imageView = t.views[std::min(base + i, levels - 1)];
+            image_infos[i].imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+        }
+
+        VkDescriptorBufferInfo buffer_info {};
+        buffer_info.buffer = _counters.get_vk_buffer();
+        buffer_info.offset = 0;
+        buffer_info.range = VK_WHOLE_SIZE;
+
+        VkWriteDescriptorSet writes[2] = {};
+        writes[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[0].dstSet = set;
+        writes[0].dstBinding = 0;
+        writes[0].descriptorCount = static_cast<uint32_t>(image_infos.size());
+        writes[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        writes[0].pImageInfo = image_infos.data();
+        writes[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[1].dstSet = set;
+        writes[1].dstBinding = 1;
+        writes[1].descriptorCount = 1;
+        writes[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        writes[1].pBufferInfo = &buffer_info;
+        vkUpdateDescriptorSets(_device->_logical_device, 2, writes, 0, nullptr);
+
+        t.sets.push_back(set);
+    }
+    return t;
+}
+
+void mip_generator::record(VkCommandBuffer command_buffer, VkImage image, VkFormat format, uint32_t width, uint32_t height,
+                           uint32_t layers, uint32_t levels, mip_filter filter)
+{
+    EA_ASSERT_MSG(can_generate(format), "check can_generate before asking for the mips of an image");
+    EA_ASSERT(levels > 1 && levels <= MAX_LEVELS && layers != 0 && layers <= MAX_LAYERS);
+
+    if(_pipeline_layout == VK_NULL_HANDLE)
+        create_layouts();
+
+    VkPipeline pipeline = get_pipeline(*find_variant(format));
+    target& t = get_target(image, format, layers, levels);
+
+    //note: the copy that filled level 0 has to land before the shader reads it, and the counters of whatever dispatch ran
+    //before this one have to be back to 0.  One barrier takes every level to the layout the shader uses
+    VkImageMemoryBarrier barrier {};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.image = image;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, levels, 0, layers };
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+    VkMemoryBarrier counter_barrier {};
+    counter_barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    counter_barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    counter_barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+    vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &counter_barrier, 0, nullptr, 1, &barrier);
+
+    vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+
+    uint32_t pass = 0;
+    for( uint32_t base = 0; base + 1 < levels; base += LEVELS_PER_PASS, ++pass)
+    {
+        //note: the level a pass starts from was written by the pass before it
+        if(pass != 0)
+        {
+            vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+                                 1, &counter_barrier, 0, nullptr, 0, nullptr);
+        }
+
+        uint32_t base_width = std::max(1u, width >> base);
+        uint32_t base_height = std::max(1u, height >> base);
+        uint32_t groups_x = (base_width + TILE_SIZE - 1) / TILE_SIZE;
+        uint32_t groups_y = (base_height + TILE_SIZE - 1) / TILE_SIZE;
+
+        push_constants constants {};
+        constants.base_size[0] = static_cast<int32_t>(base_width);
+        constants.base_size[1] = static_cast<int32_t>(base_height);
+        constants.num_levels = static_cast<int32_t>(std::min(LEVELS_PER_PASS, levels - 1 - base));
+        constants.filter_mode = static_cast<int32_t>(filter);
+        constants.num_groups = static_cast<int32_t>(groups_x * groups_y);
+
+        vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, _pipeline_layout, 0, 1, &t.sets[pass], 0, nullptr);
+        vkCmdPushConstants(command_buffer, _pipeline_layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(constants), &constants);
+        vkCmdDispatch(command_buffer, groups_x, groups_y, layers);
+    }
+
+    barrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+                         0, nullptr, 0, nullptr, 1, &barrier);
+}
+
+void mip_generator::forget(VkImage image)
+{
+    for( auto it = _targets.begin(); it != _targets.end(); ++it)
+    {
+        if(it->image != image)
+            continue;
+
+        for( VkImageView view : it->views)
+        {
+            vkDestroyImageView(_device->_logical_device, view, nullptr);
+        }
+        vkFreeDescriptorSets(_device->_logical_device, _descriptor_pool, static_cast<uint32_t>(it->sets.size()), it->sets.data());
+        _targets.erase(it);
+        return;
+    }
+}
+
+void mip_generator::destroy()
+{
+    while(!_targets.empty())
+    {
+        forget(_targets.back().image);
+    }
+
+    for( variant& v : _variants)
+    {
+        if(v.pipeline != VK_NULL_HANDLE)
+            vkDestroyPipeline(_device->_logical_device, v.pipeline, nullptr);
+        v.pipeline = VK_NULL_HANDLE;
+    }
+
+    if(_pipeline_layout != VK_NULL_HANDLE)
+    {
+        vkDestroyDescriptorPool(_device->_logical_device, _descriptor_pool, nullptr);
+        vkDestroyPipelineLayout(_device->_logical_device, _pipeline_layout, nullptr);
+        vkDestroyDescriptorSetLayout(_device->_logical_device, _descriptor_set_layout, nullptr);
+        _counters.destroy();
+    }
+    _descriptor_pool = VK_NULL_HANDLE;
+    _pipeline_layout = VK_NULL_HANDLE;
+    _descriptor_set_layout = VK_NULL_HANDLE;
+}
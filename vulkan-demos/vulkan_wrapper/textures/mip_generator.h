@@ -0,0 +1,101 @@
+//
+//  mip_generator.h
+//  vulkan-demos
+//
+//  Created by Rafael Sabino on 10/19/26.
+//  Copyright © 2026 Rafael Sabino. All rights reserved.
+//
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include "EASTL/array.h"
+#include "EASTL/fixed_vector.h"
+#include "EASTL/vector.h"
+#include "resource.h"
+#include "device.h"
+#include "storage_buffer.h"
+
+namespace vk
+{
+    //note: how the texels of a level are averaged into the level below it
+    enum class mip_filter
+    {
+        LINEAR = 0,
+        //color that was stored with the srgb curve in a unorm format, averaged in linear space
+        SRGB = 1,
+        //tangent space normals in 0 to 1, averaged as vectors and put back to unit length
+        NORMAL_MAP = 2
+    };
+
+    //note: builds the mip chain of an image with one compute dispatch for every 12 levels, see mip_downsample.comp.  Blits need
+    //linear filtering support for the format and a barrier for every level, this needs neither.  The image must have been
+    //created with VK_IMAGE_USAGE_STORAGE_BIT and every layer is reduced on its own, cube maps included.
+    //
+    //the image views and descriptor sets of an image are made the first time its mips are generated and kept until forget is
+    //called for it, render targets that refresh their mips every frame do not pay for them again
+    class mip_generator : public resource
+    {
+    public:
+
+        static constexpr uint32_t LEVELS_PER_PASS = 12u;
+        //note: texels of the first level of a pass a work group reduces, must match mip_downsample.comp
+        static constexpr uint32_t TILE_SIZE = 64u;
+        static constexpr uint32_t MAX_LEVELS = 16u;
+        static constexpr uint32_t MAX_LAYERS = 64u;
+        static constexpr uint32_t MAX_SETS = 512u;
+
+        mip_generator(){}
+        mip_generator(device* dev){ _device = dev; }
+
+        //note: false for formats that cannot be storage images on this device or that the shader has no qualifier for, those
+        //are left to the blits in texture_2d
+        bool can_generate(VkFormat format);
+
+        //note: level 0 of every layer holds the image and every level is in VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL.  All levels
+        //end up in VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+        void record(VkCommandBuffer command_buffer, VkImage image, VkFormat format, uint32_t width, uint32_t height,
+                    uint32_t layers, uint32_t levels, mip_filter filter);
+
+        //note: called when image is destroyed, frees its views and descriptor sets
+        void forget(VkImage image);
+
+        virtual void destroy() override;
+
+        virtual char const * const * get_instance_type() override { return (&_type); };
+        static char const * const *  get_class_type(){ return (&_type); }
+
+    private:
+
+        struct target
+        {
+            VkImage image = VK_NULL_HANDLE;
+            eastl::fixed_vector<VkImageView, MAX_LEVELS, false> views {};
+            //note: one per pass, element 0 of the set of a pass is the level it starts from
+            eastl::fixed_vector<VkDescriptorSet, 2, false> sets {};
+        };
+
+        struct variant
+        {
+            VkFormat    format = VK_FORMAT_UNDEFINED;
+            const char* qualifier = nullptr;
+            VkPipeline  pipeline = VK_NULL_HANDLE;
+        };
+
+        void create_layouts();
+        variant* find_variant(VkFormat format);
+        VkPipeline get_pipeline(variant& v);
+        target& get_target(VkImage image, VkFormat format, uint32_t layers, uint32_t levels);
+
+        static constexpr char const * _type = nullptr;
+
+        device*                 _device = nullptr;
+        VkDescriptorSetLayout   _descriptor_set_layout = VK_NULL_HANDLE;
+        VkPipelineLayout        _pipeline_layout = VK_NULL_HANDLE;
+        VkDescriptorPool        _descriptor_pool = VK_NULL_HANDLE;
+        storage_buffer          _counters {};
+
+        eastl::array<variant, 8> _variants {};
+        eastl::vector<target>   _targets {};
+    };
+}
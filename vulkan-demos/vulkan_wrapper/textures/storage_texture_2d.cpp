@@ -0,0 +1,156 @@
+//
+//  storage_texture_2d.cpp
+//  vulkan-demos
+//
+//  Created by Rafael Sabino on 10/19/26.
+//  Copyright © 2026 Rafael Sabino. All rights reserved.
+//
+
+#include "storage_texture_2d.h"
+#include "texture_cache.h"
+#include <cmath>
+
+using namespace vk;
+
+void storage_texture_2d::mip_view::destroy()
+{
+    //note: the parent texture owns the sampler and the image, only the view belongs to this level
+    if(_image_view != VK_NULL_HANDLE)
+        vkDestroyImageView(_device->_logical_device, _image_view, nullptr);
+
+    _image_view = VK_NULL_HANDLE;
+    _image = VK_NULL_HANDLE;
+    _sampler = VK_NULL_HANDLE;
+    _initialized = false;
+}
+
+void storage_texture_2d::init()
+{
+    if(!_initialized)
+    {
+        EA_ASSERT(_device != nullptr);
+        EA_ASSERT( _width != 0 && _height != 0);
+
+        _mip_levels = _enable_mipmapping ? static_cast<uint32_t>( std::floor(std::log2( std::max( _width, _height)))) + 1 : 1;
+        EA_ASSERT_MSG(_mip_levels <= MAX_MIP_LEVELS, "texture is too big, increase MAX_MIP_LEVELS");
+
+        create_sampler();
+        create_image(
+                     static_cast<VkFormat>(_format),
+                     VK_IMAGE_TILING_OPTIMAL,
+                     VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                     VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, false);
+
+        create_image_view(_image, static_cast<VkFormat>(_format), _image_view);
+
+        _mips.resize(_mip_levels);
+        for( uint32_t level = 0; level < _mip_levels; ++level)
+        {
+            mip_view& mip = _mips[level];
+            mip.set_device(_device);
+            mip._image = _image;
+            mip._sampler = _sampler;
+            mip._format = _format;
+            mip._width = get_mip_width(level);
+            mip._height = get_mip_height(level);
+            mip._image_layout = image_layouts::GENERAL;
+            mip._original_layout = image_layouts::GENERAL;
+            create_mip_view(level, mip._image_view);
+            mip._initialized = true;
+        }
+
+        change_layout(image_layouts::GENERAL);
+        _original_layout = image_layouts::GENERAL;
+
+        _initialized = true;
+    }
+}
+
+void storage_texture_2d::create_sampler()
+{
+    VkSamplerCreateInfo sampler_create_info {};
+
+    sampler_create_info.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    sampler_create_info.pNext = nullptr;
+    sampler_create_info.flags = 0;
+    sampler_create_info.magFilter = static_cast<VkFilter>(_filter);
+    sampler_create_info.minFilter = static_cast<VkFilter>(_filter);
+    sampler_create_info.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    sampler_create_info.addressModeU  = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    sampler_create_info.addressModeV =  VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    sampler_create_info.addressModeW =  VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    sampler_create_info.mipLodBias = 0.0f;
+    sampler_create_info.anisotropyEnable = VK_FALSE;
+    sampler_create_info.maxAnisotropy = 1;
+    sampler_create_info.compareEnable = VK_FALSE;
+    sampler_create_info.compareOp = VK_COMPARE_OP_ALWAYS;
+    sampler_create_info.minLod = 0.0f;
+    sampler_create_info.maxLod = static_cast<float>(_mip_levels);
+    sampler_create_info.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+    sampler_create_info.unnormalizedCoordinates = VK_FALSE;
+
+    _sampler = _device->get_texture_cache().acquire_sampler(sampler_create_info);
+}
+
+void storage_texture_2d::create_image_view( VkImage image, VkFormat format, VkImageView& image_view)
+{
+    VkImageViewCreateInfo image_view_create_info {};
+
+    image_view_create_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    image_view_create_info.pNext = nullptr;
+    image_view_create_info.flags = 0;
+    image_view_create_info.image = image;
+    image_view_create_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    image_view_create_info.format = format;
+    image_view_create_info.components.r = VK_COMPONENT_SWIZZLE_IDENTITY;
+    image_view_create_info.components.g = VK_COMPONENT_SWIZZLE_IDENTITY;
+    image_view_create_info.components.b = VK_COMPONENT_SWIZZLE_IDENTITY;
+    image_view_create_info.components.a = VK_COMPONENT_SWIZZLE_IDENTITY;
+    image_view_create_info.subresourceRange.aspectMask = _aspect_flag;
+    image_view_create_info.subresourceRange.baseMipLevel = 0;
+    image_view_create_info.subresourceRange.levelCount = _mip_levels;
+    image_view_create_info.subresourceRange.baseArrayLayer = 0;
+    image_view_create_info.subresourceRange.layerCount = 1;
+
+    VkResult result = vkCreateImageView(_device->_logical_device, &image_view_create_info, nullptr, &image_view);
+    ASSERT_VULKAN(result);
+}
+
+void storage_texture_2d::create_mip_view(uint32_t level, VkImageView& image_view)
+{
+    VkImageViewCreateInfo image_view_create_info {};
+
+    image_view_create_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    image_view_create_info.pNext = nullptr;
+    image_view_create_info.flags = 0;
+    image_view_create_info.image = _image;
+    image_view_create_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    image_view_create_info.format = static_cast<VkFormat>(_format);
+    image_view_create_info.components.r = VK_COMPONENT_SWIZZLE_IDENTITY;
+    image_view_create_info.components.g = VK_COMPONENT_SWIZZLE_IDENTITY;
+    image_view_create_info.components.b = VK_COMPONENT_SWIZZLE_IDENTITY;
+    image_view_create_info.components.a = VK_COMPONENT_SWIZZLE_IDENTITY;
+    image_view_create_info.subresourceRange.aspectMask = _aspect_flag;
+    image_view_create_info.subresourceRange.baseMipLevel = level;
+    image_view_create_info.subresourceRange.levelCount = 1;
+    image_view_create_info.subresourceRange.baseArrayLayer = 0;
+    image_view_create_info.subresourceRange.layerCount = 1;
+
+    VkResult result = vkCreateImageView(_device->_logical_device, &image_view_create_info, nullptr, &image_view);
+    ASSERT_VULKAN(result);
+}
+
+void storage_texture_2d::destroy()
+{
+    if(_initialized)
+    {
+        for( mip_view& mip : _mips)
+        {
+            mip.destroy();
+        }
+        _mips.clear();
+
+        image::destroy();
+        _initialized = false;
+    }
+}
@@ -0,0 +1,96 @@
+//
+//  storage_texture_2d.h
+//  vulkan-demos
+//
+//  Created by Rafael Sabino on 10/19/26.
+//  Copyright © 2026 Rafael Sabino. All rights reserved.
+//
+
+#pragma once
+
+#include "image.h"
+#include "EASTL/fixed_vector.h"
+
+namespace vk
+{
+    //note: a 2d texture that compute shaders write to, it always lives in the GENERAL layout.  Each mip level can be bound on its own
+    //through get_mip, which is how mip chains (depth pyramids, downsamples...) get built one level at a time.
+    class storage_texture_2d : public image
+    {
+    public:
+
+        static constexpr uint32_t MAX_MIP_LEVELS = 16u;
+
+        //note: a view to a single mip level of a storage_texture_2d, it does not own the vulkan image or the sampler
+        class mip_view : public image
+        {
+        public:
+            mip_view(){}
+
+            virtual image_layouts get_usage_layout( vk::usage_type usage) override
+            {
+                return image_layouts::GENERAL;
+            }
+
+            virtual void init() override {}
+            virtual void destroy() override;
+
+            virtual char const * const * get_instance_type() override { return (& _image_type); }
+            static char  const * const * get_class_type(){ return (& _image_type); }
+
+        private:
+            friend class storage_texture_2d;
+
+            static constexpr const char * _image_type = nullptr;
+
+            virtual void create_sampler() override {}
+            virtual void create_image_view( VkImage image, VkFormat format, VkImageView& image_view) override {}
+        };
+
+        storage_texture_2d(){}
+        storage_texture_2d(device* dev): image(dev){}
+        storage_texture_2d(device* dev, uint32_t width, uint32_t height):
+        image(dev)
+        {
+            _width = width;
+            _height = height;
+        }
+
+        inline void set_enable_mipmapping(bool b)
+        {
+            _enable_mipmapping = b;
+        }
+
+        inline mip_view& get_mip(uint32_t level)
+        {
+            EA_ASSERT_MSG(level < _mips.size(), "mip level does not exist, did you call set_enable_mipmapping before init?");
+            return _mips[level];
+        }
+
+        inline uint32_t get_num_mips(){ return static_cast<uint32_t>(_mips.size()); }
+        inline uint32_t get_mip_width(uint32_t level){ return eastl::max(_width >> level, 1u); }
+        inline uint32_t get_mip_height(uint32_t level){ return eastl::max(_height >> level, 1u); }
+
+        virtual image_layouts get_usage_layout( vk::usage_type usage) override
+        {
+            return image_layouts::GENERAL;
+        }
+
+        virtual void init() override;
+        virtual void destroy() override;
+
+        virtual char const * const * get_instance_type() override { return (& _image_type); }
+        static char  const * const * get_class_type(){ return (& _image_type); }
+
+    private:
+
+        static constexpr const char * _image_type = nullptr;
+
+        virtual void create_sampler() override;
+        virtual void create_image_view( VkImage image, VkFormat format, VkImageView& image_view) override;
+        void create_mip_view(uint32_t level, VkImageView& image_view);
+
+        bool _enable_mipmapping = false;
+        eastl::fixed_vector<mip_view, MAX_MIP_LEVELS, false> _mips {};
+    };
+}
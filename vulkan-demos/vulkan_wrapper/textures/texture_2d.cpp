@@ -7,8 +7,12 @@
 //
 
 #include "texture_2d.h"
+#include "asset_loader.h"
+#include "texture_streamer.h"
+#include "texture_cache.h"
 #include <assert.h>
 #include <cmath>
+#include <cstdio>
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
@@ -36,10 +40,32 @@ void texture_2d::init()
     {
         EA_ASSERT(_device != nullptr);
         _mip_levels = _enable_mipmapping ? static_cast<uint32_t>( std::floor(std::log2( std::max( _width, _height)))) + 1 : 1;
+        //note: containers come with their mip chain, it is used whether mip mapping was asked for or not
+        if(_container.is_open())
+        {
+            _mip_levels = _container.get_num_levels();
+        }
+        //note: streamed textures start with the end of their chain, see texture_streamer.h
+        if(_mip_streamed)
+        {
+            _resident_level = get_tail_level();
+            _mip_levels = _source_levels - _resident_level;
+        }
         create_sampler();
         EA_ASSERT( _width != 0 && _height != 0);
         create(_width, _height);
         
+        if(_mip_streamed)
+        {
+            _device->get_texture_streamer().add(this);
+        }
+        
+        //note: submitted here and not in the constructor, the workers build mip chains with the filter set before init
+        if(_streaming && !_requested)
+        {
+            _requested = true;
+            _device->get_asset_loader().submit(this, _path.c_str());
+        }
         _initialized = true;
     }
 }
@@ -48,24 +74,37 @@ texture_2d::texture_2d(device* device,const char* path)
 :image(device)
 {
     _path = resource::resource_root + texture_2d::texture_resource_path + path;
-    load(&_ppixels, _path.c_str());
+    if(!open_container() && !request_load())
+    {
+        load(&_ppixels, _path.c_str());
+    }
 }
 
-void texture_2d::load( stbi_uc ** pixels, const char* path)
+//note: only the header of the image is read here, that is enough to pick the format and size of the image.  Pixels are decoded
+//by the asset loader once the texture is initialized and copied in a later graph update, until then the image is cleared to the
+//placeholder color
+bool texture_2d::request_load()
 {
     int w = 0;
     int h = 0;
     int c = 0;
-    
-    _format = formats::R8G8B8A8_UNSIGNED_NORMALIZED;
-    _original_layout = _image_layout = image_layouts::PREINITIALIZED;
-    EA_ASSERT_MSG(_path.empty() == false, "texture path is empty");
-    *pixels = stbi_load(path, &w, &h, &c, STBI_default);
+    if(!asset_loader::is_enabled() || !stbi_info(_path.c_str(), &w, &h, &c))
+        return false;
     
     _width = static_cast<uint32_t>(w);
     _height = static_cast<uint32_t>(h);
-    _channels = static_cast<uint32_t>(c);
-    
+    set_format_from_channels(static_cast<uint32_t>(c));
+    _original_layout = _image_layout = image_layouts::PREINITIALIZED;
+    _streaming = true;
+    _mip_streamed = texture_streamer::is_enabled();
+    _source_levels = static_cast<uint32_t>( std::floor(std::log2( std::max( _width, _height)))) + 1;
+    return true;
+}
+
+void texture_2d::set_format_from_channels(uint32_t channels)
+{
+    _channels = channels;
+    _format = formats::R8G8B8A8_UNSIGNED_NORMALIZED;
     if(_channels == 3)
     {
         _format = formats::R8G8B8_UNSIGNED_NORMALIZED;
@@ -74,7 +113,53 @@ void texture_2d::load( stbi_uc ** pixels, const char* path)
     {
         _format = formats::R8_UNSIGNED_NORMALIZED;
     }
-    EA_ASSERT_FORMATTED(_channels != 2, ("2 channels in a texture are not supported in macs. %s", path));
+    EA_ASSERT_FORMATTED(_channels != 2, ("2 channels in a texture are not supported in macs. %s", _path.c_str()));
+}
+
+//note: a compressed copy of the image made with texture_container::convert is used instead of the image itself.  Formats the
+//device cannot sample are decoded on the cpu, formats that cannot be decoded either fall back to the source image
+bool texture_2d::open_container()
+{
+    eastl::fixed_string<char, 260> container_path = _path.c_str();
+    container_path += texture_container::EXTENSION;
+    if(!_container.open(container_path.c_str()))
+        return false;
+    
+    texture_container::format format = _container.get_format();
+    _compressed = _device->is_format_supported(texture_container::get_vk_format(format), VK_IMAGE_TILING_OPTIMAL,
+                                               VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT);
+    if(!_compressed && !block_compression::can_decode(format))
+    {
+        printf("%s is %s, the device cannot sample it, loading %s instead\n", container_path.c_str(),
+               block_compression::get_name(format), _path.c_str());
+        _container.close();
+        return false;
+    }
+    
+    _width = _container.get_width();
+    _height = _container.get_height();
+    _channels = _compressed ? texture_container::get_channels(format) : 4;
+    _format = _compressed ? static_cast<formats>(texture_container::get_vk_format(format)) : formats::R8G8B8A8_UNSIGNED_NORMALIZED;
+    _original_layout = _image_layout = image_layouts::PREINITIALIZED;
+    _source_levels = _container.get_num_levels();
+    _mip_streamed = texture_streamer::is_enabled() && _source_levels > 1;
+    
+    return true;
+}
+
+void texture_2d::load( stbi_uc ** pixels, const char* path)
+{
+    int w = 0;
+    int h = 0;
+    int c = 0;
+    
+    _original_layout = _image_layout = image_layouts::PREINITIALIZED;
+    EA_ASSERT_MSG(_path.empty() == false, "texture path is empty");
+    *pixels = stbi_load(path, &w, &h, &c, STBI_default);
+    
+    _width = static_cast<uint32_t>(w);
+    _height = static_cast<uint32_t>(h);
+    set_format_from_channels(static_cast<uint32_t>(c));
     EA_ASSERT_FORMATTED(*pixels != nullptr, ("Texture did not load:%s\n\n %s", path, stbi_failure_reason()));
     _loaded = true;
 }
@@ -98,17 +183,28 @@ void texture_2d::create_sampler()
     sampler_create_info.compareEnable = VK_FALSE;
     sampler_create_info.compareOp = VK_COMPARE_OP_ALWAYS;
     sampler_create_info.minLod = 0.0f;
-    sampler_create_info.maxLod = static_cast<float>(_mip_levels);
+    //note: the view already limits the levels that can be sampled, no clamp here lets textures of every size share one sampler
+    sampler_create_info.maxLod = VK_LOD_CLAMP_NONE;
     sampler_create_info.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
     sampler_create_info.unnormalizedCoordinates = VK_FALSE;
     
-    VkResult result = vkCreateSampler(_device->_logical_device, &sampler_create_info, nullptr, &_sampler);
-    ASSERT_VULKAN(result);
+    _sampler = _device->get_texture_cache().acquire_sampler(sampler_create_info);
 }
 void texture_2d::create(uint32_t width, uint32_t height)
 {
     
     EA_ASSERT(width != 0 && height != 0);
+    if(_container.is_open())
+    {
+        create_from_container();
+        return;
+    }
+    if(_streaming)
+    {
+        create_placeholder();
+        return;
+    }
+    
     _width = width;
     _height = height;
     _depth = _depth;
@@ -133,7 +229,7 @@ void texture_2d::create(uint32_t width, uint32_t height)
     create_image(
                  static_cast<VkFormat>(_format),
                  VK_IMAGE_TILING_OPTIMAL,
-                 VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                 get_upload_usage(),
                  VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, !_path.empty());
     
     
@@ -159,6 +255,369 @@ void texture_2d::create(uint32_t width, uint32_t height)
     _initialized = true;
 }
 
+//note: every level is copied in one submission, blocks go to the gpu as they are in the file.  Streamed textures only copy their
+//resident levels and keep the container mapped for the levels they stream in later
+void texture_2d::create_from_container()
+{
+    uint32_t num_levels = _container.get_num_levels();
+    
+    eastl::fixed_vector<VkBufferImageCopy, texture_container::MAX_LEVELS, false> regions {};
+    VkDeviceSize offset = 0;
+    for( uint32_t l = _resident_level; l < num_levels; ++l)
+    {
+        const texture_container::level& level = _container.get_level(l);
+        
+        VkBufferImageCopy region {};
+        region.bufferOffset = offset;
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.mipLevel = l - _resident_level;
+        region.imageSubresource.baseArrayLayer = 0;
+        region.imageSubresource.layerCount = 1;
+        region.imageOffset = { 0, 0, 0};
+        region.imageExtent = { level.width, level.height, 1};
+        regions.push_back(region);
+        offset += get_staging_size(l, l + 1);
+    }
+    
+    VkDeviceSize staging_size = get_staging_size(_resident_level, num_levels);
+    VkBuffer staging_buffer {};
+    VkDeviceMemory staging_buffer_memory {};
+    create_buffer(_device->_logical_device, _device->_physical_device, staging_size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                  staging_buffer, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, staging_buffer_memory);
+    
+    uint8_t* data = nullptr;
+    VkResult res = vkMapMemory(_device->_logical_device, staging_buffer_memory, 0, VK_WHOLE_SIZE, 0, reinterpret_cast<void**>(&data));
+    ASSERT_VULKAN(res);
+    write_levels(_resident_level, num_levels, data);
+    vkUnmapMemory(_device->_logical_device, staging_buffer_memory);
+    
+    create_image(
+                 static_cast<VkFormat>(_format),
+                 VK_IMAGE_TILING_OPTIMAL,
+                 VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, true);
+    
+    change_image_layout(_device->_graphics_command_pool, _device->_graphics_queue, _image, static_cast<VkFormat>(_format),
+                        VK_IMAGE_LAYOUT_PREINITIALIZED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+    
+    VkCommandBuffer command_buffer = _device->start_single_time_command_buffer(_device->_graphics_command_pool);
+    vkCmdCopyBufferToImage(command_buffer, staging_buffer, _image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                           static_cast<uint32_t>(regions.size()), regions.data());
+    _device->end_single_time_command_buffer(_device->_graphics_queue, _device->_graphics_command_pool, command_buffer);
+    
+    change_image_layout(_device->_graphics_command_pool, _device->_graphics_queue, _image, static_cast<VkFormat>(_format),
+                        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    
+    vkDestroyBuffer(_device->_logical_device, staging_buffer, nullptr);
+    vkFreeMemory(_device->_logical_device, staging_buffer_memory, nullptr);
+    
+    create_image_view(_image, static_cast<VkFormat>(_format), _image_view);
+    if(!_mip_streamed)
+    {
+        _container.close();
+    }
+    _initialized = true;
+}
+
+uint32_t texture_2d::get_tail_level()
+{
+    uint32_t level = 0;
+    while(level + 1 < _source_levels && (std::max(_width, _height) >> level) > texture_streamer::STREAM_TAIL_SIZE)
+        ++level;
+    return level;
+}
+
+VkDeviceSize texture_2d::get_level_bytes(uint32_t level)
+{
+    EA_ASSERT(level < _source_levels);
+    if(_container.is_open() && _compressed)
+        return _container.get_level(level).size;
+    
+    return VkDeviceSize(std::max(1u, _width >> level)) * std::max(1u, _height >> level) * _channels;
+}
+
+VkDeviceSize texture_2d::get_staging_size(uint32_t first_level, uint32_t last_level)
+{
+    //note: offsets of compressed copies have to be a multiple of the block size, 16 covers every format
+    VkDeviceSize size = 0;
+    for( uint32_t l = first_level; l < last_level; ++l)
+    {
+        size += (get_level_bytes(l) + 15) & ~VkDeviceSize(15);
+    }
+    return size;
+}
+
+void texture_2d::write_levels(uint32_t first_level, uint32_t last_level, uint8_t* destination)
+{
+    EA_ASSERT_MSG(has_level_data(), "this texture has no mip chain on the cpu");
+    
+    //note: the chain from the asset loader has its levels one after the other with no padding
+    size_t chain_offset = 0;
+    for( uint32_t l = 0; l < first_level && !_container.is_open(); ++l)
+    {
+        chain_offset += get_level_bytes(l);
+    }
+    
+    for( uint32_t l = first_level; l < last_level; ++l)
+    {
+        VkDeviceSize bytes = get_level_bytes(l);
+        if(_container.is_open())
+        {
+            const texture_container::level& level = _container.get_level(l);
+            if(_compressed)
+                memcpy(destination, level.data, level.size);
+            else
+                block_compression::decompress_image(_container.get_format(), level.data, level.width, level.height, destination);
+        }
+        else
+        {
+            memcpy(destination, _level_data.data() + chain_offset, bytes);
+            chain_offset += bytes;
+        }
+        destination += (bytes + 15) & ~VkDeviceSize(15);
+    }
+}
+
+void texture_2d::set_level_data(eastl::vector<uint8_t>&& chain)
+{
+    VkDeviceSize size = 0;
+    for( uint32_t l = 0; l < _source_levels; ++l)
+    {
+        size += get_level_bytes(l);
+    }
+    EA_ASSERT_MSG(chain.size() == size, "the chain does not match the size of the texture");
+    _level_data = eastl::move(chain);
+}
+
+//note: images whose mips are generated on the gpu are written by mip_downsample.comp as storage images
+VkImageUsageFlags texture_2d::get_upload_usage()
+{
+    VkImageUsageFlags usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    if(_mip_levels > 1 && !_mip_streamed && _device->get_mip_generator().can_generate(static_cast<VkFormat>(_format)))
+    {
+        usage |= VK_IMAGE_USAGE_STORAGE_BIT;
+    }
+    return usage;
+}
+
+void texture_2d::create_placeholder()
+{
+    create_image(
+                 static_cast<VkFormat>(_format),
+                 VK_IMAGE_TILING_OPTIMAL,
+                 get_upload_usage(),
+                 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, true);
+    
+    VkImageMemoryBarrier barrier {};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.image = _image;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = _mip_levels;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = 1;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_PREINITIALIZED;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    
+    VkCommandBuffer command_buffer = _device->start_single_time_command_buffer(_device->_graphics_command_pool);
+    vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+                         0, nullptr, 0, nullptr, 1, &barrier);
+    
+    VkClearColorValue color {};
+    color.float32[0] = _placeholder_color.r;
+    color.float32[1] = _placeholder_color.g;
+    color.float32[2] = _placeholder_color.b;
+    color.float32[3] = _placeholder_color.a;
+    vkCmdClearColorImage(command_buffer, _image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, &color, 1, &barrier.subresourceRange);
+    
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+                         0, nullptr, 0, nullptr, 1, &barrier);
+    _device->end_single_time_command_buffer(_device->_graphics_queue, _device->_graphics_command_pool, command_buffer);
+    
+    _image_layout = image_layouts::SHADER_READ_ONLY_OPTIMAL;
+    create_image_view(_image, static_cast<VkFormat>(_format), _image_view);
+    _initialized = true;
+}
+
+//note: recorded into a command buffer of the asset loader that is submitted between frames, frames already submitted may still
+//be sampling the placeholder so the image waits for their shaders before it is written
+void texture_2d::record_upload(VkCommandBuffer command_buffer, VkBuffer staging)
+{
+    EA_ASSERT_MSG(_streaming, "only textures the asset loader is loading can be uploaded to");
+    
+    VkImageMemoryBarrier barrier {};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.image = _image;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = _mip_levels;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = 1;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+    
+    //note: streamed textures get every resident level from the chain the workers built, the others only level 0
+    eastl::fixed_vector<VkBufferImageCopy, texture_container::MAX_LEVELS, false> regions {};
+    uint32_t first_level = _mip_streamed ? _resident_level : 0;
+    uint32_t last_level = _mip_streamed ? _source_levels : 1;
+    VkDeviceSize offset = 0;
+    for( uint32_t l = first_level; l < last_level; ++l)
+    {
+        VkBufferImageCopy region {};
+        region.bufferOffset = offset;
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.mipLevel = l - first_level;
+        region.imageSubresource.baseArrayLayer = 0;
+        region.imageSubresource.layerCount = 1;
+        region.imageOffset = { 0, 0, 0};
+        region.imageExtent = { std::max(1u, _width >> l), std::max(1u, _height >> l), 1};
+        regions.push_back(region);
+        offset += get_staging_size(l, l + 1);
+    }
+    vkCmdCopyBufferToImage(command_buffer, staging, _image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                           static_cast<uint32_t>(regions.size()), regions.data());
+    
+    if(_mip_levels == 1 || _mip_streamed)
+    {
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+                             0, nullptr, 0, nullptr, 1, &barrier);
+    }
+    else
+    {
+        generate_mipmaps(_image, command_buffer, _width, _height, _depth);
+    }
+    
+    _streaming = false;
+}
+
+texture_2d::retired_image texture_2d::record_residency(VkCommandBuffer command_buffer, uint32_t first_level, VkBuffer staging)
+{
+    EA_ASSERT_MSG(_mip_streamed && _initialized, "only streamed textures change their resident levels");
+    EA_ASSERT(first_level < _source_levels && first_level != _resident_level);
+    
+    retired_image old {};
+    old.image = _image;
+    old.memory = _image_memory;
+    old.view = _image_view;
+    uint32_t old_level = _resident_level;
+    uint32_t old_mip_levels = _mip_levels;
+    
+    _resident_level = first_level;
+    _mip_levels = _source_levels - first_level;
+    create_image(
+                 static_cast<VkFormat>(_format),
+                 VK_IMAGE_TILING_OPTIMAL,
+                 VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, false);
+    
+    VkImageMemoryBarrier barriers[2] = {};
+    for( VkImageMemoryBarrier& barrier : barriers)
+    {
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        barrier.subresourceRange.baseMipLevel = 0;
+        barrier.subresourceRange.baseArrayLayer = 0;
+        barrier.subresourceRange.layerCount = 1;
+    }
+    barriers[0].image = _image;
+    barriers[0].subresourceRange.levelCount = _mip_levels;
+    barriers[0].oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    barriers[0].newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barriers[0].srcAccessMask = 0;
+    barriers[0].dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    //note: frames already submitted may still be sampling the old image
+    barriers[1].image = old.image;
+    barriers[1].subresourceRange.levelCount = old_mip_levels;
+    barriers[1].oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barriers[1].newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barriers[1].srcAccessMask = 0;
+    barriers[1].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 2, barriers);
+    
+    eastl::fixed_vector<VkImageCopy, texture_container::MAX_LEVELS, false> copies {};
+    eastl::fixed_vector<VkBufferImageCopy, texture_container::MAX_LEVELS, false> regions {};
+    VkDeviceSize offset = 0;
+    for( uint32_t l = first_level; l < _source_levels; ++l)
+    {
+        VkExtent3D extent = { std::max(1u, _width >> l), std::max(1u, _height >> l), 1};
+        if(l >= old_level)
+        {
+            VkImageCopy copy {};
+            copy.srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, l - old_level, 0, 1};
+            copy.dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, l - first_level, 0, 1};
+            copy.extent = extent;
+            copies.push_back(copy);
+        }
+        else
+        {
+            VkBufferImageCopy region {};
+            region.bufferOffset = offset;
+            region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, l - first_level, 0, 1};
+            region.imageExtent = extent;
+            regions.push_back(region);
+            offset += get_staging_size(l, l + 1);
+        }
+    }
+    
+    if(!copies.empty())
+    {
+        vkCmdCopyImage(command_buffer, old.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, _image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                       static_cast<uint32_t>(copies.size()), copies.data());
+    }
+    if(!regions.empty())
+    {
+        EA_ASSERT_MSG(staging != VK_NULL_HANDLE, "levels above the old resident level come from the staging buffer");
+        vkCmdCopyBufferToImage(command_buffer, staging, _image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                               static_cast<uint32_t>(regions.size()), regions.data());
+    }
+    
+    barriers[0].oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barriers[0].newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barriers[0].srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barriers[0].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+                         0, nullptr, 0, nullptr, 1, barriers);
+    
+    create_image_view(_image, static_cast<VkFormat>(_format), _image_view);
+    return old;
+}
+
+//note: streamed textures are as large as their resident level
+VkImageCreateInfo texture_2d::get_image_create_info( VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage_flags)
+{
+    VkImageCreateInfo image_create_info = image::get_image_create_info(format, tiling, usage_flags);
+    if(_mip_streamed)
+    {
+        image_create_info.extent.width = std::max(1u, _width >> _resident_level);
+        image_create_info.extent.height = std::max(1u, _height >> _resident_level);
+    }
+    return image_create_info;
+}
+
 void texture_2d::create_image_view(VkImage image, VkFormat format, VkImageView& image_view)
 {
     VkImageViewCreateInfo image_view_create_info {};
@@ -190,18 +649,43 @@ void texture_2d::destroy()
         stbi_image_free(_ppixels);
         _loaded = false;
     }
+    _container.close();
+    
+    //note: the loader may still be decoding this texture or copying to its image
+    if(_requested)
+    {
+        _device->get_asset_loader().cancel(this);
+        _requested = false;
+        _streaming = false;
+    }
     
     if(_initialized)
     {
+        if(_mip_streamed)
+        {
+            _device->get_texture_streamer().remove(this);
+        }
+        _level_data.clear();
+        _device->get_mip_generator().forget(_image);
+        _device->get_texture_cache().forget_texture(this);
         image::destroy();
         _initialized = false;
     }
 }
 
 
+//note: every level is expected in VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL with level 0 written, depth is the number of layers.
+//Formats that can be storage images go through the mip generator, the rest are blitted one level at a time
 void texture_2d::generate_mipmaps(VkImage image, VkCommandBuffer& command_buffer,
                                    uint32_t width,  uint32_t height, uint32_t depth)
 {
+    mip_generator& generator = _device->get_mip_generator();
+    if(generator.can_generate(static_cast<VkFormat>(_format)))
+    {
+        generator.record(command_buffer, image, static_cast<VkFormat>(_format), width, height, depth, _mip_levels, _mip_filter);
+        return;
+    }
+    
     VkImageMemoryBarrier barrier = {};
     barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
     barrier.image = image;
@@ -209,10 +693,15 @@ void texture_2d::generate_mipmaps(VkImage image, VkCommandBuffer& command_buffer
     barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
     barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
     barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = depth;
+    barrier.subresourceRange.levelCount = 1;
+    
+    //note: formats without linear filtering are still blitted, with the nearest texel instead of an average
+    VkFilter filter = _device->is_format_supported(static_cast<VkFormat>(_format), VK_IMAGE_TILING_OPTIMAL,
+                                                   VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT) ? VK_FILTER_LINEAR : VK_FILTER_NEAREST;
     
     int32_t mip_width = width;
     int32_t mip_height = height;
-    int32_t mip_depth = depth;
     
     for (uint32_t i = 1; i < _mip_levels; i++) {
         
@@ -224,8 +713,6 @@ void texture_2d::generate_mipmaps(VkImage image, VkCommandBuffer& command_buffer
         barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
         barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
         barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-        barrier.subresourceRange.layerCount = mip_depth;
-        barrier.subresourceRange.levelCount = 1;
         
         vkCmdPipelineBarrier(command_buffer,
                              VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
@@ -233,65 +720,52 @@ void texture_2d::generate_mipmaps(VkImage image, VkCommandBuffer& command_buffer
                              0, nullptr,
                              1, &barrier);
         
-        //here we create the current mip level
+        //here we create the current mip level, every layer at once
         VkImageBlit blit = {};
         blit.srcOffsets[0] = {0, 0, 0};
         blit.srcOffsets[1] = {mip_width, mip_height, 1};
         blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
         blit.srcSubresource.mipLevel = i - 1;
-        //starting layer
         blit.srcSubresource.baseArrayLayer = 0;
-        //how many layers to copy
-        blit.srcSubresource.layerCount = mip_depth;
+        blit.srcSubresource.layerCount = depth;
         blit.dstOffsets[0] = {0, 0, 0};
         blit.dstOffsets[1] = { mip_width > 1 ? mip_width / 2 : 1, mip_height > 1 ? mip_height / 2 : 1, 1};
         
         blit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
         blit.dstSubresource.mipLevel = i;
         blit.dstSubresource.baseArrayLayer = 0;
-        blit.dstSubresource.layerCount = mip_depth > 1 ? mip_depth /2 : 1;
+        blit.dstSubresource.layerCount = depth;
         
         vkCmdBlitImage(command_buffer,
                        image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
                        image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
                        1, &blit,
-                       VK_FILTER_LINEAR);
-        
-        //transfer the base miplevel to shader optimal
-        
-        
-        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-        barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-        barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-        
-        //finally we switch the current mip level to VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT for shader sampling
-        vkCmdPipelineBarrier(command_buffer,
-                             VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
-                             0, nullptr,
-                             0, nullptr,
-                             1, &barrier);
+                       filter);
         
         if (mip_width > 1) mip_width /= 2;
         if (mip_height > 1) mip_height /= 2;
-        if (mip_depth > 1 ) mip_depth /= 2;
     }
     
-    for(uint32_t i = 0; i < _mip_levels; ++i)
-    {
-        barrier.subresourceRange.baseMipLevel = i;
-        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-        barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-        barrier.srcAccessMask = 0;
-        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-        
-        vkCmdPipelineBarrier(command_buffer,
-                             VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
-                             0, nullptr,
-                             0, nullptr,
-                             1, &barrier);
-
-    }
+    //note: every level but the last one was the source of a blit
+    VkImageMemoryBarrier final_barriers[2] = { barrier, barrier };
+    final_barriers[0].subresourceRange.baseMipLevel = 0;
+    final_barriers[0].subresourceRange.levelCount = _mip_levels - 1;
+    final_barriers[0].oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    final_barriers[0].newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    final_barriers[0].srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    final_barriers[0].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    final_barriers[1].subresourceRange.baseMipLevel = _mip_levels - 1;
+    final_barriers[1].subresourceRange.levelCount = 1;
+    final_barriers[1].oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    final_barriers[1].newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    final_barriers[1].srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    final_barriers[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    
+    vkCmdPipelineBarrier(command_buffer,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+                         0, nullptr,
+                         0, nullptr,
+                         2, final_barriers);
 }
 //the following code is based off of: https://vulkan-tutorial.com/Generating_Mipmaps
 void texture_2d::generate_mipmaps(VkImage image, VkCommandPool command_pool, VkQueue queue,
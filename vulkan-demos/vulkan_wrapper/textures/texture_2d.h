@@ -13,6 +13,9 @@
 
 #include "resource.h"
 #include "image.h"
+#include "texture_container.h"
+#include "mip_generator.h"
+#include "EASTL/vector.h"
 
 #include "stb_image.h"
 namespace vk
@@ -73,6 +76,7 @@ namespace vk
         void load(stbi_uc ** pixels, const char* path);
         
         virtual void create_image_view(VkImage image, VkFormat format, VkImageView& image_view) override;
+        virtual VkImageCreateInfo get_image_create_info( VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage_flags) override;
         virtual void init() override;
         
         virtual  char const * const * get_instance_type() override { return ( &_image_type); };
@@ -100,6 +104,79 @@ namespace vk
             _enable_mipmapping = b;
         }
         
+        //note: what a texture loaded by the asset loader samples as until its pixels arrive
+        inline void set_placeholder_color(glm::vec4 color)
+        {
+            _placeholder_color = color;
+        }
+        
+        //note: how mip levels are averaged, on the gpu and in the chains the asset loader builds.  Set before init
+        inline void set_mip_filter(mip_filter filter)
+        {
+            _mip_filter = filter;
+        }
+        
+        inline mip_filter get_mip_filter()
+        {
+            return _mip_filter;
+        }
+        
+        //note: true while the asset loader still has to copy the pixels of this texture to its image
+        inline bool is_streaming()
+        {
+            return _streaming;
+        }
+        
+        //note: called by the asset loader, staging holds the whole of level 0.  Levels below it are regenerated, unless the
+        //texture is mip streamed, then staging holds every resident level, see write_levels
+        void record_upload(VkCommandBuffer command_buffer, VkBuffer staging);
+        
+        //note: mip streaming, see texture_streamer.h.  Levels are numbered from the full size image, the image on the gpu holds
+        //the resident level and every level smaller than it
+        struct retired_image
+        {
+            VkImage         image = VK_NULL_HANDLE;
+            VkDeviceMemory  memory = VK_NULL_HANDLE;
+            VkImageView     view = VK_NULL_HANDLE;
+        };
+        
+        inline bool is_mip_streamed()
+        {
+            return _mip_streamed;
+        }
+        
+        inline uint32_t get_resident_level()
+        {
+            return _resident_level;
+        }
+        
+        inline uint32_t get_num_source_levels()
+        {
+            return _source_levels;
+        }
+        
+        //note: false until the asset loader hands over the decoded chain
+        inline bool has_level_data()
+        {
+            return _container.is_open() || !_level_data.empty();
+        }
+        
+        //note: the level textures start out with, the first one no larger than texture_streamer::STREAM_TAIL_SIZE
+        uint32_t get_tail_level();
+        VkDeviceSize get_level_bytes(uint32_t level);
+        
+        //note: levels first_level up to last_level, not included, one after the other on 16 byte boundaries
+        VkDeviceSize get_staging_size(uint32_t first_level, uint32_t last_level);
+        void write_levels(uint32_t first_level, uint32_t last_level, uint8_t* destination);
+        
+        //note: called by the asset loader with every level of the image one after the other, built by its workers
+        void set_level_data(eastl::vector<uint8_t>&& chain);
+        
+        //note: replaces the image with one that starts at first_level.  Levels both images have are copied on the gpu, staging
+        //holds the levels from first_level up to the old resident level.  The old image is returned, frames in flight may still
+        //sample it
+        retired_image record_residency(VkCommandBuffer command_buffer, uint32_t first_level, VkBuffer staging);
+        
         static const eastl::fixed_string<char, 250> texture_resource_path;
         
     protected:
@@ -111,8 +188,32 @@ namespace vk
         bool _loaded = false;
     private:
         
+        bool open_container();
+        VkImageUsageFlags get_upload_usage();
+        void create_from_container();
+        bool request_load();
+        void set_format_from_channels(uint32_t channels);
+        void create_placeholder();
+        
         static constexpr char const * const _image_type = nullptr;
         stbi_uc *_ppixels = nullptr;
+        
+        //note: open from the constructor until the levels are uploaded, see texture_container.h
+        texture_container _container;
+        //note: false if the device cannot sample the format of the container, its levels are decoded to RGBA8 instead
+        bool _compressed = false;
+        
+        //note: the image is cleared to this color until the asset loader uploads the decoded pixels, see asset_loader.h
+        glm::vec4 _placeholder_color = glm::vec4(.5f, .5f, .5f, 1.f);
+        mip_filter _mip_filter = mip_filter::LINEAR;
+        bool _streaming = false;
+        bool _requested = false;
+        
+        bool _mip_streamed = false;
+        uint32_t _resident_level = 0;
+        uint32_t _source_levels = 1;
+        //note: the decoded chain of a streamed texture that has no container, see set_level_data
+        eastl::vector<uint8_t> _level_data {};
     };
 }
 
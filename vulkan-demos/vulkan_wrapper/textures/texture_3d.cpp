@@ -7,6 +7,7 @@
 //
 
 #include "texture_3d.h"
+#include "texture_cache.h"
 #include <cmath>
 
 using namespace vk;
@@ -50,8 +51,7 @@ void texture_3d::create_sampler()
     sampler_create_info.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
     sampler_create_info.unnormalizedCoordinates = VK_FALSE;
     
-    VkResult result = vkCreateSampler(_device->_logical_device, &sampler_create_info, nullptr, &_sampler);
-    ASSERT_VULKAN(result);
+    _sampler = _device->get_texture_cache().acquire_sampler(sampler_create_info);
 }
 
 void texture_3d::create_image_view( VkImage image, VkFormat format, VkImageView& image_view)
@@ -0,0 +1,237 @@
+//
+//  texture_cache.cpp
+//  vulkan-demos
+//
+//  Created by Rafael Sabino on 10/19/26.
+//  Copyright © 2026 Rafael Sabino. All rights reserved.
+//
+
+#include "texture_cache.h"
+#include "texture_2d.h"
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <sys/stat.h>
+
+using namespace vk;
+
+bool texture_cache::_enabled = true;
+
+//note: pNext chains are not compared, nothing in this repo creates samplers with one
+bool texture_cache::same_sampler(const VkSamplerCreateInfo& a, const VkSamplerCreateInfo& b)
+{
+    return a.flags == b.flags &&
+           a.magFilter == b.magFilter &&
+           a.minFilter == b.minFilter &&
+           a.mipmapMode == b.mipmapMode &&
+           a.addressModeU == b.addressModeU &&
+           a.addressModeV == b.addressModeV &&
+           a.addressModeW == b.addressModeW &&
+           a.mipLodBias == b.mipLodBias &&
+           a.anisotropyEnable == b.anisotropyEnable &&
+           a.maxAnisotropy == b.maxAnisotropy &&
+           a.compareEnable == b.compareEnable &&
+           a.compareOp == b.compareOp &&
+           a.minLod == b.minLod &&
+           a.maxLod == b.maxLod &&
+           a.borderColor == b.borderColor &&
+           a.unnormalizedCoordinates == b.unnormalizedCoordinates;
+}
+
+VkSampler texture_cache::acquire_sampler(const VkSamplerCreateInfo& info)
+{
+    EA_ASSERT_MSG(info.pNext == nullptr, "samplers with a pNext chain cannot be shared");
+    for( sampler_entry& e : _samplers)
+    {
+        if(same_sampler(e.info, info))
+        {
+            ++e.references;
+            return e.sampler;
+        }
+    }
+
+    sampler_entry e {};
+    e.info = info;
+    e.references = 1;
+    VkResult result = vkCreateSampler(_device->_logical_device, &info, nullptr, &e.sampler);
+    ASSERT_VULKAN(result);
+    _samplers.push_back(e);
+    return e.sampler;
+}
+
+void texture_cache::release_sampler(VkSampler sampler)
+{
+    if(sampler == VK_NULL_HANDLE)
+        return;
+
+    for( auto it = _samplers.begin(); it != _samplers.end(); ++it)
+    {
+        if(it->sampler != sampler)
+            continue;
+
+        if(--it->references == 0)
+        {
+            vkDestroySampler(_device->_logical_device, it->sampler, nullptr);
+            _samplers.erase(it);
+        }
+        return;
+    }
+    EA_FAIL_MSG("the sampler was not acquired from the texture cache");
+}
+
+//note: 64 bit fnv-1a over the whole file, read in blocks.  A collision needs two files of the same size with the same hash
+bool texture_cache::hash_file(const char* path, uint64_t& hash, uint64_t& size)
+{
+    FILE* file = fopen(path, "rb");
+    if(file == nullptr)
+        return false;
+
+    hash = 14695981039346656037ull;
+    size = 0;
+    uint8_t block[64 * 1024];
+    size_t read = 0;
+    while((read = fread(block, 1, sizeof(block), file)) != 0)
+    {
+        for( size_t i = 0; i < read; ++i)
+        {
+            hash = (hash ^ block[i]) * 1099511628211ull;
+        }
+        size += read;
+    }
+    fclose(file);
+    return true;
+}
+
+bool texture_cache::stat_file(const char* path, uint64_t& size, int64_t& modified)
+{
+    struct stat info {};
+    if(stat(path, &info) != 0)
+        return false;
+
+    size = static_cast<uint64_t>(info.st_size);
+    modified = static_cast<int64_t>(info.st_mtime);
+    return true;
+}
+
+bool texture_cache::hash_key(texture_key& key)
+{
+    uint64_t size = 0;
+    int64_t modified = 0;
+    if(!stat_file(key.path.c_str(), size, modified) || size != key.size || modified != key.modified)
+        return false;
+
+    key.hashed = hash_file(key.path.c_str(), key.hash, size) && size == key.size;
+    return key.hashed;
+}
+
+eastl::shared_ptr<texture_2d> texture_cache::find_texture(const char* path, texture_key& key)
+{
+    eastl::fixed_string<char, 250> full_path = resource::resource_root + texture_2d::texture_resource_path + path;
+    char real_path[PATH_MAX] = {};
+    key = texture_key {};
+    key.path = realpath(full_path.c_str(), real_path) != nullptr ? real_path : full_path.c_str();
+    if(!_enabled)
+        return nullptr;
+
+    for( texture_entry& e : _textures)
+    {
+        if(e.key.path == key.path)
+        {
+            ++e.shared;
+            return e.texture;
+        }
+    }
+
+    //note: files that are not there are left to texture_2d, it knows where else to look and what to say when it cannot
+    if(!stat_file(key.path.c_str(), key.size, key.modified))
+        return nullptr;
+
+    //note: files of different sizes cannot hold the same image, most files are never read here
+    for( texture_entry& e : _textures)
+    {
+        if(e.key.size != key.size)
+            continue;
+        if(!key.hashed && !hash_key(key))
+            return nullptr;
+        if(!e.key.hashed && !hash_key(e.key))
+            continue;
+
+        if(e.key.hash == key.hash)
+        {
+            ++e.shared;
+            return e.texture;
+        }
+    }
+    return nullptr;
+}
+
+void texture_cache::add_texture(const texture_key& key, eastl::shared_ptr<texture_2d> texture)
+{
+    if(!_enabled)
+        return;
+
+    texture_entry e {};
+    e.key = key;
+    e.texture = texture;
+    _textures.push_back(e);
+}
+
+void texture_cache::forget_texture(texture_2d* texture)
+{
+    for( auto it = _textures.begin(); it != _textures.end(); ++it)
+    {
+        if(it->texture.get() == texture)
+        {
+            _textures.erase(it);
+            return;
+        }
+    }
+}
+
+uint32_t texture_cache::get_num_sampler_references() const
+{
+    uint32_t references = 0;
+    for( const sampler_entry& e : _samplers)
+    {
+        references += e.references;
+    }
+    return references;
+}
+
+uint32_t texture_cache::get_num_shared() const
+{
+    uint32_t shared = 0;
+    for( const texture_entry& e : _textures)
+    {
+        shared += e.shared;
+    }
+    return shared;
+}
+
+VkDeviceSize texture_cache::get_saved_bytes() const
+{
+    VkDeviceSize bytes = 0;
+    for( const texture_entry& e : _textures)
+    {
+        if(e.shared == 0 || e.texture->get_image() == VK_NULL_HANDLE)
+            continue;
+
+        VkMemoryRequirements requirements {};
+        vkGetImageMemoryRequirements(_device->_logical_device, e.texture->get_image(), &requirements);
+        bytes += requirements.size * e.shared;
+    }
+    return bytes;
+}
+
+void texture_cache::destroy()
+{
+    //note: the textures belong to the graphs that loaded them, they are destroyed by their texture registries
+    _textures.clear();
+
+    //note: textures that were never destroyed leave their samplers behind
+    for( sampler_entry& e : _samplers)
+    {
+        vkDestroySampler(_device->_logical_device, e.sampler, nullptr);
+    }
+    _samplers.clear();
+}
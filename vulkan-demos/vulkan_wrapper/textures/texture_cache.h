@@ -0,0 +1,107 @@
+//
+//  texture_cache.h
+//  vulkan-demos
+//
+//  Created by Rafael Sabino on 10/19/26.
+//  Copyright © 2026 Rafael Sabino. All rights reserved.
+//
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include "EASTL/vector.h"
+#include "EASTL/fixed_string.h"
+#include "EASTL/shared_ptr.h"
+#include "resource.h"
+#include "device.h"
+
+namespace vk
+{
+    class texture_2d;
+
+    //note: shares what identical textures would otherwise each make for themselves.
+    //
+    //samplers are looked up by every field of their VkSamplerCreateInfo and counted, a texture acquires its sampler when it is
+    //created and releases it when it is destroyed.  Every texture_2d asks for the same filtering, so the materials of a scene end
+    //up with a handful of samplers instead of one per texture.
+    //
+    //textures loaded from a file are looked up by the real path of the file first and by a hash of its bytes second.  Imported
+    //scenes often point at the same roughness or occlusion image from dozens of materials, under different relative paths or
+    //as copies of the same file, every one of them gets the texture that was loaded first.  Reading a whole image to hash it
+    //costs as much io as loading it, only files that are as big as one that was loaded are hashed, both of them then.  The texture registry of the graph
+    //holds the shared texture under every name it was asked for, see texture_registry::get_loaded_texture_2d
+    class texture_cache : public resource
+    {
+    public:
+
+        //note: what a file resolves to, filled in by find_texture and handed back to add_texture when nothing was found
+        struct texture_key
+        {
+            eastl::fixed_string<char, 250> path {};
+            uint64_t size = 0;
+            //note: last modification time of the file, a hash is only taken of a file that did not change since it was looked up
+            int64_t  modified = 0;
+            uint64_t hash = 0;
+            bool     hashed = false;
+        };
+
+        texture_cache(){}
+        texture_cache(device* dev){ _device = dev; }
+
+        //note: textures made while this is false are loaded once per path, like they used to.  Samplers are always shared
+        static void set_enabled(bool enabled){ _enabled = enabled; }
+        static bool is_enabled(){ return _enabled; }
+
+        VkSampler acquire_sampler(const VkSamplerCreateInfo& info);
+        void release_sampler(VkSampler sampler);
+
+        //note: path is relative to the texture folder, like the path of texture_2d's constructor
+        eastl::shared_ptr<texture_2d> find_texture(const char* path, texture_key& key);
+        void add_texture(const texture_key& key, eastl::shared_ptr<texture_2d> texture);
+
+        //called by texture_2d when it is destroyed
+        void forget_texture(texture_2d* texture);
+
+        inline uint32_t get_num_samplers() const { return static_cast<uint32_t>(_samplers.size()); }
+        uint32_t get_num_sampler_references() const;
+        inline uint32_t get_num_textures() const { return static_cast<uint32_t>(_textures.size()); }
+        uint32_t get_num_shared() const;
+
+        //note: image memory the textures that were shared would have taken on the gpu had they been loaded again
+        VkDeviceSize get_saved_bytes() const;
+
+        virtual void destroy() override;
+
+        virtual char const * const * get_instance_type() override { return (&_type); };
+        static char const * const *  get_class_type(){ return (&_type); }
+
+    private:
+
+        struct sampler_entry
+        {
+            VkSamplerCreateInfo info {};
+            VkSampler           sampler = VK_NULL_HANDLE;
+            uint32_t            references = 0;
+        };
+
+        struct texture_entry
+        {
+            texture_key                     key {};
+            eastl::shared_ptr<texture_2d>   texture = nullptr;
+            //note: times find_texture handed this texture out, on top of the load that made it
+            uint32_t                        shared = 0;
+        };
+
+        static bool same_sampler(const VkSamplerCreateInfo& a, const VkSamplerCreateInfo& b);
+        static bool stat_file(const char* path, uint64_t& size, int64_t& modified);
+        static bool hash_file(const char* path, uint64_t& hash, uint64_t& size);
+        static bool hash_key(texture_key& key);
+
+        static bool _enabled;
+        static constexpr char const * _type = nullptr;
+
+        device*                         _device = nullptr;
+        eastl::vector<sampler_entry>    _samplers {};
+        eastl::vector<texture_entry>    _textures {};
+    };
+}
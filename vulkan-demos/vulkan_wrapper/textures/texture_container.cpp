@@ -0,0 +1,338 @@
+//
+//  texture_container.cpp
+//  vulkan-demos
+//
+//  Created by Rafael Sabino on 10/19/26.
+//  Copyright © 2026 Rafael Sabino. All rights reserved.
+//
+
+#include "texture_container.h"
+#include "EASTL/fixed_string.h"
+#include "EASTL/vector.h"
+#include "EAAssert/eaassert.h"
+#include "stb_image.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace vk;
+
+namespace
+{
+    inline uint64_t align_up(uint64_t offset, uint64_t alignment)
+    {
+        return (offset + alignment - 1) & ~(alignment - 1);
+    }
+
+    struct srgb_table
+    {
+        float values[256];
+
+        srgb_table()
+        {
+            for( int i = 0; i < 256; ++i)
+            {
+                float c = static_cast<float>(i) / 255.0f;
+                values[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+            }
+        }
+    };
+
+    bool write_padding(FILE* file, uint64_t& offset, uint64_t alignment)
+    {
+        static const char zeros[64] = {};
+        uint64_t padding = align_up(offset, alignment) - offset;
+        offset += padding;
+        return padding == 0 || fwrite(zeros, 1, padding, file) == padding;
+    }
+}
+
+VkFormat texture_container::get_vk_format(format f)
+{
+    switch(f)
+    {
+        case format::BC1:           return VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+        case format::BC4:           return VK_FORMAT_BC4_UNORM_BLOCK;
+        case format::BC5:           return VK_FORMAT_BC5_UNORM_BLOCK;
+        case format::BC7:           return VK_FORMAT_BC7_UNORM_BLOCK;
+        case format::ETC2_RGB8:     return VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK;
+        case format::ETC2_RGBA8:    return VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK;
+        case format::ASTC_4X4:      return VK_FORMAT_ASTC_4x4_UNORM_BLOCK;
+        default:
+            EA_FAIL_MSG("unrecognized compressed format");
+    }
+    return VK_FORMAT_UNDEFINED;
+}
+
+//note: 2x2 average, odd edges repeat their last row or column.  Srgb color is averaged in linear space and normals are put
+//back to unit length, alpha is always averaged as it is
+void texture_container::downsample(const uint8_t* source, uint32_t width, uint32_t height, uint32_t channels, uint8_t* destination,
+                                   mip_filter filter)
+{
+    //note: the workers of the asset loader call this at the same time, the table is built once by whichever gets here first
+    static const srgb_table srgb_to_linear {};
+
+    uint32_t color_channels = std::min(channels, 3u);
+    if(filter == mip_filter::NORMAL_MAP && channels < 3)
+        filter = mip_filter::LINEAR;
+
+    uint32_t w = std::max(1u, width / 2);
+    uint32_t h = std::max(1u, height / 2);
+    for( uint32_t y = 0; y < h; ++y)
+    {
+        uint32_t y0 = std::min(y * 2, height - 1);
+        uint32_t y1 = std::min(y * 2 + 1, height - 1);
+        for( uint32_t x = 0; x < w; ++x)
+        {
+            uint32_t x0 = std::min(x * 2, width - 1);
+            uint32_t x1 = std::min(x * 2 + 1, width - 1);
+            const uint8_t* texels[4] = { source + (size_t(y0) * width + x0) * channels, source + (size_t(y0) * width + x1) * channels,
+                                         source + (size_t(y1) * width + x0) * channels, source + (size_t(y1) * width + x1) * channels };
+            uint8_t* out = destination + (size_t(y) * w + x) * channels;
+
+            if(filter == mip_filter::LINEAR)
+            {
+                for( uint32_t c = 0; c < channels; ++c)
+                {
+                    uint32_t sum = texels[0][c] + texels[1][c] + texels[2][c] + texels[3][c];
+                    out[c] = static_cast<uint8_t>((sum + 2) / 4);
+                }
+                continue;
+            }
+
+            float color[3] = {};
+            for( uint32_t c = 0; c < color_channels; ++c)
+            {
+                for( const uint8_t* texel : texels)
+                {
+                    color[c] += filter == mip_filter::SRGB ? srgb_to_linear.values[texel[c]] : static_cast<float>(texel[c]) / 127.5f - 1.0f;
+                }
+                color[c] *= .25f;
+            }
+
+            if(filter == mip_filter::NORMAL_MAP)
+            {
+                float length = std::sqrt(color[0] * color[0] + color[1] * color[1] + color[2] * color[2]);
+                for( uint32_t c = 0; c < 3; ++c)
+                {
+                    color[c] = length > 1e-5f ? color[c] / length : (c == 2 ? 1.0f : 0.0f);
+                    out[c] = static_cast<uint8_t>(std::lround((color[c] * .5f + .5f) * 255.0f));
+                }
+            }
+            else
+            {
+                for( uint32_t c = 0; c < color_channels; ++c)
+                {
+                    float v = color[c] <= 0.0031308f ? color[c] * 12.92f : 1.055f * std::pow(color[c], 1.0f / 2.4f) - 0.055f;
+                    out[c] = static_cast<uint8_t>(std::lround(std::min(std::max(v, 0.0f), 1.0f) * 255.0f));
+                }
+            }
+
+            for( uint32_t c = color_channels; c < channels; ++c)
+            {
+                uint32_t sum = texels[0][c] + texels[1][c] + texels[2][c] + texels[3][c];
+                out[c] = static_cast<uint8_t>((sum + 2) / 4);
+            }
+        }
+    }
+}
+
+uint32_t texture_container::get_channels(format f)
+{
+    switch(f)
+    {
+        case format::BC4:           return 1;
+        case format::BC5:           return 2;
+        case format::BC1:
+        case format::ETC2_RGB8:     return 3;
+        default:                    return 4;
+    }
+}
+
+bool texture_container::open(const char* path)
+{
+    close();
+
+    int fd = ::open(path, O_RDONLY);
+    if(fd < 0)
+        return false;
+
+    struct stat info {};
+    if(fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(file_header))
+    {
+        ::close(fd);
+        return false;
+    }
+
+    _mapping_size = static_cast<size_t>(info.st_size);
+    _mapping = mmap(nullptr, _mapping_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+
+    if(_mapping == MAP_FAILED)
+    {
+        _mapping = nullptr;
+        return false;
+    }
+
+    const uint8_t* base = static_cast<const uint8_t*>(_mapping);
+    const file_header* header = reinterpret_cast<const file_header*>(base);
+
+    bool valid = header->magic == MAGIC && header->version == VERSION && header->format < static_cast<uint32_t>(format::COUNT) &&
+                 header->num_levels != 0 && header->num_levels <= MAX_LEVELS &&
+                 sizeof(file_header) + uint64_t(header->num_levels) * sizeof(level_header) <= _mapping_size;
+
+    if(valid)
+    {
+        _format = static_cast<format>(header->format);
+
+        //note: every level has to be half the size of the one before, with exactly the bytes its blocks need
+        const level_header* levels = reinterpret_cast<const level_header*>(header + 1);
+        for( uint32_t l = 0; l < header->num_levels && valid; ++l)
+        {
+            const level_header& lh = levels[l];
+            valid = lh.width != 0 && lh.height != 0 && (lh.offset % LEVEL_ALIGNMENT) == 0 && lh.offset + lh.size <= _mapping_size &&
+                    lh.size == block_compression::get_compressed_size(_format, lh.width, lh.height);
+            if(valid && l != 0)
+            {
+                valid = lh.width == std::max(1u, levels[l - 1].width / 2) && lh.height == std::max(1u, levels[l - 1].height / 2);
+            }
+            if(!valid)
+                break;
+
+            level lvl {};
+            lvl.data = base + lh.offset;
+            lvl.size = static_cast<size_t>(lh.size);
+            lvl.width = lh.width;
+            lvl.height = lh.height;
+            _levels.push_back(lvl);
+        }
+    }
+
+    if(!valid)
+    {
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void texture_container::close()
+{
+    if(_mapping != nullptr)
+    {
+        munmap(_mapping, _mapping_size);
+    }
+    _mapping = nullptr;
+    _mapping_size = 0;
+    _levels.clear();
+}
+
+bool texture_container::convert(const char* source, const char* destination, format f, conversion_report* report)
+{
+    EA_ASSERT_MSG(block_compression::can_encode(f), "there is no encoder for this format");
+
+    int w = 0, h = 0, c = 0;
+    stbi_uc* pixels = stbi_load(source, &w, &h, &c, STBI_rgb_alpha);
+    if(pixels == nullptr)
+    {
+        printf("could not load %s: %s\n", source, stbi_failure_reason());
+        return false;
+    }
+
+    uint32_t width = static_cast<uint32_t>(w);
+    uint32_t height = static_cast<uint32_t>(h);
+    //note: same chain texture_2d::init asks for, down to 1x1
+    uint32_t num_levels = 1;
+    while(num_levels < MAX_LEVELS && (std::max(width, height) >> num_levels) != 0)
+        ++num_levels;
+
+    eastl::vector<uint8_t> current(pixels, pixels + size_t(width) * height * 4);
+    eastl::vector<uint8_t> next {};
+    stbi_image_free(pixels);
+
+    eastl::fixed_vector<level_header, MAX_LEVELS, false> level_headers {};
+    eastl::vector<uint8_t> blocks {};
+    eastl::vector<uint8_t> decoded {};
+
+    uint64_t offset = align_up(sizeof(file_header) + uint64_t(num_levels) * sizeof(level_header), LEVEL_ALIGNMENT);
+    uint32_t level_width = width;
+    uint32_t level_height = height;
+    for( uint32_t l = 0; l < num_levels; ++l)
+    {
+        size_t size = block_compression::get_compressed_size(f, level_width, level_height);
+        size_t start = blocks.size();
+        blocks.resize(start + size);
+        block_compression::compress_image(f, current.data(), level_width, level_height, blocks.data() + start);
+
+        if(l == 0 && report != nullptr)
+        {
+            decoded.resize(current.size());
+            block_compression::decompress_image(f, blocks.data(), level_width, level_height, decoded.data());
+            report->psnr = block_compression::psnr(current.data(), decoded.data(), size_t(level_width) * level_height, get_channels(f));
+        }
+
+        level_header lh {};
+        lh.offset = offset;
+        lh.size = size;
+        lh.width = level_width;
+        lh.height = level_height;
+        level_headers.push_back(lh);
+        offset = align_up(offset + size, LEVEL_ALIGNMENT);
+
+        if(l + 1 < num_levels)
+        {
+            next.resize(size_t(std::max(1u, level_width / 2)) * std::max(1u, level_height / 2) * 4);
+            downsample(current.data(), level_width, level_height, 4, next.data());
+            current.swap(next);
+            level_width = std::max(1u, level_width / 2);
+            level_height = std::max(1u, level_height / 2);
+        }
+    }
+
+    file_header header {};
+    header.format = static_cast<uint32_t>(f);
+    header.num_levels = num_levels;
+
+    eastl::fixed_string<char, 260> temp_path {};
+    temp_path.sprintf("%s.tmp", destination);
+
+    FILE* file = fopen(temp_path.c_str(), "wb");
+    if(file == nullptr)
+        return false;
+
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    ok = ok && fwrite(level_headers.data(), sizeof(level_header), level_headers.size(), file) == level_headers.size();
+
+    offset = sizeof(file_header) + uint64_t(num_levels) * sizeof(level_header);
+    size_t start = 0;
+    for( uint32_t l = 0; l < num_levels && ok; ++l)
+    {
+        size_t size = static_cast<size_t>(level_headers[l].size);
+        ok = write_padding(file, offset, LEVEL_ALIGNMENT) && fwrite(blocks.data() + start, 1, size, file) == size;
+        offset += size;
+        start += size;
+    }
+
+    ok = (fclose(file) == 0) && ok;
+    ok = ok && std::rename(temp_path.c_str(), destination) == 0;
+    if(!ok)
+        std::remove(temp_path.c_str());
+
+    if(ok && report != nullptr)
+    {
+        report->width = width;
+        report->height = height;
+        report->num_levels = num_levels;
+        report->source_bytes = size_t(width) * height * 4;
+        report->compressed_bytes = blocks.size();
+    }
+
+    return ok;
+}
@@ -0,0 +1,114 @@
+//
+//  texture_container.h
+//  vulkan-demos
+//
+//  Created by Rafael Sabino on 10/19/26.
+//  Copyright © 2026 Rafael Sabino. All rights reserved.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vulkan/vulkan.h>
+#include "EASTL/fixed_vector.h"
+#include "block_compression.h"
+#include "mip_generator.h"
+
+namespace vk
+{
+    //note: a texture that is ready to be copied to the gpu, every mip level already compressed, laid out the way KTX2 lays out
+    //its levels: a header, a table with the offset and size of every level, then the levels themselves.  texture_2d looks for
+    //one next to the image it is asked to load ("albedo.png" -> "albedo.png.vktex") and uploads its levels as they are, nothing
+    //is decoded and no mip maps are generated on the gpu.
+    //
+    //containers are made offline from source images with convert, see --compress-texture in main.mm.  Bump VERSION whenever
+    //the layout changes
+    class texture_container
+    {
+    public:
+
+        static constexpr uint32_t MAGIC = 0x58544b56u; //"VKTX"
+        static constexpr uint32_t VERSION = 1u;
+        static constexpr uint32_t MAX_LEVELS = 16u;
+        static constexpr const char* EXTENSION = ".vktex";
+
+        using format = block_compression::format;
+
+        //note: data points into the mapping
+        struct level
+        {
+            const uint8_t*  data = nullptr;
+            size_t          size = 0;
+            uint32_t        width = 0;
+            uint32_t        height = 0;
+        };
+
+        //note: how far the level 0 of a conversion is from its source, decoded back on the cpu
+        struct conversion_report
+        {
+            uint32_t    width = 0;
+            uint32_t    height = 0;
+            uint32_t    num_levels = 0;
+            size_t      source_bytes = 0;
+            size_t      compressed_bytes = 0;
+            float       psnr = 0.0f;
+        };
+
+        texture_container(){}
+        ~texture_container(){ close(); }
+
+        texture_container & operator=(const texture_container&) = delete;
+        texture_container(const texture_container&) = delete;
+
+        //maps the file, returns false if it is missing or damaged
+        bool open(const char* path);
+        void close();
+
+        inline bool is_open() const { return _mapping != nullptr; }
+        inline format get_format() const { return _format; }
+        inline uint32_t get_width() const { return _levels.empty() ? 0 : _levels[0].width; }
+        inline uint32_t get_height() const { return _levels.empty() ? 0 : _levels[0].height; }
+        inline uint32_t get_num_levels() const { return static_cast<uint32_t>(_levels.size()); }
+        inline const level& get_level(uint32_t l) const { return _levels[l]; }
+
+        static VkFormat get_vk_format(format f);
+        static uint32_t get_channels(format f);
+        
+        //note: box filters an 8 bit image with any number of channels to the next level of its mip chain, the cpu version of
+        //what mip_downsample.comp does
+        static void downsample(const uint8_t* source, uint32_t width, uint32_t height, uint32_t channels, uint8_t* destination,
+                               mip_filter filter = mip_filter::LINEAR);
+
+        //note: loads source with stb_image, builds a box filtered mip chain down to 1x1 and compresses every level.  Written to
+        //a temporary file that is renamed over destination
+        static bool convert(const char* source, const char* destination, format f, conversion_report* report = nullptr);
+
+    private:
+
+        struct file_header
+        {
+            uint32_t    magic = MAGIC;
+            uint32_t    version = VERSION;
+            uint32_t    format = 0;
+            uint32_t    num_levels = 0;
+        };
+
+        struct level_header
+        {
+            uint64_t    offset = 0;
+            uint64_t    size = 0;
+            uint32_t    width = 0;
+            uint32_t    height = 0;
+        };
+
+        //note: levels start on this boundary, copies out of the staging buffer need offsets that are a multiple of the block size
+        static constexpr size_t LEVEL_ALIGNMENT = 16u;
+
+        void*   _mapping = nullptr;
+        size_t  _mapping_size = 0;
+
+        format  _format = format::BC7;
+        eastl::fixed_vector<level, MAX_LEVELS, false> _levels {};
+    };
+}
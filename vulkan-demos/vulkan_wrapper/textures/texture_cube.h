@@ -48,128 +48,6 @@ namespace vk {
             _depth = 6;
         }
 
-        virtual void generate_mipmaps( VkImage image, VkCommandBuffer& command_buffer,
-                                    uint32_t width,  uint32_t height, uint32_t) override
-        {
-#if _APPLE_ && DEBUG
-            EA_ASSERT_MSG( false, "moltenvk doesn't blit images very well, proceed with caution...");
-#endif
-            eastl::array<VkImageMemoryBarrier, 100> mip_barriers = {};
-            EA_ASSERT(_mip_levels < 100);
-            
-            //note:: technically this could be done without a loop, but validation layers throw error when I do this, don't understand why...
-            for(uint32_t i = 0; i < _mip_levels; ++i)
-            {
-                mip_barriers[i].sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-                mip_barriers[i].image = image;
-                mip_barriers[i].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-                mip_barriers[i].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-                mip_barriers[i].subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-                mip_barriers[i].subresourceRange.baseMipLevel = i;
-                mip_barriers[i].oldLayout = static_cast<VkImageLayout>(_image_layout);
-                mip_barriers[i].newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-                mip_barriers[i].srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
-                mip_barriers[i].dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
-                mip_barriers[i].subresourceRange.layerCount = _depth;
-                mip_barriers[i].subresourceRange.levelCount = 1;
-                mip_barriers[i].subresourceRange.baseArrayLayer = i * _depth;
-            }
-
-            vkCmdPipelineBarrier(command_buffer,
-                                  VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0,
-                                  0, nullptr,
-                                  0, nullptr,
-                                 _mip_levels, mip_barriers.data());
-            
-            VkImageMemoryBarrier barrier = {};
-            barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-            barrier.image = image;
-            barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-            barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-            barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-            
-            int32_t mip_width = width;
-            int32_t mip_height = height;
-            EA_ASSERT_MSG(_depth == 6, "cubemaps must have depth of 6 for the the 6 layers");
-            uint32_t i = 1;
-            for (; i < _mip_levels; i++)
-            {
-                uint32_t prev_layer = (i - 1);
-                barrier.subresourceRange.baseMipLevel = prev_layer;
-                barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-                barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-                barrier.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
-                barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
-                barrier.subresourceRange.layerCount = _depth;
-                barrier.subresourceRange.levelCount = 1;
-                barrier.subresourceRange.baseArrayLayer = (prev_layer * _depth);
-
-                //TODO: optimize these stages
-                vkCmdPipelineBarrier(command_buffer,
-                                  VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0,
-                                  0, nullptr,
-                                  0, nullptr,
-                                  1, &barrier);
-
-                //here we create the current mip level
-                VkImageBlit blit = {};
-                blit.srcOffsets[0] = {0, 0, 0};
-                blit.srcOffsets[1] = {mip_width, mip_height, 1};
-                blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-                blit.srcSubresource.mipLevel =  prev_layer;
-                //starting layer
-                blit.srcSubresource.baseArrayLayer = prev_layer * _depth;
-                //how many layers to copy
-                blit.srcSubresource.layerCount = _depth;
-                blit.dstOffsets[0] = {0, 0, 0};
-                blit.dstOffsets[1] = { mip_width > 1 ? mip_width / 2 : 1, mip_height > 1 ? mip_height / 2 : 1, 1};
-
-                blit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-                blit.dstSubresource.mipLevel = i;
-                blit.dstSubresource.baseArrayLayer = i * _depth;
-                blit.dstSubresource.layerCount = _depth;
-
-                vkCmdBlitImage(command_buffer,
-                            image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-                            image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                            1, &blit,
-                            VK_FILTER_LINEAR);
-
-                //transfer the base miplevel to shader optimal
-                barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-                barrier.newLayout = static_cast<VkImageLayout>(_image_layout);;
-                barrier.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
-                barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
-
-                vkCmdPipelineBarrier(command_buffer,
-                                  VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0,
-                                  0, nullptr,
-                                  0, nullptr,
-                                  1, &barrier);
-
-                if (mip_width > 1) mip_width /= 2;
-                if (mip_height > 1) mip_height /= 2;
-            }
-            
-            barrier.subresourceRange.baseMipLevel = (i-1);
-            barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-            barrier.newLayout = static_cast<VkImageLayout>(_image_layout);
-            barrier.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
-            barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
-            barrier.subresourceRange.layerCount = _depth;
-            barrier.subresourceRange.levelCount = 1;
-            barrier.subresourceRange.baseArrayLayer = (i-1) * _depth;
-            
-             
-            vkCmdPipelineBarrier(command_buffer,
-                                  VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0,
-                                  0, nullptr,
-                                  0, nullptr,
-                                  1, &barrier);
-            
-            _image_layout = _original_layout;
-        }
-        
         virtual image_layouts get_usage_layout( vk::usage_type usage) override
         {
             image::image_layouts layout = get_original_layout();
@@ -294,6 +172,7 @@ namespace vk {
                 else
                 {
                     refresh_mimaps();
+                    _original_layout = image::image_layouts::SHADER_READ_ONLY_OPTIMAL;
                 }
             }
 
@@ -313,7 +192,8 @@ namespace vk {
             image_create_info.extent.height = _height;
             image_create_info.extent.depth = 1.0f;
             image_create_info.mipLevels = _mip_levels;
-            image_create_info.arrayLayers = _depth * _mip_levels;
+            //note: a regular cube, 6 layers with every mip level in each.  Mips are generated for all the faces at once
+            image_create_info.arrayLayers = _depth;
             image_create_info.samples = _multisampling ? _device->get_max_usable_sample_count() : VK_SAMPLE_COUNT_1_BIT ;
             image_create_info.tiling = tiling;
             image_create_info.usage = usage_flags;
@@ -372,7 +252,7 @@ namespace vk {
             image_view_create_info.subresourceRange.baseMipLevel = 0;
             image_view_create_info.subresourceRange.levelCount = _mip_levels;
             image_view_create_info.subresourceRange.baseArrayLayer = 0;
-            image_view_create_info.subresourceRange.layerCount = _mip_levels * _depth;
+            image_view_create_info.subresourceRange.layerCount = _depth;
             
             VkResult result = vkCreateImageView(_device->_logical_device, &image_view_create_info, nullptr, &image_view);
             ASSERT_VULKAN(result);
@@ -0,0 +1,347 @@
+//
+//  texture_streamer.cpp
+//  vulkan-demos
+//
+//  Created by Rafael Sabino on 10/19/26.
+//  Copyright © 2026 Rafael Sabino. All rights reserved.
+//
+
+#include "texture_streamer.h"
+#include "texture_2d.h"
+#include "profiler.h"
+#include "EASTL/algorithm.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+using namespace vk;
+
+bool texture_streamer::_enabled = true;
+
+void texture_streamer::set_budget(VkDeviceSize bytes)
+{
+    if(bytes == 0)
+    {
+        VkPhysicalDeviceMemoryProperties properties {};
+        vkGetPhysicalDeviceMemoryProperties(_device->_physical_device, &properties);
+        for( uint32_t i = 0; i < properties.memoryHeapCount; ++i)
+        {
+            if(properties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
+                bytes = std::max(bytes, properties.memoryHeaps[i].size / 4);
+        }
+    }
+    _budget = bytes;
+}
+
+texture_streamer::entry* texture_streamer::find(texture_2d* texture)
+{
+    for( entry& e : _entries)
+    {
+        if(e.texture == texture)
+            return &e;
+    }
+    return nullptr;
+}
+
+void texture_streamer::add(texture_2d* texture)
+{
+    EA_ASSERT_MSG(find(texture) == nullptr, "the texture is already streamed");
+    if(_budget == 0)
+        set_budget(0);
+
+    entry e {};
+    e.texture = texture;
+    e.requested = e.wanted = e.target = texture->get_tail_level();
+    e.frames = FEEDBACK_FRAMES;
+    _entries.push_back(e);
+    _resident_bytes += texture->get_staging_size(texture->get_resident_level(), texture->get_num_source_levels());
+}
+
+void texture_streamer::remove(texture_2d* texture)
+{
+    entry* e = find(texture);
+    if(e == nullptr)
+        return;
+
+    //note: the image of the texture is destroyed right after this, copies to it have to be done
+    for( upload& u : _uploads)
+    {
+        if(eastl::find(u.textures.begin(), u.textures.end(), texture) != u.textures.end())
+        {
+            release_finished_uploads(true);
+            break;
+        }
+    }
+
+    for( eastl::vector<texture_2d*>& slot : _slots)
+    {
+        slot.erase(eastl::remove(slot.begin(), slot.end(), texture), slot.end());
+    }
+
+    _resident_bytes -= texture->get_staging_size(texture->get_resident_level(), texture->get_num_source_levels());
+    _entries.erase(_entries.begin() + (e - _entries.data()));
+}
+
+uint32_t texture_streamer::allocate_slot()
+{
+    EA_ASSERT_MSG(_slots.size() < MAX_SLOTS, "out of feedback slots, increase MAX_SLOTS");
+    _slots.emplace_back();
+    return static_cast<uint32_t>(_slots.size() - 1);
+}
+
+void texture_streamer::add_to_slot(uint32_t slot, texture_2d* texture)
+{
+    EA_ASSERT(slot < _slots.size());
+    entry* e = find(texture);
+    //note: textures that are not streamed are always whole, they have nothing to ask for
+    if(e == nullptr)
+        return;
+
+    e->has_slot = true;
+    if(eastl::find(_slots[slot].begin(), _slots[slot].end(), texture) == _slots[slot].end())
+        _slots[slot].push_back(texture);
+}
+
+texture_streamer::buffer_array& texture_streamer::get_feedback_buffers()
+{
+    if(!_feedback[0].is_initialized())
+    {
+        for( int i = 0; i < _feedback.size(); ++i)
+        {
+            _feedback[i].set_device(_device);
+            _feedback[i].create(sizeof(uint32_t) * MAX_SLOTS, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+            memset(_feedback[i].get_mapped_memory(), 0, sizeof(uint32_t) * MAX_SLOTS);
+        }
+    }
+    return _feedback;
+}
+
+void texture_streamer::record_feedback_barrier(VkCommandBuffer command_buffer)
+{
+    if(!_feedback[0].is_initialized())
+        return;
+
+    VkMemoryBarrier barrier {};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0,
+                         1, &barrier, 0, nullptr, 0, nullptr);
+}
+
+//note: a slot holds 16 times the log2 of the texels across the uv range its draws needed, plus one so that 0 means unseen
+void texture_streamer::read_feedback(uint32_t image_id)
+{
+    if(!_feedback[image_id].is_initialized())
+        return;
+
+    uint32_t* values = static_cast<uint32_t*>(_feedback[image_id].get_mapped_memory());
+    for( uint32_t slot = 0; slot < _slots.size(); ++slot)
+    {
+        if(values[slot] == 0)
+            continue;
+
+        float texels = static_cast<float>(values[slot] - 1) / 16.0f;
+        for( texture_2d* texture : _slots[slot])
+        {
+            entry* e = find(texture);
+            float full = std::log2(static_cast<float>(std::max(texture->get_width(), texture->get_height())));
+            float level = std::floor(full - texels);
+            uint32_t requested = level <= 0.0f ? 0u : std::min(static_cast<uint32_t>(level), texture->get_num_source_levels() - 1);
+            e->requested = std::min(e->requested, requested);
+        }
+    }
+    memset(values, 0, sizeof(uint32_t) * _slots.size());
+
+    //note: finer levels are wanted as soon as they are asked for, coarser ones only after a whole window without the finer one
+    for( entry& e : _entries)
+    {
+        e.wanted = std::min(e.wanted, e.requested);
+        if(--e.frames == 0)
+        {
+            e.wanted = e.requested;
+            e.requested = e.texture->get_tail_level();
+            e.frames = FEEDBACK_FRAMES;
+        }
+    }
+}
+
+void texture_streamer::pick_targets()
+{
+    VkDeviceSize total = 0;
+    for( entry& e : _entries)
+    {
+        texture_2d* texture = e.texture;
+        //note: textures whose chain has not arrived yet stay on their placeholder
+        if(!texture->has_level_data() || texture->is_streaming())
+        {
+            e.target = texture->get_resident_level();
+        }
+        else
+        {
+            e.target = std::min(e.has_slot ? e.wanted : 0u, texture->get_tail_level());
+        }
+        total += texture->get_staging_size(e.target, texture->get_num_source_levels());
+    }
+
+    //note: over budget, the texture with the largest top level loses it until everything fits
+    while(total > _budget)
+    {
+        entry* largest = nullptr;
+        VkDeviceSize largest_bytes = 0;
+        for( entry& e : _entries)
+        {
+            if(e.target >= e.texture->get_tail_level() || !e.texture->has_level_data() || e.texture->is_streaming())
+                continue;
+
+            VkDeviceSize bytes = e.texture->get_level_bytes(e.target);
+            if(bytes > largest_bytes)
+            {
+                largest = &e;
+                largest_bytes = bytes;
+            }
+        }
+        if(largest == nullptr)
+            break;
+
+        total -= largest->texture->get_staging_size(largest->target, largest->target + 1);
+        ++largest->target;
+    }
+}
+
+void texture_streamer::update()
+{
+    PROFILE_ZONE("texture_streamer::update");
+    release_finished_uploads(false);
+    release_retired(false);
+    if(_entries.empty())
+        return;
+
+    pick_targets();
+
+    upload u {};
+    VkDeviceSize uploaded = 0;
+    for( entry& e : _entries)
+    {
+        texture_2d* texture = e.texture;
+        uint32_t resident = texture->get_resident_level();
+        if(e.target == resident)
+            continue;
+
+        VkDeviceSize bytes = e.target < resident ? texture->get_staging_size(e.target, resident) : 0;
+        if(uploaded != 0 && uploaded + bytes > UPLOAD_BUDGET)
+            continue;
+        uploaded += bytes;
+
+        if(u.command_buffer == VK_NULL_HANDLE)
+            u.command_buffer = _device->start_single_time_command_buffer(_device->_graphics_command_pool);
+
+        VkBuffer staging_buffer = VK_NULL_HANDLE;
+        if(bytes != 0)
+        {
+            VkDeviceMemory staging_buffer_memory = VK_NULL_HANDLE;
+            create_buffer(_device->_logical_device, _device->_physical_device, bytes, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, staging_buffer,
+                          VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, staging_buffer_memory);
+
+            void* data = nullptr;
+            VkResult result = vkMapMemory(_device->_logical_device, staging_buffer_memory, 0, VK_WHOLE_SIZE, 0, &data);
+            ASSERT_VULKAN(result);
+            texture->write_levels(e.target, resident, static_cast<uint8_t*>(data));
+            vkUnmapMemory(_device->_logical_device, staging_buffer_memory);
+
+            u.buffers.push_back(staging_buffer);
+            u.memories.push_back(staging_buffer_memory);
+        }
+
+        _resident_bytes -= texture->get_staging_size(resident, texture->get_num_source_levels());
+        texture_2d::retired_image old = texture->record_residency(u.command_buffer, e.target, staging_buffer);
+        _resident_bytes += texture->get_staging_size(e.target, texture->get_num_source_levels());
+
+        //note: every swapchain image records once more, with the new view, before the old image goes away
+        retired r {};
+        r.image = old.image;
+        r.memory = old.memory;
+        r.view = old.view;
+        r.frames = glfw_swapchain::NUM_SWAPCHAIN_IMAGES;
+        _retired.push_back(r);
+        u.textures.push_back(texture);
+    }
+
+    if(u.command_buffer == VK_NULL_HANDLE)
+        return;
+
+    VkResult result = vkEndCommandBuffer(u.command_buffer);
+    ASSERT_VULKAN(result);
+
+    VkFenceCreateInfo fence_info {};
+    fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    result = vkCreateFence(_device->_logical_device, &fence_info, nullptr, &u.fence);
+    ASSERT_VULKAN(result);
+
+    VkSubmitInfo submit_info {};
+    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submit_info.commandBufferCount = 1;
+    submit_info.pCommandBuffers = &u.command_buffer;
+    result = vkQueueSubmit(_device->_graphics_queue, 1, &submit_info, u.fence);
+    ASSERT_VULKAN(result);
+
+    _uploads.push_back(eastl::move(u));
+}
+
+void texture_streamer::release_finished_uploads(bool wait)
+{
+    for( auto it = _uploads.begin(); it != _uploads.end(); )
+    {
+        if(wait)
+        {
+            VkResult result = vkWaitForFences(_device->_logical_device, 1, &it->fence, VK_TRUE, UINT64_MAX);
+            ASSERT_VULKAN(result);
+        }
+        else if(vkGetFenceStatus(_device->_logical_device, it->fence) != VK_SUCCESS)
+        {
+            ++it;
+            continue;
+        }
+
+        for( size_t i = 0; i < it->buffers.size(); ++i)
+        {
+            vkDestroyBuffer(_device->_logical_device, it->buffers[i], nullptr);
+            vkFreeMemory(_device->_logical_device, it->memories[i], nullptr);
+        }
+        vkFreeCommandBuffers(_device->_logical_device, _device->_graphics_command_pool, 1, &it->command_buffer);
+        vkDestroyFence(_device->_logical_device, it->fence, nullptr);
+        it = _uploads.erase(it);
+    }
+}
+
+void texture_streamer::release_retired(bool all)
+{
+    for( auto it = _retired.begin(); it != _retired.end(); )
+    {
+        if(!all && --it->frames != 0)
+        {
+            ++it;
+            continue;
+        }
+
+        vkDestroyImageView(_device->_logical_device, it->view, nullptr);
+        vkDestroyImage(_device->_logical_device, it->image, nullptr);
+        vkFreeMemory(_device->_logical_device, it->memory, nullptr);
+        it = _retired.erase(it);
+    }
+}
+
+void texture_streamer::destroy()
+{
+    release_finished_uploads(true);
+    release_retired(true);
+
+    for( int i = 0; i < _feedback.size(); ++i)
+    {
+        _feedback[i].destroy();
+    }
+    _entries.clear();
+    _slots.clear();
+    _resident_bytes = 0;
+}
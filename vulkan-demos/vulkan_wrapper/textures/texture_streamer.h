@@ -0,0 +1,142 @@
+//
+//  texture_streamer.h
+//  vulkan-demos
+//
+//  Created by Rafael Sabino on 10/19/26.
+//  Copyright © 2026 Rafael Sabino. All rights reserved.
+//
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include "EASTL/array.h"
+#include "EASTL/vector.h"
+#include "EASTL/fixed_vector.h"
+#include "resource.h"
+#include "device.h"
+#include "glfw_swapchain.h"
+#include "storage_buffer.h"
+
+namespace vk
+{
+    class texture_2d;
+
+    //note: keeps only the mip levels of a texture that are needed on the gpu.  A streamed texture_2d starts out with the small
+    //levels at the end of its chain (STREAM_TAIL_SIZE and below) and its full chain stays on the cpu, mapped from its container
+    //or decoded by the asset loader.  Its image on the gpu holds one level and every level smaller than it, the resident level.
+    //
+    //the level a texture needs comes from the shaders.  Fragment shaders that sample streamed textures write how many texels
+    //across the uv range they would need for one texel per pixel into a feedback buffer, one entry per slot, see pbr.frag.  The
+    //feedback of a frame is read back once the fence of its swapchain image is waited on.  Levels are streamed in right away and
+    //out only after FEEDBACK_FRAMES frames without being asked for.  If the resident levels of every texture do not fit in the
+    //budget, the largest textures lose their top level first.
+    //
+    //changing the resident level creates a new image, copies the levels both images share on the gpu and the new ones from a
+    //staging buffer.  Materials rewrite the descriptors of images whose view changed the next time they are committed, the old
+    //image is destroyed once every swapchain image has been recorded again.  Vulkan 1.2 has no view min lod clamp and MoltenVK no
+    //sparse residency, so smaller images are the only way to free the memory of levels that are not needed
+    class texture_streamer : public resource
+    {
+    public:
+
+        static constexpr uint32_t MAX_SLOTS = 1024u;
+        //note: textures are never smaller than this on the gpu
+        static constexpr uint32_t STREAM_TAIL_SIZE = 64u;
+        static constexpr uint32_t FEEDBACK_FRAMES = 60u;
+        //note: bytes of new levels copied to the gpu in one graph update, at least one texture is always streamed in
+        static constexpr VkDeviceSize UPLOAD_BUDGET = 16ull * 1024ull * 1024ull;
+
+        using buffer_array = eastl::array<storage_buffer, glfw_swapchain::NUM_SWAPCHAIN_IMAGES>;
+
+        texture_streamer(){}
+        texture_streamer(device* dev){ _device = dev; }
+
+        //note: textures made while this is false have their whole chain on the gpu, like they used to
+        static void set_enabled(bool enabled){ _enabled = enabled; }
+        static bool is_enabled(){ return _enabled; }
+
+        //note: bytes the resident levels of all streamed textures may use.  0 picks a quarter of the largest device local heap
+        void set_budget(VkDeviceSize bytes);
+        inline VkDeviceSize get_budget() const { return _budget; }
+        inline VkDeviceSize get_resident_bytes() const { return _resident_bytes; }
+
+        //called by texture_2d when it is initialized and destroyed
+        void add(texture_2d* texture);
+        void remove(texture_2d* texture);
+
+        //note: a slot is what a draw writes its feedback to, the textures added to it are streamed by that feedback.  Textures
+        //that are in no slot are wanted at full resolution
+        uint32_t allocate_slot();
+        void add_to_slot(uint32_t slot, texture_2d* texture);
+
+        //note: one per swapchain image, bound by the subpasses that write feedback
+        buffer_array& get_feedback_buffers();
+
+        //called by the graph after the fence of image_id is waited on, before recording it
+        void read_feedback(uint32_t image_id);
+
+        //called by the graph at the end of every frame, makes the feedback written by its shaders visible to read_feedback
+        void record_feedback_barrier(VkCommandBuffer command_buffer);
+
+        //note: the barrier is only recorded once the feedback buffers exist
+        inline bool is_feedback_enabled(){ return _feedback[0].is_initialized(); }
+
+        //called once per frame from graph::update: picks the resident level of every texture and records the changes
+        void update();
+
+        virtual void destroy() override;
+
+        virtual char const * const * get_instance_type() override { return (&_type); };
+        static char const * const *  get_class_type(){ return (&_type); }
+
+    private:
+
+        struct entry
+        {
+            texture_2d* texture = nullptr;
+            //note: lowest level asked for by the feedback of the current window, and frames left in the window
+            uint32_t    requested = 0;
+            uint32_t    wanted = 0;
+            uint32_t    frames = 0;
+            uint32_t    target = 0;
+            bool        has_slot = false;
+        };
+
+        //note: the image a texture had before its resident level changed, frames still in flight may sample it
+        struct retired
+        {
+            VkImage         image = VK_NULL_HANDLE;
+            VkDeviceMemory  memory = VK_NULL_HANDLE;
+            VkImageView     view = VK_NULL_HANDLE;
+            uint32_t        frames = 0;
+        };
+
+        struct upload
+        {
+            VkCommandBuffer command_buffer = VK_NULL_HANDLE;
+            VkFence         fence = VK_NULL_HANDLE;
+            eastl::vector<texture_2d*>      textures {};
+            eastl::vector<VkBuffer>         buffers {};
+            eastl::vector<VkDeviceMemory>   memories {};
+        };
+
+        entry* find(texture_2d* texture);
+        void pick_targets();
+        void release_finished_uploads(bool wait);
+        void release_retired(bool all);
+
+        static bool _enabled;
+        static constexpr char const * _type = nullptr;
+
+        device*                 _device = nullptr;
+        VkDeviceSize            _budget = 0;
+        VkDeviceSize            _resident_bytes = 0;
+
+        eastl::vector<entry>    _entries {};
+        eastl::vector<eastl::vector<texture_2d*>> _slots {};
+        buffer_array            _feedback {};
+
+        eastl::vector<retired>  _retired {};
+        eastl::vector<upload>   _uploads {};
+    };
+}